@@ -297,6 +297,23 @@ if (HDF4_ENABLE_SZIP_SUPPORT)
   if (CMAKE_VERSION VERSION_GREATER_EQUAL "3.15.0")
     message (VERBOSE "Filter SZIP is ON")
   endif ()
+  if (H4_HAVE_LIBSZ AND NOT SZIP_USE_EXTERNAL)
+    # When the szip library is libaec's wrapper, the decoder can call libaec directly
+    find_library (AEC_LIBRARY NAMES aec libaec HINTS ${SZIP_INCLUDE_DIRS}/../lib)
+    if (AEC_LIBRARY)
+      set (CMAKE_REQUIRED_INCLUDES ${SZIP_INCLUDE_DIRS})
+      set (CMAKE_REQUIRED_LIBRARIES ${AEC_LIBRARY})
+      check_symbol_exists (aec_buffer_decode "libaec.h" H4_HAVE_LIBAEC)
+      unset (CMAKE_REQUIRED_INCLUDES)
+      unset (CMAKE_REQUIRED_LIBRARIES)
+      if (H4_HAVE_LIBAEC)
+        set (LINK_COMP_LIBS ${LINK_COMP_LIBS} ${AEC_LIBRARY})
+        if (CMAKE_VERSION VERSION_GREATER_EQUAL "3.15.0")
+          message (VERBOSE "... decoding with library AEC")
+        endif ()
+      endif ()
+    endif ()
+  endif ()
   if (HDF4_ENABLE_SZIP_ENCODING)
     set (H4_HAVE_SZIP_ENCODER 1)
     set (SZIP_INFO "enabled with encoder")
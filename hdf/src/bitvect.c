@@ -34,12 +34,54 @@ DESIGN
     The data structure is optimized for finding the next zero bit an array
     and caches this location when appropriate. It is NOT similarly optimized
     for finding 1 bits as that is not a use case in the HDF4 library.
+
+    To find a zero bit in a mostly full bit-vector quickly, a second, much
+    smaller bit-vector marks each chunk of BV_CHUNK_SIZE bytes whose bits are
+    all set; those chunks are skipped whole, and the other bytes are checked
+    four at a time.
  */
 
 #define BV_MASTER
 
 #include "bitvect.h" /* Multi-file raster information */
 
+/* # of bytes of the summary of a buffer of 'n' bytes */
+#define BV_FULL_SIZE(n) ((size_t)(((n) / BV_CHUNK_SIZE + 7) / 8))
+
+/* whether the chunk of the buffer at byte 'i' is marked as full */
+#define BV_CHUNK_FULL(b, i) ((b)->full[(i) / BV_CHUNK_SIZE / 8] & bv_bit_value[((i) / BV_CHUNK_SIZE) % 8])
+
+/*--------------------------------------------------------------------------
+ NAME
+    bv_update_full
+ PURPOSE
+    Update the summary bit of a chunk after a bit in it changed
+ USAGE
+    void bv_update_full(b,base_elem)
+        bv_ptr b;                   IN: Bit-vector to use
+        int32 base_elem;            IN: byte that changed
+--------------------------------------------------------------------------*/
+static void
+bv_update_full(bv_ptr b, int32 base_elem)
+{
+    int32    chunk = base_elem / BV_CHUNK_SIZE; /* the chunk of the byte */
+    bv_base *p     = &b->buffer[chunk * BV_CHUNK_SIZE];
+    uint32   word;
+    intn     i;
+
+    if (b->buffer[base_elem] != 255) {
+        b->full[chunk / 8] &= (uint8)~bv_bit_value[chunk % 8];
+        return;
+    }
+
+    for (i = 0; i < BV_CHUNK_SIZE; i += 4) {
+        memcpy(&word, &p[i], sizeof(uint32));
+        if (word != 0xFFFFFFFF)
+            return;
+    }
+    b->full[chunk / 8] |= bv_bit_value[chunk % 8];
+} /* bv_update_full() */
+
 /*--------------------------------------------------------------------------
  NAME
     bv_new
@@ -74,7 +116,7 @@ bv_new(int32 num_bits)
     base_elements =
         ((num_bits % BV_BASE_BITS) > 0) ? (num_bits / BV_BASE_BITS) + 1 : (num_bits / BV_BASE_BITS);
 
-    if ((b = malloc(sizeof(bv_struct))) == NULL)
+    if ((b = calloc(1, sizeof(bv_struct))) == NULL)
         goto error;
 
     b->bits_used  = num_bits;
@@ -88,6 +130,9 @@ bv_new(int32 num_bits)
     memset(b->buffer, 0, array_mem_size);
     b->last_zero = 0;
 
+    if ((b->full = calloc(BV_FULL_SIZE(b->array_size), 1)) == NULL)
+        goto error;
+
     return b;
 error:
     if (b != NULL)
@@ -119,6 +164,7 @@ bv_delete(bv_ptr b)
         return FAIL;
 
     free(b->buffer);
+    free(b->full);
     free(b);
 
     return SUCCEED;
@@ -163,6 +209,7 @@ bv_set(bv_ptr b, int32 bit_num, bv_bool value)
         else {
             /* allocate more space for bits */
             bv_base *old_buf = b->buffer; /* ptr to the old buffer */
+            uint8   *new_full;            /* ptr to the larger summary */
             int32    num_chunks;          /* number of chunks to grab */
             size_t   new_size;
             size_t   extra_size;
@@ -179,6 +226,15 @@ bv_set(bv_ptr b, int32 bit_num, bv_bool value)
             extra_size = (size_t)(num_chunks * BV_CHUNK_SIZE);
             memset(&b->buffer[b->array_size], 0, extra_size);
 
+            /* The new chunks are not full */
+            if (BV_FULL_SIZE(new_size) > BV_FULL_SIZE(b->array_size)) {
+                if ((new_full = realloc(b->full, BV_FULL_SIZE(new_size))) == NULL)
+                    return FAIL;
+                memset(&new_full[BV_FULL_SIZE(b->array_size)], 0,
+                       BV_FULL_SIZE(new_size) - BV_FULL_SIZE(b->array_size));
+                b->full = new_full;
+            }
+
             b->array_size += num_chunks * BV_CHUNK_SIZE;
             b->bits_used = bit_num + 1;
         }
@@ -191,6 +247,7 @@ bv_set(bv_ptr b, int32 bit_num, bv_bool value)
     }
     else
         b->buffer[base_elem] |= bv_bit_value[bit_elem];
+    bv_update_full(b, base_elem);
 
     return SUCCEED;
 } /* bv_set() */
@@ -291,12 +348,29 @@ bv_find_next_zero(bv_ptr b)
     else
         i = 0;
 
-    tmp_buf = &b->buffer[i];
+    while (i < bytes_used) {
+        /* skip the chunks that are full */
+        if (i % BV_CHUNK_SIZE == 0 && BV_CHUNK_FULL(b, i)) {
+            i += BV_CHUNK_SIZE;
+            continue;
+        }
+
+        /* and the bytes that are, four at a time */
+        if (i % 4 == 0 && i + 4 <= bytes_used) {
+            uint32 word;
+
+            memcpy(&word, &b->buffer[i], sizeof(uint32));
+            if (word == 0xFFFFFFFF) {
+                i += 4;
+                continue;
+            }
+        }
 
-    while (i < bytes_used && *tmp_buf == 255) {
+        if (b->buffer[i] != 255)
+            break;
         i++;
-        tmp_buf++;
     }
+    tmp_buf = &b->buffer[i];
 
     if (i < bytes_used) {
         b->last_zero = i;
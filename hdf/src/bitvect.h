@@ -54,6 +54,8 @@ typedef struct bv_struct_tag {
     int32    array_size; /* The number of bv_base elements in the bit-vector */
     int32    last_zero;  /* The last location we know had a zero bit */
     bv_base *buffer;     /* Pointer to the buffer used to store the bits */
+    uint8   *full;       /* One bit per BV_CHUNK_SIZE elements of the buffer,
+                            set when all the bits of those elements are set */
 } bv_struct;
 
 /* Table of bits for each bit position */
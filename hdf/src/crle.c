@@ -58,6 +58,16 @@ static int32 HCIcrle_encode(compinfo_t *info, int32 length, const uint8 *buf);
 
 static int32 HCIcrle_term(compinfo_t *info);
 
+static int32 HCIcrle_flush(compinfo_t *info);
+
+static int32 HCIcrle_unread(compinfo_t *info);
+
+static int32 HCIcrle_get(compinfo_t *info, intn len, uint8 *dst);
+
+static int32 HCIcrle_put(compinfo_t *info, intn len, const uint8 *src);
+
+static intn HCIcrle_runlen(const uint8 *buf, intn len, uint8 c);
+
 /*--------------------------------------------------------------------------
  NAME
     HCIcrle_init -- Initialize a RLE compressed data element.
@@ -83,11 +93,20 @@ HCIcrle_init(accrec_t *access_rec)
     compinfo_t            *info;     /* special element information */
     comp_coder_rle_info_t *rle_info; /* ptr to RLE info */
 
-    info = (compinfo_t *)access_rec->special_info;
+    info     = (compinfo_t *)access_rec->special_info;
+    rle_info = &(info->cinfo.coder_info.rle_info);
+
+    /* write out any pending output before moving */
+    if (HCIcrle_flush(info) == FAIL)
+        HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+
     if (Hseek(info->aid, 0, DF_START) == FAIL) /* seek to beginning of element */
         HRETURN_ERROR(DFE_SEEKERROR, FAIL);
 
-    rle_info = &(info->cinfo.coder_info.rle_info);
+    /* empty the I/O buffer */
+    rle_info->io_len  = 0;
+    rle_info->io_pos  = 0;
+    rle_info->io_mode = 'r';
 
     /* Initialize RLE state information */
     rle_info->rle_state   = RLE_INIT;       /* start in initial state */
@@ -99,6 +118,237 @@ HCIcrle_init(accrec_t *access_rec)
     return (SUCCEED);
 } /* end HCIcrle_init() */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcrle_flush -- Write out the pending output in the I/O buffer.
+
+ USAGE
+    int32 HCIcrle_flush(info)
+    compinfo_t *info;   IN: the info about the compressed element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Writes the encoded bytes collected in the I/O buffer to the compressed
+    element, and leaves the I/O buffer empty.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static int32
+HCIcrle_flush(compinfo_t *info)
+{
+    comp_coder_rle_info_t *rle_info; /* ptr to RLE info */
+
+    rle_info = &(info->cinfo.coder_info.rle_info);
+
+    if (rle_info->io_mode == 'w' && rle_info->io_len > 0)
+        if (Hwrite(info->aid, rle_info->io_len, rle_info->io_buf) == FAIL)
+            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+    rle_info->io_len = 0;
+
+    return (SUCCEED);
+} /* end HCIcrle_flush() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcrle_unread -- Give back the unused bytes read ahead into the I/O buffer.
+
+ USAGE
+    int32 HCIcrle_unread(info)
+    compinfo_t *info;   IN: the info about the compressed element
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Seeks the compressed element back over the bytes read ahead but not
+    decoded yet, so that the next write starts right after the last byte
+    decoded, and leaves the I/O buffer empty.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static int32
+HCIcrle_unread(compinfo_t *info)
+{
+    comp_coder_rle_info_t *rle_info; /* ptr to RLE info */
+
+    rle_info = &(info->cinfo.coder_info.rle_info);
+
+    if (rle_info->io_mode == 'r' && rle_info->io_pos < rle_info->io_len)
+        if (Hseek(info->aid, rle_info->io_pos - rle_info->io_len, DF_CURRENT) == FAIL)
+            HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+    rle_info->io_len = 0;
+    rle_info->io_pos = 0;
+
+    return (SUCCEED);
+} /* end HCIcrle_unread() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcrle_get -- Get bytes from the compressed element through the I/O buffer.
+
+ USAGE
+    int32 HCIcrle_get(info,len,dst)
+    compinfo_t *info;   IN: the info about the compressed element
+    intn len;           IN: number of bytes to get
+    uint8 *dst;         OUT: buffer to store the bytes in
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Copies bytes out of the I/O buffer, refilling it from the compressed
+    element in large reads when it runs out.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+    Past the end of the element the bytes are left as they were, except
+    that a single byte reads as 0xff, the same as the HDgetc()/Hread()
+    calls this replaces.
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static int32
+HCIcrle_get(compinfo_t *info, intn len, uint8 *dst)
+{
+    comp_coder_rle_info_t *rle_info; /* ptr to RLE info */
+    intn                   copy_len; /* number of bytes to copy from the buffer */
+    int32                  n;        /* number of bytes read in */
+
+    rle_info = &(info->cinfo.coder_info.rle_info);
+
+    /* write out any pending output before reading */
+    if (rle_info->io_mode != 'r') {
+        if (HCIcrle_flush(info) == FAIL)
+            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+        rle_info->io_pos  = 0;
+        rle_info->io_mode = 'r';
+    } /* end if */
+
+    while (len > 0) {
+        if (rle_info->io_pos == rle_info->io_len) { /* refill the buffer */
+            if ((n = Hread(info->aid, RLE_IO_BUF_SIZE, rle_info->io_buf)) == FAIL)
+                HRETURN_ERROR(DFE_READERROR, FAIL);
+            rle_info->io_len = (intn)n;
+            rle_info->io_pos = 0;
+            if (n == 0) { /* end of the element */
+                if (len == 1)
+                    *dst = (uint8)FAIL;
+                break;
+            } /* end if */
+        }     /* end if */
+
+        copy_len = MIN(len, rle_info->io_len - rle_info->io_pos);
+        memcpy(dst, &rle_info->io_buf[rle_info->io_pos], (size_t)copy_len);
+        rle_info->io_pos += copy_len;
+        dst += copy_len;
+        len -= copy_len;
+    } /* end while */
+
+    return (SUCCEED);
+} /* end HCIcrle_get() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcrle_put -- Put bytes to the compressed element through the I/O buffer.
+
+ USAGE
+    int32 HCIcrle_put(info,len,src)
+    compinfo_t *info;   IN: the info about the compressed element
+    intn len;           IN: number of bytes to put
+    const uint8 *src;   IN: buffer to get the bytes from
+
+ RETURNS
+    Returns SUCCEED or FAIL
+
+ DESCRIPTION
+    Collects encoded bytes in the I/O buffer, writing it out to the
+    compressed element when it fills up.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static int32
+HCIcrle_put(compinfo_t *info, intn len, const uint8 *src)
+{
+    comp_coder_rle_info_t *rle_info; /* ptr to RLE info */
+    intn                   copy_len; /* number of bytes to copy into the buffer */
+
+    rle_info = &(info->cinfo.coder_info.rle_info);
+
+    /* give back any bytes read ahead before writing */
+    if (rle_info->io_mode != 'w') {
+        if (HCIcrle_unread(info) == FAIL)
+            HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+        rle_info->io_mode = 'w';
+    } /* end if */
+
+    while (len > 0) {
+        if (rle_info->io_len == RLE_IO_BUF_SIZE)
+            if (HCIcrle_flush(info) == FAIL)
+                HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+
+        copy_len = MIN(len, RLE_IO_BUF_SIZE - rle_info->io_len);
+        memcpy(&rle_info->io_buf[rle_info->io_len], src, (size_t)copy_len);
+        rle_info->io_len += copy_len;
+        src += copy_len;
+        len -= copy_len;
+    } /* end while */
+
+    return (SUCCEED);
+} /* end HCIcrle_put() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCIcrle_runlen -- Find the length of a run of bytes.
+
+ USAGE
+    intn HCIcrle_runlen(buf,len,c)
+    const uint8 *buf;   IN: buffer to scan
+    intn len;           IN: number of bytes to scan at most
+    uint8 c;            IN: the byte value of the run
+
+ RETURNS
+    Returns the number of bytes at the start of buf equal to c
+
+ DESCRIPTION
+    Compares a machine word of bytes at a time against a word filled with
+    the run byte, and finishes the run a byte at a time.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static intn
+HCIcrle_runlen(const uint8 *buf, intn len, uint8 c)
+{
+    uint64_t pattern; /* word filled with the run byte */
+    uint64_t word;    /* word of bytes from the buffer */
+    intn     n = 0;
+
+    pattern = (uint64_t)c * 0x0101010101010101ULL;
+    while (n + (intn)sizeof(uint64_t) <= len) {
+        memcpy(&word, &buf[n], sizeof(uint64_t));
+        if (word != pattern)
+            break;
+        n += (intn)sizeof(uint64_t);
+    } /* end while */
+    while (n < len && buf[n] == c)
+        n++;
+
+    return (n);
+} /* end HCIcrle_runlen() */
+
 /*--------------------------------------------------------------------------
  NAME
     HCIcrle_decode -- Decode RLE compressed data into a buffer.
@@ -126,25 +376,28 @@ HCIcrle_decode(compinfo_t *info, int32 length, uint8 *buf)
     comp_coder_rle_info_t *rle_info;    /* ptr to RLE info */
     int32                  orig_length; /* original length to read */
     uintn                  dec_len;     /* length to decode */
-    intn                   c;           /* character to hold a byte read in */
 
     rle_info = &(info->cinfo.coder_info.rle_info);
 
     orig_length = length;                      /* save this for later */
     while (length > 0) {                       /* decode until we have all the bytes we need */
         if (rle_info->rle_state == RLE_INIT) { /* need to figure out RUN or MIX state */
-            if ((c = HDgetc(info->aid)) == FAIL)
+            uint8 c;                           /* control byte read in */
+
+            if (HCIcrle_get(info, 1, &c) == FAIL)
                 HRETURN_ERROR(DFE_READERROR, FAIL);
             if (c & RUN_MASK) {                                        /* run byte */
+                uint8 run_byte;                                        /* the byte repeated in the run */
                 rle_info->rle_state  = RLE_RUN;                        /* set to run state */
                 rle_info->buf_length = (c & COUNT_MASK) + RLE_MIN_RUN; /* run length */
-                if ((rle_info->last_byte = (uintn)HDgetc(info->aid)) == (uintn)FAIL)
+                if (HCIcrle_get(info, 1, &run_byte) == FAIL)
                     HRETURN_ERROR(DFE_READERROR, FAIL);
+                rle_info->last_byte = (uintn)run_byte;
             }                                                          /* end if */
             else {                                                     /* mix byte */
                 rle_info->rle_state  = RLE_MIX;                        /* set to mix state */
                 rle_info->buf_length = (c & COUNT_MASK) + RLE_MIN_MIX; /* mix length */
-                if (Hread(info->aid, rle_info->buf_length, rle_info->buffer) == FAIL)
+                if (HCIcrle_get(info, rle_info->buf_length, rle_info->buffer) == FAIL)
                     HRETURN_ERROR(DFE_READERROR, FAIL);
                 rle_info->buf_pos = 0;
             } /* end else */
@@ -200,7 +453,8 @@ HCIcrle_encode(compinfo_t *info, int32 length, const uint8 *buf)
 {
     comp_coder_rle_info_t *rle_info;    /* ptr to RLE info */
     int32                  orig_length; /* original length to write */
-    intn                   c;           /* character to hold a byte read in */
+    intn                   n;           /* number of bytes handled in one step */
+    uint8                  c[2];        /* control byte and run byte to output */
 
     rle_info = &(info->cinfo.coder_info.rle_info);
 
@@ -217,65 +471,79 @@ HCIcrle_encode(compinfo_t *info, int32 length, const uint8 *buf)
                 break;
 
             case RLE_RUN:
-                /* check for end of run */
-                if ((uintn)*buf != rle_info->last_byte) {
-                    rle_info->rle_state = RLE_MIX;
-                    c                   = RUN_MASK | (rle_info->buf_length - RLE_MIN_RUN);
-                    if (HDputc((uint8)c, info->aid) == FAIL)
+                /* take in as much of the run as will fit in one run code */
+                n = HCIcrle_runlen(buf, (intn)MIN(length, RLE_MAX_RUN - rle_info->buf_length),
+                                   (uint8)rle_info->last_byte);
+                rle_info->buf_length += n;
+                buf += n;
+                length -= n;
+
+                if (rle_info->buf_length >= RLE_MAX_RUN) { /* check for too long */
+                    c[0] = (uint8)(RUN_MASK | (rle_info->buf_length - RLE_MIN_RUN));
+                    c[1] = (uint8)rle_info->last_byte;
+                    if (HCIcrle_put(info, 2, c) == FAIL)
                         HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-                    if (HDputc((uint8)rle_info->last_byte, info->aid) == FAIL)
+                    rle_info->rle_state   = RLE_INIT;
+                    rle_info->second_byte = rle_info->last_byte = (uintn)RLE_NIL;
+                }                      /* end if */
+                else if (length > 0) { /* end of run */
+                    rle_info->rle_state = RLE_MIX;
+                    c[0]                = (uint8)(RUN_MASK | (rle_info->buf_length - RLE_MIN_RUN));
+                    c[1]                = (uint8)rle_info->last_byte;
+                    if (HCIcrle_put(info, 2, c) == FAIL)
                         HRETURN_ERROR(DFE_WRITEERROR, FAIL);
                     rle_info->last_byte  = (uintn)(rle_info->buffer[0] = *buf);
                     rle_info->buf_length = 1;
                     rle_info->buf_pos    = 1;
-                }      /* end if */
-                else { /* run is continuing */
-                    rle_info->buf_length++;
-                    if (rle_info->buf_length >= RLE_MAX_RUN) { /* check for too long */
-                        c = RUN_MASK | (rle_info->buf_length - RLE_MIN_RUN);
-                        if (HDputc((uint8)c, info->aid) == FAIL)
-                            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-                        if (HDputc((uint8)rle_info->last_byte, info->aid) == FAIL)
-                            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-                        rle_info->rle_state   = RLE_INIT;
-                        rle_info->second_byte = rle_info->last_byte = (uintn)RLE_NIL;
-                    } /* end if */
-                }     /* end else */
-                buf++;
-                length--;
+                    buf++;
+                    length--;
+                } /* end if */
                 break;
 
             case RLE_MIX: /* mixed bunch of bytes */
-                /* check for run */
-                if ((uintn)*buf == rle_info->last_byte && (uintn)*buf == rle_info->second_byte) {
-                    rle_info->rle_state = RLE_RUN;                  /* shift to RUN state */
-                    if (rle_info->buf_length > (RLE_MIN_RUN - 1)) { /* check for mixed data to write */
-                        if (HDputc((uint8)((rle_info->buf_length - RLE_MIN_MIX) - (RLE_MIN_RUN - 1)),
-                                   info->aid) == FAIL)
+            {
+                uintn last_byte   = rle_info->last_byte;   /* local copy of the last byte */
+                uintn second_byte = rle_info->second_byte; /* local copy of the second to last byte */
+                intn  buf_length  = rle_info->buf_length;  /* local copy of the mix length */
+
+                /* copy bytes into the mix until three in a row match */
+                /* or the buffer is full */
+                while (length > 0 && !((uintn)*buf == last_byte && (uintn)*buf == second_byte)) {
+                    second_byte                    = last_byte;
+                    last_byte                      = (uintn)*buf;
+                    rle_info->buffer[buf_length++] = *buf++;
+                    length--;
+                    if (buf_length >= RLE_BUF_SIZE)
+                        break;
+                } /* end while */
+                rle_info->last_byte   = last_byte;
+                rle_info->second_byte = second_byte;
+                rle_info->buf_length  = buf_length;
+                rle_info->buf_pos     = buf_length;
+
+                if (buf_length >= RLE_BUF_SIZE) { /* check for too long */
+                    c[0] = (uint8)(buf_length - RLE_MIN_MIX);
+                    if (HCIcrle_put(info, 1, c) == FAIL)
+                        HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+                    if (HCIcrle_put(info, buf_length, rle_info->buffer) == FAIL)
+                        HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+                    rle_info->rle_state   = RLE_INIT;
+                    rle_info->second_byte = rle_info->last_byte = (uintn)RLE_NIL;
+                }                      /* end if */
+                else if (length > 0) { /* found a run */
+                    rle_info->rle_state = RLE_RUN;        /* shift to RUN state */
+                    if (buf_length > (RLE_MIN_RUN - 1)) { /* check for mixed data to write */
+                        c[0] = (uint8)((buf_length - RLE_MIN_MIX) - (RLE_MIN_RUN - 1));
+                        if (HCIcrle_put(info, 1, c) == FAIL)
                             HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-                        if (Hwrite(info->aid, (rle_info->buf_length - (RLE_MIN_RUN - 1)), rle_info->buffer) ==
-                            FAIL)
+                        if (HCIcrle_put(info, buf_length - (RLE_MIN_RUN - 1), rle_info->buffer) == FAIL)
                             HRETURN_ERROR(DFE_WRITEERROR, FAIL);
                     } /* end if */
                     rle_info->buf_length = RLE_MIN_RUN;
-                }      /* end if */
-                else { /* continue MIX */
-                    rle_info->second_byte = rle_info->last_byte;
-                    rle_info->last_byte   = (uintn)(rle_info->buffer[rle_info->buf_pos] = *buf);
-                    rle_info->buf_length++;
-                    rle_info->buf_pos++;
-                    if (rle_info->buf_length >= RLE_BUF_SIZE) { /* check for too long */
-                        if (HDputc((uint8)(rle_info->buf_length - RLE_MIN_MIX), info->aid) == FAIL)
-                            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-                        if (Hwrite(info->aid, rle_info->buf_length, rle_info->buffer) == FAIL)
-                            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-                        rle_info->rle_state   = RLE_INIT;
-                        rle_info->second_byte = rle_info->last_byte = (uintn)RLE_NIL;
-                    } /* end if */
-                }     /* end else */
-                buf++;
-                length--;
-                break;
+                    buf++;
+                    length--;
+                } /* end if */
+            } break;
 
             default:
                 HRETURN_ERROR(DFE_INTERNAL, FAIL)
@@ -309,23 +577,23 @@ static int32
 HCIcrle_term(compinfo_t *info)
 {
     comp_coder_rle_info_t *rle_info; /* ptr to RLE info */
-    intn                   c;        /* character to hold a byte read in */
+    uint8                  c[2];     /* control byte and run byte to output */
 
     rle_info = &(info->cinfo.coder_info.rle_info);
 
     switch (rle_info->rle_state) {
         case RLE_RUN:
-            c = RUN_MASK | (rle_info->buf_length - RLE_MIN_RUN);
-            if (HDputc((uint8)c, info->aid) == FAIL)
-                HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-            if (HDputc((uint8)rle_info->last_byte, info->aid) == FAIL)
+            c[0] = (uint8)(RUN_MASK | (rle_info->buf_length - RLE_MIN_RUN));
+            c[1] = (uint8)rle_info->last_byte;
+            if (HCIcrle_put(info, 2, c) == FAIL)
                 HRETURN_ERROR(DFE_WRITEERROR, FAIL);
             break;
 
         case RLE_MIX: /* mixed bunch of bytes */
-            if (HDputc((uint8)((rle_info->buf_length - RLE_MIN_MIX)), info->aid) == FAIL)
+            c[0] = (uint8)(rle_info->buf_length - RLE_MIN_MIX);
+            if (HCIcrle_put(info, 1, c) == FAIL)
                 HRETURN_ERROR(DFE_WRITEERROR, FAIL);
-            if (Hwrite(info->aid, rle_info->buf_length, rle_info->buffer) == FAIL)
+            if (HCIcrle_put(info, rle_info->buf_length, rle_info->buffer) == FAIL)
                 HRETURN_ERROR(DFE_WRITEERROR, FAIL);
             break;
 
@@ -373,7 +641,21 @@ HCIcrle_staccess(accrec_t *access_rec, int16 acc_mode)
 
     if (info->aid == FAIL)
         HRETURN_ERROR(DFE_DENIED, FAIL);
-    return (HCIcrle_init(access_rec)); /* initialize the RLE info */
+
+    /* allocate the buffer for I/O to the compressed element */
+    if ((info->cinfo.coder_info.rle_info.io_buf = (uint8 *)malloc(RLE_IO_BUF_SIZE)) == NULL)
+        HRETURN_ERROR(DFE_NOSPACE, FAIL);
+    info->cinfo.coder_info.rle_info.io_len  = 0;
+    info->cinfo.coder_info.rle_info.io_mode = 'r';
+
+    /* initialize the RLE info */
+    if (HCIcrle_init(access_rec) == FAIL) {
+        free(info->cinfo.coder_info.rle_info.io_buf);
+        info->cinfo.coder_info.rle_info.io_buf = NULL;
+        HRETURN_ERROR(DFE_CINIT, FAIL);
+    } /* end if */
+
+    return SUCCEED;
 } /* end HCIcrle_staccess() */
 
 /*--------------------------------------------------------------------------
@@ -649,8 +931,18 @@ HCPcrle_endaccess(accrec_t *access_rec)
 
     /* flush out RLE buffer */
     if ((access_rec->access & DFACC_WRITE) && rle_info->rle_state != RLE_INIT)
-        if (HCIcrle_term(info) == FAIL)
+        if (HCIcrle_term(info) == FAIL) {
+            free(rle_info->io_buf);
+            rle_info->io_buf = NULL;
             HRETURN_ERROR(DFE_CTERM, FAIL);
+        } /* end if */
+    if (HCIcrle_flush(info) == FAIL) {
+        free(rle_info->io_buf);
+        rle_info->io_buf = NULL;
+        HRETURN_ERROR(DFE_CTERM, FAIL);
+    } /* end if */
+    free(rle_info->io_buf);
+    rle_info->io_buf = NULL;
 
     /* close the compressed data AID */
     if (Hendaccess(info->aid) == FAIL)
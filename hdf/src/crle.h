@@ -55,6 +55,8 @@ HDFLIBAPI intn HCPcrle_endaccess(accrec_t *access_rec);
 
 /* size of the RLE buffer */
 #define RLE_BUF_SIZE 128
+/* size of the buffer for bytes read from or written to the compressed element */
+#define RLE_IO_BUF_SIZE 8192
 /* NIL code for run bytes */
 #define RLE_NIL (-1)
 /* minimum length of run */
@@ -92,6 +94,10 @@ typedef struct {
         RLE_RUN,  /* buffer up to the current position is a run */
         RLE_MIX   /* buffer up to the current position is a mix */
     } rle_state;  /* state of the buffer storage */
+    uint8 *io_buf;  /* buffer for bytes read from or written to the element */
+    intn   io_len;  /* number of bytes in io_buf */
+    intn   io_pos;  /* position of the next byte to read from io_buf */
+    uint8  io_mode; /* what io_buf holds now ('r' - read-ahead, 'w' - pending output) */
 } comp_coder_rle_info_t;
 
 #ifndef CRLE_MASTER
@@ -162,6 +162,12 @@ HCIcskphuff_init(accrec_t *access_rec, uintn alloc_buf)
     skphuff_info->skip_pos = 0; /* start in first byte */
     skphuff_info->offset   = 0; /* start at the beginning of the data */
 
+    /* Empty the decoder's read-ahead bits */
+    skphuff_info->bit_buf   = 0;
+    skphuff_info->bit_count = 0;
+    skphuff_info->bit_read  = 0;
+    skphuff_info->bit_start = 0;
+
     if (alloc_buf == TRUE) {
         /* allocate pointers to the compression buffers */
         if ((skphuff_info->left = (uintn **)malloc(sizeof(uintn *) * (uintn)skphuff_info->skip_size)) == NULL)
@@ -231,28 +237,47 @@ HCIcskphuff_decode(compinfo_t *info, int32 length, uint8 *buf)
 {
     comp_coder_skphuff_info_t *skphuff_info; /* ptr to skipping Huffman info */
     int32                      orig_length;  /* original length to read */
-    uint32                     bit;          /* bit from the file */
-    uintn                      a;
-    uint8                      plain; /* the source code expanded from the file */
+    uint32                     bit_buf;      /* local copy of the read-ahead bits */
+    intn                       bit_count;    /* number of unused bits in bit_buf */
+    intn                       n;            /* number of bits read in */
+    int32                      left;         /* number of bytes left in the element */
+    const uintn               *lleft,        /* local copy of the left pointer */
+        *lright;                             /* local copy of the right pointer */
+    uintn a;
+    uint8 plain; /* the source code expanded from the file */
 
     skphuff_info = &(info->cinfo.coder_info.skphuff_info);
 
+    bit_buf   = skphuff_info->bit_buf;
+    bit_count = skphuff_info->bit_count;
+
     orig_length = length; /* save this for later */
     while (length > 0) {  /* decode until we have all the bytes we need */
 #ifdef TESTING
         printf("length=%ld\n", (long)length);
 #endif            /* TESTING */
-        a = ROOT; /* start at the root of the tree and find the leaf we need */
+        lleft  = skphuff_info->left[skphuff_info->skip_pos];
+        lright = skphuff_info->right[skphuff_info->skip_pos];
+        a      = ROOT; /* start at the root of the tree and find the leaf we need */
 
         do { /* walk down once for each bit on the path */
-#ifdef TESTING
-            intn bitcount = 0;
-            printf("bitcount=%d\n", ++bitcount);
-#endif /* TESTING */
-            if (Hbitread(info->aid, 1, &bit) == FAIL)
-                HRETURN_ERROR(DFE_CDECODE, FAIL);
-            a = ((bit == 0) ? (skphuff_info->left[skphuff_info->skip_pos][a])
-                            : (skphuff_info->right[skphuff_info->skip_pos][a]));
+            if (bit_count == 0) {
+                /* Refill the read-ahead bits a whole word at a time, since */
+                /* the tree changes after every code there's no use in */
+                /* decoding more than one bit per step.  Near the end of */
+                /* the element only the bits left in it are read */
+                skphuff_info->bit_start += skphuff_info->bit_read / (intn)BITNUM;
+                skphuff_info->bit_read %= (intn)BITNUM;
+                n    = (intn)DATANUM;
+                left = skphuff_info->bit_end - skphuff_info->bit_start;
+                if (left <= (int32)(DATANUM / BITNUM))
+                    n = (intn)left * (intn)BITNUM - skphuff_info->bit_read;
+                if (n <= 0 || Hbitread(info->aid, n, &bit_buf) != n)
+                    HRETURN_ERROR(DFE_CDECODE, FAIL);
+                skphuff_info->bit_read += n;
+                bit_count = n;
+            } /* end if */
+            a = ((bit_buf >> --bit_count) & 1) == 0 ? lleft[a] : lright[a];
         } while (a <= SKPHUFF_MAX_CHAR);
 
         plain = (uint8)(a - SUCCMAX);
@@ -260,7 +285,10 @@ HCIcskphuff_decode(compinfo_t *info, int32 length, uint8 *buf)
         skphuff_info->skip_pos = (skphuff_info->skip_pos + 1) % skphuff_info->skip_size;
         *buf++                 = plain;
         length--;
-    }                                    /* end while */
+    } /* end while */
+
+    skphuff_info->bit_buf   = bit_buf;
+    skphuff_info->bit_count = bit_count;
     skphuff_info->offset += orig_length; /* incr. abs. offset into the file */
     return (SUCCEED);
 } /* end HCIcskphuff_decode() */
@@ -300,6 +328,17 @@ HCIcskphuff_encode(compinfo_t *info, int32 length, const uint8 *buf)
 
     skphuff_info = &(info->cinfo.coder_info.skphuff_info);
 
+    /* Move back over any bits the decoder read ahead, so appending */
+    /* after reading starts right after the last code read */
+    if (skphuff_info->bit_count > 0) {
+        intn used = skphuff_info->bit_read - skphuff_info->bit_count;
+
+        if (Hbitseek(info->aid, skphuff_info->bit_start + used / (intn)BITNUM, used % (intn)BITNUM) == FAIL)
+            HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+        skphuff_info->bit_count = 0;
+        skphuff_info->bit_read  = used;
+    } /* end if */
+
     orig_length = length;                       /* save this for later */
     while (length > 0) {                        /* encode until we stored all the bytes */
         a              = (uintn)*buf + SUCCMAX; /* find position in the up array */
@@ -327,15 +366,23 @@ HCIcskphuff_encode(compinfo_t *info, int32 length, const uint8 *buf)
                 if (Hbitwrite(info->aid, (intn)bit_count[stack_ptr], output_bits[stack_ptr]) !=
                     (intn)bit_count[stack_ptr])
                     HRETURN_ERROR(DFE_CENCODE, FAIL);
+                skphuff_info->bit_read += (intn)bit_count[stack_ptr];
             } /* end if */
             stack_ptr--;
         } while (stack_ptr >= 0);
+
+        /* keep the position for the decoder, which reads on from here */
+        skphuff_info->bit_start += skphuff_info->bit_read / (intn)BITNUM;
+        skphuff_info->bit_read %= (intn)BITNUM;
         HCIcskphuff_splay(skphuff_info, *buf); /* semi-splay the tree around this node */
         skphuff_info->skip_pos = (skphuff_info->skip_pos + 1) % skphuff_info->skip_size;
         buf++;
         length--;
     } /* end while */
 
+    /* the element now reaches at least to the byte of the last code */
+    if (skphuff_info->bit_end < skphuff_info->bit_start + (skphuff_info->bit_read > 0 ? 1 : 0))
+        skphuff_info->bit_end = skphuff_info->bit_start + (skphuff_info->bit_read > 0 ? 1 : 0);
     skphuff_info->offset += orig_length; /* incr. abs. offset into the file */
     return (SUCCEED);
 } /* end HCIcskphuff_encode() */
@@ -408,9 +455,17 @@ HCIcskphuff_term(compinfo_t *info)
 static int32
 HCIcskphuff_staccess(accrec_t *access_rec, int16 acc_mode)
 {
-    compinfo_t *info; /* special element information */
+    compinfo_t                *info;         /* special element information */
+    comp_coder_skphuff_info_t *skphuff_info; /* ptr to skphuff info */
 
-    info = (compinfo_t *)access_rec->special_info;
+    info         = (compinfo_t *)access_rec->special_info;
+    skphuff_info = &(info->cinfo.coder_info.skphuff_info);
+
+    /* the decoder must not read past the end of the element */
+    skphuff_info->bit_end = 0;
+    if (Hexist(access_rec->file_id, DFTAG_COMPRESSED, info->comp_ref) == SUCCEED &&
+        (skphuff_info->bit_end = Hlength(access_rec->file_id, DFTAG_COMPRESSED, info->comp_ref)) == FAIL)
+        HRETURN_ERROR(DFE_INTERNAL, FAIL);
 
 #ifdef TESTING
     printf("HCIcskphuff_staccess(): before bitio calls\n");
@@ -69,9 +69,14 @@ typedef struct {
     intn    skip_size; /* number of bytes in each element */
     uintn **left,      /* define the left and right pointer arrays */
         **right;
-    uint8 **up;       /* define the up pointer array */
-    intn    skip_pos; /* current byte to read or write */
-    int32   offset;   /* offset in the de-compressed array */
+    uint8 **up;        /* define the up pointer array */
+    intn    skip_pos;  /* current byte to read or write */
+    int32   offset;    /* offset in the de-compressed array */
+    uint32  bit_buf;   /* bits read ahead from the element by the decoder */
+    intn    bit_count; /* number of unused bits in bit_buf */
+    intn    bit_read;  /* number of bits read or written from bit_start on */
+    int32   bit_start; /* byte offset in the element bit_read counts from */
+    int32   bit_end;   /* length of the element in bytes, reads stop there */
 } comp_coder_skphuff_info_t;
 
 #ifndef CSKPHUFF_MASTER
@@ -18,6 +18,9 @@
 
 #ifdef H4_HAVE_LIBSZ
 #include "szlib.h"
+#ifdef H4_HAVE_LIBAEC
+#include "libaec.h"
+#endif
 #endif
 
 #define CSZIP_MASTER
@@ -194,21 +197,31 @@ HCIcszip_decode(compinfo_t *info, int32 length, uint8 *buf)
             bytes_per_pixel++;
 
         out_length = szip_info->pixels * bytes_per_pixel;
-        if ((out_buffer = (uint8 *)malloc(out_length)) == NULL)
+
+        /* When all of the data is wanted at once (the chunk cache reads */
+        /* whole chunks), decode straight into the caller's buffer instead */
+        /* of decoding into a temporary buffer and copying it out */
+        if (length == out_length)
+            out_buffer = buf;
+        else if ((out_buffer = (uint8 *)malloc(out_length)) == NULL) {
+            free(in_buffer);
             HRETURN_ERROR(DFE_NOSPACE, FAIL);
+        }
 
         /* Read the unompressed data */
         if (old_way == 1) {
             /* this is encoded in V4.2r0 */
             /* the preamble isn't in the file, so read only the data */
             if ((rbytes = Hread(info->aid, in_length - 5, in_buffer + 5)) == FAIL) {
-                free(out_buffer);
+                if (out_buffer != buf)
+                    free(out_buffer);
                 free(in_buffer);
                 HRETURN_ERROR(DFE_READERROR, FAIL);
             }
             if (rbytes == 0 || rbytes != (in_length - 5)) {
                 /* is this possible? */
-                free(out_buffer);
+                if (out_buffer != buf)
+                    free(out_buffer);
                 free(in_buffer);
                 HRETURN_ERROR(DFE_READERROR, FAIL);
             }
@@ -216,13 +229,15 @@ HCIcszip_decode(compinfo_t *info, int32 length, uint8 *buf)
         else {
             /* HDF4.2R1: read the data plus preamble */
             if ((rbytes = Hread(info->aid, in_length, in_buffer)) == FAIL) {
-                free(out_buffer);
+                if (out_buffer != buf)
+                    free(out_buffer);
                 free(in_buffer);
                 HRETURN_ERROR(DFE_READERROR, FAIL);
             }
             if (rbytes == 0 || rbytes != in_length) {
                 /* is this possible? */
-                free(out_buffer);
+                if (out_buffer != buf)
+                    free(out_buffer);
                 free(in_buffer);
                 HRETURN_ERROR(DFE_READERROR, FAIL);
             }
@@ -233,29 +248,29 @@ HCIcszip_decode(compinfo_t *info, int32 length, uint8 *buf)
         if (in_buffer[0] == 1) {
             /* This byte means the data was not compressed -- just copy out */
             szip_info->szip_state = SZIP_RUN;
-            memcpy(out_buffer, in_buffer + 5, good_bytes);
-            szip_info->buffer      = out_buffer;
-            szip_info->buffer_pos  = 0;
-            szip_info->buffer_size = good_bytes;
-            szip_info->offset      = 0;
             if (good_bytes > length) {
-                /* partial read */
+                /* partial read, keep the rest of the data for later */
+                if (out_buffer == buf && (out_buffer = (uint8 *)malloc(good_bytes)) == NULL) {
+                    free(in_buffer);
+                    HRETURN_ERROR(DFE_NOSPACE, FAIL);
+                }
+                memcpy(out_buffer, in_buffer + 5, good_bytes);
                 memcpy(buf, in_buffer + 5, length);
-                szip_info->buffer_pos += length;
-                szip_info->buffer_size -= length;
+                szip_info->buffer      = out_buffer;
+                szip_info->buffer_pos  = length;
+                szip_info->buffer_size = good_bytes - length;
             }
             else {
                 /* read the whole data block to the user buffer */
                 memcpy(buf, in_buffer + 5, good_bytes);
-                szip_info->buffer_pos += good_bytes;
-                szip_info->buffer_size -= good_bytes;
+                if (out_buffer != buf)
+                    free(out_buffer);
+                szip_info->buffer      = NULL;
+                szip_info->buffer_pos  = good_bytes;
+                szip_info->buffer_size = 0;
             }
             szip_info->offset = szip_info->buffer_pos;
             free(in_buffer);
-            if (szip_info->buffer_size == 0) {
-                free(szip_info->buffer);
-                szip_info->buffer = NULL;
-            }
             return (SUCCEED);
         }
 
@@ -267,12 +282,46 @@ HCIcszip_decode(compinfo_t *info, int32 length, uint8 *buf)
         sz_param.pixels_per_block    = szip_info->pixels_per_block;
         sz_param.pixels_per_scanline = szip_info->pixels_per_scanline;
         size_out                     = out_length;
-        if (SZ_OK != (status = SZ_BufftoBuffDecompress(out_buffer, &size_out, (in_buffer + 5), good_bytes,
-                                                       &sz_param))) {
-            free(out_buffer);
-            free(in_buffer);
-            HRETURN_ERROR(DFE_CDECODE, FAIL);
+#ifdef H4_HAVE_LIBAEC
+        /* libaec's SZIP functions are a wrapper around its own decoder; */
+        /* call the decoder directly unless the wrapper has to pad */
+        /* scanlines or de-interleave 32 and 64-bit pixels */
+        if ((sz_param.pixels_per_scanline % sz_param.pixels_per_block) == 0 &&
+            sz_param.bits_per_pixel != 32 && sz_param.bits_per_pixel != 64) {
+            struct aec_stream strm;
+
+            strm.bits_per_sample = (unsigned)sz_param.bits_per_pixel;
+            strm.block_size      = (unsigned)sz_param.pixels_per_block;
+            strm.rsi             = (unsigned)(sz_param.pixels_per_scanline / sz_param.pixels_per_block);
+            strm.flags           = 0;
+            if (sz_param.options_mask & SZ_MSB_OPTION_MASK)
+                strm.flags |= AEC_DATA_MSB;
+            if (sz_param.options_mask & SZ_NN_OPTION_MASK)
+                strm.flags |= AEC_DATA_PREPROCESS;
+#ifdef AEC_NOT_ENFORCE
+            strm.flags |= AEC_NOT_ENFORCE;
+#endif
+            strm.next_in   = in_buffer + 5;
+            strm.avail_in  = (size_t)good_bytes;
+            strm.next_out  = out_buffer;
+            strm.avail_out = size_out;
+            if (AEC_OK != (status = aec_buffer_decode(&strm))) {
+                if (out_buffer != buf)
+                    free(out_buffer);
+                free(in_buffer);
+                HRETURN_ERROR(DFE_CDECODE, FAIL);
+            }
+            size_out = strm.total_out;
         }
+        else
+#endif /* H4_HAVE_LIBAEC */
+            if (SZ_OK != (status = SZ_BufftoBuffDecompress(out_buffer, &size_out, (in_buffer + 5),
+                                                           good_bytes, &sz_param))) {
+                if (out_buffer != buf)
+                    free(out_buffer);
+                free(in_buffer);
+                HRETURN_ERROR(DFE_CDECODE, FAIL);
+            }
 
         if ((int32)size_out != out_length) {
             /* This should never happen?? */
@@ -281,11 +330,19 @@ HCIcszip_decode(compinfo_t *info, int32 length, uint8 *buf)
 
         /* The data is successfully decompressed. Put into the szip struct */
         free(in_buffer);
-        szip_info->szip_state  = SZIP_RUN;
+        szip_info->szip_state = SZIP_RUN;
+        szip_info->offset     = 0;
+        if (out_buffer == buf) {
+            /* all of the data went to the caller already */
+            szip_info->buffer      = NULL;
+            szip_info->buffer_pos  = out_length;
+            szip_info->buffer_size = 0;
+            szip_info->offset      = out_length;
+            return (SUCCEED);
+        }
         szip_info->buffer      = out_buffer;
         szip_info->buffer_pos  = 0;
         szip_info->buffer_size = out_length;
-        szip_info->offset      = 0;
     }
 
     /* copy the data into the return buffer */
@@ -26,6 +26,7 @@ EXPORTED ROUTINES
    Hstartbitwrite - open a dataset for bitfile dataset writing
    Happendable    - make a writable dataset appendable
    Hbitread       - read bits from a bitfile dataset
+   Hbitread_n     - read a number of fixed-width bit fields from a bitfile dataset
    Hbitwrite      - write bits to a bitfile dataset
    Hbitseek       - seek to a given bit offset in a bitfile dataset
    Hendbitaccess  - close off access to a bitfile dataset
@@ -285,6 +286,9 @@ Hbitwrite(int32 bitid, intn count, uint32 data)
     static int32     last_bit_id = (-1);  /* the bit ID of the last bitfile_record accessed */
     static bitrec_t *bitfile_rec = NULL;  /* access record */
     intn             orig_count  = count; /* keep track of orig, number of bits to output */
+    intn             nbits;               /* number of buffered and new bits together */
+    intn             nbytes;              /* number of whole bytes in those bits */
+    intn             i;
 
     /* clear error stack and check validity of file id */
     HEclear();
@@ -322,6 +326,29 @@ Hbitwrite(int32 bitid, intn count, uint32 data)
         return (orig_count);
     } /* end if */
 
+    /* if the completed bytes fit in the buffer without filling it, merge */
+    /* the buffered bits and the new bits in a 64-bit accumulator and */
+    /* store all the whole bytes at once */
+    nbits  = ((intn)BITNUM - bitfile_rec->count) + count;
+    nbytes = nbits / (intn)BITNUM;
+    if ((bitfile_rec->bytez - bitfile_rec->bytep) > nbytes) {
+        uint64_t acc; /* buffered bits followed by the new bits */
+
+        acc = ((uint64_t)((uintn)bitfile_rec->bits >> bitfile_rec->count) << count) | (uint64_t)data;
+        nbits -= nbytes * (intn)BITNUM;
+        for (i = nbytes - 1; i >= 0; i--)
+            *(bitfile_rec->bytep++) = (uint8)(acc >> (nbits + i * (intn)BITNUM));
+        bitfile_rec->byte_offset += nbytes;
+
+        /* keep the leftover bits, left-justified, in the bits buffer */
+        bitfile_rec->count = (intn)BITNUM - nbits;
+        bitfile_rec->bits  = (uint8)(acc << bitfile_rec->count);
+
+        if (bitfile_rec->byte_offset > bitfile_rec->max_offset)
+            bitfile_rec->max_offset = bitfile_rec->byte_offset;
+        return (orig_count);
+    } /* end if */
+
     /* fill up the current bits buffer and output the byte */
     *(bitfile_rec->bytep) = (uint8)(bitfile_rec->bits | (uint8)(data >> (count -= bitfile_rec->count)));
     bitfile_rec->byte_offset++;
@@ -418,6 +445,7 @@ Hbitread(int32 bitid, intn count, uint32 *data)
     uint32           l;
     uint32           b = 0;      /* bits to return */
     intn             orig_count; /* the original number of bits to read in */
+    intn             nbytes;     /* number of bytes needed beyond the buffered bits */
     int32            n;
 
     /* clear error stack and check validity of file id */
@@ -451,6 +479,32 @@ Hbitread(int32 bitid, intn count, uint32 *data)
         return (count);
     } /* end if */
 
+    /* if the rest of the request is already in the buffer, gather the */
+    /* bytes into a 64-bit accumulator and extract the bits in one pass */
+    nbytes = (count - bitfile_rec->count + (intn)BITNUM - 1) / (intn)BITNUM;
+    if ((bitfile_rec->bytez - bitfile_rec->bytep) >= nbytes) {
+        uint64_t acc;   /* buffered bits followed by the new bytes */
+        intn     nbits; /* number of unused bits left in the accumulator */
+        intn     i;
+
+        acc = (uint64_t)(bitfile_rec->bits & maskc[bitfile_rec->count]);
+        for (i = 0; i < nbytes; i++)
+            acc = (acc << BITNUM) | (uint64_t)bitfile_rec->bytep[i];
+        nbits = bitfile_rec->count + nbytes * (intn)BITNUM - count;
+
+        bitfile_rec->bytep += nbytes;
+        bitfile_rec->byte_offset += nbytes;
+        if (bitfile_rec->byte_offset > bitfile_rec->max_offset)
+            bitfile_rec->max_offset = bitfile_rec->byte_offset;
+
+        /* the unused bits are the low bits of the last byte read */
+        if ((bitfile_rec->count = nbits) > 0)
+            bitfile_rec->bits = *(bitfile_rec->bytep - 1);
+
+        *data = (uint32)(acc >> nbits) & maskl[count];
+        return (count);
+    } /* end if */
+
     /* keep track of the original number of bits to read in */
     orig_count = count;
 
@@ -464,7 +518,7 @@ Hbitread(int32 bitid, intn count, uint32 *data)
     while (count >= (intn)BITNUM) {
         if (bitfile_rec->bytep == bitfile_rec->bytez) {
             n = Hread(bitfile_rec->acc_id, BITBUF_SIZE, bitfile_rec->bytea);
-            if (n == FAIL) { /* EOF */
+            if (n == FAIL || n == 0) { /* EOF */
                 bitfile_rec->count =
                     0;     /* make certain that we don't try to access the file->bits information */
                 *data = b; /* assign the bits read in */
@@ -486,7 +540,7 @@ Hbitread(int32 bitid, intn count, uint32 *data)
     if (count > 0) {
         if (bitfile_rec->bytep == bitfile_rec->bytez) {
             n = Hread(bitfile_rec->acc_id, BITBUF_SIZE, bitfile_rec->bytea);
-            if (n == FAIL) { /* EOF */
+            if (n == FAIL || n == 0) { /* EOF */
                 bitfile_rec->count =
                     0;     /* make certain that we don't try to access the file->bits information */
                 *data = b; /* assign the bits read in */
@@ -511,6 +565,111 @@ Hbitread(int32 bitid, intn count, uint32 *data)
     return (orig_count);
 } /* end Hbitread() */
 
+/*--------------------------------------------------------------------------
+
+ NAME
+       Hbitread_n -- read a number of fixed-width bit fields from a bit-element
+ USAGE
+       int32 Hbitread_n(bitid, count, nitems, data)
+       int32 bitid;         IN: id of bit-element to read from
+       intn count;          IN: number of bits in each field
+       int32 nitems;        IN: number of fields to read
+       uint32 *data;        OUT: array of nitems fields read
+                            (bits input will be in the low bits)
+ RETURNS
+       the number of whole fields read on success,
+       FAIL to indicate failure
+ DESCRIPTION
+       Read a sequence of fields of the same width from a bit-element.
+       The result is the same as calling Hbitread() nitems times, but the
+       bytes are gathered into a 64-bit accumulator a word at a time and
+       the buffer is only refilled from Hread() when it is exhausted.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+       If the end of the element is reached in the middle of a field, the
+       bits of the partial field are read and discarded, and the number of
+       whole fields read so far is returned.
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+int32
+Hbitread_n(int32 bitid, intn count, int32 nitems, uint32 *data)
+{
+    bitrec_t *bitfile_rec; /* access record */
+    uint64_t  acc;         /* bit accumulator, unused bits are right-justified */
+    intn      nbits;       /* number of unused bits in the accumulator */
+    int32     nbytes = 0;  /* number of bytes moved into the accumulator */
+    uint32    mask;        /* mask for one field */
+    uint8    *p;           /* local copy of the buffer position */
+    int32     n;
+    int32     i;
+
+    /* clear error stack and check validity of file id */
+    HEclear();
+
+    if (count <= 0 || count > (intn)DATANUM || nitems < 0 || data == NULL)
+        HRETURN_ERROR(DFE_ARGS, FAIL);
+
+    if ((bitfile_rec = HAatom_object(bitid)) == NULL)
+        HRETURN_ERROR(DFE_ARGS, FAIL);
+
+    /* change bitfile modes if necessary */
+    if (bitfile_rec->mode == 'w')
+        if (HIwrite2read(bitfile_rec) == FAIL)
+            HRETURN_ERROR(DFE_INTERNAL, FAIL);
+
+    acc   = (uint64_t)(bitfile_rec->bits & maskc[bitfile_rec->count]);
+    nbits = bitfile_rec->count;
+    mask  = maskl[count];
+    p     = bitfile_rec->bytep;
+    for (i = 0; i < nitems; i++) {
+        while (nbits < count) {
+            if (p == bitfile_rec->bytez) {
+                n = Hread(bitfile_rec->acc_id, BITBUF_SIZE, bitfile_rec->bytea);
+                if (n == FAIL || n == 0) { /* EOF */
+                    nbits = 0; /* throw away the bits of the partial field */
+                    goto done;
+                } /* end if */
+                bitfile_rec->block_offset += bitfile_rec->buf_read;
+                bitfile_rec->bytez    = bitfile_rec->bytea + n;
+                bitfile_rec->buf_read = n;
+                p                     = bitfile_rec->bytea;
+            } /* end if */
+
+            /* nbits is less than 32 here, so a whole word always fits */
+            if ((bitfile_rec->bytez - p) >= 4) {
+                acc = (acc << 32) | ((uint64_t)p[0] << 24) | ((uint64_t)p[1] << 16) |
+                      ((uint64_t)p[2] << 8) | (uint64_t)p[3];
+                p += 4;
+                nbits += 32;
+                nbytes += 4;
+            } /* end if */
+            else {
+                acc = (acc << BITNUM) | (uint64_t)*p++;
+                nbits += (intn)BITNUM;
+                nbytes++;
+            } /* end else */
+        }     /* end while */
+        nbits -= count;
+        data[i] = (uint32)(acc >> nbits) & mask;
+    } /* end for */
+
+done:
+    /* give the whole unused bytes back to the buffer and keep the unused */
+    /* bits of the last byte read in the bits buffer (the field boundary is */
+    /* always within the current buffer, so all of these bytes are still there) */
+    p -= nbits / (intn)BITNUM;
+    nbytes -= nbits / (intn)BITNUM;
+    if ((bitfile_rec->count = nbits % (intn)BITNUM) > 0)
+        bitfile_rec->bits = *(p - 1);
+    bitfile_rec->bytep = p;
+    bitfile_rec->byte_offset += nbytes;
+    if (bitfile_rec->byte_offset > bitfile_rec->max_offset)
+        bitfile_rec->max_offset = bitfile_rec->byte_offset;
+
+    return (i);
+} /* end Hbitread_n() */
+
 /*--------------------------------------------------------------------------
 
  NAME
@@ -586,8 +745,9 @@ Hbitseek(int32 bitid, int32 byte_offset, intn bit_offset)
             bitfile_rec->bits = *(bitfile_rec->bytep);
             bitfile_rec->bits &= maskc[bit_offset] << bitfile_rec->count;
         } /* end if */
-        else {
+        else { /* the byte is taken out of the buffer, count it as Hbitread() does */
             bitfile_rec->bits = *bitfile_rec->bytep++;
+            bitfile_rec->byte_offset++;
         } /* end else */
     }     /* end if */
     else {
@@ -818,9 +978,24 @@ static intn
 HIread2write(bitrec_t *bitfile_rec)
 {
 
-    bitfile_rec->block_offset = (int32)LONG_MIN; /* set to bogus value */
-    bitfile_rec->mode         = 'w';             /* change to write mode */
-    if (Hbitseek(bitfile_rec->bit_id, bitfile_rec->byte_offset, ((intn)BITNUM - bitfile_rec->count)) == FAIL)
+    int32 byte_offset = bitfile_rec->byte_offset; /* byte to go on writing in */
+    intn  bit_offset  = 0;                        /* bit to go on writing at */
+
+    /* the byte the unread bits came from has already been counted */
+    if (bitfile_rec->count > 0) {
+        byte_offset--;
+        bit_offset = (intn)BITNUM - bitfile_rec->count;
+    } /* end if */
+
+    /* the buffered block is unchanged, so there are no bits to flush, and */
+    /* writing expects the file at the start of the block */
+    bitfile_rec->count = BITNUM;
+    bitfile_rec->bits  = 0;
+    if (Hseek(bitfile_rec->acc_id, bitfile_rec->block_offset, DF_START) == FAIL)
+        HRETURN_ERROR(DFE_SEEKERROR, FAIL);
+
+    bitfile_rec->mode = 'w'; /* change to write mode */
+    if (Hbitseek(bitfile_rec->bit_id, byte_offset, bit_offset) == FAIL)
         HRETURN_ERROR(DFE_INTERNAL, FAIL);
     return (SUCCEED);
 } /* HIread2write */
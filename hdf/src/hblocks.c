@@ -116,6 +116,9 @@ LOCAL ROUTINES
    HLIstaccess -- set up AID to access a linked block elem
    HLIgetlink  -- get link information
    HLInewlink  -- write out some data to a linked block
+   HLIaddlink  -- add a block table to the index of block tables
+   HLIfindlink -- find (or create) a block table by its index
+   HLIfreelinks -- free the block tables of an element
 */
 
 #include "hdf.h"
@@ -124,7 +127,9 @@ LOCAL ROUTINES
 /* block_t - record of a linked block. contains the tag and ref of the
    data elt that forms the linked block */
 typedef struct block_t {
-    uint16 ref; /* ref of the linked block */
+    uint16 ref;    /* ref of the linked block */
+    int32  offset; /* offset of the block in the file, 0 if not looked up yet */
+    int32  length; /* length of the block in the file */
 } block_t;
 
 /* link_t - a linked list block table.
@@ -142,9 +147,12 @@ typedef struct linkinfo_t {
     int32   first_length;  /* length of first block */
     int32   block_length;  /* the length of the remaining blocks */
     int32   number_blocks; /* total number of blocks in each link/block table */
-    uint16  link_ref;      /* ref of the first block table structure */
-    link_t *link;          /* pointer to the first block table */
-    link_t *last_link;     /* pointer to the last block table */
+    uint16   link_ref;      /* ref of the first block table structure */
+    link_t  *link;          /* pointer to the first block table */
+    link_t  *last_link;     /* pointer to the last block table */
+    link_t **links;         /* the block tables in order, for direct lookup */
+    int32    nlinks;        /* number of block tables in links */
+    int32    max_links;     /* number of entries allocated for links */
 } linkinfo_t;
 
 /* private functions */
@@ -154,6 +162,14 @@ static link_t *HLInewlink(int32 file_id, int32 number_blocks, uint16 link_ref, u
 
 static link_t *HLIgetlink(int32 file_id, uint16 ref, int32 number_blocks);
 
+static intn HLIaddlink(linkinfo_t *info, link_t *new_link);
+
+static link_t *HLIfindlink(int32 file_id, linkinfo_t *info, int32 link_idx, intn create);
+
+static intn HLIputrefs(int32 file_id, linkinfo_t *info, int32 link_idx, int32 first, int32 last);
+
+static void HLIfreelinks(linkinfo_t *info);
+
 /* the accessing function table for linked blocks */
 funclist_t linked_funcs = {
     HLPstread, HLPstwrite,   HLPseek, HLPinquire, HLPread,
@@ -272,7 +288,7 @@ HLcreate(int32 file_id, uint16 tag, uint16 ref, int32 block_length, int32 number
     link_ref = Htagnewref(file_id, DFTAG_LINKED);
 
     /* allocate and fill special info struct */
-    if ((info = (linkinfo_t *)malloc((uint32)sizeof(linkinfo_t))) == NULL)
+    if ((info = (linkinfo_t *)calloc(1, sizeof(linkinfo_t))) == NULL)
         HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
     info->attached      = 1;
@@ -305,6 +321,9 @@ HLcreate(int32 file_id, uint16 tag, uint16 ref, int32 block_length, int32 number
     info->link = HLInewlink(file_id, number_blocks, link_ref, (uint16)((data_id != FAIL) ? new_data_ref : 0));
     if (!info->link)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    info->last_link = info->link;
+    if (HLIaddlink(info, info->link) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
     /* Detach from the data DD ID */
     if (data_id != FAIL) {
@@ -331,6 +350,8 @@ HLcreate(int32 file_id, uint16 tag, uint16 ref, int32 block_length, int32 number
 
 done:
     if (ret_value == FAIL) { /* Error condition cleanup */
+        if (info != NULL)
+            HLIfreelinks(info);
         free(info);
         if (access_rec != NULL)
             HIrelease_accrec_node(access_rec);
@@ -463,7 +484,7 @@ HLconvert(int32 aid, int32 block_length, int32 number_blocks)
     link_ref = Htagnewref(file_id, DFTAG_LINKED);
 
     /* allocates special info struct for linked blocks */
-    access_rec->special_info = malloc((uint32)sizeof(linkinfo_t));
+    access_rec->special_info = calloc(1, sizeof(linkinfo_t));
     if (!access_rec->special_info)
         HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
@@ -503,6 +524,9 @@ HLconvert(int32 aid, int32 block_length, int32 number_blocks)
     /* write out linked block */
     if ((info->link = HLInewlink(file_id, number_blocks, link_ref, (uint16)new_data_ref)) == NULL)
         HGOTO_ERROR(DFE_CANTLINK, FAIL);
+    info->last_link = info->link;
+    if (HLIaddlink(info, info->link) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
     /* update access record and file record */
     access_rec->special_func = &linked_funcs;
@@ -516,10 +540,11 @@ HLconvert(int32 aid, int32 block_length, int32 number_blocks)
     }
 
 done:
-    if (ret_value == FAIL) { /* Error condition cleanup */
+    if (ret_value == FAIL && access_rec != NULL) { /* Error condition cleanup */
+        if (access_rec->special_info != NULL)
+            HLIfreelinks((linkinfo_t *)access_rec->special_info);
         free(access_rec->special_info);
-        if (access_rec != NULL)
-            HIrelease_accrec_node(access_rec);
+        HIrelease_accrec_node(access_rec);
     }
 
     return ret_value;
@@ -620,17 +645,8 @@ HLIstaccess(accrec_t *access_rec, int16 acc_mode)
         linkinfo_t *t_info = (linkinfo_t *)access_rec->special_info;
 
         if (--(t_info->attached) == 0) {
-            link_t *t_link; /* current link to free */
-            link_t *next;   /* next link to free */
-
             /* free the linked list of links/block tables */
-            if (t_info->link != NULL) {
-                for (t_link = t_info->link; t_link; t_link = next) {
-                    next = t_link->next;
-                    free(t_link->block_list);
-                    free(t_link);
-                }
-            }
+            HLIfreelinks(t_info);
             free(t_info);
             access_rec->special_info = NULL;
         }
@@ -661,7 +677,7 @@ HLIstaccess(accrec_t *access_rec, int16 acc_mode)
         HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
 
     /* allocate space for special information */
-    access_rec->special_info = malloc((uint32)sizeof(linkinfo_t));
+    access_rec->special_info = calloc(1, sizeof(linkinfo_t));
     info                     = (linkinfo_t *)access_rec->special_info;
     if (!info)
         HGOTO_ERROR(DFE_NOSPACE, FAIL);
@@ -695,19 +711,18 @@ HLIstaccess(accrec_t *access_rec, int16 acc_mode)
     else
         info->first_length = info->block_length;
 
-    /* process through all the linked-blocks in the file for this element */
+    /* process through all the linked-blocks in the file for this element,
+       indexing the block tables as they are read */
     info->last_link = info->link;
+    if (HLIaddlink(info, info->link) == FAIL) {
+        HLIfreelinks(info);
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
     while (info->last_link->nextref != 0) {
         info->last_link->next =
             HLIgetlink(access_rec->file_id, info->last_link->nextref, info->number_blocks);
-        if (!info->last_link->next) {
-            link_t *l, *next;
-
-            for (l = info->link; l; l = next) {
-                next = l->next;
-                free(l->block_list);
-                free(l);
-            }
+        if (!info->last_link->next || HLIaddlink(info, info->last_link->next) == FAIL) {
+            HLIfreelinks(info);
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
         }
         info->last_link = info->last_link->next;
@@ -986,8 +1001,11 @@ HLIgetlink(int32 file_id, uint16 ref, int32 number_blocks)
         uint8 *p = buffer;
 
         UINT16DECODE(p, new_link->nextref);
-        for (i = 0; i < number_blocks; i++)
+        for (i = 0; i < number_blocks; i++) {
             UINT16DECODE(p, new_link->block_list[i].ref);
+            new_link->block_list[i].offset = 0;
+            new_link->block_list[i].length = 0;
+        }
     }
 
     /* end access to this block table */
@@ -1071,18 +1089,25 @@ HLPread(accrec_t *access_rec, int32 length, void *datap)
 {
     uint8 *data = (uint8 *)datap;
     /* information record for this special data elt */
-    linkinfo_t *info   = (linkinfo_t *)(access_rec->special_info);
-    link_t     *t_link = info->link; /* block table record */
+    linkinfo_t *info = (linkinfo_t *)(access_rec->special_info);
+    link_t     *t_link;   /* block table record */
+    filerec_t  *file_rec; /* file record */
 
     /* relative position in linked block of data elt */
     int32 relative_posn = access_rec->posn;
 
     int32 block_idx;      /* block table index of current block */
+    int32 link_idx;       /* index of the current block table */
     int32 current_length; /* length of current block */
     int32 nbytes     = 0; /* # bytes read on any single Hread() */
     int32 bytes_read = 0; /* total # bytes read for this call of HLIread */
     int32 ret_value  = SUCCEED;
 
+    /* convert file id to file record */
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
     /* validate length */
     if (length == 0)
         length = info->length - access_rec->posn;
@@ -1105,16 +1130,10 @@ HLPread(accrec_t *access_rec, int32 length, void *datap)
         current_length = info->block_length;
     }
 
-    /* calculate which block to start from? */
-    {
-        int32 i;
-
-        for (i = 0; i < block_idx / info->number_blocks; i++) {
-            if (t_link == NULL)
-                HGOTO_ERROR(DFE_INTERNAL, FAIL);
-            t_link = t_link->next;
-        }
-    }
+    /* look up the block table to start from */
+    link_idx = block_idx / info->number_blocks;
+    if ((t_link = HLIfindlink(access_rec->file_id, info, link_idx, FALSE)) == NULL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
     block_idx %= info->number_blocks;
 
     /* found the starting block, now read in the data */
@@ -1130,14 +1149,34 @@ HLPread(accrec_t *access_rec, int32 length, void *datap)
             block_t *current_block = /* record on the current block */
                 &(t_link->block_list[block_idx]);
 
-            access_id = Hstartread(access_rec->file_id, DFTAG_LINKED, current_block->ref);
-            if (access_id == (int32)FAIL ||
-                (relative_posn && (int32)FAIL == Hseek(access_id, relative_posn, DF_START)) ||
-                (int32)FAIL == (nbytes = Hread(access_id, remaining, data)))
-                HGOTO_ERROR(DFE_READERROR, FAIL);
+            /* remember where the block is, so that later reads can go
+               straight to the file */
+            if (current_block->offset == 0) {
+                current_block->offset = Hoffset(access_rec->file_id, DFTAG_LINKED, current_block->ref);
+                current_block->length = Hlength(access_rec->file_id, DFTAG_LINKED, current_block->ref);
+                if (current_block->offset == FAIL || current_block->length == FAIL) {
+                    current_block->offset = 0;
+                    HGOTO_ERROR(DFE_READERROR, FAIL);
+                } /* end if */
+            }     /* end if */
+
+            if (relative_posn + remaining <= current_block->length) {
+                if (HPseek(file_rec, current_block->offset + relative_posn) == FAIL)
+                    HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+                if (HP_read(file_rec, data, remaining) == FAIL)
+                    HGOTO_ERROR(DFE_READERROR, FAIL);
+                nbytes = remaining;
+            } /* end if */
+            else {
+                access_id = Hstartread(access_rec->file_id, DFTAG_LINKED, current_block->ref);
+                if (access_id == (int32)FAIL ||
+                    (relative_posn && (int32)FAIL == Hseek(access_id, relative_posn, DF_START)) ||
+                    (int32)FAIL == (nbytes = Hread(access_id, remaining, data)))
+                    HGOTO_ERROR(DFE_READERROR, FAIL);
+                Hendaccess(access_id);
+            } /* end else */
 
             bytes_read += nbytes;
-            Hendaccess(access_id);
         }
         else { /*if block is missing, fill this part of buffer with zero's */
             memset(data, 0, (size_t)remaining);
@@ -1149,8 +1188,7 @@ HLPread(accrec_t *access_rec, int32 length, void *datap)
         length -= remaining;
         if (length > 0 && ++block_idx >= info->number_blocks) {
             block_idx = 0;
-            t_link    = t_link->next;
-            if (t_link == NULL)
+            if ((t_link = HLIfindlink(access_rec->file_id, info, ++link_idx, FALSE)) == NULL)
                 HGOTO_ERROR(DFE_INTERNAL, FAIL);
         }
         relative_posn  = 0;
@@ -1190,17 +1228,16 @@ HLPwrite(accrec_t *access_rec, int32 length, const void *datap)
     uint16       data_tag, data_ref; /* Tag/ref of the data in the file */
     linkinfo_t  *info =              /* linked blocks information record */
         (linkinfo_t *)(access_rec->special_info);
-    link_t *t_link = /* ptr to link block table */
-        info->link;
-    int32 relative_posn = /* relative position in linked block */
+    link_t *t_link;           /* ptr to link block table */
+    int32   relative_posn = /* relative position in linked block */
         access_rec->posn;
-    int32   block_idx;        /* block table index of current block */
-    link_t *prev_link = NULL; /* ptr to block table before current block table.
-                                   for groking the offset of
-                                   current block table */
+    int32 block_idx;          /* block table index of current block */
+    int32 link_idx = 0;       /* index of the current block table */
     int32 current_length;     /* length of current block */
     int32 nbytes         = 0; /* #bytes written by any single Hwrite */
     int32 bytes_written  = 0; /* total #bytes written by HLIwrite */
+    int32 new_first      = -1; /* first and last new block in the current table */
+    int32 new_last       = -1;
     uint8 local_ptbuf[4] = {0, 0, 0, 0};
     int32 ret_value      = SUCCEED;
 
@@ -1226,45 +1263,11 @@ HLPwrite(accrec_t *access_rec, int32 length, const void *datap)
         relative_posn %= info->block_length;
         current_length = info->block_length;
     }
-    {
-        /* follow the links of block tables and create missing
-           block tables along the way */
-        int32 num_links; /* number of links to follow */
-
-        for (num_links = block_idx / info->number_blocks; num_links > 0; num_links--) {
-            if (!t_link->next) { /* create missing link (block table) */
-                t_link->nextref = Htagnewref(access_rec->file_id, DFTAG_LINKED);
-                t_link->next    = HLInewlink(access_rec->file_id, info->number_blocks, t_link->nextref, 0);
-                if (!t_link->next)
-                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                { /* AA */
-                    /* update previous link with information about new link */
-
-                    uint16 link_tag = DFTAG_LINKED;
-                    uint16 link_ref = /* ref of current link */
-                        (uint16)(prev_link != NULL ? prev_link->nextref : info->link_ref);
-
-                    uint8 *p = local_ptbuf; /* temp buf ptr */
-
-                    /* write file the updated portion of current link */
-
-                    int32 link_id = /* access id for current link */
-                        Hstartwrite(access_rec->file_id, link_tag, link_ref, 0);
-
-                    if (link_id == FAIL)
-                        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
-                    UINT16ENCODE(p, t_link->nextref);
-                    if (Hwrite(link_id, 2, local_ptbuf) == FAIL)
-                        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
-                    Hendaccess(link_id);
-                } /* AA */
-            }     /* if not t_link->next */
-
-            /* move to the next link */
-            prev_link = t_link;
-            t_link    = t_link->next;
-        } /* end for */
-    }     /* end block statement(bad) */
+    /* look up the block table to start in, creating missing
+       block tables along the way */
+    link_idx = block_idx / info->number_blocks;
+    if ((t_link = HLIfindlink(access_rec->file_id, info, link_idx, TRUE)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
     block_idx %= info->number_blocks;
 
@@ -1301,27 +1304,12 @@ HLPwrite(accrec_t *access_rec, int32 length, const void *datap)
         Hendaccess(access_id);
         bytes_written += nbytes;
 
-        if (new_ref) { /* created a new block, so update the link/block table */
-            uint16 link_tag = DFTAG_LINKED;
-            uint16 link_ref = /* ref of the current link/block table */
-                (uint16)(prev_link ? prev_link->nextref : info->link_ref);
-            uint8 *p = /* temp buffer ptr */
-                local_ptbuf;
-            int32 link_id = /* access record id of the current
-                               link/block table */
-                Hstartwrite(access_rec->file_id, link_tag, link_ref, 0);
-
-            if (link_id == FAIL)
-                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
-            UINT16ENCODE(p, new_ref);
-            if (Hseek(link_id, 2 + 2 * block_idx, DF_START) == FAIL)
-                HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-            if (Hwrite(link_id, 2, local_ptbuf) == FAIL)
-                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
-            Hendaccess(link_id);
-
-            /* update memory structure */
+        if (new_ref) { /* created a new block; the link/block table in the
+                          file is updated once for all the new blocks in it */
             t_link->block_list[block_idx].ref = new_ref;
+            if (new_first < 0)
+                new_first = block_idx;
+            new_last = block_idx;
         } /* if new_ref */
 
         /* move ptrs and counters for next phase */
@@ -1329,35 +1317,14 @@ HLPwrite(accrec_t *access_rec, int32 length, const void *datap)
         length -= remaining;
 
         if (length > 0 && ++block_idx >= info->number_blocks) { /* move to the next link/block table */
+            if (new_first >= 0) {
+                if (HLIputrefs(access_rec->file_id, info, link_idx, new_first, new_last) == FAIL)
+                    HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+                new_first = -1;
+            } /* end if */
             block_idx = 0;
-            if (!t_link->next) { /* create missing link/block table */
-                t_link->nextref = Htagnewref(access_rec->file_id, DFTAG_LINKED);
-                t_link->next    = HLInewlink(access_rec->file_id, info->number_blocks, t_link->nextref, 0);
-                if (!t_link->next)
-                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
-
-                { /* BB */
-                    uint16 link_tag = DFTAG_LINKED;
-                    uint16 link_ref = /* ref of current link/block table */
-                        (uint16)(prev_link ? prev_link->nextref : info->link_ref);
-                    uint8 *p = /* temp buffer ptr */
-                        local_ptbuf;
-                    int32 link_id = /* access record id of
-                                       current link/block table */
-                        Hstartwrite(access_rec->file_id, link_tag, link_ref, 0);
-
-                    if (link_id == FAIL)
-                        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
-                    UINT16ENCODE(p, t_link->nextref);
-                    if (Hwrite(link_id, 2, local_ptbuf) == FAIL)
-                        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
-                    Hendaccess(link_id);
-                } /* BB */
-            }     /* if not t_link->next  */
-
-            /* move to the next link/block table */
-            prev_link = t_link;
-            t_link    = t_link->next;
+            if ((t_link = HLIfindlink(access_rec->file_id, info, ++link_idx, TRUE)) == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
         } /* end if "length" */
 
         /* update vars for next phase */
@@ -1365,6 +1332,12 @@ HLPwrite(accrec_t *access_rec, int32 length, const void *datap)
         current_length = info->block_length;
     } while (length > 0);
 
+    if (new_first >= 0) {
+        if (HLIputrefs(access_rec->file_id, info, link_idx, new_first, new_last) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        new_first = -1;
+    } /* end if */
+
     /* update the info for the dataset */
     if (HTPinquire(access_rec->ddid, &data_tag, &data_ref, NULL, NULL) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
@@ -1392,9 +1365,65 @@ HLPwrite(accrec_t *access_rec, int32 length, const void *datap)
     ret_value = bytes_written;
 
 done:
+    if (ret_value == FAIL) { /* Error condition cleanup */
+        /* don't leave the blocks already written out of the table */
+        if (new_first >= 0)
+            HLIputrefs(access_rec->file_id, info, link_idx, new_first, new_last);
+    } /* end if */
+
     return ret_value;
 } /* HLPwrite */
 
+/* ------------------------------ HLIputrefs ------------------------------ */
+/*
+NAME
+   HLIputrefs -- write block refs into a link/block table in the file
+USAGE
+   intn HLIputrefs(fid, info, link_idx, first, last)
+   int32       fid;        IN: file ID
+   linkinfo_t *info;       IN: linked block information
+   int32       link_idx;   IN: index of the link/block table
+   int32       first;      IN: first block entry to write
+   int32       last;       IN: last block entry to write
+RETURNS
+   SUCCEED / FAIL
+DESCRIPTION
+   Write the refs of blocks first through last of a link/block table,
+   as they are in memory, to the table in the file with one write.
+
+---------------------------------------------------------------------------*/
+static intn
+HLIputrefs(int32 file_id, linkinfo_t *info, int32 link_idx, int32 first, int32 last)
+{
+    link_t *t_link = info->links[link_idx];
+    uint16  link_ref = /* ref of the link/block table */
+        (uint16)(link_idx > 0 ? info->links[link_idx - 1]->nextref : info->link_ref);
+    int32  link_id = FAIL;
+    uint8 *buf     = NULL;
+    uint8 *p;
+    int32  i;
+    intn   ret_value = SUCCEED;
+
+    if ((buf = (uint8 *)malloc((size_t)(2 * (last - first + 1)))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (p = buf, i = first; i <= last; i++)
+        UINT16ENCODE(p, t_link->block_list[i].ref);
+
+    if ((link_id = Hstartwrite(file_id, DFTAG_LINKED, link_ref, 0)) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    if (Hseek(link_id, 2 + 2 * first, DF_START) == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+    if (Hwrite(link_id, 2 * (last - first + 1), buf) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    if (link_id != FAIL)
+        Hendaccess(link_id);
+    free(buf);
+
+    return ret_value;
+} /* HLIputrefs */
+
 /* ------------------------------ HLInewlink ------------------------------ */
 /*
 NAME
@@ -1457,6 +1486,10 @@ HLInewlink(int32 file_id, int32 number_blocks, uint16 link_ref, uint16 first_blo
             t_link->block_list[i].ref = 0;
             UINT16ENCODE(p, 0);
         }
+        for (i = 0; i < number_blocks; i++) {
+            t_link->block_list[i].offset = 0;
+            t_link->block_list[i].length = 0;
+        }
     } /* CC */
 
     /* write the link */
@@ -1479,6 +1512,135 @@ done:
     return ret_value;
 } /* HLInewlink */
 
+/* ------------------------------ HLIaddlink ------------------------------ */
+/*
+NAME
+   HLIaddlink -- add a block table to the index of block tables
+USAGE
+   intn HLIaddlink(info, new_link)
+   linkinfo_t * info;        IN: special information of the element
+   link_t * new_link;        IN: block table to add after the last one
+RETURNS
+   SUCCEED / FAIL
+DESCRIPTION
+   Append a block table to info->links, which lets the reading and
+   writing routines find the table holding any block directly instead
+   of following the chain of tables from the first one.
+
+---------------------------------------------------------------------------*/
+static intn
+HLIaddlink(linkinfo_t *info, link_t *new_link)
+{
+    intn ret_value = SUCCEED;
+
+    if (info->nlinks >= info->max_links) {
+        int32    new_max = (info->max_links > 0) ? 2 * info->max_links : 8;
+        link_t **new_links;
+
+        new_links = (link_t **)realloc(info->links, (size_t)new_max * sizeof(link_t *));
+        if (new_links == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        info->links     = new_links;
+        info->max_links = new_max;
+    } /* end if */
+    info->links[info->nlinks++] = new_link;
+
+done:
+    return ret_value;
+} /* HLIaddlink */
+
+/* ------------------------------ HLIfindlink ----------------------------- */
+/*
+NAME
+   HLIfindlink -- find (or create) a block table by its index
+USAGE
+   link_t * HLIfindlink(fid, info, link_idx, create)
+   int32  fid;               IN: file ID
+   linkinfo_t * info;        IN: special information of the element
+   int32  link_idx;          IN: index of the block table, 0 for the first
+   intn   create;            IN: whether to create missing block tables
+RETURNS
+   A pointer to the block table or NULL
+DESCRIPTION
+   Return the link_idx'th block table of the element.  When create is
+   TRUE, the block tables up to link_idx are created as needed, and each
+   new table is linked to the one before it in memory and in the file.
+
+---------------------------------------------------------------------------*/
+static link_t *
+HLIfindlink(int32 file_id, linkinfo_t *info, int32 link_idx, intn create)
+{
+    uint8   local_ptbuf[2];
+    link_t *ret_value = NULL; /* FAIL */
+
+    if (link_idx < 0 || info->nlinks == 0 || (link_idx >= info->nlinks && !create))
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
+
+    while (link_idx >= info->nlinks) {
+        link_t *t_link = info->links[info->nlinks - 1]; /* current last block table */
+        uint16  link_ref =                              /* ref of the current last block table */
+            (uint16)(info->nlinks > 1 ? info->links[info->nlinks - 2]->nextref : info->link_ref);
+        uint8 *p = local_ptbuf;
+        int32  link_id; /* access id for the current last block table */
+
+        /* create the new block table */
+        t_link->nextref = Htagnewref(file_id, DFTAG_LINKED);
+        t_link->next    = HLInewlink(file_id, info->number_blocks, t_link->nextref, 0);
+        if (!t_link->next)
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+        info->last_link = t_link->next;
+        if (HLIaddlink(info, t_link->next) == FAIL)
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+
+        /* update the previous block table in the file with the new one */
+        if ((link_id = Hstartwrite(file_id, DFTAG_LINKED, link_ref, 0)) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, NULL);
+        UINT16ENCODE(p, t_link->nextref);
+        if (Hwrite(link_id, 2, local_ptbuf) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, NULL);
+        Hendaccess(link_id);
+    } /* end while */
+
+    ret_value = info->links[link_idx];
+
+done:
+    return ret_value;
+} /* HLIfindlink */
+
+/* ----------------------------- HLIfreelinks ----------------------------- */
+/*
+NAME
+   HLIfreelinks -- free the block tables of an element
+USAGE
+   void HLIfreelinks(info)
+   linkinfo_t * info;        IN: special information of the element
+RETURNS
+   none
+DESCRIPTION
+   Free the chain of block tables and the index of them.  The
+   linkinfo_t itself is left to the caller.
+
+---------------------------------------------------------------------------*/
+static void
+HLIfreelinks(linkinfo_t *info)
+{
+    link_t *t_link; /* current link to free */
+    link_t *next;   /* next link to free */
+
+    for (t_link = info->link; t_link; t_link = next) {
+        next = t_link->next;
+        free(t_link->block_list);
+        free(t_link);
+    }
+    info->link      = NULL;
+    info->last_link = NULL;
+
+    free(info->links);
+    info->links     = NULL;
+    info->nlinks    = 0;
+    info->max_links = 0;
+} /* HLIfreelinks */
+
 /* ------------------------------ HLPinquire ------------------------------ */
 /*
 NAME
@@ -1621,15 +1783,8 @@ HLPcloseAID(accrec_t *access_rec)
     /* detach the special information record.
        If no more references to that, free the record */
     if (--(info->attached) == 0) {
-        link_t *t_link; /* current link to free */
-        link_t *next;   /* next link to free */
-
         /* free the linked list of links/block tables */
-        for (t_link = info->link; t_link; t_link = next) {
-            next = t_link->next;
-            free(t_link->block_list);
-            free(t_link);
-        }
+        HLIfreelinks(info);
 
         free(info);
         access_rec->special_info = NULL;
@@ -1734,8 +1889,10 @@ HLsetblockinfo(int32 aid,        /* access record id */
        to change the block info, ignore the request to change. */
     if (access_rec->special != SPECIAL_LINKED) {
         /* Set the linked-block size, if requested */
-        if (block_size != -1)
+        if (block_size != -1) {
             access_rec->block_size = block_size;
+            access_rec->block_set  = TRUE;
+        }
 
         /* Set the number of blocks in each block table, if requested */
         if (num_blocks != -1)
@@ -58,6 +58,9 @@ typedef enum {
 /* The magic cookie for Hcache to cache all files */
 #define CACHE_ALL_FILES (-2)
 
+/* The magic cookie for Hpreallocate to set the default for all files */
+#define PREALLOC_ALL_FILES (-2)
+
 /* File access modes */
 /* 001--007 for different serial modes */
 /* 011--017 for different parallel modes */
@@ -119,6 +122,16 @@ typedef struct hdf_ntinfo_t {
     char byte_order[13]; /* "bigEndian" or "littleEndian" */
 } hdf_ntinfo_t;
 
+/* One attribute in the buffer returned by Vgetattrs, VSgetattrs, SDgetattrs
+   and GRgetattrs.  The names and values are in the same buffer, after the
+   array of these; the caller frees the whole buffer with free(). */
+typedef struct hdf_attr_t {
+    char  *name;   /* name of the attribute, null-terminated */
+    int32  nt;     /* number type of the values */
+    int32  count;  /* number of values */
+    void  *values; /* the values, in the memory format of this machine */
+} hdf_attr_t;
+
 /* type for File ID to send to Hlevel from Vxx interface */
 typedef int32 HFILEID;
 
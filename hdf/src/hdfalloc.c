@@ -12,12 +12,16 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "hdf.h"
+#include "hfile.h"
 
 /*
 LOCAL ROUTINES
   None
 EXPORTED ROUTINES
   HDmemfill    -- copy a chunk of memory repetitively into another chunk
+  HDattrs_alloc -- allocate a buffer of attributes for the *getattrs calls
+  HDattr_space -- space for the name and values of one attribute in it
+  HDattr_place -- lay out one attribute in it
   HIstrncpy    -- string copy with termination
   HDstrdup     -- in-library replacement for non-ANSI strdup()
 */
@@ -83,6 +87,84 @@ HDmemfill(void *dest, const void *src, uint32 item_size, uint32 num_items)
     return (dest);
 } /* end HDmemfill() */
 
+/* the names and values in an attribute buffer start on 8-byte boundaries,
+   so that values of any number type can be used in place */
+#define ATTR_ALIGN(n) (((n) + 7) & ~(size_t)7)
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDattrs_alloc -- allocate a buffer of attributes
+ USAGE
+    hdf_attr_t *HDattrs_alloc(nattrs, space, next)
+        intn nattrs;        IN: number of attributes
+        size_t space;       IN: sum of HDattr_space() for all the attributes
+        uint8 **next;       OUT: where the first name goes
+ RETURNS
+    The buffer, to be filled with HDattr_place(); NULL if out of memory.
+ DESCRIPTION
+    The buffer Vgetattrs, VSgetattrs, SDgetattrs and GRgetattrs return
+    holds an array of hdf_attr_t and, after it, the name and values of
+    each attribute.  The caller gets it in one piece and frees it with
+    free().
+--------------------------------------------------------------------------*/
+hdf_attr_t *
+HDattrs_alloc(intn nattrs, size_t space, uint8 **next)
+{
+    size_t      head = ATTR_ALIGN((size_t)nattrs * sizeof(hdf_attr_t));
+    hdf_attr_t *ret_value;
+
+    if ((ret_value = (hdf_attr_t *)malloc(head + space)) != NULL)
+        *next = (uint8 *)ret_value + head;
+    return ret_value;
+} /* end HDattrs_alloc() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDattr_space -- space one attribute takes in a buffer of attributes
+ USAGE
+    size_t HDattr_space(namelen, valsize)
+        size_t namelen;     IN: length of the name, without the terminator
+        size_t valsize;     IN: size in bytes of the values in memory
+ RETURNS
+    The number of bytes HDattr_place() uses for the attribute.
+--------------------------------------------------------------------------*/
+size_t
+HDattr_space(size_t namelen, size_t valsize)
+{
+    return ATTR_ALIGN(namelen + 1) + ATTR_ALIGN(valsize);
+} /* end HDattr_space() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HDattr_place -- lay out one attribute in a buffer of attributes
+ USAGE
+    void *HDattr_place(attr, next, name, namelen, nt, count, valsize)
+        hdf_attr_t *attr;   OUT: the entry of the attribute
+        uint8 **next;       IN/OUT: where the name goes; moved past
+                            the values on return
+        const char *name;   IN: name of the attribute, need not be
+                            null-terminated
+        size_t namelen;     IN: length of the name
+        int32 nt;           IN: number type of the values
+        int32 count;        IN: number of values
+        size_t valsize;     IN: size in bytes of the values in memory
+ RETURNS
+    Where the values go; the caller copies or reads them there.
+--------------------------------------------------------------------------*/
+void *
+HDattr_place(hdf_attr_t *attr, uint8 **next, const char *name, size_t namelen, int32 nt, int32 count,
+             size_t valsize)
+{
+    attr->name = (char *)*next;
+    memcpy(attr->name, name, namelen);
+    attr->name[namelen] = '\0';
+    attr->nt            = nt;
+    attr->count         = count;
+    attr->values        = *next + ATTR_ALIGN(namelen + 1);
+    *next += HDattr_space(namelen, valsize);
+    return attr->values;
+} /* end HDattr_place() */
+
 /*--------------------------------------------------------------------------
  NAME
     HIstrncpy -- string copy with termination
@@ -98,7 +98,7 @@ static char *extcreatedir    = NULL;
 static char *HDFEXTCREATEDIR = NULL;
 static char *extdir          = NULL;
 static char *HDFEXTDIR       = NULL;
-static intn  extdir_changed  = FALSE;
+static uintn extdir_gen      = 0; /* changed each time extdir is changed */
 
 /* extinfo_t -- external elt information structure */
 
@@ -109,14 +109,38 @@ typedef struct {
     int32      length;           /* length of this element */
     int32      length_file_name; /* length of the external file name */
     int32      para_extfile_id;  /* parallel ID of the external file */
-    hdf_file_t file_external;    /* external file descriptor */
     char      *extern_file_name; /* name of the external file */
-    intn       file_open;        /* has the file been opened yet ? */
+    char      *path;             /* name the external file was found at, NULL if not yet looked up */
+    uintn      path_gen;         /* extdir_gen when path was looked up */
+    intn       file_used;        /* has the file been used through this record yet? */
+    filerec_t *file_rec;         /* HDF file the element is in */
 } extinfo_t;
 
+/* extfile_t -- an external file kept open in the pool of external files.
+   The files are shared by all external elements, and no access record
+   holds on to a file between calls, so any of them can be closed to
+   make room for another; the least recently used one is.  A file is
+   also closed when an HDF file which used it is closed, so that it is
+   opened again, and found again if it was replaced, the next time. */
+
+typedef struct {
+    char      *path;     /* name of the file, NULL if this slot is free */
+    hdf_file_t file;     /* external file descriptor */
+    intn       writable; /* was the file opened for writing? */
+    uint32     last_use; /* value of ext_pool_clock when the file was last used */
+    filerec_t *file_rec; /* HDF file it was used for, NULL if used for several */
+} extfile_t;
+
+static extfile_t ext_pool[MAX_EXT_FILE];
+static uint32    ext_pool_clock = 0;
+
 /* forward declaration of the functions provided in this module */
 static int32 HXIstaccess(accrec_t *access_rec, int16 access);
 static char *HXIbuildfilename(const char *ext_fname, const intn acc_mode);
+static intn  HXIpool_find(const char *path);
+static void  HXIpool_close(intn slot);
+static intn  HXIpool_open(filerec_t *file_rec, const char *path, intn acc_mode, intn create, hdf_file_t *file);
+static intn  HXIgetfile(extinfo_t *info, intn acc_mode, hdf_file_t *file);
 
 /* ext_funcs -- table of the accessing functions of the external
    data element function modules.  The position of each function in
@@ -257,13 +281,8 @@ HXcreate(int32 file_id, uint16 tag, uint16 ref, const char *extern_file_name, in
 
     /* Try to open the external file with write access first, if that fails,
        create it */
-    file_external = (hdf_file_t)HI_OPEN(fname, DFACC_WRITE);
-    if (OPENERR(file_external)) {
-        file_external = (hdf_file_t)HI_CREATE(fname);
-        if (OPENERR(file_external))
-            HGOTO_ERROR(DFE_BADOPEN, FAIL);
-    }
-    free(fname);
+    if (HXIpool_open(file_rec, fname, DFACC_WRITE, TRUE, &file_external) == FAIL)
+        HGOTO_ERROR(DFE_BADOPEN, FAIL);
 
     /* Get a bare access record and special info structure */
     access_rec = HIget_access_rec();
@@ -275,8 +294,9 @@ HXcreate(int32 file_id, uint16 tag, uint16 ref, const char *extern_file_name, in
     if (!info)
         HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-    /* Initialize char pointer for use in resource cleanup */
+    /* Initialize char pointers for use in resource cleanup */
     info->extern_file_name = NULL;
+    info->path             = NULL;
 
     /* If there is data, either regular or special, read the data then write
        it to the external file, otherwise, do nothing */
@@ -285,6 +305,9 @@ HXcreate(int32 file_id, uint16 tag, uint16 ref, const char *extern_file_name, in
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
         if (Hgetelement(file_id, tag, ref, buf) == FAIL)
             HGOTO_ERROR(DFE_READERROR, FAIL);
+        /* look the file up again, reading the data may have used the pool */
+        if (HXIpool_open(file_rec, fname, DFACC_WRITE, TRUE, &file_external) == FAIL)
+            HGOTO_ERROR(DFE_BADOPEN, FAIL);
         if (HI_SEEK(file_external, offset) == FAIL)
             HGOTO_ERROR(DFE_SEEKERROR, FAIL);
         if (HI_WRITE(file_external, buf, (int)data_len) == FAIL)
@@ -296,8 +319,11 @@ HXcreate(int32 file_id, uint16 tag, uint16 ref, const char *extern_file_name, in
 
     /* Set up the special element information and write it to file */
     info->attached         = 1;
-    info->file_open        = TRUE;
-    info->file_external    = file_external;
+    info->path             = fname;
+    info->path_gen         = extdir_gen;
+    info->file_used        = TRUE;
+    info->file_rec         = file_rec;
+    fname                  = NULL; /* now owned by info */
     info->extern_offset    = offset;
     info->extern_file_name = (char *)HDstrdup(extern_file_name);
     if (!info->extern_file_name)
@@ -349,6 +375,7 @@ done:
             HIrelease_accrec_node(access_rec);
         if (info != NULL) {
             free(info->extern_file_name);
+            free(info->path);
             free(info);
 
             access_rec->special_info = NULL;
@@ -380,7 +407,6 @@ HXPsetaccesstype(accrec_t *access_rec)
 {
     hdf_file_t file_external; /* external file descriptor */
     extinfo_t *info;          /* special element information */
-    char      *fname     = NULL;
     intn       ret_value = SUCCEED;
 
     /* clear error stack and validate args */
@@ -393,21 +419,11 @@ HXPsetaccesstype(accrec_t *access_rec)
     if ((info = (extinfo_t *)access_rec->special_info) == NULL)
         HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-    /* build the customized external file name. */
-    if ((fname = HXIbuildfilename(info->extern_file_name, DFACC_OLD)) == NULL)
-        HGOTO_ERROR(DFE_BADOPEN, FAIL);
-
     /* Open the external file for the correct access type */
     switch (access_rec->access_type) {
         case DFACC_SERIAL:
-            file_external = (hdf_file_t)HI_OPEN(fname, DFACC_WRITE);
-            if (OPENERR(file_external)) {
-                file_external = (hdf_file_t)HI_CREATE(fname);
-                if (OPENERR(file_external))
-                    HGOTO_ERROR(DFE_BADOPEN, FAIL);
-            }
-            free(fname);
-            info->file_external = file_external;
+            if (HXIgetfile(info, DFACC_WRITE | DFACC_CREATE, &file_external) == FAIL)
+                HGOTO_ERROR(DFE_BADOPEN, FAIL);
             break;
 
         default:
@@ -415,10 +431,6 @@ HXPsetaccesstype(accrec_t *access_rec)
     }
 
 done:
-    if (ret_value == FAIL) { /* Error condition cleanup */
-        free(fname);
-    }
-
     return ret_value;
 }
 
@@ -494,7 +506,9 @@ HXIstaccess(accrec_t *access_rec, int16 acc_mode)
         info->extern_file_name[info->length_file_name] = '\0';
 
         /* delay file opening until needed */
-        info->file_open = FALSE;
+        info->path      = NULL;
+        info->file_used = FALSE;
+        info->file_rec  = file_rec;
         info->attached  = 1;
     }
 
@@ -625,7 +639,8 @@ HXPread(accrec_t *access_rec, int32 length, void *data)
 {
     extinfo_t *info = /* information on the special element */
         (extinfo_t *)access_rec->special_info;
-    int32 ret_value = SUCCEED;
+    hdf_file_t file_external; /* external file descriptor */
+    int32      ret_value = SUCCEED;
 
     /* validate length */
     if (length < 0)
@@ -637,38 +652,19 @@ HXPread(accrec_t *access_rec, int32 length, void *data)
     else if (length < 0)
         HGOTO_ERROR(DFE_RANGE, FAIL);
 
-    /* if the file is open but external directory is changed (by HXsetdir),
-       then close the file first before making the new file path */
-    if (!info->file_open || (info->file_open && extdir_changed)) {
-        char *fname;
-
-        /* if the file is open, close it first */
-        if (info->file_open) {
-            HI_CLOSE(info->file_external);
-            info->file_open = FALSE;
-        }
-
-        /* build the customized external file name. */
-        if ((fname = HXIbuildfilename(info->extern_file_name, DFACC_OLD)) == NULL)
-            HGOTO_ERROR(DFE_BADOPEN, FAIL);
-
-        info->file_external = (hdf_file_t)HI_OPEN(fname, access_rec->access);
-        free(fname);
-        if (OPENERR(info->file_external)) {
-            HERROR(DFE_BADOPEN);
-            HEreport("Could not find external file %s\n", info->extern_file_name);
-            HGOTO_DONE(FAIL);
-        }
-        info->file_open = TRUE;
+    /* get the external file from the pool of open files */
+    if (HXIgetfile(info, DFACC_READ, &file_external) == FAIL) {
+        HERROR(DFE_BADOPEN);
+        HEreport("Could not find external file %s\n", info->extern_file_name);
+        HGOTO_DONE(FAIL);
     }
 
-    /* read it in from the file */
-    {
-        if (HI_SEEK(info->file_external, access_rec->posn + info->extern_offset) == FAIL)
-            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-        if (HI_READ(info->file_external, data, length) == FAIL)
-            HGOTO_ERROR(DFE_READERROR, FAIL);
-    }
+    /* read it in from the file; the pooled handle may be shared with other
+       elements, so always seek to this element's position first */
+    if (HI_SEEK(file_external, access_rec->posn + info->extern_offset) == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+    if (HI_READ(file_external, data, length) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
 
     /* adjust access position */
     access_rec->posn += length;
@@ -705,6 +701,7 @@ HXPwrite(accrec_t *access_rec, int32 length, const void *data)
         (extinfo_t *)(access_rec->special_info);
     uint8     *p = local_ptbuf; /* temp buffer ptr */
     filerec_t *file_rec;        /* file record */
+    hdf_file_t file_external;   /* external file descriptor */
     int32      ret_value = SUCCEED;
 
     /* convert file id to file record */
@@ -714,51 +711,19 @@ HXPwrite(accrec_t *access_rec, int32 length, const void *data)
     if (length < 0)
         HGOTO_ERROR(DFE_RANGE, FAIL);
 
-    /* if the file is open but external directory is changed (by HXsetdir),
-       then close the file first before making the new file path */
-    if (!info->file_open || (info->file_open && extdir_changed)) {
-        char *fname;
-
-        /* if the file is open, close it first */
-        if (info->file_open) {
-            HI_CLOSE(info->file_external);
-            info->file_open = FALSE;
-        }
-
-        /* build the customized external file name. */
-        if ((fname = HXIbuildfilename(info->extern_file_name, DFACC_OLD)) == NULL)
-            HGOTO_ERROR(DFE_BADOPEN, FAIL);
-
-        info->file_external = (hdf_file_t)HI_OPEN(fname, access_rec->access);
-        free(fname);
-        if (OPENERR(info->file_external)) {
-            HERROR(DFE_BADOPEN);
-            HEreport("Could not find external file %s\n", info->extern_file_name);
-            HGOTO_DONE(FAIL);
-        }
-        info->file_open = TRUE;
+    /* get the external file from the pool of open files, opened for
+       writing even if this AID was only started for reading */
+    if (HXIgetfile(info, DFACC_WRITE, &file_external) == FAIL) {
+        HERROR(DFE_BADOPEN);
+        HEreport("Could not open external file %s for writing\n", info->extern_file_name);
+        HGOTO_DONE(FAIL);
     }
 
     /* write the data onto file */
-    {
-        if (HI_SEEK(info->file_external, access_rec->posn + info->extern_offset) == FAIL)
-            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-        if (HI_WRITE(info->file_external, data, length) == FAIL) {
-            /* this external file might not be opened with write permission,
-               reopen the file and try again */
-            hdf_file_t f = (hdf_file_t)HI_OPEN(info->extern_file_name, DFACC_WRITE);
-
-            if (OPENERR(f) || HI_SEEK(f, access_rec->posn + info->extern_offset) == FAIL ||
-                HI_WRITE(f, data, length) == FAIL) {
-                HI_CLOSE(f);
-                HGOTO_ERROR(DFE_DENIED, FAIL);
-            }
-            HI_CLOSE(info->file_external);
-
-            /* if okay, substitute the file descriptor */
-            info->file_external = f;
-        }
-    }
+    if (HI_SEEK(file_external, access_rec->posn + info->extern_offset) == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+    if (HI_WRITE(file_external, data, length) == FAIL)
+        HGOTO_ERROR(DFE_DENIED, FAIL);
 
     /* update access record, and information about special elelemt */
     access_rec->posn += length;
@@ -921,8 +886,12 @@ HXPcloseAID(accrec_t *access_rec)
        If no more references to that, free the record */
 
     if (--(info->attached) == 0) {
-        if (info->file_open)
-            HI_CLOSE(info->file_external);
+        intn slot;
+
+        /* the file stays in the pool, but make what was written visible */
+        if (info->path != NULL && (slot = HXIpool_find(info->path)) != FAIL && ext_pool[slot].writable)
+            HI_FLUSH(ext_pool[slot].file);
+        free(info->path);
         free(info->extern_file_name);
         free(info);
         access_rec->special_info = NULL;
@@ -1021,6 +990,8 @@ HXPreset(accrec_t *access_rec, sp_info_block_t *info_block)
     if (!info->extern_file_name)
         HGOTO_ERROR(DFE_NOSPACE, FAIL);
     info->length_file_name = (int32)HDstrlen(info->extern_file_name);
+    free(info->path);
+    info->path = NULL;
 
     /*
      * delete the existing tag / ref object
@@ -1128,8 +1099,8 @@ HXsetdir(const char *newdir)
     if (newdir == NULL) {
         if (extdir != NULL) {
             free(extdir);
-            extdir         = NULL;
-            extdir_changed = TRUE;
+            extdir = NULL;
+            extdir_gen++;
         }
     }
     else {
@@ -1138,16 +1109,16 @@ HXsetdir(const char *newdir)
 
         if (extdir != NULL) {
             if (!HDstrcmp(newdir, extdir))
-                extdir_changed = FALSE;
+                free(pt);
             else {
                 free(extdir);
-                extdir         = pt;
-                extdir_changed = TRUE;
+                extdir = pt;
+                extdir_gen++;
             }
         }
         else {
-            extdir         = pt;
-            extdir_changed = TRUE;
+            extdir = pt;
+            extdir_gen++;
         }
     }
 
@@ -1348,6 +1319,199 @@ done:
     return ret_value;
 } /* HXIbuildfilename */
 
+/* ------------------------------ HXIpool_find ----------------------------- */
+/*
+NAME
+   HXIpool_find -- look for an external file in the pool of open files
+USAGE
+   intn HXIpool_find(path)
+   const char *path;        IN: name of the external file
+RETURNS
+   The slot of the file in the pool, or FAIL if it is not open.
+
+---------------------------------------------------------------------------*/
+static intn
+HXIpool_find(const char *path)
+{
+    intn slot;
+
+    for (slot = 0; slot < MAX_EXT_FILE; slot++)
+        if (ext_pool[slot].path != NULL && !HDstrcmp(ext_pool[slot].path, path))
+            return slot;
+    return FAIL;
+} /* HXIpool_find */
+
+/* ----------------------------- HXIpool_close ----------------------------- */
+/*
+NAME
+   HXIpool_close -- close an external file in the pool of open files
+USAGE
+   void HXIpool_close(slot)
+   intn slot;               IN: slot of the file in the pool
+RETURNS
+   none
+
+---------------------------------------------------------------------------*/
+static void
+HXIpool_close(intn slot)
+{
+    HI_CLOSE(ext_pool[slot].file);
+    free(ext_pool[slot].path);
+    ext_pool[slot].path     = NULL;
+    ext_pool[slot].writable = FALSE;
+} /* HXIpool_close */
+
+/* ------------------------------ HXIpool_open ----------------------------- */
+/*
+NAME
+   HXIpool_open -- get an external file from the pool of open files
+USAGE
+   intn HXIpool_open(file_rec, path, acc_mode, create, file)
+   filerec_t  *file_rec;    IN: HDF file the external file is used for
+   const char *path;        IN: name of the external file
+   intn        acc_mode;    IN: DFACC_READ or DFACC_WRITE
+   intn        create;      IN: create the file if it can't be opened?
+   hdf_file_t *file;        OUT: the open file
+RETURNS
+   SUCCEED / FAIL
+DESCRIPTION
+   Return the pool's descriptor for the file, opening it if it is not
+   in the pool yet, or reopening it for writing if it was only opened
+   for reading.  When the pool is full, the least recently used file is
+   closed to make room.  Callers seek before every read or write, so
+   the descriptor can be shared by all the elements in the file.
+
+---------------------------------------------------------------------------*/
+static intn
+HXIpool_open(filerec_t *file_rec, const char *path, intn acc_mode, intn create, hdf_file_t *file)
+{
+    filerec_t *owner = file_rec; /* HDF file(s) the external file is used for */
+    intn       slot;
+    intn       ret_value = SUCCEED;
+
+    slot = HXIpool_find(path);
+    if (slot != FAIL && ext_pool[slot].file_rec != file_rec)
+        ext_pool[slot].file_rec = NULL;
+
+    /* a file opened for reading has to be reopened for writing */
+    if (slot != FAIL && (acc_mode & DFACC_WRITE) && !ext_pool[slot].writable) {
+        owner = ext_pool[slot].file_rec;
+        HXIpool_close(slot);
+        slot = FAIL;
+    } /* end if */
+
+    if (slot == FAIL) {
+        hdf_file_t f; /* newly opened file */
+        intn       i;
+
+        f = (hdf_file_t)HI_OPEN(path, acc_mode);
+        if (OPENERR(f) && create)
+            f = (hdf_file_t)HI_CREATE(path);
+        if (OPENERR(f))
+            HGOTO_DONE(FAIL);
+
+        /* use a free slot, else the least recently used one */
+        slot = 0;
+        for (i = 0; i < MAX_EXT_FILE; i++) {
+            if (ext_pool[i].path == NULL) {
+                slot = i;
+                break;
+            } /* end if */
+            if (ext_pool[i].last_use < ext_pool[slot].last_use)
+                slot = i;
+        } /* end for */
+        if (ext_pool[slot].path != NULL)
+            HXIpool_close(slot);
+
+        if ((ext_pool[slot].path = HDstrdup(path)) == NULL) {
+            HI_CLOSE(f);
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        } /* end if */
+        ext_pool[slot].file     = f;
+        ext_pool[slot].writable = (acc_mode & DFACC_WRITE) ? TRUE : FALSE;
+        ext_pool[slot].file_rec = owner;
+    } /* end if */
+
+    ext_pool[slot].last_use = ++ext_pool_clock;
+    *file                   = ext_pool[slot].file;
+
+done:
+    return ret_value;
+} /* HXIpool_open */
+
+/* ------------------------------- HXIgetfile ------------------------------ */
+/*
+NAME
+   HXIgetfile -- get the external file of an external element
+USAGE
+   intn HXIgetfile(info, acc_mode, file)
+   extinfo_t  *info;        IN: special information of the element
+   intn        acc_mode;    IN: DFACC_READ or DFACC_WRITE, with DFACC_CREATE
+                                to create the file if it does not exist
+   hdf_file_t *file;        OUT: the open file
+RETURNS
+   SUCCEED / FAIL
+DESCRIPTION
+   Look for the external file in the directories set up by HXsetdir
+   the first time it is used, or after those directories have changed,
+   then get it from the pool of open files.  The first time the element
+   uses a file which was already in the pool, the file is flushed, so
+   that data buffered from an earlier use is not returned.
+
+---------------------------------------------------------------------------*/
+static intn
+HXIgetfile(extinfo_t *info, intn acc_mode, hdf_file_t *file)
+{
+    intn slot;
+    intn ret_value = SUCCEED;
+
+    if (info->path == NULL || info->path_gen != extdir_gen) {
+        free(info->path);
+        if ((info->path = HXIbuildfilename(info->extern_file_name, DFACC_OLD)) == NULL)
+            HGOTO_DONE(FAIL);
+        info->path_gen = extdir_gen;
+    } /* end if */
+
+    slot = HXIpool_find(info->path);
+    if (HXIpool_open(info->file_rec, info->path, acc_mode & (DFACC_READ | DFACC_WRITE),
+                     acc_mode & DFACC_CREATE, file) == FAIL)
+        HGOTO_DONE(FAIL);
+    if (!info->file_used) {
+        if (slot != FAIL)
+            HI_FLUSH(*file);
+        info->file_used = TRUE;
+    } /* end if */
+
+done:
+    return ret_value;
+} /* HXIgetfile */
+
+/*------------------------------------------------------------------------
+NAME
+   HXPclosefile -- close the external files used for an HDF file
+USAGE
+   void HXPclosefile(file_rec)
+   filerec_t *file_rec;     IN: HDF file being closed
+RETURNS
+   none
+DESCRIPTION
+   Close the files in the pool of external files which were used for
+   the HDF file, including those also used for other HDF files, so that
+   an external file replaced or removed after the HDF file is closed is
+   not read through an old descriptor.
+
+--------------------------------------------------------------------------*/
+void
+HXPclosefile(filerec_t *file_rec)
+{
+    intn slot;
+
+    for (slot = 0; slot < MAX_EXT_FILE; slot++)
+        if (ext_pool[slot].path != NULL &&
+            (ext_pool[slot].file_rec == file_rec || ext_pool[slot].file_rec == NULL))
+            HXIpool_close(slot);
+} /* end HXPclosefile() */
+
 /*------------------------------------------------------------------------
 NAME
    HXPshutdown -- free any memory buffers we've allocated
@@ -1362,6 +1526,13 @@ DESCRIPTION
 intn
 HXPshutdown(void)
 {
+    intn slot;
+
+    /* close the files left open in the pool */
+    for (slot = 0; slot < MAX_EXT_FILE; slot++)
+        if (ext_pool[slot].path != NULL)
+            HXIpool_close(slot);
+
     free(extcreatedir);
     extcreatedir = NULL;
 
@@ -43,7 +43,9 @@
 
    EXPORTED ROUTINES
    Hopen       -- open or create a HDF file
+   Hopen_image -- open or create a HDF file image in memory
    Hclose      -- close HDF file
+   Hget_image  -- copy out the contents of a HDF file image
    Hstartread  -- locate and position a read access elt on a tag/ref
    Hnextread   -- locate and position a read access elt on next tag/ref.
    Hexist      -- locate an object in an HDF file
@@ -64,6 +66,7 @@
    Htrunc      -- truncate a dataset to a length
    Hsync       -- sync file with memory
    Hcache      -- set low-level caching for a file
+   Hpreallocate -- set the file system preallocation for a file
    HDvalidfid  -- check if a file ID is valid
    HDerr       --  Closes a file and return FAIL.
    Hsetacceesstype -- set the I/O access type (serial, parallel, ...)
@@ -99,15 +102,27 @@
 
    LOCAL ROUTINES
    HIextend_file   -- extend file to current length
+   HIprealloc      -- reserve file system space ahead of the end of file
+   HIprealloc_release -- give back the space reserved but not used
    HIget_function_table -- create special function table
    HIgetspinfo          -- return special info
    HIunlock             -- unlock a previously locked file record
    HIget_filerec_node   -- locate a filerec for a new file
    HIrelease_filerec_node -- release a filerec
    HIvalid_magic        -- verify the magic number in a file
+   HIimage_reserve      -- make room in the buffer of a file image
+   HIseek               -- seek the file to an offset
+   HIwrite              -- write to the file at the current offset
+   HIwb_overlaps        -- check whether a range of the file is in the write buffer
+   HIwb_put             -- put a small write into the write buffer
    HIget_access_rec     -- allocate a new access record
    HIupdate_version     -- determine whether new version tag should be written
    HIread_version       -- reads a version tag from a file
+   HIappend_block_size  -- block length for converting an appendable element
+   HIgetdiskblock       -- allocate a block, optionally from the free lists
+   HIfree_list_get      -- take a block from the free lists
+   HIfree_list_build    -- rebuild the free lists from the DD list
+   HIfree_list_release  -- release the free lists
    + */
 
 #include <string.h>
@@ -120,11 +135,19 @@
 #include <errno.h>
 #include "glist.h" /* for double-linked lists, stacks and queues */
 
+#if defined(H4_HAVE_POSIX_FALLOCATE) && defined(HI_FILENO)
+#include <fcntl.h>
+#define HI_PREALLOC
+#endif
+
 /*--------------------- Locally defined Globals -----------------------------*/
 
 /* The default state of the file DD caching */
 static intn default_cache = TRUE;
 
+/* The default size of the file system preallocation, 0 for none */
+static int32 default_prealloc = 0;
+
 /* Whether we've installed the library termination function yet for this interface */
 static intn          library_terminate = FALSE;
 static Generic_list *cleanup_list      = NULL;
@@ -132,6 +155,12 @@ static Generic_list *cleanup_list      = NULL;
 /* Whether to install the atexit routine */
 static intn install_atexit = TRUE;
 
+/* Number of file images opened, for naming them */
+static uint32 image_count = 0;
+
+/* Smallest buffer allocated for a file image */
+#define IMAGE_MIN_SIZE 4096
+
 /*--------------------- Externally defined Globals --------------------------*/
 /* Function tables declarations.  These function tables contain pointers
    to functions that help access each type of special element. */
@@ -188,8 +217,22 @@ static intn HIrelease_filerec_node(filerec_t *file_rec);
 
 static intn HIvalid_magic(hdf_file_t file);
 
+static intn HIimage_reserve(filerec_t *file_rec, int32 size);
+
+static intn HIseek(filerec_t *file_rec, int32 offset);
+
+static intn HIwrite(filerec_t *file_rec, const void *buf, int32 bytes);
+
+static intn HIwb_overlaps(filerec_t *file_rec, int32 offset, int32 bytes);
+
+static intn HIwb_put(filerec_t *file_rec, const void *buf, int32 bytes);
+
 static intn HIextend_file(filerec_t *file_rec);
 
+static intn HIprealloc(filerec_t *file_rec, int32 end);
+
+static intn HIprealloc_release(filerec_t *file_rec);
+
 static funclist_t *HIget_function_table(accrec_t *access_rec);
 
 static intn HIupdate_version(int32);
@@ -198,6 +241,16 @@ static intn HIread_version(int32);
 
 static intn HIcheckfileversion(int32 file_id);
 
+static int32 HIappend_block_size(accrec_t *access_rec, int32 grown_len);
+
+static int32 HIgetdiskblock(filerec_t *file_rec, int32 block_size, intn moveto, intn reuse);
+
+static int32 HIfree_list_get(filerec_t *file_rec, int32 block_size);
+
+static intn HIfree_list_build(filerec_t *file_rec);
+
+static void HIfree_list_release(filerec_t *file_rec);
+
 static intn HIsync(filerec_t *file_rec);
 
 static intn HIstart(void);
@@ -279,6 +332,10 @@ Hopen(const char *path, intn acc_mode, int16 ndds)
 #ifndef NO_MULTI_OPEN
             hdf_file_t f;
 
+            /* an image can't be reopened, it was copied only if writable */
+            if (file_rec->image != NULL)
+                HGOTO_ERROR(DFE_DENIED, FAIL);
+
             /* Sync. the file before throwing away the old file handle */
             if (HIsync(file_rec) == FAIL)
                 HGOTO_ERROR(DFE_INTERNAL, FAIL);
@@ -385,6 +442,9 @@ Hopen(const char *path, intn acc_mode, int16 ndds)
         /* currently, default is caching OFF */
         file_rec->cache = default_cache;
         file_rec->dirty = 0; /* mark all dirty flags off to start */
+
+        file_rec->prealloc     = default_prealloc;
+        file_rec->prealloc_end = 0;
     }                        /* end else */
 
     file_rec->version_set = FALSE;
@@ -416,6 +476,125 @@ done:
     return ret_value;
 } /* Hopen */
 
+/*--------------------------------------------------------------------------
+NAME
+   Hopen_image -- open or create a HDF file image in memory
+USAGE
+   int32 Hopen_image(image, size, acc_mode, ndds)
+   const void *image;      IN: contents of the file, or NULL
+   int32 size;             IN: length of the contents
+   int acc_mode;           IN: access mode to open the image with
+   int16 ndds;             IN: Number of dds in a block if the image is
+                                created.
+RETURNS
+   On success returns file id, on failure returns -1.
+DESCRIPTION
+   Opens the contents of a HDF file held in memory, as Hopen() opens a
+   file on disk.  The file ID can be used with every interface which
+   takes an ID from Hopen(), such as Vstart(), GRstart(), ANstart() and
+   SDstart_image().
+
+   With DFACC_READ, the image is read in place, so it must not be
+   changed or freed until the file is closed.  With DFACC_WRITE, the
+   image is copied into a buffer which grows as the file is written; an
+   image of NULL or of size 0 creates a new file, as does DFACC_CREATE.
+   The contents of the file are retrieved with Hget_image() before the
+   file is closed.
+
+--------------------------------------------------------------------------*/
+int32
+Hopen_image(const void *image, int32 size, intn acc_mode, int16 ndds)
+{
+    filerec_t *file_rec = NULL; /* File record */
+    char       name[32];        /* name given to the image */
+    intn       new_file;        /* whether the image is new and needs to be set up */
+    int32      fid       = FAIL; /* File ID */
+    int32      ret_value = SUCCEED;
+
+    /* Clear errors and check args and all the boring stuff. */
+    HEclear();
+    if (((acc_mode & DFACC_ALL) != acc_mode) || size < 0 || (image == NULL && size > 0))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    new_file = (acc_mode & DFACC_CREATE) || image == NULL || size == 0;
+    if (new_file && !(acc_mode & (DFACC_WRITE | DFACC_CREATE)))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* Perform global, one-time initialization */
+    if (library_terminate == FALSE)
+        if (HIstart() == FAIL)
+            HGOTO_ERROR(DFE_CANTINIT, FAIL);
+
+    /* Get a file record under a name no file on disk is opened with */
+    snprintf(name, sizeof(name), "<HDF image %lu>", (unsigned long)++image_count);
+    if ((file_rec = HIget_filerec_node(name)) == NULL)
+        HGOTO_ERROR(DFE_TOOMANY, FAIL);
+
+    file_rec->f_cur_off = 0;
+    file_rec->last_op   = H4_OP_UNKNOWN;
+    if (new_file) {
+        if (HIimage_reserve(file_rec, IMAGE_MIN_SIZE) == FAIL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+        /* set up the new image with the magic cookie and initial data
+           descriptor records */
+        if (HP_write(file_rec, HDFMAGIC, MAGICLEN) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        if (HTPinit(file_rec, ndds) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+        file_rec->maxref = 0;
+        file_rec->access = DFACC_ALL;
+    } /* end if */
+    else {
+        if (size < MAGICLEN || !NSTREQ((const char *)image, HDFMAGIC, MAGICLEN))
+            HGOTO_ERROR(DFE_NOTDFFILE, FAIL);
+
+        if (acc_mode & DFACC_WRITE) { /* writable images are copied */
+            if (HIimage_reserve(file_rec, size) == FAIL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            memcpy(file_rec->image_buf, image, (size_t)size);
+        } /* end if */
+        else
+            file_rec->image = image;
+        file_rec->image_len = size;
+        file_rec->access    = acc_mode | DFACC_READ;
+
+        /* Read in all the relevant data descriptor records. */
+        if (HTPstart(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_BADOPEN, FAIL);
+    } /* end else */
+    file_rec->refcount    = 1;
+    file_rec->attach      = 0;
+    file_rec->cache       = default_cache;
+    file_rec->dirty       = 0;
+    file_rec->version_set = FALSE;
+
+    if ((fid = HAregister_atom(FIDGROUP, file_rec)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* version tags */
+    if (new_file) {
+        if (HIupdate_version(fid) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    } /* end if */
+    else
+        HIread_version(fid); /* ignore return code in case the file doesn't have a version */
+
+    ret_value = fid;
+
+done:
+    if (ret_value == FAIL) { /* Error condition cleanup */
+        if (fid != FAIL)
+            HAremove_atom(fid);
+
+        /* Chuck the file record we've built */
+        if (file_rec != NULL)
+            HIrelease_filerec_node(file_rec);
+    }
+
+    return ret_value;
+} /* Hopen_image */
+
 /*--------------------------------------------------------------------------
 NAME
    Hclose -- close HDF file
@@ -462,9 +641,17 @@ Hclose(int32 file_id)
         if (HIsync(file_rec) == FAIL)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
+        /* give back the preallocated space the file did not grow into */
+        if (HIprealloc_release(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
         /* otherwise, nothing should still be using this file, close it */
         /* ignore any close error */
-        HI_CLOSE(file_rec->file);
+        if (file_rec->image == NULL)
+            HI_CLOSE(file_rec->file);
+
+        /* and the external files its elements were in */
+        HXPclosefile(file_rec);
 
         if (HTPend(file_rec) == FAIL)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
@@ -480,6 +667,51 @@ done:
     return ret_value;
 } /* Hclose */
 
+/*--------------------------------------------------------------------------
+NAME
+   Hget_image -- copy out the contents of a HDF file image
+USAGE
+   int32 Hget_image(file_id, buf, size)
+   int32 file_id;          IN: id of a file opened with Hopen_image
+   void *buf;              OUT: buffer for the contents, or NULL
+   int32 size;             IN: size of buf
+RETURNS
+   The length of the file on success, FAIL (-1) otherwise.
+DESCRIPTION
+   Brings the file image up to date, as closing the file would, then
+   copies as much of it as fits in buf.  Calling with buf NULL only
+   returns the length, so that a buffer of the right size can be
+   allocated.  The interfaces started on the file (Vstart(), GRstart(),
+   SDstart_image(), ...) should be ended first, so that what they hold
+   in memory is in the image.
+
+--------------------------------------------------------------------------*/
+int32
+Hget_image(int32 file_id, void *buf, int32 size)
+{
+    filerec_t *file_rec; /* file record pointer */
+    int32      ret_value = SUCCEED;
+
+    HEclear();
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec) || file_rec->image == NULL || size < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (file_rec->access & DFACC_WRITE) {
+        if (file_rec->version.modified == 1)
+            HIupdate_version(file_id);
+        if (HIsync(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    } /* end if */
+
+    if (buf != NULL)
+        memcpy(buf, file_rec->image, (size_t)MIN(size, file_rec->image_len));
+    ret_value = file_rec->image_len;
+
+done:
+    return ret_value;
+} /* Hget_image */
+
 /*--------------------------------------------------------------------------
 NAME
    Hexist -- locate an object in an HDF file
@@ -884,6 +1116,7 @@ Hstartaccess(int32 file_id, uint16 tag, uint16 ref, uint32 flags)
     /* VSsetblocksize and VSsetnumblocks - BMR (bug #267 - June 2001) */
     access_rec->block_size = HDF_APPENDABLE_BLOCK_LEN;
     access_rec->num_blocks = HDF_APPENDABLE_BLOCK_NUM;
+    access_rec->block_set  = FALSE;
 
     access_rec->special_info = NULL; /* reset */
 
@@ -1010,8 +1243,10 @@ Hsetlength(int32 aid, int32 length)
     if (BADFREC(file_rec))
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* place the data element at the end of the file and record its offset */
-    if ((offset = HPgetdiskblock(file_rec, length, FALSE)) == FAIL)
+    /* place the data element in released space or at the end of the file and
+       record its offset; appendable elements always go at the end so that
+       they can grow in place */
+    if ((offset = HIgetdiskblock(file_rec, length, FALSE, !access_rec->appendable)) == FAIL)
         HGOTO_ERROR(DFE_SEEKERROR, FAIL);
 
     /* fill in dd record updating the offset and length of the element */
@@ -1178,7 +1413,8 @@ Hseek(int32 access_id, int32 offset, intn origin)
         /* check if we are at end of file */
         if (data_len + data_off !=
             file_rec->f_end_off) { /* nope, so try to convert element into linked-block element */
-            if (HLconvert(access_id, access_rec->block_size, access_rec->num_blocks) == FAIL) {
+            if (HLconvert(access_id, HIappend_block_size(access_rec, data_len), access_rec->num_blocks) ==
+                FAIL) {
                 access_rec->appendable = FALSE;
                 HEreport("Tried to seek to %d (object length:  %d)", offset, data_len);
                 HGOTO_ERROR(DFE_BADSEEK, FAIL);
@@ -1346,6 +1582,10 @@ Hwrite(int32 access_id, int32 length, const void *data)
     if (access_rec == (accrec_t *)NULL || !(access_rec->access & DFACC_WRITE) || data == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    /* positions in an element are 32-bit too */
+    if (length > MAX_FILE_OFFSET - access_rec->posn)
+        HGOTO_ERROR(DFE_EXCEEDMAX, FAIL);
+
     /* if special elt, call special write function */
     if (access_rec->special) {
         ret_value = (*access_rec->special_func->write)(access_rec, length, data);
@@ -1360,8 +1600,8 @@ Hwrite(int32 access_id, int32 length, const void *data)
     /* check for a "new" element and make it appendable if so.
        Does this mean every element is by default appendable? */
     if (access_rec->new_elem == TRUE) {
-        Hsetlength(access_id, length); /* make the initial chunk of data */
         access_rec->appendable = TRUE; /* make it appendable */
+        Hsetlength(access_id, length); /* make the initial chunk of data */
     }                                  /* end if */
 
     /* get the offset and length of the element. This should have
@@ -1369,6 +1609,10 @@ Hwrite(int32 access_id, int32 length, const void *data)
     if (HTPinquire(access_rec->ddid, NULL, NULL, &data_off, &data_len) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
+    /* the data can't extend past the last offset a DD can hold */
+    if (length > MAX_FILE_OFFSET - data_off - access_rec->posn)
+        HGOTO_ERROR(DFE_EXCEEDMAX, FAIL);
+
     /* check validity of length and write data.
      NOTE: it is an error to attempt write past the end of the elt */
     if (length <= 0 || (!access_rec->appendable && length + access_rec->posn > data_len))
@@ -1382,7 +1626,8 @@ Hwrite(int32 access_id, int32 length, const void *data)
            hmm. not sure about this condition. */
         if (data_len + data_off != file_rec->f_end_off) { /* nope, not at end of file. Try to promote to
                                                          linked-block element. */
-            if (HLconvert(access_id, access_rec->block_size, access_rec->num_blocks) == FAIL) {
+            if (HLconvert(access_id, HIappend_block_size(access_rec, MAX(data_len, length)),
+                          access_rec->num_blocks) == FAIL) {
                 access_rec->appendable = FALSE;
                 HGOTO_ERROR(DFE_BADSEEK, FAIL);
             } /* end if */
@@ -1400,6 +1645,8 @@ Hwrite(int32 access_id, int32 length, const void *data)
     } /* end if */
 
     /* seek and write data */
+    if (HIprealloc(file_rec, access_rec->posn + data_off + length) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
     if (HPseek(file_rec, access_rec->posn + data_off) == FAIL)
         HGOTO_ERROR(DFE_SEEKERROR, FAIL);
 
@@ -1858,6 +2105,10 @@ HIsync(filerec_t *file_rec)
         file_rec->dirty = 0; /* file doesn't need to be flushed now */
     }                        /* end if */
 
+    /* write out what is left in the write buffer */
+    if (HPflush_writes(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_CANTFLUSH, FAIL);
+
 done:
     return ret_value;
 } /* HIsync */
@@ -1940,6 +2191,65 @@ done:
     return ret_value;
 } /* Hcache */
 
+/*--------------------------------------------------------------------------
+NAME
+   Hpreallocate -- set the file system preallocation for a file
+USAGE
+   intn Hpreallocate(file_id, extent)
+           int32 file_id;            IN: id of file
+           int32 extent;             IN: bytes to reserve ahead, 0 for none
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   When extent is positive, each time the file grows past the space
+   reserved so far, at least extent more bytes are reserved from the
+   file system with posix_fallocate(), so that large datasets and chunks
+   are laid out contiguously on disk and a full disk is reported when
+   the space is allocated rather than part way through the writes.  The
+   space that was reserved but not used is given back when the file is
+   closed or preallocation is turned off.
+   If file_id is set to PREALLOC_ALL_FILES, then extent is used as the
+   default for the files opened after the call.
+   Fails with DFE_UNSUPPORTED for a positive extent if the system has no
+   posix_fallocate() or the file is a memory image.
+--------------------------------------------------------------------------*/
+intn
+Hpreallocate(int32 file_id, int32 extent)
+{
+    filerec_t *file_rec; /* file record */
+    intn       ret_value = SUCCEED;
+
+    HEclear();
+    if (extent < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+#ifndef HI_PREALLOC
+    if (extent > 0)
+        HGOTO_ERROR(DFE_UNSUPPORTED, FAIL);
+#endif /* HI_PREALLOC */
+
+    if (file_id == PREALLOC_ALL_FILES) /* set the default for all further files Hopen'ed */
+        default_prealloc = extent;
+    else {
+        /* check validity of file record */
+        file_rec = HAatom_object(file_id);
+        if (BADFREC(file_rec))
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        if (extent > 0 && file_rec->image != NULL)
+            HGOTO_ERROR(DFE_UNSUPPORTED, FAIL);
+
+        if (extent == 0 && file_rec->prealloc > 0) {
+            if (HIsync(file_rec) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            if (HIprealloc_release(file_rec) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        } /* end if */
+        file_rec->prealloc = extent;
+    } /* end else */
+
+done:
+    return ret_value;
+} /* Hpreallocate */
+
 /*--------------------------------------------------------------------------
 NAME
    HDvalidfid -- check if a file ID is valid
@@ -2236,6 +2546,87 @@ done:
     return ret_value;
 } /* HIextend_file */
 
+/*--------------------------------------------------------------------------
+NAME
+   HIprealloc -- reserve file system space ahead of the end of file
+USAGE
+   intn HIprealloc(file_rec, end)
+           filerec_t  * file_rec        IN: pointer to file structure
+           int32 end;                   IN: offset the file is about to reach
+RETURNS
+   SUCCEED / FAIL
+DESCRIPTION
+   Does nothing unless preallocation is on for the file and end is past
+   the space reserved so far.  Otherwise reserves up to end, or one
+   extent past the reserved space, whichever is further.
+--------------------------------------------------------------------------*/
+static intn
+HIprealloc(filerec_t *file_rec, int32 end)
+{
+    intn ret_value = SUCCEED;
+
+#ifdef HI_PREALLOC
+    int32 start; /* first byte not reserved yet */
+    int32 new_end;
+
+    if (file_rec->prealloc <= 0 || file_rec->image != NULL || end <= file_rec->prealloc_end)
+        HGOTO_DONE(SUCCEED);
+
+    start   = MAX(file_rec->prealloc_end, file_rec->f_end_off);
+    new_end = MAX(end, start + MIN(file_rec->prealloc, INT32_MAX - start));
+    if (new_end > start &&
+        posix_fallocate(HI_FILENO(file_rec->file), (off_t)start, (off_t)(new_end - start)) != 0)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    file_rec->prealloc_end = new_end;
+
+done:
+#else  /* HI_PREALLOC */
+    (void)file_rec;
+    (void)end;
+#endif /* HI_PREALLOC */
+    return ret_value;
+} /* HIprealloc */
+
+/*--------------------------------------------------------------------------
+NAME
+   HIprealloc_release -- give back the space reserved but not used
+USAGE
+   intn HIprealloc_release(file_rec)
+           filerec_t  * file_rec        IN: pointer to file structure
+RETURNS
+   SUCCEED / FAIL
+DESCRIPTION
+   Cuts the file back to f_end_off if the last extent reserved runs past
+   it and nothing else has written beyond the extent.  Should be called
+   after the file is synced.
+--------------------------------------------------------------------------*/
+static intn
+HIprealloc_release(filerec_t *file_rec)
+{
+    intn ret_value = SUCCEED;
+
+#ifdef HI_PREALLOC
+    struct stat st;
+
+    if (file_rec->prealloc_end <= file_rec->f_end_off)
+        HGOTO_DONE(SUCCEED);
+
+    if (HI_FLUSH(file_rec->file) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    if (fstat(HI_FILENO(file_rec->file), &st) != 0)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    if (st.st_size <= (off_t)file_rec->prealloc_end &&
+        ftruncate(HI_FILENO(file_rec->file), (off_t)file_rec->f_end_off) != 0)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    file_rec->prealloc_end = 0;
+#else  /* HI_PREALLOC */
+    (void)file_rec;
+#endif /* HI_PREALLOC */
+    return ret_value;
+} /* HIprealloc_release */
+
 /*--------------------------------------------------------------------------
 NAME
    HIget_function_table -- create special function table
@@ -2628,10 +3019,14 @@ static intn
 HIrelease_filerec_node(filerec_t *file_rec)
 {
     /* Close file if it's opened */
-    if (file_rec->file != NULL)
+    if (file_rec->image == NULL && file_rec->file != NULL)
         HI_CLOSE(file_rec->file);
 
     /* Free all the components of the file record */
+    free(file_rec->image_buf);
+    free(file_rec->wb_data);
+    free(file_rec->wb_ranges);
+    HIfree_list_release(file_rec);
     free(file_rec->path);
     free(file_rec);
 
@@ -2741,6 +3136,43 @@ done:
     return (ret_value);
 } /* HPcompare_accrec_tagref */
 
+/*--------------------------------------------------------------------------
+ NAME
+       HIimage_reserve -- make room in the buffer of a file image
+ USAGE
+       intn HIimage_reserve(file_rec, size)
+       filerec_t *file_rec;         IN: file record of the image
+       int32 size;                  IN: number of bytes the image must hold
+ RETURNS
+       SUCCEED/FAIL
+ DESCRIPTION
+       Grow the buffer of an image to at least size bytes, doubling it so
+       that writing a file piece by piece copies it only a few times.
+
+--------------------------------------------------------------------------*/
+static intn
+HIimage_reserve(filerec_t *file_rec, int32 size)
+{
+    uint8 *new_image;
+    int32  new_size;
+    intn   ret_value = SUCCEED;
+
+    if (size <= file_rec->image_size)
+        HGOTO_DONE(SUCCEED);
+
+    new_size = MAX(file_rec->image_size, IMAGE_MIN_SIZE);
+    while (new_size < size)
+        new_size = (new_size > INT32_MAX / 2) ? INT32_MAX : new_size * 2;
+    if ((new_image = (uint8 *)realloc(file_rec->image_buf, (size_t)new_size)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    file_rec->image      = new_image;
+    file_rec->image_buf  = new_image;
+    file_rec->image_size = new_size;
+
+done:
+    return ret_value;
+} /* HIimage_reserve */
+
 /*--------------------------------------------------------------------------
  NAME
        HIvalid_magic -- verify the magic number in a file
@@ -2940,6 +3372,37 @@ done:
     return ret_value;
 } /* HIread_version */
 
+/*-----------------------------------------------------------------------
+NAME
+   HIappend_block_size --- Block length for converting an appendable element.
+USAGE
+   int32 HIappend_block_size(access_rec, grown_len)
+   accrec_t *access_rec;    IN: access record of the appendable element
+   int32 grown_len;         IN: size the element or its writes have reached
+RETURNS
+   the block length to pass to HLconvert()
+DESCRIPTION
+   Linked blocks after the first all have the same length, so the length
+   is picked once, when an appendable element can no longer grow in place.
+   A length set with HLsetblockinfo() is used as is.  Otherwise the
+   default is doubled until it covers what the element has grown to so
+   far, up to HDF_APPENDABLE_BLOCK_MAX, so that elements which are
+   appended to in large pieces do not end up in thousands of small
+   blocks and long chains of block tables.
+
+-------------------------------------------------------------------------*/
+static int32
+HIappend_block_size(accrec_t *access_rec, int32 grown_len)
+{
+    int32 block_size = access_rec->block_size;
+
+    if (access_rec->block_set == FALSE)
+        while (block_size < grown_len && block_size <= HDF_APPENDABLE_BLOCK_MAX / 2)
+            block_size *= 2;
+
+    return block_size;
+} /* HIappend_block_size() */
+
 /*-----------------------------------------------------------------------
 NAME
    HPgetdiskblock --- Get the offset of a free block in the file.
@@ -2953,14 +3416,36 @@ USAGE
 RETURNS
    returns offset of block in the file if successful, FAIL (-1) if failed.
 DESCRIPTION
-   Used to "allocate" space in the file.  Currently, it just appends
-   blocks to the end of the file willy-nilly.  At some point in the
-   future, this could be changed to use a "real" free-list of empty
-   blocks in the file and dole those out.
+   Used to "allocate" space in the file.  The block is carved out of
+   space released by deleted or moved elements when a large enough run
+   is free, otherwise it is appended to the end of the file.
 
 -------------------------------------------------------------------------*/
 int32
 HPgetdiskblock(filerec_t *file_rec, int32 block_size, intn moveto)
+{
+    return HIgetdiskblock(file_rec, block_size, moveto, TRUE);
+} /* HPgetdiskblock() */
+
+/*-----------------------------------------------------------------------
+NAME
+   HIgetdiskblock --- Get the offset of a block in the file.
+USAGE
+   int32 HIgetdiskblock(file_rec, block_size, moveto, reuse)
+   filerec_t *file_rec;     IN: ptr to the file record
+   int32 block_size;        IN: size of the block needed
+   intn moveto;             IN: whether to move the file position
+                                to the allocated position
+   intn reuse;              IN: whether released space may be used
+RETURNS
+   returns offset of block in the file if successful, FAIL (-1) if failed.
+DESCRIPTION
+   Does the work for HPgetdiskblock.  When reuse is FALSE, the block is
+   always appended to the end of the file.
+
+-------------------------------------------------------------------------*/
+static int32
+HIgetdiskblock(filerec_t *file_rec, int32 block_size, intn moveto, intn reuse)
 {
     uint8 temp;
     int32 ret_value = SUCCEED;
@@ -2969,6 +3454,27 @@ HPgetdiskblock(filerec_t *file_rec, int32 block_size, intn moveto)
     if (file_rec == NULL || block_size < 0)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+#ifndef DISKBLOCK_DEBUG
+    /* look for a run of released space that the block fits in */
+    if (reuse == TRUE && block_size > 0) {
+        int32 free_off; /* offset of the block in released space */
+
+        if ((free_off = HIfree_list_get(file_rec, block_size)) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if (free_off > 0) {
+            if (moveto == TRUE && HPseek(file_rec, free_off) == FAIL)
+                HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+            HGOTO_DONE(free_off);
+        } /* end if */
+    }     /* end if */
+#else     /* DISKBLOCK_DEBUG */
+    (void)reuse;
+#endif    /* DISKBLOCK_DEBUG */
+
+    /* the end of the block must still be addressable by a DD */
+    if (block_size > MAX_FILE_OFFSET - file_rec->f_end_off)
+        HGOTO_ERROR(DFE_EXCEEDMAX, FAIL);
+
 #ifdef DISKBLOCK_DEBUG
     block_size += (DISKBLOCK_HSIZE + DISKBLOCK_TSIZE);
     /* get the offset of the allocated block */
@@ -2995,7 +3501,12 @@ HPgetdiskblock(filerec_t *file_rec, int32 block_size, intn moveto)
                 HGOTO_ERROR(DFE_WRITEERROR, FAIL);
         }               /* end else */
 #else                   /* DISKBLOCK_DEBUG */
-        if (file_rec->cache)
+        if (file_rec->prealloc > 0) {
+            /* the reserved extent already makes the file long enough */
+            if (HIprealloc(file_rec, ret_value + block_size) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        } /* end if */
+        else if (file_rec->cache)
             file_rec->dirty |= FILE_END_DIRTY;
         else {
             if (HPseek(file_rec, ret_value + block_size - 1) == FAIL)
@@ -3016,7 +3527,7 @@ HPgetdiskblock(filerec_t *file_rec, int32 block_size, intn moveto)
 
 done:
     return ret_value;
-} /* HPgetdiskblock() */
+} /* HIgetdiskblock() */
 
 /*-----------------------------------------------------------------------
 NAME
@@ -3029,9 +3540,11 @@ USAGE
 RETURNS
    returns SUCCEED (0) if successful, FAIL (-1) if failed.
 DESCRIPTION
-   Used to "release" space in the file.  Currently, it does nothing.
-   At some point in the future, this could be changed to add the block
-   to a "real" free-list of empty blocks in the file and manage those.
+   Used to "release" space in the file.  The block is not handed out
+   again right away: a block may still be referenced by a duplicate DD
+   (see Hdupdd) or by the DD that is about to be deleted.  Instead, the
+   released bytes are counted and the free lists are rebuilt from the
+   DD list once enough space has been released to satisfy a request.
 
 -------------------------------------------------------------------------*/
 intn
@@ -3039,13 +3552,243 @@ HPfreediskblock(filerec_t *file_rec, int32 block_off, int32 block_size)
 {
     intn ret_value = SUCCEED;
 
-    (void)file_rec;
-    (void)block_off;
-    (void)block_size;
+    /* check for valid arguments */
+    if (file_rec == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* only count real blocks in files that can be written to */
+    if (!(file_rec->access & DFACC_WRITE) || block_off == INVALID_OFFSET || block_off <= 0 ||
+        block_size == INVALID_LENGTH || block_size <= 0)
+        HGOTO_DONE(SUCCEED);
 
+    /* no more than the whole file can be released */
+    if (block_size > file_rec->f_end_off - file_rec->free_pending)
+        file_rec->free_pending = file_rec->f_end_off;
+    else
+        file_rec->free_pending += block_size;
+
+done:
     return ret_value;
 } /* HPfreediskblock() */
 
+/* extent of the file in use by a DD or a DD block, for HIfree_list_build */
+typedef struct {
+    int32 start; /* offset of the first byte in use */
+    int32 end;   /* offset of the first byte after the extent */
+} free_extent_t;
+
+/* qsort() comparison for extents, by starting offset */
+static int
+HIfree_extent_cmp(const void *a, const void *b)
+{
+    const free_extent_t *ea = (const free_extent_t *)a;
+    const free_extent_t *eb = (const free_extent_t *)b;
+
+    return (ea->start > eb->start) - (ea->start < eb->start);
+} /* HIfree_extent_cmp */
+
+/* index of the free list that a run of 'length' (> 0) bytes belongs in */
+static intn
+HIfree_list_index(int32 length)
+{
+    intn idx = 0;
+
+    while (length >>= 1)
+        idx++;
+    return idx;
+} /* HIfree_list_index */
+
+/*-----------------------------------------------------------------------
+NAME
+   HIfree_list_release --- Release the free lists of a file.
+USAGE
+   void HIfree_list_release(file_rec)
+   filerec_t *file_rec;     IN: ptr to the file record
+RETURNS
+   none
+DESCRIPTION
+   Frees every run in the free lists and marks them as not built.
+
+-------------------------------------------------------------------------*/
+static void
+HIfree_list_release(filerec_t *file_rec)
+{
+    freeblock_t *blk, *next;
+    intn         i;
+
+    for (i = 0; i < FREE_NLISTS; i++) {
+        for (blk = file_rec->free_list[i]; blk != NULL; blk = next) {
+            next = blk->next;
+            free(blk);
+        } /* end for */
+        file_rec->free_list[i] = NULL;
+    } /* end for */
+    file_rec->free_built   = FALSE;
+    file_rec->free_pending = 0;
+} /* HIfree_list_release */
+
+/*-----------------------------------------------------------------------
+NAME
+   HIfree_list_build --- Rebuild the free lists from the DD list.
+USAGE
+   intn HIfree_list_build(file_rec)
+   filerec_t *file_rec;     IN: ptr to the file record
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) if failed.
+DESCRIPTION
+   The DD list is the only record of which parts of the file are in
+   use, so the free lists are derived from it rather than stored in the
+   file.  The file header, every DD block, and the data of every
+   non-NULL DD are collected and sorted, and the gaps between them
+   below the end of the file are put in the free lists.  This also
+   picks up space left unused by earlier sessions.
+
+-------------------------------------------------------------------------*/
+static intn
+HIfree_list_build(filerec_t *file_rec)
+{
+    free_extent_t *ext = NULL; /* extents in use */
+    ddblock_t     *block;      /* DD block being scanned */
+    int32          n_ext;      /* number of extents */
+    int32          cur;        /* end of the extents scanned so far */
+    int32          i;
+    intn           ret_value = SUCCEED;
+
+    HIfree_list_release(file_rec);
+
+    /* count the extents: the header, the DD blocks, and their DDs */
+    n_ext = 1;
+    for (block = file_rec->ddhead; block != NULL; block = block->next)
+        n_ext += 1 + block->ndds;
+
+    if ((ext = (free_extent_t *)malloc((size_t)n_ext * sizeof(free_extent_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    ext[0].start = 0;
+    ext[0].end   = MAGICLEN;
+    n_ext        = 1;
+    for (block = file_rec->ddhead; block != NULL; block = block->next) {
+        dd_t *dd = block->ddlist;
+
+        ext[n_ext].start = block->myoffset;
+        ext[n_ext].end   = block->myoffset + NDDS_SZ + OFFSET_SZ + (block->ndds * DD_SZ);
+        n_ext++;
+        for (i = 0; i < block->ndds; i++, dd++) {
+            if (dd->tag == DFTAG_NULL || dd->offset == INVALID_OFFSET || dd->length == INVALID_LENGTH ||
+                dd->offset < 0 || dd->length <= 0)
+                continue;
+            ext[n_ext].start = dd->offset;
+            ext[n_ext].end   = dd->offset + dd->length;
+            n_ext++;
+        } /* end for */
+    }     /* end for */
+
+    qsort(ext, (size_t)n_ext, sizeof(free_extent_t), HIfree_extent_cmp);
+
+    /* the gaps between the extents are free */
+    cur = 0;
+    for (i = 0; i <= n_ext; i++) {
+        int32 gap_end = (i < n_ext && ext[i].start < file_rec->f_end_off) ? ext[i].start : file_rec->f_end_off;
+
+        if (gap_end > cur) {
+            freeblock_t *blk;
+            intn         idx;
+
+            if ((blk = (freeblock_t *)malloc(sizeof(freeblock_t))) == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            blk->offset               = cur;
+            blk->length               = gap_end - cur;
+            idx                       = HIfree_list_index(blk->length);
+            blk->next                 = file_rec->free_list[idx];
+            file_rec->free_list[idx]  = blk;
+        } /* end if */
+        if (i < n_ext && ext[i].end > cur)
+            cur = ext[i].end;
+    } /* end for */
+
+    file_rec->free_built = TRUE;
+
+done:
+    if (ret_value == FAIL)
+        HIfree_list_release(file_rec);
+    free(ext);
+
+    return ret_value;
+} /* HIfree_list_build */
+
+/*-----------------------------------------------------------------------
+NAME
+   HIfree_list_get --- Take a block from the free lists.
+USAGE
+   int32 HIfree_list_get(file_rec, block_size)
+   filerec_t *file_rec;     IN: ptr to the file record
+   int32 block_size;        IN: size of the block needed (> 0)
+RETURNS
+   returns offset of the block, 0 if no released run is large enough,
+   or FAIL (-1) if failed.
+DESCRIPTION
+   The free lists are built on the first allocation after the file is
+   opened and rebuilt when a request does not fit but at least as many
+   bytes as requested have been released since the last build.  A run
+   is taken first-fit from the request's own list, else from the first
+   non-empty larger list, and whatever is left of it is put back.
+
+-------------------------------------------------------------------------*/
+static int32
+HIfree_list_get(filerec_t *file_rec, int32 block_size)
+{
+    freeblock_t *blk = NULL; /* run the block is carved from */
+    intn         idx;
+    intn         i;
+    int32        ret_value = 0;
+
+    if (file_rec->free_built == FALSE && HIfree_list_build(file_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    idx = HIfree_list_index(block_size);
+    for (;;) {
+        freeblock_t **prev = &file_rec->free_list[idx];
+
+        /* first fit in the list for this size */
+        for (blk = *prev; blk != NULL && blk->length < block_size; blk = *prev)
+            prev = &blk->next;
+
+        /* any run in a list for larger sizes fits */
+        for (i = idx + 1; blk == NULL && i < FREE_NLISTS; i++)
+            if (file_rec->free_list[i] != NULL) {
+                prev = &file_rec->free_list[i];
+                blk  = *prev;
+            } /* end if */
+
+        if (blk != NULL) {
+            *prev = blk->next;
+            break;
+        } /* end if */
+
+        /* try again once with the space released since the last build */
+        if (file_rec->free_pending < block_size)
+            HGOTO_DONE(0);
+        if (HIfree_list_build(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    } /* end for */
+
+    ret_value = blk->offset;
+
+    /* put the rest of the run back */
+    blk->offset += block_size;
+    blk->length -= block_size;
+    if (blk->length > 0) {
+        i                      = HIfree_list_index(blk->length);
+        blk->next              = file_rec->free_list[i];
+        file_rec->free_list[i] = blk;
+    } /* end if */
+    else
+        free(blk);
+
+done:
+    return ret_value;
+} /* HIfree_list_get */
+
 /*--------------------------------------------------------------------------
  NAME
        HDget_special_info -- get information about a special element
@@ -3200,13 +3943,27 @@ HP_read(filerec_t *file_rec, void *buf, int32 bytes)
 {
     intn ret_value = SUCCEED;
 
+    /* copy from a file image */
+    if (file_rec->image != NULL) {
+        if (file_rec->f_cur_off > file_rec->image_len - bytes)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        memcpy(buf, file_rec->image + file_rec->f_cur_off, (size_t)bytes);
+        file_rec->f_cur_off += bytes;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    /* bytes still in the write buffer have to reach the file first */
+    if (HIwb_overlaps(file_rec, file_rec->f_cur_off, bytes))
+        if (HPflush_writes(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
     /* Check for switching file access operations */
     if (file_rec->last_op == H4_OP_WRITE || file_rec->last_op == H4_OP_UNKNOWN) {
 #ifdef HFILE_SEEKINFO
         read_force_seek++;
 #endif /* HFILE_SEEKINFO */
         file_rec->last_op = H4_OP_UNKNOWN;
-        if (HPseek(file_rec, file_rec->f_cur_off) == FAIL)
+        if (HIseek(file_rec, file_rec->f_cur_off) == FAIL)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
     } /* end if */
 
@@ -3239,6 +3996,51 @@ done:
 --------------------------------------------------------------------------*/
 intn
 HPseek(filerec_t *file_rec, int32 offset)
+{
+    intn ret_value = SUCCEED;
+
+    /* a file image only keeps the offset, like a seek past the end of a file */
+    if (file_rec->image != NULL) {
+        if (offset < 0)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        file_rec->f_cur_off = offset;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    /* once writes are buffered, the seek is left to the next read or write
+       which goes to the file, as most of them end in the buffer */
+    if (file_rec->wb_data != NULL) {
+        if (offset < 0)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        if (file_rec->f_cur_off != offset) {
+            file_rec->f_cur_off = offset;
+            file_rec->last_op   = H4_OP_UNKNOWN;
+        } /* end if */
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    ret_value = HIseek(file_rec, offset);
+
+done:
+    return ret_value;
+} /* end HPseek() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIseek
+ PURPOSE
+    Seek the file to an offset, unless it is there already.
+ USAGE
+    intn HIseek(file_rec,offset)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+        int32 offset;           IN: offset in the file to go to
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    Function to wrap around HI_SEEK
+--------------------------------------------------------------------------*/
+static intn
+HIseek(filerec_t *file_rec, int32 offset)
 {
     intn ret_value = SUCCEED;
 
@@ -3265,7 +4067,7 @@ HPseek(filerec_t *file_rec, int32 offset)
 
 done:
     return ret_value;
-} /* end HPseek() */
+} /* end HIseek() */
 
 /*--------------------------------------------------------------------------
  NAME
@@ -3292,13 +4094,65 @@ HP_write(filerec_t *file_rec, const void *buf, int32 bytes)
 {
     intn ret_value = SUCCEED;
 
+    /* copy into a file image, filling any gap left by a seek with zeros */
+    if (file_rec->image != NULL) {
+        if (file_rec->image_buf == NULL || file_rec->f_cur_off > INT32_MAX - bytes)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        if (HIimage_reserve(file_rec, file_rec->f_cur_off + bytes) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        if (file_rec->f_cur_off > file_rec->image_len)
+            memset(file_rec->image_buf + file_rec->image_len, 0,
+                   (size_t)(file_rec->f_cur_off - file_rec->image_len));
+        memcpy(file_rec->image_buf + file_rec->f_cur_off, buf, (size_t)bytes);
+        file_rec->f_cur_off += bytes;
+        if (file_rec->f_cur_off > file_rec->image_len)
+            file_rec->image_len = file_rec->f_cur_off;
+        HGOTO_DONE(SUCCEED);
+    } /* end if */
+
+    /* small writes (DD blocks, headers, attributes) are collected in the
+       write buffer, to be written out together */
+    if (bytes <= HDF_WRITE_BUF_MAX_WRITE && (file_rec->access & DFACC_WRITE))
+        HGOTO_DONE(HIwb_put(file_rec, buf, bytes));
+
+    /* a larger write goes straight to the file, after any buffered bytes
+       it would overwrite */
+    if (HIwb_overlaps(file_rec, file_rec->f_cur_off, bytes))
+        if (HPflush_writes(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    ret_value = HIwrite(file_rec, buf, bytes);
+
+done:
+    return ret_value;
+} /* end HP_write() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIwrite
+ PURPOSE
+    Write to the file at the current offset.
+ USAGE
+    intn HIwrite(file_rec,buf,bytes)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+        void * buf;              IN: Pointer to the buffer to write
+        int32 bytes;            IN: # of bytes to write
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    Function to wrap around HI_WRITE
+--------------------------------------------------------------------------*/
+static intn
+HIwrite(filerec_t *file_rec, const void *buf, int32 bytes)
+{
+    intn ret_value = SUCCEED;
+
     /* Check for switching file access operations */
     if (file_rec->last_op == H4_OP_READ || file_rec->last_op == H4_OP_UNKNOWN) {
 #ifdef HFILE_SEEKINFO
         write_force_seek++;
 #endif /* HFILE_SEEKINFO */
         file_rec->last_op = H4_OP_UNKNOWN;
-        if (HPseek(file_rec, file_rec->f_cur_off) == FAIL)
+        if (HIseek(file_rec, file_rec->f_cur_off) == FAIL)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
     } /* end if */
 
@@ -3309,7 +4163,199 @@ HP_write(filerec_t *file_rec, const void *buf, int32 bytes)
 
 done:
     return ret_value;
-} /* end HP_write() */
+} /* end HIwrite() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIwb_overlaps
+ PURPOSE
+    Check whether a range of the file is in the write buffer.
+ USAGE
+    intn HIwb_overlaps(file_rec,offset,bytes)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+        int32 offset;           IN: offset of the range
+        int32 bytes;            IN: length of the range
+ RETURNS
+    TRUE if any byte of the range is in the buffer, FALSE otherwise
+--------------------------------------------------------------------------*/
+static intn
+HIwb_overlaps(filerec_t *file_rec, int32 offset, int32 bytes)
+{
+    intn i;
+
+    if (file_rec->wb_nranges == 0 || offset >= file_rec->wb_hi || offset + bytes <= file_rec->wb_lo)
+        return FALSE;
+    for (i = 0; i < file_rec->wb_nranges; i++) {
+        wbrange_t *range = &file_rec->wb_ranges[i];
+
+        if (offset < range->offset + range->length && offset + bytes > range->offset)
+            return TRUE;
+    } /* end for */
+    return FALSE;
+} /* end HIwb_overlaps() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIwb_put
+ PURPOSE
+    Put a small write into the write buffer.
+ USAGE
+    intn HIwb_put(file_rec,buf,bytes)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+        void * buf;              IN: Pointer to the buffer to write
+        int32 bytes;            IN: # of bytes to write
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    The bytes are written at the current offset into the buffer.  A write
+    which continues the last one extends its range, and a write inside a
+    range already in the buffer replaces its bytes there.  The ranges in
+    the buffer never overlap, so that they can be written out in any
+    order; a write which partly overlaps them, or doesn't fit, writes the
+    buffer out first.
+--------------------------------------------------------------------------*/
+static intn
+HIwb_put(filerec_t *file_rec, const void *buf, int32 bytes)
+{
+    int32      offset = file_rec->f_cur_off;
+    wbrange_t *range  = NULL;
+    intn       i;
+    intn       ret_value = SUCCEED;
+
+    /* set up the buffer the first time it is needed, the second half of
+       it is used to gather ranges when they are written out */
+    if (file_rec->wb_data == NULL) {
+        file_rec->wb_data   = (uint8 *)malloc(2 * HDF_WRITE_BUF_SIZE);
+        file_rec->wb_ranges = (wbrange_t *)malloc(HDF_WRITE_BUF_NRANGES * sizeof(wbrange_t));
+        if (file_rec->wb_data == NULL || file_rec->wb_ranges == NULL) {
+            free(file_rec->wb_data);
+            free(file_rec->wb_ranges);
+            file_rec->wb_data   = NULL;
+            file_rec->wb_ranges = NULL;
+            HGOTO_DONE(HIwrite(file_rec, buf, bytes)); /* do without it */
+        }                                              /* end if */
+        file_rec->wb_used    = 0;
+        file_rec->wb_nranges = 0;
+    } /* end if */
+
+    if (HIwb_overlaps(file_rec, offset, bytes)) {
+        for (i = 0; i < file_rec->wb_nranges; i++) {
+            range = &file_rec->wb_ranges[i];
+            if (offset >= range->offset && offset + bytes <= range->offset + range->length) {
+                memcpy(file_rec->wb_data + range->pos + (offset - range->offset), buf, (size_t)bytes);
+                break;
+            } /* end if */
+        }     /* end for */
+        if (i < file_rec->wb_nranges)
+            HGOTO_DONE(SUCCEED);
+        if (HPflush_writes(file_rec) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    } /* end if */
+
+    range = (file_rec->wb_nranges > 0) ? &file_rec->wb_ranges[file_rec->wb_nranges - 1] : NULL;
+    if (range != NULL && range->offset + range->length == offset &&
+        file_rec->wb_used + bytes <= HDF_WRITE_BUF_SIZE)
+        range->length += bytes;
+    else {
+        if (file_rec->wb_used + bytes > HDF_WRITE_BUF_SIZE ||
+            file_rec->wb_nranges == HDF_WRITE_BUF_NRANGES)
+            if (HPflush_writes(file_rec) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        if (file_rec->wb_nranges == 0) {
+            file_rec->wb_lo = offset;
+            file_rec->wb_hi = offset + bytes;
+        } /* end if */
+        range         = &file_rec->wb_ranges[file_rec->wb_nranges++];
+        range->offset = offset;
+        range->length = bytes;
+        range->pos    = file_rec->wb_used;
+    } /* end else */
+    memcpy(file_rec->wb_data + file_rec->wb_used, buf, (size_t)bytes);
+    file_rec->wb_used += bytes;
+    file_rec->wb_lo = MIN(file_rec->wb_lo, offset);
+    file_rec->wb_hi = MAX(file_rec->wb_hi, offset + bytes);
+
+done:
+    if (ret_value != FAIL && file_rec->wb_data != NULL) {
+        file_rec->f_cur_off = offset + bytes;
+        file_rec->last_op   = H4_OP_UNKNOWN; /* the file itself wasn't moved */
+    }                                        /* end if */
+    return ret_value;
+} /* end HIwb_put() */
+
+/* compares two ranges of the write buffer by their offsets, for qsort */
+static int
+HIwb_range_cmp(const void *a, const void *b)
+{
+    const wbrange_t *ra = (const wbrange_t *)a;
+    const wbrange_t *rb = (const wbrange_t *)b;
+
+    return (ra->offset > rb->offset) - (ra->offset < rb->offset);
+} /* end HIwb_range_cmp() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HPflush_writes
+ PURPOSE
+    Write out the write buffer of a file.
+ USAGE
+    intn HPflush_writes(file_rec)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    The ranges in the buffer are written in order of their offsets, and
+    ranges which follow on from each other are gathered into a single
+    write.  The current offset of the file record is kept.
+ COMMENTS, BUGS, ASSUMPTIONS
+    Should only be called by HDF low-level routines
+--------------------------------------------------------------------------*/
+intn
+HPflush_writes(filerec_t *file_rec)
+{
+    wbrange_t *ranges  = file_rec->wb_ranges;
+    uint8     *gather  = file_rec->wb_data + HDF_WRITE_BUF_SIZE; /* second half of the buffer */
+    int32      cur_off = file_rec->f_cur_off;
+    intn       i, j;
+    intn       ret_value = SUCCEED;
+
+    if (file_rec->wb_nranges == 0)
+        HGOTO_DONE(SUCCEED);
+
+    qsort(ranges, (size_t)file_rec->wb_nranges, sizeof(wbrange_t), HIwb_range_cmp);
+    for (i = 0; i < file_rec->wb_nranges; i = j) {
+        const uint8 *data   = file_rec->wb_data + ranges[i].pos;
+        int32        length = ranges[i].length;
+
+        for (j = i + 1; j < file_rec->wb_nranges; j++)
+            if (ranges[j].offset != ranges[j - 1].offset + ranges[j - 1].length)
+                break;
+        if (j > i + 1) {
+            intn k;
+
+            for (k = i, length = 0; k < j; k++) {
+                memcpy(gather + length, file_rec->wb_data + ranges[k].pos, (size_t)ranges[k].length);
+                length += ranges[k].length;
+            } /* end for */
+            data = gather;
+        } /* end if */
+
+        if (HIseek(file_rec, ranges[i].offset) == FAIL || HIwrite(file_rec, data, length) == FAIL) {
+            HERROR(DFE_WRITEERROR);
+            ret_value = FAIL;
+            break;
+        } /* end if */
+    }     /* end for */
+
+    /* the buffer is emptied even after an error, which has been reported */
+    file_rec->wb_nranges = 0;
+    file_rec->wb_used    = 0;
+    file_rec->f_cur_off  = cur_off;
+    file_rec->last_op    = H4_OP_UNKNOWN;
+
+done:
+    return ret_value;
+} /* end HPflush_writes() */
 
 /*--------------------------------------------------------------------------
  NAME
@@ -3361,6 +4407,138 @@ done:
     return ret_value;
 } /* HPread_drec */
 
+/* an element of HPread_prefixes, in the order of its offset in the file */
+typedef struct {
+    int32 offset; /* offset of the element in the file */
+    intn  idx;    /* index of the element in the caller's list */
+} prefix_t;
+
+/* compares two elements of HPread_prefixes by their offsets, for qsort */
+static int
+HIprefix_cmp(const void *a, const void *b)
+{
+    const prefix_t *pa = (const prefix_t *)a;
+    const prefix_t *pb = (const prefix_t *)b;
+
+    return (pa->offset > pb->offset) - (pa->offset < pb->offset);
+} /* end HIprefix_cmp() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HPread_prefixes -- reads the first bytes of many elements of a tag
+ USAGE
+    intn HPread_prefixes(file_id, tag, n, refs, len, buf)
+    int32 file_id;          IN: id of file
+    uint16 tag;             IN: tag of the elements
+    intn n;                 IN: number of elements
+    const uint16 refs[];    IN: refs of the elements
+    int32 len;              IN: number of bytes to read from each element
+    uint8 *buf;             OUT: n * len bytes, the bytes of refs[i] at i * len
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    Reads the elements in the order of their offsets in the file.  Elements
+    at most HDF_PREFIX_READ_GAP bytes apart are read together, with one read
+    of up to HDF_PREFIX_READ_SIZE bytes, so that a table of small elements
+    written one after the other takes a few reads instead of one per element.
+    Special elements are read through an access record.  Fails if one of the
+    elements is shorter than len.
+--------------------------------------------------------------------------*/
+intn
+HPread_prefixes(int32 file_id, uint16 tag, intn n, const uint16 refs[], int32 len, uint8 *buf)
+{
+    filerec_t *file_rec;       /* file record pointer */
+    prefix_t  *elts    = NULL; /* plain elements to read, sorted by offset */
+    uint8     *span    = NULL; /* bytes of a run of elements */
+    int32      span_sz = 0;    /* size of the span buffer */
+    intn       nelts   = 0;    /* number of plain elements */
+    intn       i, j, k;
+    intn       ret_value = SUCCEED;
+
+    HEclear();
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec) || n < 0 || len <= 0 || (n > 0 && (refs == NULL || buf == NULL)))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (n == 0)
+        HGOTO_DONE(SUCCEED);
+
+    if ((elts = (prefix_t *)malloc((size_t)n * sizeof(prefix_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* locate the elements, reading the special ones right away */
+    for (i = 0; i < n; i++) {
+        atom_t ddid;
+        int32  off, length;
+        intn   special;
+
+        if ((ddid = HTPselect(file_rec, tag, refs[i])) == FAIL)
+            HGOTO_ERROR(DFE_NOMATCH, FAIL);
+        special = HTPis_special(ddid);
+        if (HTPinquire(ddid, NULL, NULL, &off, &length) == FAIL) {
+            HTPendaccess(ddid);
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        } /* end if */
+        if (HTPendaccess(ddid) == FAIL)
+            HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
+
+        if (special) {
+            int32 aid;
+
+            if ((aid = Hstartread(file_id, tag, refs[i])) == FAIL)
+                HGOTO_ERROR(DFE_BADAID, FAIL);
+            if (Hread(aid, len, buf + (size_t)i * (size_t)len) != len) {
+                Hendaccess(aid);
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            } /* end if */
+            if (Hendaccess(aid) == FAIL)
+                HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
+        }
+        else {
+            if (length < len)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            elts[nelts].offset = off;
+            elts[nelts].idx    = i;
+            nelts++;
+        } /* end else */
+    }     /* end for */
+
+    qsort(elts, (size_t)nelts, sizeof(prefix_t), HIprefix_cmp);
+
+    /* read the elements a run at a time */
+    for (i = 0; i < nelts; i = j) {
+        int32 start = elts[i].offset;
+        int32 end   = start + len;
+
+        for (j = i + 1; j < nelts; j++) {
+            if (elts[j].offset - end > HDF_PREFIX_READ_GAP ||
+                elts[j].offset + len - start > HDF_PREFIX_READ_SIZE)
+                break;
+            if (elts[j].offset + len > end)
+                end = elts[j].offset + len;
+        } /* end for */
+
+        if (end - start > span_sz) {
+            uint8 *tmp;
+
+            if ((tmp = (uint8 *)realloc(span, (size_t)(end - start))) == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            span    = tmp;
+            span_sz = end - start;
+        } /* end if */
+        if (HPseek(file_rec, start) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        if (HP_read(file_rec, span, end - start) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        for (k = i; k < j; k++)
+            memcpy(buf + (size_t)elts[k].idx * (size_t)len, span + (elts[k].offset - start), (size_t)len);
+    } /* end for */
+
+done:
+    free(elts);
+    free(span);
+    return ret_value;
+} /* HPread_prefixes */
+
 /*--------------------------------------------------------------------------
  NAME
     HDcheck_empty -- determines if an element has been written with data
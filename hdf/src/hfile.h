@@ -78,6 +78,7 @@ typedef FILE *hdf_file_t;
 #define HI_SEEK_CUR(f, o) (fseek((f), (long)(o), SEEK_CUR) == 0 ? SUCCEED : FAIL)
 #define HI_SEEKEND(f)     (fseek((f), (long)0, SEEK_END) == 0 ? SUCCEED : FAIL)
 #define HI_TELL(f)        (ftell(f))
+#define HI_FILENO(f)      (fileno(f))
 #define OPENERR(f)        ((f) == (FILE *)NULL)
 #endif /* FILELIB == UNIXBUFIO */
 
@@ -93,6 +94,7 @@ typedef int hdf_file_t;
 #define HI_SEEK(f, o)     (lseek((f), (off_t)(o), SEEK_SET) != (-1) ? SUCCEED : FAIL)
 #define HI_SEEKEND(f)     (lseek((f), (off_t)0, SEEK_END) != (-1) ? SUCCEED : FAIL)
 #define HI_TELL(f)        (lseek((f), (off_t)0, SEEK_CUR))
+#define HI_FILENO(f)      (f)
 #define OPENERR(f)        (f < 0)
 #endif /* FILELIB == UNIXUNBUFIO */
 
@@ -228,6 +230,23 @@ typedef struct ddblock_t {
     struct dd_t      *ddlist;     /* pointer to array of dd's */
 } ddblock_t;
 
+/* record of a run of unused space in the file */
+typedef struct freeblock_t {
+    int32               offset; /* offset of the unused run */
+    int32               length; /* length of the unused run */
+    struct freeblock_t *next;   /* next run in the same free list */
+} freeblock_t;
+
+/* number of free lists, one for each power of two up to the largest int32 */
+#define FREE_NLISTS 31
+
+/* range of the file written into the write buffer */
+typedef struct wbrange_t {
+    int32 offset; /* offset of the range in the file */
+    int32 length; /* length of the range */
+    int32 pos;    /* position of its bytes in the write buffer */
+} wbrange_t;
+
 /* Tag tree node structure */
 typedef struct tag_info_str {
     uint16 tag; /* tag value for this node */
@@ -272,8 +291,32 @@ typedef struct filerec_t {
     struct ddblock_t *ddnull;     /* location of last ddblock with a DFTAG_NULL */
     int32             ddnull_idx; /* offset of the last location with DFTAG_NULL */
 
+    /* free space pointers (for re-using space released by deleted elements) */
+    struct freeblock_t *free_list[FREE_NLISTS]; /* unused runs, by floor(log2) of their length */
+    intn                free_built;             /* boolean: whether free_list reflects the DD list */
+    int32               free_pending;           /* bytes released since free_list was built */
+
+    /* write buffer (collects small writes, written out in offset order) */
+    uint8     *wb_data;    /* bytes written into the buffer, NULL until used */
+    int32      wb_used;    /* number of bytes used in wb_data */
+    wbrange_t *wb_ranges;  /* ranges of the file the bytes belong to */
+    intn       wb_nranges; /* number of ranges */
+    int32      wb_lo;      /* lowest offset of the ranges */
+    int32      wb_hi;      /* end of the highest range */
+
+    /* memory image (for files opened with Hopen_image) */
+    const uint8 *image;      /* contents of the file, NULL if the file is on disk */
+    uint8       *image_buf;  /* the same buffer when it belongs to the library (and can grow), else NULL */
+    int32        image_len;  /* length of the file */
+    int32        image_size; /* size of the image buffer */
+
+    /* file system preallocation (see Hpreallocate) */
+    int32 prealloc;     /* size of the extents reserved ahead, 0 if off */
+    int32 prealloc_end; /* end of the space reserved so far */
+
     /* tag tree for file */
     TBBT_TREE *tag_tree; /* TBBT of the tags in the file */
+    bv_ptr     ref_used; /* refs used by any tag, built once maxref reaches MAX_REF */
 
     /* annotation stuff for file */
     intn       an_num[4];  /* Holds number of annotations found of each type */
@@ -298,6 +341,7 @@ typedef struct accrec_t {
     intn               new_elem;     /* is a new element (i.e. no length set yet) */
     int32              block_size;   /* size of the blocks for linked-block element*/
     int32              num_blocks;   /* number blocks in the linked-block element */
+    intn               block_set;    /* whether block_size was set with HLsetblockinfo */
     uint32             access;       /* access codes */
     uintn              access_type;  /* I/O access type: serial/parallel/... */
     int32              file_id;      /* id of attached file */
@@ -455,12 +499,27 @@ HDFLIBAPI intn HPseek(filerec_t *file_rec, int32 offset);
 
 HDFLIBAPI intn HP_write(filerec_t *file_rec, const void *buf, int32 bytes);
 
+HDFLIBAPI intn HPflush_writes(filerec_t *file_rec);
+
 HDFLIBAPI int32 HPread_drec(int32 file_id, atom_t data_id, uint8 **drec_buf);
 
+HDFLIBAPI intn HPread_prefixes(int32 file_id, uint16 tag, intn n, const uint16 refs[], int32 len,
+                               uint8 *buf);
+
 HDFLIBAPI intn tagcompare(void *k1, void *k2, intn cmparg);
 
 HDFLIBAPI void tagdestroynode(void *n);
 
+/*
+ ** from hdfalloc.c
+ */
+HDFLIBAPI hdf_attr_t *HDattrs_alloc(intn nattrs, size_t space, uint8 **next);
+
+HDFLIBAPI size_t HDattr_space(size_t namelen, size_t valsize);
+
+HDFLIBAPI void *HDattr_place(hdf_attr_t *attr, uint8 **next, const char *name, size_t namelen, int32 nt,
+                             int32 count, size_t valsize);
+
 /*
  ** from hblocks.c
  */
@@ -507,6 +566,8 @@ HDFLIBAPI int32 HXPinfo(accrec_t *access_rec, sp_info_block_t *info_block);
 
 HDFLIBAPI int32 HXPreset(accrec_t *access_rec, sp_info_block_t *info_block);
 
+HDFLIBAPI void HXPclosefile(filerec_t *file_rec);
+
 HDFLIBAPI intn HXPsetaccesstype(accrec_t *access_rec);
 
 HDFLIBAPI intn HXPshutdown(void);
@@ -106,6 +106,12 @@ static intn HTIregister_tag_ref(filerec_t *file_rec, dd_t *dd);
 
 static intn HTIunregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr);
 
+/* Gather the refs used by any tag in a file */
+static bv_ptr HTIbuild_ref_used(filerec_t *file_rec);
+
+/* Check whether any tag in a file uses a ref */
+static intn HTIref_in_use(filerec_t *file_rec, uint16 ref);
+
 /* Local definitions */
 /* The initial size of a ref dynarray */
 #define REF_DYNARRAY_START 64
@@ -171,6 +177,7 @@ HTPstart(filerec_t *file_rec /* IN:  File record to store info in */
 
     /* Initialize the tag tree */
     file_rec->tag_tree = tbbtdmake(tagcompare, sizeof(uint16), TBBT_FAST_UINT16_COMPARE);
+    file_rec->ref_used = NULL;
 
     /* Initialize the DD atom group (trying 256 hash currently, feel free to change */
     if (HAinit_group(DDGROUP, 256) == FAIL)
@@ -385,6 +392,7 @@ HTPinit(filerec_t *file_rec, /* IN: File record to store info in */
 
     /* Initialize the tag tree */
     file_rec->tag_tree = tbbtdmake(tagcompare, sizeof(uint16), TBBT_FAST_UINT16_COMPARE);
+    file_rec->ref_used = NULL;
 
     /* Initialize the DD atom group (trying 256 hash currently, feel free to change */
     if (HAinit_group(DDGROUP, 256) == FAIL)
@@ -504,6 +512,10 @@ HTPend(filerec_t *file_rec /* IN:  File record to store info in */
 
     /* Chuck the tag info tree too */
     tbbtdfree(file_rec->tag_tree, tagdestroynode, NULL);
+    if (file_rec->ref_used != NULL) {
+        bv_delete(file_rec->ref_used);
+        file_rec->ref_used = NULL;
+    }
 
     /* Shutdown the DD atom group */
     if (HAdestroy_group(DDGROUP) == FAIL)
@@ -729,6 +741,11 @@ HTPupdate(atom_t ddid,    /* IN: DD id to update */
     if ((dd_ptr = HAatom_object(ddid)) == NULL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
+    /* Release the space of the old data when the element is moved */
+    if (new_off != dont_change && new_off != dd_ptr->offset)
+        if (HPfreediskblock(dd_ptr->blk->frec, dd_ptr->offset, dd_ptr->length) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
     /* Update the tag/ref in memory */
     if (new_len != dont_change)
         dd_ptr->length = new_len;
@@ -938,9 +955,8 @@ uint16
 Hnewref(int32 file_id /* IN: File ID the tag/refs are in */)
 {
     filerec_t *file_rec; /* file record */
-    uint16     ref;      /* the new ref */
+    int32      ref;      /* the new ref */
     uint16     ret_value = DFREF_NONE;
-    uint32     i_ref; /* index for FOR loop */
 
     /* clear error stack and check validity of file record id */
     HEclear();
@@ -953,17 +969,16 @@ Hnewref(int32 file_id /* IN: File ID the tag/refs are in */)
     if (file_rec->maxref < MAX_REF)
         ret_value = ++(file_rec->maxref);
     else { /* otherwise, search for an empty ref */
-        /* incredibly slow but unlikely situation */
-        /* This could possibly get replaced with some sort of bit-vector manipulation -QAK */
-        for (i_ref = 1; i_ref <= (uint32)MAX_REF; i_ref++) {
-            dd_t *dd_ptr = NULL;
-            ref          = (uint16)i_ref;
-            if (HTIfind_dd(file_rec, (uint16)DFTAG_WILDCARD, ref, &dd_ptr, DF_FORWARD) == FAIL) {
-                ret_value = ref; /* set return value to ref found */
-                break;           /* break out of loop */
-            }                    /* end if */
-        }                        /* end for */
-    }                            /* end else */
+        /* the refs used by all the tags are gathered once, then kept up to date */
+        if (file_rec->ref_used == NULL)
+            if ((file_rec->ref_used = HTIbuild_ref_used(file_rec)) == NULL)
+                HGOTO_ERROR(DFE_BVNEW, 0);
+
+        if ((ref = bv_find_next_zero(file_rec->ref_used)) == FAIL)
+            HGOTO_ERROR(DFE_BVFIND, 0);
+        if (ref <= MAX_REF)
+            ret_value = (uint16)ref;
+    } /* end else */
 
 done:
     return ret_value;
@@ -1170,10 +1185,7 @@ HDreuse_tagref(int32  file_id, /* IN: id of file */
     if ((ddid = HTPselect(file_rec, tag, ref)) == FAIL)
         HGOTO_ERROR(DFE_NOMATCH, FAIL);
 
-    /* could reuse space in file by calling HPfreediskblock() routine
-       but it does nothing for now. For later. */
-    /* if (HPfreediskblock(file_rec,dd_ptr->offset,dd_ptr->length) == FAIL)
-        HGOTO_ERROR(DFE_INTERNAL, FAIL); */
+    /* the space of the old data is released by HTPupdate() below */
 
     /* reuse the dd by setting the offset and length to
        INVALID_OFFSET and INVALID_LENGTH*/
@@ -1412,8 +1424,9 @@ HTInew_dd_block(filerec_t *file_rec)
     list[0].blk    = block;
     HDmemfill(&list[1], &list[0], sizeof(dd_t), (uint32)ndds - 1);
 
-    if (file_rec->cache != 0) { /* if we are caching, wait to update previous DD block */
-        uint8 *tbuf;            /* temporary buffer */
+    /* write out the NIL tags, the block may be in space released by other elements */
+    {
+        uint8 *tbuf; /* temporary buffer */
 
         tbuf = (uint8 *)malloc(ndds * DD_SZ);
         if (tbuf == (uint8 *)NULL)
@@ -1453,8 +1466,9 @@ HTInew_dd_block(filerec_t *file_rec)
     /* update file record */
     file_rec->ddlast = block;
 
-    /* set the end of the file to the end of the current DD block */
-    file_rec->f_end_off = block->myoffset + (NDDS_SZ + OFFSET_SZ) + (block->ndds * DD_SZ);
+    /* extend the end of the file to the end of the current DD block */
+    if (file_rec->f_end_off < block->myoffset + (NDDS_SZ + OFFSET_SZ) + (block->ndds * DD_SZ))
+        file_rec->f_end_off = block->myoffset + (NDDS_SZ + OFFSET_SZ) + (block->ndds * DD_SZ);
 
 done:
     return ret_value;
@@ -1933,6 +1947,9 @@ HTIregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr)
     /* Set the bit in the bit-vector */
     if (bv_set(tinfo_ptr->b, (intn)dd_ptr->ref, BV_TRUE) == FAIL)
         HGOTO_ERROR(DFE_BVSET, FAIL);
+    if (file_rec->ref_used != NULL)
+        if (bv_set(file_rec->ref_used, (intn)dd_ptr->ref, BV_TRUE) == FAIL)
+            HGOTO_ERROR(DFE_BVSET, FAIL);
 
     /* Insert the DD info into the dynarray for later use */
     if (DAset_elem(tinfo_ptr->d, (intn)dd_ptr->ref, (void *)dd_ptr) == FAIL)
@@ -1985,6 +2002,11 @@ HTIunregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr)
         if (bv_set(tinfo_ptr->b, (intn)dd_ptr->ref, BV_FALSE) == FAIL)
             HGOTO_ERROR(DFE_BVSET, FAIL);
 
+        /* The ref is free in the file only if no other tag uses it */
+        if (file_rec->ref_used != NULL && !HTIref_in_use(file_rec, dd_ptr->ref))
+            if (bv_set(file_rec->ref_used, (intn)dd_ptr->ref, BV_FALSE) == FAIL)
+                HGOTO_ERROR(DFE_BVSET, FAIL);
+
         /* Delete the DD info from the tag tree */
         if (DAdel_elem(tinfo_ptr->d, (intn)dd_ptr->ref) == NULL)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
@@ -1997,6 +2019,88 @@ done:
     return ret_value;
 } /* HTIunregister_tag_ref */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HTIbuild_ref_used -- gather the refs used by any tag in a file
+ USAGE
+    bv_ptr HTIbuild_ref_used(file_rec)
+        filerec_t  * file_rec;        IN: file record
+ RETURNS
+    returns a bit-vector of the refs used on success, NULL on failure
+ DESCRIPTION
+    Combines the bit-vectors of all the tags in the tag tree, so that
+    Hnewref can find a free ref without searching the DDs for each ref.
+
+--------------------------------------------------------------------------*/
+static bv_ptr
+HTIbuild_ref_used(filerec_t *file_rec)
+{
+    bv_ptr ref_used; /* the refs used by any tag */
+    void **t;        /* the current node of the tag tree */
+    bv_ptr ret_value = NULL;
+
+    if ((ref_used = bv_new(MAX_REF + 1)) == NULL)
+        HGOTO_ERROR(DFE_BVNEW, NULL);
+    /* ref # zero cannot be stored in HDF files */
+    if (bv_set(ref_used, 0, BV_TRUE) == FAIL)
+        HGOTO_ERROR(DFE_BVSET, NULL);
+
+    if (NULL != (t = (void **)tbbtfirst((TBBT_NODE *)*(file_rec->tag_tree)))) {
+        do {
+            tag_info *tinfo_ptr = (tag_info *)*t; /* pointer to the info for a tag */
+            int32     size;                       /* # of bits in the tag's bit-vector */
+            int32     i;                          /* local counting variable */
+
+            if ((size = bv_size(tinfo_ptr->b)) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, NULL);
+            if (size > MAX_REF + 1)
+                size = MAX_REF + 1;
+            for (i = 1; i < size; i++)
+                if (bv_get(tinfo_ptr->b, i) == BV_TRUE)
+                    if (bv_set(ref_used, i, BV_TRUE) == FAIL)
+                        HGOTO_ERROR(DFE_BVSET, NULL);
+        } while (NULL != (t = (void **)tbbtnext((TBBT_NODE *)t)));
+    } /* end if */
+
+    ret_value = ref_used;
+
+done:
+    if (ret_value == NULL && ref_used != NULL)
+        bv_delete(ref_used);
+
+    return ret_value;
+} /* HTIbuild_ref_used */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTIref_in_use -- check whether any tag in a file uses a ref
+ USAGE
+    intn HTIref_in_use(file_rec, ref)
+        filerec_t  * file_rec;        IN: file record
+        uint16 ref;                   IN: ref # to check
+ RETURNS
+    returns TRUE if some tag uses the ref, FALSE otherwise
+ DESCRIPTION
+    Checks the bit-vector of each tag in the tag tree for the ref.
+
+--------------------------------------------------------------------------*/
+static intn
+HTIref_in_use(filerec_t *file_rec, uint16 ref)
+{
+    void **t; /* the current node of the tag tree */
+
+    if (NULL != (t = (void **)tbbtfirst((TBBT_NODE *)*(file_rec->tag_tree)))) {
+        do {
+            tag_info *tinfo_ptr = (tag_info *)*t; /* pointer to the info for a tag */
+
+            if (bv_get(tinfo_ptr->b, (intn)ref) == BV_TRUE)
+                return TRUE;
+        } while (NULL != (t = (void **)tbbtnext((TBBT_NODE *)t)));
+    } /* end if */
+
+    return FALSE;
+} /* HTIref_in_use */
+
 /* ---------------------------- tagcompare ------------------------- */
 /*
    Compares two tag B-tree keys for equality.  Similar to memcmp.
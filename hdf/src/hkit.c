@@ -151,7 +151,11 @@ HDflush(int32 file_id)
     if (BADFREC(file_rec))
         HRETURN_ERROR(DFE_ARGS, FAIL);
 
-    HI_FLUSH(file_rec->file);
+    if (file_rec->image == NULL) {
+        if (HPflush_writes(file_rec) == FAIL)
+            HRETURN_ERROR(DFE_WRITEERROR, FAIL);
+        HI_FLUSH(file_rec->file);
+    } /* end if */
 
     return SUCCEED;
 } /* HDflush */
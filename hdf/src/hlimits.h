@@ -96,6 +96,14 @@
 #define MAX_PATH_LEN 1024
 #endif /* MAX_PATH_LEN */
 
+/* Maximum number of external files kept open at once (used in hextelt.c) */
+#ifndef MAX_EXT_FILE
+#define MAX_EXT_FILE 32
+#endif /* MAX_EXT_FILE */
+
+/* Largest offset or length in a file, DDs store them as signed 32-bit values */
+#define MAX_FILE_OFFSET ((int32)0x7fffffff)
+
 /* ndds (number of dd's in a block) default,
    so user need not specify */
 #ifndef DEF_NDDS
@@ -115,6 +123,24 @@
 /* variable-length blocks */
 #define HDF_APPENDABLE_BLOCK_LEN 4096
 #define HDF_APPENDABLE_BLOCK_NUM 16
+/* largest block length the default is grown to for elements that have */
+/* already grown large while appendable */
+#define HDF_APPENDABLE_BLOCK_MAX 1048576
+
+/* size of the buffer collecting small writes to a file until they are */
+/* written out together, and the largest write put in it */
+#ifndef HDF_WRITE_BUF_SIZE
+#define HDF_WRITE_BUF_SIZE 65536
+#endif /* HDF_WRITE_BUF_SIZE */
+#define HDF_WRITE_BUF_MAX_WRITE (HDF_WRITE_BUF_SIZE / 16)
+/* number of separate ranges of the file the buffer can hold */
+#define HDF_WRITE_BUF_NRANGES 512
+
+/* reading the first bytes of many small elements at once (HPread_prefixes): */
+/* elements at most this many bytes apart are read together, in reads of at */
+/* most HDF_PREFIX_READ_SIZE bytes */
+#define HDF_PREFIX_READ_GAP  4096
+#define HDF_PREFIX_READ_SIZE 65536
 
 /* hashing information */
 #define HASH_MASK       0xff
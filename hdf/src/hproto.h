@@ -55,8 +55,12 @@ extern "C" {
  */
 HDFLIBAPI int32 Hopen(const char *path, intn acc_mode, int16 ndds);
 
+HDFLIBAPI int32 Hopen_image(const void *image, int32 size, intn acc_mode, int16 ndds);
+
 HDFLIBAPI intn Hclose(int32 file_id);
 
+HDFLIBAPI int32 Hget_image(int32 file_id, void *buf, int32 size);
+
 HDFLIBAPI int32 Hstartread(int32 file_id, uint16 tag, uint16 ref);
 
 HDFLIBAPI intn Hnextread(int32 access_id, uint16 tag, uint16 ref, intn origin);
@@ -106,6 +110,8 @@ HDFLIBAPI intn Hsync(int32 file_id);
 
 HDFLIBAPI intn Hcache(int32 file_id, intn cache_on);
 
+HDFLIBAPI intn Hpreallocate(int32 file_id, int32 extent);
+
 HDFLIBAPI intn Hgetlibversion(uint32 *majorv, uint32 *minorv, uint32 *releasev, char *string);
 
 HDFLIBAPI intn Hgetfileversion(int32 file_id, uint32 *majorv, uint32 *minorv, uint32 *release, char *string);
@@ -436,6 +442,8 @@ HDFLIBAPI intn Hbitwrite(int32 bitid, intn count, uint32 data);
 
 HDFLIBAPI intn Hbitread(int32 bitid, intn count, uint32 *data);
 
+HDFLIBAPI int32 Hbitread_n(int32 bitid, intn count, int32 nitems, uint32 *data);
+
 HDFLIBAPI intn Hbitseek(int32 bitid, int32 byte_offset, intn bit_offset);
 
 HDFLIBAPI intn Hgetbit(int32 bitid);
@@ -911,6 +919,8 @@ HDFLIBAPI intn GRattrinfo(int32 id, int32 idx, char *name, int32 *attr_nt, int32
 
 HDFLIBAPI intn GRgetattr(int32 id, int32 idx, void *data);
 
+HDFLIBAPI intn GRgetattrs(int32 id, hdf_attr_t **attrs);
+
 HDFLIBAPI int32 GRfindattr(int32 id, const char *name);
 
 HDFLIBAPI intn GRgetcomptype(int32 riid, comp_coder_t *comp_type);
@@ -1276,6 +1286,7 @@ HDFLIBAPI intn Vattrinfo2 /* copy of Vattrinfo for old attributes */
     (int32 vgid, intn attrindex, char *name, int32 *datatype, int32 *count, int32 *size, int32 *nfields,
      uint16 *refnum);
 HDFLIBAPI intn Vgetattr(int32 vgid, intn attrindex, void *values);
+HDFLIBAPI intn Vgetattrs(int32 vgid, hdf_attr_t **attrs);
 HDFLIBAPI intn Vgetattr2 /* copy of Vgetattr for old attributes */
     (int32 vgid, intn attrindex, void *values);
 HDFLIBAPI int32 Vgetversion(int32 vgid);
@@ -1288,6 +1299,7 @@ HDFLIBAPI intn  VSfindattr(int32 vsid, int32 findex, const char *attrname);
 HDFLIBAPI intn VSattrinfo(int32 vsid, int32 findex, intn attrindex, char *name, int32 *datatype, int32 *count,
                           int32 *size);
 HDFLIBAPI intn VSgetattr(int32 vsid, int32 findex, intn attrindex, void *values);
+HDFLIBAPI intn VSgetattrs(int32 vsid, int32 findex, hdf_attr_t **attrs);
 HDFLIBAPI intn VSisattr(int32 vsid);
 /*
  ** from vconv.c
@@ -1402,6 +1414,8 @@ HDFLIBAPI int32 VQuerytag(int32 vkey);
 
 HDFLIBAPI int32 Vaddtagref(int32 vkey, int32 tag, int32 ref);
 
+HDFLIBAPI int32 Vaddtagrefs(int32 vkey, int32 n, const int32 tags[], const int32 refs[]);
+
 HDFLIBAPI int32 Ventries(HFILEID f, int32 vgid);
 
 HDFLIBAPI int32 Vsetname(int32 vkey, const char *vgname);
@@ -44,6 +44,7 @@
  *                  (used in annotation TBBTtree)
  *  ANIaddentry:  - add entry to corresponding annotation TBBTtree
  *  ANIcreate_ann_tree - create annotation TBBTtree
+ *  ANIread_elems - read the data tag/refs of the entries of a TBBTtree
  *  ANIfind:      - return annotation handle(ann_id) if found of given TYPE/ref
  *  ANInumann:    - return number of annotations that match TYPE/tag/ref
  *  ANIannlist:   - return list of handles(ann_id's) that match TYPE/tag/ref
@@ -419,15 +420,13 @@ ANIcreate_ann_tree(int32    an_id,/* IN: annotation interface id */
                                          AN_FILE_DESC for file descriptions.*/)
 {
     filerec_t *file_rec = NULL; /* file record pointer */
-    uint8      datadi[4];
-    int32      more_anns;
-    int32      aid = FAIL;
     int32      nanns;
     int32      i;
-    int32     *ann_key = NULL;
+    int32     *ann_key  = NULL;
     uint16     ann_tag;
-    uint16     ann_ref;
-    uint8     *dptr      = NULL;
+    uint16     ann_ref  = 0;
+    uint16     find_tag = 0;
+    int32      find_off, find_len;
     ANentry   *ann_entry = NULL;
     ANnode    *ann_node  = NULL;
     intn       ret_value = SUCCEED;
@@ -477,33 +476,17 @@ ANIcreate_ann_tree(int32    an_id,/* IN: annotation interface id */
         goto done; /* we are done */
     }
 
-    /* start read on 'type' annotations  in file
-     * note that so far an_id == file_id */
-    if ((aid = Hstartread(an_id, ann_tag, DFREF_WILDCARD)) == FAIL) {
-        HE_REPORT_GOTO("Hstartread failed to read annotation", FAIL);
-    }
-    else
-        more_anns = SUCCEED;
-
-    /* Process annotations of 'type' in file */
-    for (i = 0; (i < nanns) && (more_anns != FAIL); i++) { /* see if annotation is there */
-        if (FAIL == Hinquire(aid, (int32 *)NULL, (uint16 *)NULL, &ann_ref, (int32 *)NULL, (int32 *)NULL,
-                             (int32 *)NULL, (int16 *)NULL,
-                             (int16 *)NULL)) { /* record what we found so far and return */
-            file_rec->an_num[type] = nanns;
+    /* Walk the DD list for the annotations of 'type'; the tag/ref of the
+     * element a data annotation belongs to is only read when first needed,
+     * by ANIread_elems */
+    for (i = 0; i < nanns; i++) {
+        if (Hfind(an_id, ann_tag, DFREF_WILDCARD, &find_tag, &ann_ref, &find_off, &find_len, DF_FORWARD) ==
+            FAIL) { /* record what we found so far and return */
+            file_rec->an_num[type] = i;
             ret_value              = FAIL;
             goto done; /* we are done */
         }
 
-        /* if data annotation, read data annotation tag/ref */
-        if (type != AN_FILE_LABEL && type != AN_FILE_DESC) {
-            if ((int32)FAIL == Hread(aid, (int32)4, datadi)) { /* record what we found so far and return */
-                file_rec->an_num[type] = nanns;
-                ret_value              = FAIL;
-                goto done; /* we are done */
-            }
-        }
-
         /* allocate space for key */
         if ((ann_key = (int32 *)malloc(sizeof(int32))) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
@@ -523,7 +506,6 @@ ANIcreate_ann_tree(int32    an_id,/* IN: annotation interface id */
         ann_node->new_ann = 0; /* not a newly created annotation */
 
         /* Initialize annotation entry for insertion into corresponding TBBT */
-        /* and  decode data tag/ref */
         if ((ann_entry = malloc(sizeof(ANentry))) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
@@ -533,11 +515,10 @@ ANIcreate_ann_tree(int32    an_id,/* IN: annotation interface id */
         if (FAIL == ann_entry->ann_id)
             HE_REPORT_GOTO("failed to insert annotation into ann_id Group", FAIL);
 
-        /* Check if data annotation to decode data tag/ref */
+        /* Data annotations: element tag/ref not read yet */
         if (type != AN_FILE_LABEL && type != AN_FILE_DESC) {
-            dptr = (uint8 *)&(datadi[0]);
-            UINT16DECODE(dptr, ann_entry->elmtag);
-            UINT16DECODE(dptr, ann_entry->elmref);
+            ann_entry->elmtag = AN_ELEM_UNREAD;
+            ann_entry->elmref = 0;
         }
         else {
             ann_entry->elmtag = ann_tag;
@@ -547,16 +528,10 @@ ANIcreate_ann_tree(int32    an_id,/* IN: annotation interface id */
         /* Add annotation entry to 'type' tree */
         if (tbbtdins(file_rec->an_tree[type], ann_entry, ann_key) == NULL)
             HE_REPORT_GOTO("failed to insert annotation into 'type' tree", FAIL);
-
-        /* set read on next annotation */
-        more_anns = Hnextread(aid, ann_tag, DFREF_WILDCARD, DF_CURRENT);
-    } /* end for "more_anns" */
-
-    /* Finish access*/
-    if (FAIL != aid) {
-        if (FAIL == Hendaccess(aid))
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-    }
+        ann_key   = NULL;
+        ann_entry = NULL;
+        ann_node  = NULL;
+    } /* end for */
 
     /* set return value */
     ret_value = file_rec->an_num[type] = nanns;
@@ -566,13 +541,84 @@ done:
         free(ann_key);
         free(ann_entry);
         free(ann_node);
-        if (FAIL != aid)
-            Hendaccess(aid);
     }
 
     return ret_value;
 } /* ANIcreate_ann_tree */
 
+/*--------------------------------------------------------------------------
+ NAME
+   ANIread_elems -- read the element tag/refs of the data annotations of 'type'
+
+ DESCRIPTION
+   Reads the tag/ref of the element each data annotation of 'type' belongs
+   to, for the entries of the annotation tree that do not have it yet.  The
+   4-byte prefixes of all the annotations are read in one pass over the file
+   with HPread_prefixes.  Nothing is read for file labels/descriptions.
+
+ RETURNS
+   SUCCEED (0) if successful and FAIL (-1) otherwise
+
+ -------------------------------------------------------------------------*/
+static intn
+ANIread_elems(int32    an_id, /* IN: annotation interface id */
+              ann_type type   /* IN: AN_DATA_LABEL or AN_DATA_DESC */)
+{
+    filerec_t *file_rec = NULL; /* file record pointer */
+    TBBT_NODE *entry    = NULL;
+    ANentry  **pending  = NULL; /* entries without their element tag/ref */
+    uint16    *refs     = NULL; /* annotation refs of the pending entries */
+    uint8     *prefixes = NULL; /* element tag/ref of each pending entry */
+    uint8     *dptr     = NULL;
+    intn       npending = 0;
+    intn       i;
+    intn       ret_value = SUCCEED;
+
+    /* convert an_id i.e. file_id to file rec and check for validity */
+    file_rec = HAatom_object(an_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((type != AN_DATA_LABEL && type != AN_DATA_DESC) || file_rec->an_num[type] <= 0)
+        HGOTO_DONE(SUCCEED);
+
+    if ((pending = (ANentry **)malloc((size_t)file_rec->an_num[type] * sizeof(ANentry *))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (entry = tbbtfirst((TBBT_NODE *)*(file_rec->an_tree[type])); entry != NULL; entry = tbbtnext(entry)) {
+        ANentry *ann_entry = (ANentry *)entry->data;
+
+        if (ann_entry->elmtag == AN_ELEM_UNREAD && npending < file_rec->an_num[type])
+            pending[npending++] = ann_entry;
+    }
+    if (npending == 0)
+        HGOTO_DONE(SUCCEED);
+
+    if ((refs = (uint16 *)malloc((size_t)npending * sizeof(uint16))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((prefixes = (uint8 *)malloc((size_t)npending * 4)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < npending; i++)
+        refs[i] = pending[i]->annref;
+
+    if (HPread_prefixes(an_id, type == AN_DATA_LABEL ? DFTAG_DIL : DFTAG_DIA, npending, refs, 4, prefixes) ==
+        FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    /* decode data tag/ref */
+    dptr = prefixes;
+    for (i = 0; i < npending; i++) {
+        UINT16DECODE(dptr, pending[i]->elmtag);
+        UINT16DECODE(dptr, pending[i]->elmref);
+    }
+
+done:
+    free(pending);
+    free(refs);
+    free(prefixes);
+
+    return ret_value;
+} /* ANIread_elems */
+
 #if NOT_USED_YET
 /*--------------------------------------------------------------------------
  NAME
@@ -685,6 +731,8 @@ ANInumann(int32    an_id,  /* IN: annotation interface id */
         if (ANIcreate_ann_tree(an_id, type) == FAIL)
             HGOTO_ERROR(DFE_BADCALL, FAIL);
     }
+    if (ANIread_elems(an_id, type) == FAIL)
+        HGOTO_ERROR(DFE_BADCALL, FAIL);
 
     /* Traverse the list looking for a match */
     for (entry = tbbtfirst((TBBT_NODE *)*(file_rec->an_tree[type])); entry != NULL; entry = tbbtnext(entry)) {
@@ -746,6 +794,8 @@ ANIannlist(int32    an_id,  /* IN: annotation interface id */
         if (ANIcreate_ann_tree(an_id, type) == FAIL)
             HGOTO_ERROR(DFE_BADCALL, FAIL);
     }
+    if (ANIread_elems(an_id, type) == FAIL)
+        HGOTO_ERROR(DFE_BADCALL, FAIL);
 
     /* Traverse the list looking for a match */
     for (entry = tbbtfirst((TBBT_NODE *)*(file_rec->an_tree[type])); entry != NULL; entry = tbbtnext(entry)) {
@@ -1051,6 +1101,8 @@ ANIwriteann(int32       ann_id, /* IN: annotation id */
         HE_REPORT_GOTO("failed to retrieve annotation of 'type' tree", FAIL);
 
     ann_entry = (ANentry *)entry->data;
+    if (ann_entry->elmtag == AN_ELEM_UNREAD && ANIread_elems(file_id, (ann_type)type) == FAIL)
+        HGOTO_ERROR(DFE_BADCALL, FAIL);
 
     elem_tag = ann_entry->elmtag;
     elem_ref = ann_entry->elmref;
@@ -76,6 +76,10 @@ typedef struct ANentry {
 /* Obtain Annotation type from key */
 #define AN_KEY2TYPE(k) ((int32)((int32)k >> 16))
 
+/* ANentry.elmtag of a data annotation whose element tag/ref has not been
+ * read from the file yet (see ANIread_elems) */
+#define AN_ELEM_UNREAD DFTAG_NULL
+
 #else /* !defined MFAN_MASTER && !defined MFAN_TESTER */
 /* WE are NOT in main ANNOTATION source file
  * Nothing EXPORTED except Public fcns */
@@ -164,6 +164,7 @@ MODIFICATION HISTORY
 #define MFGR_MASTER
 #include "hdf.h"
 #include "hlimits.h"
+#include "vgint.h"
 
 #ifdef H4_HAVE_LIBSZ /* we have the library */
 #include "szlib.h"
@@ -202,6 +203,8 @@ static intn GRIstart(void);
 
 static intn GRIgetaid(ri_info_t *img_ptr, intn acc_perm);
 
+static intn GRIread_image(ri_info_t *ri_ptr);
+
 static intn GRIisspecial_type(int32 file_id, uint16 tag, uint16 ref);
 
 #ifdef H4_HAVE_LIBSZ /* we have the library */
@@ -555,7 +558,8 @@ Decode_diminfo(uint8 *p, dim_info_t *dim_info)
       - Look for an RI Vgroup, then read in RIs & "global" attributes.
    o Eliminate duplicate images
    o Throw all the remaining RI8s, RIGs, and RIs into an internal table with
-      appropriate information about each of them
+      their tag/refs; the rest of the information about each of them is read
+      by GRIread_image when the image is first selected
  EXAMPLES
  REVISION LOG
 --------------------------------------------------------------------------*/
@@ -828,460 +832,480 @@ GRIget_image_list(int32 file_id, gr_info_t *gr_ptr)
             }                 /* end for */
     }                         /* end for go through the images looking for duplicates */
 
-    /* Ok, now sort through the file for information about each image found */
+    /* Make an entry for each image found.  Only what is known from the
+       search is filled in; the rest is read by GRIread_image when the image
+       is first selected */
     for (i = 0; i < curr_image; i++) {
-        if (img_info[i].img_tag != DFTAG_NULL) {
-            switch (img_info[i].grp_tag) {
-                case DFTAG_VG: /* New style raster image, found in a Vgroup */
-                {
-                    ri_info_t *new_image;                 /* ptr to the image to read in */
-                    int32      img_key;                   /* Vgroup key of an image */
-                    int32      img_tag, img_ref;          /* image tag/ref in the Vgroup */
-                    char       textbuf[VGNAMELENMAX + 1]; /* buffer to store the name in */
-                    uint8      ntstring[4];               /* buffer to store NT info */
-                    uint8      GRtbuf[64];                /* local buffer for reading RIG info */
-
-                    if ((img_key = Vattach(file_id, (int32)img_info[i].grp_ref, "r")) != FAIL) {
-                        uint16 name_len;
-                        if ((new_image = (ri_info_t *)malloc(sizeof(ri_info_t))) == NULL) {
-                            free(img_info); /* free offsets */
-                            Hclose(file_id);
-                            HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                        }
+        ri_info_t *new_image; /* ptr to the image to add */
 
-                        /* Initialize all the fields in the image structure to zeros */
-                        memset(new_image, 0, sizeof(ri_info_t));
+        if (img_info[i].img_tag == DFTAG_NULL)
+            continue; /* an image which was eliminated from the list of images */
 
-                        /* Get the name of the image */
-                        if (Vgetnamelen(img_key, &name_len) == FAIL)
-                            name_len = 20; /* for "Raster Image #%d" */
-                        if ((new_image->name = (char *)malloc(name_len + 1)) == NULL)
-                            HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                        if (Vgetname(img_key, new_image->name) == FAIL)
-                            sprintf(new_image->name, "Raster Image #%d", (int)i);
-
-                        /* Initialize the local attribute tree */
-                        new_image->lattr_count = 0;
-                        new_image->lattree = tbbtdmake(rigcompare, sizeof(int32), TBBT_FAST_INT32_COMPARE);
-                        if (new_image->lattree == NULL)
-                            HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                        new_image->ri_ref = img_info[i].grp_ref;
-                        if (img_info[i].aux_ref != 0)
-                            new_image->rig_ref = img_info[i].aux_ref;
-                        else
-                            new_image->rig_ref = DFREF_WILDCARD;
-
-                        for (j = 0; j < Vntagrefs(img_key); j++) {
-                            if (Vgettagref(img_key, j, &img_tag, &img_ref) == FAIL)
-                                continue;
-
-                            /* parse this tag/ref pair */
-                            switch (img_tag) {
-                                case DFTAG_RI: /* Regular image data */
-                                    new_image->img_tag = (uint16)img_tag;
-                                    new_image->img_ref = (uint16)img_ref;
-                                    if (SPECIALTAG(new_image->img_tag) == TRUE) {
-                                        new_image->use_buf_drvr = 1;
-                                    }
-                                    break;
-
-                                case DFTAG_CI: /* Compressed image data */
-                                    new_image->img_tag      = (uint16)img_tag;
-                                    new_image->img_ref      = (uint16)img_ref;
-                                    new_image->use_buf_drvr = 1;
-                                    new_image->use_cr_drvr  = 1;
-                                    break;
-
-                                case DFTAG_LUT: /* Palette */
-                                    new_image->lut_tag = (uint16)img_tag;
-                                    new_image->lut_ref = (uint16)img_ref;
+        if ((new_image = (ri_info_t *)calloc(1, sizeof(ri_info_t))) == NULL) {
+            free(img_info); /* free offsets */
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        }
+        new_image->info_pending = TRUE;
+        new_image->found_tag    = img_info[i].grp_tag;
+        new_image->found_index  = i;
+        new_image->img_tag      = img_info[i].img_tag;
+        new_image->img_ref      = img_info[i].img_ref;
+        switch (img_info[i].grp_tag) {
+            case DFTAG_VG: /* New style raster image, found in a Vgroup */
+                new_image->ri_ref  = img_info[i].grp_ref;
+                new_image->rig_ref = img_info[i].aux_ref != 0 ? img_info[i].aux_ref : DFREF_WILDCARD;
+                break;
 
-                                    /* Fill in some default palette dimension info, in case there isn't a
-                                     * DFTAG_LD for this palette */
-                                    if (new_image->lut_dim.dim_ref == 0)
-                                        Init_diminfo(&(new_image->lut_dim));
-                                    break;
+            case DFTAG_RIG: /* Older style raster image, found in RIG */
+                new_image->ri_ref  = DFREF_WILDCARD;
+                new_image->rig_ref = img_info[i].grp_ref;
+                break;
 
-                                case DFTAG_LD: /* Palette dimensions */
-                                {
-                                    uint8 *p = GRtbuf;
-                                    if (Hgetelement(file_id, (uint16)img_tag, (uint16)img_ref, GRtbuf) !=
-                                        FAIL)
-                                        Decode_diminfo(p, &(new_image->lut_dim));
-                                    else
-                                        HGOTO_ERROR(DFE_READERROR, FAIL);
-
-                                    /* read NT */
-                                    if (Hgetelement(file_id, new_image->lut_dim.nt_tag,
-                                                    new_image->lut_dim.nt_ref, ntstring) == FAIL)
-                                        HGOTO_ERROR(DFE_READERROR, FAIL);
-
-                                    /* check for any valid NT */
-                                    if (ntstring[1] == DFNT_NONE)
-                                        break;
-
-                                    /* set NT info */
-                                    new_image->lut_dim.dim_ref          = (uint16)img_ref;
-                                    new_image->lut_dim.nt               = (int32)ntstring[1];
-                                    new_image->lut_dim.file_nt_subclass = (int32)ntstring[3];
-                                    if ((new_image->lut_dim.file_nt_subclass != DFNTF_HDFDEFAULT) &&
-                                        (new_image->lut_dim.file_nt_subclass != DFNTF_PC) &&
-                                        (new_image->lut_dim.file_nt_subclass !=
-                                         DFKgetPNSC(new_image->lut_dim.nt, DF_MT)))
-                                        break; /* unknown subclass */
-                                    if (new_image->lut_dim.file_nt_subclass !=
-                                        DFNTF_HDFDEFAULT) { /* if native or little endian */
-                                        if (new_image->lut_dim.file_nt_subclass != DFNTF_PC) /* native */
-                                            new_image->lut_dim.nt |= DFNT_NATIVE;
-                                        else /* little endian */
-                                            new_image->lut_dim.nt |= DFNT_LITEND;
-                                    } /* end if */
-                                } break;
-
-                                case DFTAG_ID: /* Image description info */
-                                {
-                                    uint8 *p = GRtbuf;
-                                    if (Hgetelement(file_id, (uint16)img_tag, (uint16)img_ref, GRtbuf) !=
-                                        FAIL)
-                                        Decode_diminfo(p, &(new_image->img_dim));
-                                    else
-                                        HGOTO_ERROR(DFE_READERROR, FAIL);
-
-                                    /* read NT */
-                                    if (Hgetelement(file_id, new_image->img_dim.nt_tag,
-                                                    new_image->img_dim.nt_ref, ntstring) == FAIL)
-                                        HGOTO_ERROR(DFE_READERROR, FAIL);
-
-                                    /* check for any valid NT */
-                                    if (ntstring[1] == DFNT_NONE)
-                                        break;
-
-                                    /* set NT info */
-                                    new_image->img_dim.dim_ref          = (uint16)img_ref;
-                                    new_image->img_dim.nt               = (int32)ntstring[1];
-                                    new_image->img_dim.file_nt_subclass = (int32)ntstring[3];
-                                    if ((new_image->img_dim.file_nt_subclass != DFNTF_HDFDEFAULT) &&
-                                        (new_image->img_dim.file_nt_subclass != DFNTF_PC) &&
-                                        (new_image->img_dim.file_nt_subclass !=
-                                         DFKgetPNSC(new_image->img_dim.nt, DF_MT)))
-                                        break; /* unknown subclass */
-                                    if (new_image->img_dim.file_nt_subclass !=
-                                        DFNTF_HDFDEFAULT) { /* if native or little endian */
-                                        if (new_image->img_dim.file_nt_subclass != DFNTF_PC) /* native */
-                                            new_image->img_dim.nt |= DFNT_NATIVE;
-                                        else /* little endian */
-                                            new_image->img_dim.nt |= DFNT_LITEND;
-                                    } /* end if */
-                                    break;
-                                } /* end case DFTAG_ID */
+            default: /* Eldest style raster image, no grouping */
+                new_image->ri_ref  = DFREF_WILDCARD;
+                new_image->rig_ref = DFREF_WILDCARD;
+                break;
+        } /* end switch */
 
-                                case DFTAG_VH: /* Attribute information */
-                                {
-                                    at_info_t *new_attr; /* attr to add to the local attr set */
-                                    int32      at_key;   /* VData key for the attribute */
+        new_image->index  = gr_ptr->gr_count;
+        new_image->gr_ptr = gr_ptr;                /* point up the tree */
+        tbbtdins(gr_ptr->grtree, new_image, NULL); /* insert the new image into B-tree */
+        gr_ptr->gr_count++;
+    } /* end for */
 
-                                    if ((new_attr = (at_info_t *)malloc(sizeof(at_info_t))) == NULL)
-                                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                                    new_attr->ref           = (uint16)img_ref;
-                                    new_attr->index         = new_image->lattr_count;
-                                    new_attr->data_modified = FALSE;
-                                    new_attr->new_at        = FALSE;
-                                    new_attr->data          = NULL;
-                                    if ((at_key = VSattach(file_id, (int32)img_ref, "r")) != FAIL) {
-                                        char *fname;
-
-                                        /* Make certain the attribute only has one field */
-                                        if (VFnfields(at_key) != 1) {
-                                            VSdetach(at_key);
-                                            free(new_attr);
-                                            break;
-                                        }
-                                        new_attr->nt  = VFfieldtype(at_key, 0);
-                                        new_attr->len = VFfieldorder(at_key, 0);
-                                        if (new_attr->len == 1)
-                                            new_attr->len = VSelts(at_key);
-
-                                        /* Get the name of the attribute */
-                                        if ((fname = VFfieldname(at_key, 0)) == NULL) {
-                                            sprintf(textbuf, "Attribute #%d", (int)new_attr->index);
-                                            if ((new_attr->name = (char *)malloc(HDstrlen(textbuf) + 1)) ==
-                                                NULL) {
-                                                VSdetach(at_key);
-                                                free(new_attr);
-                                                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                                            }
-                                            HDstrcpy(new_attr->name, textbuf);
-                                        }
-                                        else {
-                                            if ((new_attr->name = (char *)malloc(HDstrlen(fname) + 1)) ==
-                                                NULL) {
-                                                VSdetach(at_key);
-                                                free(new_attr);
-                                                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                                            }
-                                            HDstrcpy(new_attr->name, fname);
-                                        }
-
-                                        tbbtdins(new_image->lattree, new_attr,
-                                                 NULL); /* insert the attr instance in B-tree */
+    free(img_info); /* free image info structures */
 
-                                        VSdetach(at_key);
-                                    } /* end if */
+done:
+    return ret_value;
+} /* end GRIget_image_list() */
 
-                                    new_image->lattr_count++;
+/*--------------------------------------------------------------------------
+ NAME
+    GRIread_image
+ PURPOSE
+    Read the information about an image found by GRIget_image_list
+ USAGE
+    intn GRIread_image(ri_ptr)
+        ri_info_t *ri_ptr;          IN: image to read the information of
+ RETURNS
+    Return SUCCEED/FAIL
+ DESCRIPTION
+    GRIget_image_list only finds the images in a file.  The name, dimensions,
+    number type, palette and local attributes of an image are read here, the
+    first time the image is selected or looked up by name.  Does nothing for
+    an image that has been read already or was created with GRcreate.
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+static intn
+GRIread_image(ri_info_t *ri_ptr)
+{
+    int32 file_id = ri_ptr->gr_ptr->hdf_file_id; /* file the image is in */
+    int32 img_key = FAIL;                        /* Vgroup key of a new style image */
+    char  textbuf[VGNAMELENMAX + 1];             /* buffer to store the name in */
+    uint8 ntstring[4];                           /* buffer to store NT info */
+    uint8 GRtbuf[64];                            /* local buffer for reading RIG info */
+    intn  j;                                     /* local counting variable */
+    intn  ret_value = SUCCEED;
 
-                                    break;
-                                } /* end case DFTAG_VH */
+    if (!ri_ptr->info_pending)
+        HGOTO_DONE(SUCCEED);
 
-                                default: /* Unknown tag */
-                                    break;
-                            } /* end switch */
-                        }     /* end for */
+    switch (ri_ptr->found_tag) {
+        case DFTAG_VG: /* New style raster image, found in a Vgroup */
+        {
+            int32 img_tag, img_ref; /* image tag/ref in the Vgroup */
 
-                        new_image->index  = gr_ptr->gr_count;
-                        new_image->gr_ptr = gr_ptr;                /* point up the tree */
-                        tbbtdins(gr_ptr->grtree, new_image, NULL); /* insert the new image into B-tree */
-                        gr_ptr->gr_count++;
-                        Vdetach(img_key);
-                    } /* end if */
-                }     /* end case DFTAG_VG */
-                break;
+            if ((img_key = Vattach(file_id, (int32)ri_ptr->ri_ref, "r")) != FAIL) {
+                uint16 name_len;
 
-                case DFTAG_RIG: /* Older style raster image, found in RIG */
-                {
-                    int32      GroupID;
-                    uint16     elt_tag, elt_ref;
-                    ri_info_t *new_image;                 /* ptr to the image to read in */
-                    char       textbuf[VGNAMELENMAX + 1]; /* buffer to store the name in */
-                    uint8      ntstring[4];               /* buffer to store NT info */
-                    uint8      GRtbuf[64];                /* local buffer for reading RIG info */
-
-                    /* read RIG into memory */
-                    if ((GroupID = DFdiread(file_id, DFTAG_RIG, img_info[i].grp_ref)) == FAIL)
-                        HGOTO_ERROR(DFE_READERROR, FAIL);
+                /* Get the name of the image */
+                if (Vgetnamelen(img_key, &name_len) == FAIL)
+                    name_len = 20; /* for "Raster Image #%d" */
+                if ((ri_ptr->name = (char *)malloc(name_len + 1)) == NULL)
+                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                if (Vgetname(img_key, ri_ptr->name) == FAIL)
+                    sprintf(ri_ptr->name, "Raster Image #%d", (int)ri_ptr->found_index);
 
-                    if ((new_image = (ri_info_t *)malloc(sizeof(ri_info_t))) == NULL) {
-                        free(img_info); /* free offsets */
-                        Hclose(file_id);
-                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                    }
+                /* Initialize the local attribute tree */
+                ri_ptr->lattr_count = 0;
+                ri_ptr->lattree = tbbtdmake(rigcompare, sizeof(int32), TBBT_FAST_INT32_COMPARE);
+                if (ri_ptr->lattree == NULL)
+                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-                    /* Initialize all the fields in the image structure to zeros */
-                    memset(new_image, 0, sizeof(ri_info_t));
+                for (j = 0; j < Vntagrefs(img_key); j++) {
+                    if (Vgettagref(img_key, j, &img_tag, &img_ref) == FAIL)
+                        continue;
+
+                    /* parse this tag/ref pair */
+                    switch (img_tag) {
+                        case DFTAG_RI: /* Regular image data */
+                            ri_ptr->img_tag = (uint16)img_tag;
+                            ri_ptr->img_ref = (uint16)img_ref;
+                            if (SPECIALTAG(ri_ptr->img_tag) == TRUE) {
+                                ri_ptr->use_buf_drvr = 1;
+                            }
+                            break;
+
+                        case DFTAG_CI: /* Compressed image data */
+                            ri_ptr->img_tag      = (uint16)img_tag;
+                            ri_ptr->img_ref      = (uint16)img_ref;
+                            ri_ptr->use_buf_drvr = 1;
+                            ri_ptr->use_cr_drvr  = 1;
+                            break;
+
+                        case DFTAG_LUT: /* Palette */
+                            ri_ptr->lut_tag = (uint16)img_tag;
+                            ri_ptr->lut_ref = (uint16)img_ref;
+
+                            /* Fill in some default palette dimension info, in case there isn't a
+                             * DFTAG_LD for this palette */
+                            if (ri_ptr->lut_dim.dim_ref == 0)
+                                Init_diminfo(&(ri_ptr->lut_dim));
+                            break;
+
+                        case DFTAG_LD: /* Palette dimensions */
+                        {
+                            uint8 *p = GRtbuf;
+                            if (Hgetelement(file_id, (uint16)img_tag, (uint16)img_ref, GRtbuf) !=
+                                FAIL)
+                                Decode_diminfo(p, &(ri_ptr->lut_dim));
+                            else
+                                HGOTO_ERROR(DFE_READERROR, FAIL);
 
-                    /* Get the name of the image */
-                    sprintf(textbuf, "Raster Image #%d", (int)i);
-                    if ((new_image->name = (char *)malloc(HDstrlen(textbuf) + 1)) == NULL)
-                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                    HDstrcpy(new_image->name, textbuf);
-                    new_image->name_generated = TRUE;
+                            /* read NT */
+                            if (Hgetelement(file_id, ri_ptr->lut_dim.nt_tag,
+                                            ri_ptr->lut_dim.nt_ref, ntstring) == FAIL)
+                                HGOTO_ERROR(DFE_READERROR, FAIL);
 
-                    /* Initialize the local attribute tree */
-                    new_image->lattree = tbbtdmake(rigcompare, sizeof(int32), TBBT_FAST_INT32_COMPARE);
-                    if (new_image->lattree == NULL)
-                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                    new_image->ri_ref  = DFREF_WILDCARD;
-                    new_image->rig_ref = img_info[i].grp_ref;
-
-                    while (DFdiget(GroupID, &elt_tag, &elt_ref) != FAIL) { /* get next tag/ref */
-                        switch (elt_tag) {                                 /* process tag/ref */
-                            case DFTAG_RI:                                 /* regular image data */
-                                new_image->img_tag = elt_tag;
-                                new_image->img_ref = elt_ref;
-                                if (SPECIALTAG(new_image->img_tag) == TRUE) {
-                                    new_image->use_buf_drvr = 1;
-                                } /* end if */
+                            /* check for any valid NT */
+                            if (ntstring[1] == DFNT_NONE)
                                 break;
 
-                            case DFTAG_CI: /* compressed image data */
-                                new_image->img_tag      = elt_tag;
-                                new_image->img_ref      = elt_ref;
-                                new_image->use_buf_drvr = 1;
-                                new_image->use_cr_drvr  = 1;
-                                break;
+                            /* set NT info */
+                            ri_ptr->lut_dim.dim_ref          = (uint16)img_ref;
+                            ri_ptr->lut_dim.nt               = (int32)ntstring[1];
+                            ri_ptr->lut_dim.file_nt_subclass = (int32)ntstring[3];
+                            if ((ri_ptr->lut_dim.file_nt_subclass != DFNTF_HDFDEFAULT) &&
+                                (ri_ptr->lut_dim.file_nt_subclass != DFNTF_PC) &&
+                                (ri_ptr->lut_dim.file_nt_subclass !=
+                                 DFKgetPNSC(ri_ptr->lut_dim.nt, DF_MT)))
+                                break; /* unknown subclass */
+                            if (ri_ptr->lut_dim.file_nt_subclass !=
+                                DFNTF_HDFDEFAULT) { /* if native or little endian */
+                                if (ri_ptr->lut_dim.file_nt_subclass != DFNTF_PC) /* native */
+                                    ri_ptr->lut_dim.nt |= DFNT_NATIVE;
+                                else /* little endian */
+                                    ri_ptr->lut_dim.nt |= DFNT_LITEND;
+                            } /* end if */
+                        } break;
+
+                        case DFTAG_ID: /* Image description info */
+                        {
+                            uint8 *p = GRtbuf;
+                            if (Hgetelement(file_id, (uint16)img_tag, (uint16)img_ref, GRtbuf) !=
+                                FAIL)
+                                Decode_diminfo(p, &(ri_ptr->img_dim));
+                            else
+                                HGOTO_ERROR(DFE_READERROR, FAIL);
 
-                            case DFTAG_LUT: /* Palette */
-                                new_image->lut_tag = elt_tag;
-                                new_image->lut_ref = elt_ref;
+                            /* read NT */
+                            if (Hgetelement(file_id, ri_ptr->img_dim.nt_tag,
+                                            ri_ptr->img_dim.nt_ref, ntstring) == FAIL)
+                                HGOTO_ERROR(DFE_READERROR, FAIL);
 
-                                /* Fill in some default palette dimension info, in
-                                   case there isn't a DFTAG_LD for this palette */
-                                if (new_image->lut_dim.dim_ref == 0) {
-                                    Init_diminfo(&(new_image->lut_dim));
-                                } /* end if */
+                            /* check for any valid NT */
+                            if (ntstring[1] == DFNT_NONE)
                                 break;
 
-                            case DFTAG_LD: /* Palette dimensions */
-                            {
-                                uint8 *p = GRtbuf;
-                                if (Hgetelement(file_id, elt_tag, elt_ref, GRtbuf) != FAIL)
-                                    Decode_diminfo(p, &(new_image->lut_dim));
+                            /* set NT info */
+                            ri_ptr->img_dim.dim_ref          = (uint16)img_ref;
+                            ri_ptr->img_dim.nt               = (int32)ntstring[1];
+                            ri_ptr->img_dim.file_nt_subclass = (int32)ntstring[3];
+                            if ((ri_ptr->img_dim.file_nt_subclass != DFNTF_HDFDEFAULT) &&
+                                (ri_ptr->img_dim.file_nt_subclass != DFNTF_PC) &&
+                                (ri_ptr->img_dim.file_nt_subclass !=
+                                 DFKgetPNSC(ri_ptr->img_dim.nt, DF_MT)))
+                                break; /* unknown subclass */
+                            if (ri_ptr->img_dim.file_nt_subclass !=
+                                DFNTF_HDFDEFAULT) { /* if native or little endian */
+                                if (ri_ptr->img_dim.file_nt_subclass != DFNTF_PC) /* native */
+                                    ri_ptr->img_dim.nt |= DFNT_NATIVE;
+                                else /* little endian */
+                                    ri_ptr->img_dim.nt |= DFNT_LITEND;
+                            } /* end if */
+                            break;
+                        } /* end case DFTAG_ID */
+
+                        case DFTAG_VH: /* Attribute information */
+                        {
+                            at_info_t *new_attr; /* attr to add to the local attr set */
+                            int32      at_key;   /* VData key for the attribute */
+
+                            if ((new_attr = (at_info_t *)malloc(sizeof(at_info_t))) == NULL)
+                                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                            new_attr->ref           = (uint16)img_ref;
+                            new_attr->index         = ri_ptr->lattr_count;
+                            new_attr->data_modified = FALSE;
+                            new_attr->new_at        = FALSE;
+                            new_attr->data          = NULL;
+                            if ((at_key = VSattach(file_id, (int32)img_ref, "r")) != FAIL) {
+                                char *fname;
+
+                                /* Make certain the attribute only has one field */
+                                if (VFnfields(at_key) != 1) {
+                                    VSdetach(at_key);
+                                    free(new_attr);
+                                    break;
+                                }
+                                new_attr->nt  = VFfieldtype(at_key, 0);
+                                new_attr->len = VFfieldorder(at_key, 0);
+                                if (new_attr->len == 1)
+                                    new_attr->len = VSelts(at_key);
+
+                                /* Get the name of the attribute */
+                                if ((fname = VFfieldname(at_key, 0)) == NULL) {
+                                    sprintf(textbuf, "Attribute #%d", (int)new_attr->index);
+                                    if ((new_attr->name = (char *)malloc(HDstrlen(textbuf) + 1)) ==
+                                        NULL) {
+                                        VSdetach(at_key);
+                                        free(new_attr);
+                                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                                    }
+                                    HDstrcpy(new_attr->name, textbuf);
+                                }
                                 else {
-                                    DFdifree(GroupID);
-                                    HGOTO_ERROR(DFE_READERROR, FAIL);
+                                    if ((new_attr->name = (char *)malloc(HDstrlen(fname) + 1)) ==
+                                        NULL) {
+                                        VSdetach(at_key);
+                                        free(new_attr);
+                                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                                    }
+                                    HDstrcpy(new_attr->name, fname);
                                 }
 
-                                /* read NT */
-                                if (Hgetelement(file_id, new_image->lut_dim.nt_tag, new_image->lut_dim.nt_ref,
-                                                ntstring) == FAIL) {
-                                    DFdifree(GroupID);
-                                    HGOTO_ERROR(DFE_READERROR, FAIL);
-                                }
+                                tbbtdins(ri_ptr->lattree, new_attr,
+                                         NULL); /* insert the attr instance in B-tree */
 
-                                /* check for any valid NT */
-                                if (ntstring[1] == DFNT_NONE)
-                                    break;
+                                VSdetach(at_key);
+                            } /* end if */
 
-                                /* set NT info */
-                                new_image->lut_dim.dim_ref          = elt_ref;
-                                new_image->lut_dim.nt               = (int32)ntstring[1];
-                                new_image->lut_dim.file_nt_subclass = (int32)ntstring[3];
-                                if ((new_image->lut_dim.file_nt_subclass != DFNTF_HDFDEFAULT) &&
-                                    (new_image->lut_dim.file_nt_subclass != DFNTF_PC) &&
-                                    (new_image->lut_dim.file_nt_subclass !=
-                                     DFKgetPNSC(new_image->lut_dim.nt, DF_MT)))
-                                    break; /* unknown subclass */
-                                if (new_image->lut_dim.file_nt_subclass !=
-                                    DFNTF_HDFDEFAULT) { /* if native or little endian */
-                                    if (new_image->lut_dim.file_nt_subclass != DFNTF_PC) /* native */
-                                        new_image->lut_dim.nt |= DFNT_NATIVE;
-                                    else /* little endian */
-                                        new_image->lut_dim.nt |= DFNT_LITEND;
-                                } /* end if */
-                                break;
-                            }
-                            case DFTAG_ID: /* Image description info */
-                            {
-                                uint8 *p = GRtbuf;
-                                if (Hgetelement(file_id, elt_tag, elt_ref, GRtbuf) != FAIL)
-                                    Decode_diminfo(p, &(new_image->img_dim));
-                                else {
-                                    DFdifree(GroupID);
-                                    HGOTO_ERROR(DFE_GETELEM, FAIL);
-                                }
+                            ri_ptr->lattr_count++;
 
-                                /* read NT */
-                                if (Hgetelement(file_id, new_image->img_dim.nt_tag, new_image->img_dim.nt_ref,
-                                                ntstring) == FAIL) {
-                                    DFdifree(GroupID);
-                                    HGOTO_ERROR(DFE_GETELEM, FAIL);
-                                }
+                            break;
+                        } /* end case DFTAG_VH */
 
-                                /* check for any valid NT */
-                                if (ntstring[1] == DFNT_NONE)
-                                    break;
+                        default: /* Unknown tag */
+                            break;
+                    } /* end switch */
+                }     /* end for */
+            } /* end if */
+            else
+                HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+        }     /* end case DFTAG_VG */
+        break;
 
-                                /* set NT info */
-                                new_image->img_dim.dim_ref          = elt_ref;
-                                new_image->img_dim.nt               = (int32)ntstring[1];
-                                new_image->img_dim.file_nt_subclass = (int32)ntstring[3];
-                                if ((new_image->img_dim.file_nt_subclass != DFNTF_HDFDEFAULT) &&
-                                    (new_image->img_dim.file_nt_subclass != DFNTF_PC) &&
-                                    (new_image->img_dim.file_nt_subclass !=
-                                     DFKgetPNSC(new_image->img_dim.nt, DF_MT)))
-                                    break; /* unknown subclass */
-                                if (new_image->img_dim.file_nt_subclass !=
-                                    DFNTF_HDFDEFAULT) { /* if native or little endian */
-                                    if (new_image->img_dim.file_nt_subclass != DFNTF_PC) /* native */
-                                        new_image->img_dim.nt |= DFNT_NATIVE;
-                                    else /* little endian */
-                                        new_image->img_dim.nt |= DFNT_LITEND;
-                                } /* end if */
-                                break;
-                            }
-                            default: /* ignore unknown tags */
-                                break;
-                        } /* end switch */
-                    }     /* end while */
-                    new_image->index  = gr_ptr->gr_count;
-                    new_image->gr_ptr = gr_ptr;                /* point up the tree */
-                    tbbtdins(gr_ptr->grtree, new_image, NULL); /* insert the new image into B-tree */
-                    gr_ptr->gr_count++;
-                } /* end case DFTAG_RIG */
-                break;
+        case DFTAG_RIG: /* Older style raster image, found in RIG */
+        {
+            int32  GroupID;
+            uint16 elt_tag, elt_ref;
 
-                case DFTAG_NULL: /* Eldest style raster image, no grouping */
-                {
-                    ri_info_t *new_image;                 /* ptr to the image to read in */
-                    char       textbuf[VGNAMELENMAX + 1]; /* buffer to store the name in */
-                    uint8      GRtbuf[64];                /* local buffer for reading RIG info */
+            /* read RIG into memory */
+            if ((GroupID = DFdiread(file_id, DFTAG_RIG, ri_ptr->rig_ref)) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
 
-                    if ((new_image = (ri_info_t *)malloc(sizeof(ri_info_t))) == NULL) {
-                        free(img_info); /* free offsets */
-                        Hclose(file_id);
-                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                    }
+            /* Get the name of the image */
+            sprintf(textbuf, "Raster Image #%d", (int)ri_ptr->found_index);
+            if ((ri_ptr->name = (char *)malloc(HDstrlen(textbuf) + 1)) == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            HDstrcpy(ri_ptr->name, textbuf);
+            ri_ptr->name_generated = TRUE;
 
-                    /* Initialize all the fields in the image structure to zeros */
-                    memset(new_image, 0, sizeof(ri_info_t));
+            /* Initialize the local attribute tree */
+            ri_ptr->lattree = tbbtdmake(rigcompare, sizeof(int32), TBBT_FAST_INT32_COMPARE);
+            if (ri_ptr->lattree == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-                    /* Get the name of the image */
-                    sprintf(textbuf, "Raster Image #%d", (int)i);
-                    if ((new_image->name = (char *)malloc(HDstrlen(textbuf) + 1)) == NULL)
-                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                    HDstrcpy(new_image->name, textbuf);
-                    new_image->name_generated = TRUE;
+            while (DFdiget(GroupID, &elt_tag, &elt_ref) != FAIL) { /* get next tag/ref */
+                switch (elt_tag) {                                 /* process tag/ref */
+                    case DFTAG_RI:                                 /* regular image data */
+                        ri_ptr->img_tag = elt_tag;
+                        ri_ptr->img_ref = elt_ref;
+                        if (SPECIALTAG(ri_ptr->img_tag) == TRUE) {
+                            ri_ptr->use_buf_drvr = 1;
+                        } /* end if */
+                        break;
 
-                    /* Initialize the local attribute tree */
-                    new_image->lattree = tbbtdmake(rigcompare, sizeof(int32), TBBT_FAST_INT32_COMPARE);
-                    if (new_image->lattree == NULL)
-                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
-                    new_image->ri_ref  = DFREF_WILDCARD;
-                    new_image->rig_ref = DFREF_WILDCARD;
+                    case DFTAG_CI: /* compressed image data */
+                        ri_ptr->img_tag      = elt_tag;
+                        ri_ptr->img_ref      = elt_ref;
+                        ri_ptr->use_buf_drvr = 1;
+                        ri_ptr->use_cr_drvr  = 1;
+                        break;
 
-                    /* Get tag/ref for image */
-                    new_image->img_tag = img_info[i].img_tag;
-                    new_image->img_ref = img_info[i].img_ref;
+                    case DFTAG_LUT: /* Palette */
+                        ri_ptr->lut_tag = elt_tag;
+                        ri_ptr->lut_ref = elt_ref;
 
-                    /* Get dimension information for this 8-bit image */
+                        /* Fill in some default palette dimension info, in
+                           case there isn't a DFTAG_LD for this palette */
+                        if (ri_ptr->lut_dim.dim_ref == 0) {
+                            Init_diminfo(&(ri_ptr->lut_dim));
+                        } /* end if */
+                        break;
 
-                    /* Initialize dim info to default */
-                    Init_diminfo(&(new_image->img_dim));
+                    case DFTAG_LD: /* Palette dimensions */
+                    {
+                        uint8 *p = GRtbuf;
+                        if (Hgetelement(file_id, elt_tag, elt_ref, GRtbuf) != FAIL)
+                            Decode_diminfo(p, &(ri_ptr->lut_dim));
+                        else {
+                            DFdifree(GroupID);
+                            HGOTO_ERROR(DFE_READERROR, FAIL);
+                        }
 
-                    /* Reassign valid values */
-                    if (Hgetelement(file_id, DFTAG_ID8, new_image->img_ref, GRtbuf) != FAIL) {
-                        uint8 *p;
-                        uint16 u;
+                        /* read NT */
+                        if (Hgetelement(file_id, ri_ptr->lut_dim.nt_tag, ri_ptr->lut_dim.nt_ref,
+                                        ntstring) == FAIL) {
+                            DFdifree(GroupID);
+                            HGOTO_ERROR(DFE_READERROR, FAIL);
+                        }
 
-                        p = GRtbuf;
-                        UINT16DECODE(p, u);
-                        new_image->img_dim.xdim = (int32)u;
-                        UINT16DECODE(p, u);
-                        new_image->img_dim.ydim   = (int32)u;
-                        new_image->img_dim.ncomps = 1;
-                    } /* end if */
-                    else
-                        HGOTO_ERROR(DFE_GETELEM, FAIL);
+                        /* check for any valid NT */
+                        if (ntstring[1] == DFNT_NONE)
+                            break;
+
+                        /* set NT info */
+                        ri_ptr->lut_dim.dim_ref          = elt_ref;
+                        ri_ptr->lut_dim.nt               = (int32)ntstring[1];
+                        ri_ptr->lut_dim.file_nt_subclass = (int32)ntstring[3];
+                        if ((ri_ptr->lut_dim.file_nt_subclass != DFNTF_HDFDEFAULT) &&
+                            (ri_ptr->lut_dim.file_nt_subclass != DFNTF_PC) &&
+                            (ri_ptr->lut_dim.file_nt_subclass !=
+                             DFKgetPNSC(ri_ptr->lut_dim.nt, DF_MT)))
+                            break; /* unknown subclass */
+                        if (ri_ptr->lut_dim.file_nt_subclass !=
+                            DFNTF_HDFDEFAULT) { /* if native or little endian */
+                            if (ri_ptr->lut_dim.file_nt_subclass != DFNTF_PC) /* native */
+                                ri_ptr->lut_dim.nt |= DFNT_NATIVE;
+                            else /* little endian */
+                                ri_ptr->lut_dim.nt |= DFNT_LITEND;
+                        } /* end if */
+                        break;
+                    }
+                    case DFTAG_ID: /* Image description info */
+                    {
+                        uint8 *p = GRtbuf;
+                        if (Hgetelement(file_id, elt_tag, elt_ref, GRtbuf) != FAIL)
+                            Decode_diminfo(p, &(ri_ptr->img_dim));
+                        else {
+                            DFdifree(GroupID);
+                            HGOTO_ERROR(DFE_GETELEM, FAIL);
+                        }
 
-                    /* Get palette information */
-                    if (Hexist(file_id, DFTAG_IP8, new_image->img_ref) == SUCCEED) {
-                        new_image->lut_tag = DFTAG_IP8;
-                        new_image->lut_ref = new_image->img_ref;
+                        /* read NT */
+                        if (Hgetelement(file_id, ri_ptr->img_dim.nt_tag, ri_ptr->img_dim.nt_ref,
+                                        ntstring) == FAIL) {
+                            DFdifree(GroupID);
+                            HGOTO_ERROR(DFE_GETELEM, FAIL);
+                        }
 
-                        /* set palette dimensions too */
-                        Init_diminfo(&(new_image->lut_dim));
-                    } /* end if */
-                    else
-                        new_image->lut_tag = new_image->lut_ref = DFREF_WILDCARD;
+                        /* check for any valid NT */
+                        if (ntstring[1] == DFNT_NONE)
+                            break;
+
+                        /* set NT info */
+                        ri_ptr->img_dim.dim_ref          = elt_ref;
+                        ri_ptr->img_dim.nt               = (int32)ntstring[1];
+                        ri_ptr->img_dim.file_nt_subclass = (int32)ntstring[3];
+                        if ((ri_ptr->img_dim.file_nt_subclass != DFNTF_HDFDEFAULT) &&
+                            (ri_ptr->img_dim.file_nt_subclass != DFNTF_PC) &&
+                            (ri_ptr->img_dim.file_nt_subclass !=
+                             DFKgetPNSC(ri_ptr->img_dim.nt, DF_MT)))
+                            break; /* unknown subclass */
+                        if (ri_ptr->img_dim.file_nt_subclass !=
+                            DFNTF_HDFDEFAULT) { /* if native or little endian */
+                            if (ri_ptr->img_dim.file_nt_subclass != DFNTF_PC) /* native */
+                                ri_ptr->img_dim.nt |= DFNT_NATIVE;
+                            else /* little endian */
+                                ri_ptr->img_dim.nt |= DFNT_LITEND;
+                        } /* end if */
+                        break;
+                    }
+                    default: /* ignore unknown tags */
+                        break;
+                } /* end switch */
+            }     /* end while */
+        } /* end case DFTAG_RIG */
+        break;
 
-                    new_image->index  = gr_ptr->gr_count;
-                    new_image->gr_ptr = gr_ptr;                /* point up the tree */
-                    tbbtdins(gr_ptr->grtree, new_image, NULL); /* insert the new image into B-tree */
-                    gr_ptr->gr_count++;
-                } /* end case DFTAG_NULL */
-                break;
+        case DFTAG_NULL: /* Eldest style raster image, no grouping */
+        {
+            /* Get the name of the image */
+            sprintf(textbuf, "Raster Image #%d", (int)ri_ptr->found_index);
+            if ((ri_ptr->name = (char *)malloc(HDstrlen(textbuf) + 1)) == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            HDstrcpy(ri_ptr->name, textbuf);
+            ri_ptr->name_generated = TRUE;
 
-                default: /* an image which was eliminated from the list of images */
-                    break;
-            } /* end switch */
-        }     /* end if */
-    }         /* end for */
+            /* Initialize the local attribute tree */
+            ri_ptr->lattree = tbbtdmake(rigcompare, sizeof(int32), TBBT_FAST_INT32_COMPARE);
+            if (ri_ptr->lattree == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-    free(img_info); /* free image info structures */
+            /* Get dimension information for this 8-bit image */
+
+            /* Initialize dim info to default */
+            Init_diminfo(&(ri_ptr->img_dim));
+
+            /* Reassign valid values */
+            if (Hgetelement(file_id, DFTAG_ID8, ri_ptr->img_ref, GRtbuf) != FAIL) {
+                uint8 *p;
+                uint16 u;
+
+                p = GRtbuf;
+                UINT16DECODE(p, u);
+                ri_ptr->img_dim.xdim = (int32)u;
+                UINT16DECODE(p, u);
+                ri_ptr->img_dim.ydim   = (int32)u;
+                ri_ptr->img_dim.ncomps = 1;
+            } /* end if */
+            else
+                HGOTO_ERROR(DFE_GETELEM, FAIL);
+
+            /* Get palette information */
+            if (Hexist(file_id, DFTAG_IP8, ri_ptr->img_ref) == SUCCEED) {
+                ri_ptr->lut_tag = DFTAG_IP8;
+                ri_ptr->lut_ref = ri_ptr->img_ref;
+
+                /* set palette dimensions too */
+                Init_diminfo(&(ri_ptr->lut_dim));
+            } /* end if */
+            else
+                ri_ptr->lut_tag = ri_ptr->lut_ref = DFREF_WILDCARD;
+        } /* end case DFTAG_NULL */
+        break;
+
+        default:
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    } /* end switch */
 
 done:
+    if (img_key != FAIL)
+        Vdetach(img_key);
+    if (ret_value == FAIL) { /* leave the image to be read again */
+        free(ri_ptr->name);
+        ri_ptr->name        = NULL;
+        ri_ptr->lattree     = tbbtdfree(ri_ptr->lattree, GRIattrdestroynode, NULL);
+        ri_ptr->lattr_count = 0;
+    }
+    else
+        ri_ptr->info_pending = FALSE;
+
     return ret_value;
-} /* end GRIget_image_list() */
+} /* end GRIread_image() */
 
 /*--------------------------------------------------------------------------
  NAME
@@ -2205,6 +2229,10 @@ GRselect(int32 grid, int32 index)
         HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
     ri_ptr = (ri_info_t *)*t;
 
+    /* read the image's information, the first time it is selected */
+    if (GRIread_image(ri_ptr) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
     ri_ptr->access++;
 
     ret_value = HAregister_atom(RIIDGROUP, ri_ptr);
@@ -2378,6 +2406,8 @@ GRnametoindex(int32 grid, const char *name)
         HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
     do {
         ri_ptr = (ri_info_t *)*t;
+        if (ri_ptr != NULL && GRIread_image(ri_ptr) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
         if (ri_ptr != NULL && HDstrcmp(ri_ptr->name, name) == 0) /* ie. the name matches */
             HGOTO_DONE(ri_ptr->index);
     } while ((t = (void **)tbbtnext((TBBT_NODE *)t)) != NULL);
@@ -4754,6 +4784,110 @@ done:
     return ret_value;
 } /* end GRgetattr() */
 
+/*--------------------------------------------------------------------------
+ NAME
+    GRgetattrs
+
+ PURPOSE
+    Read all the attributes of an object.
+
+ USAGE
+    intn GRgetattrs(riid|grid,attrs)
+        int32 riid|grid;        IN: RI|GR ID
+        hdf_attr_t **attrs;     OUT: the attributes; NULL if there are none
+
+ RETURNS
+    The number of attributes, or FAIL
+
+ DESCRIPTION
+    Returns the name, number type, count and values of every attribute of
+    the image or the file, in index order, in one buffer that the caller
+    frees with free().  Values not already cached are read straight from
+    the attribute Vdatas, which are not attached; they are not added to
+    the cache.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+intn
+GRgetattrs(int32 id, hdf_attr_t **attrs)
+{
+    gr_info_t  *gr_ptr;      /* ptr to the GR information for this grid */
+    ri_info_t  *ri_ptr;      /* ptr to the image to work with */
+    void      **t;           /* temp. ptr to the attribute found */
+    TBBT_TREE  *search_tree; /* attribute tree to search through */
+    at_info_t  *at_ptr;      /* ptr to the attribute to work with */
+    int32       nattrs;      /* number of attributes of the object */
+    hdf_attr_t *buf = NULL;  /* the buffer returned */
+    uint8      *next;        /* where the next name goes in buf */
+    void       *values;      /* where the values of an attribute go */
+    size_t      space = 0;   /* room for the names and values */
+    int32       i;
+    intn        ret_value = SUCCEED;
+
+    /* clear error stack and check validity of args */
+    HEclear();
+
+    if ((HAatom_group(id) != RIIDGROUP && HAatom_group(id) != GRIDGROUP) || attrs == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    *attrs = NULL;
+
+    if (HAatom_group(id) == GRIDGROUP) {
+        /* locate GR's object in hash table */
+        if (NULL == (gr_ptr = (gr_info_t *)HAatom_object(id)))
+            HGOTO_ERROR(DFE_GRNOTFOUND, FAIL);
+        nattrs      = gr_ptr->gattr_count;
+        search_tree = gr_ptr->gattree;
+    } /* end if */
+    else {
+        /* locate RI's object in hash table */
+        if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(id)))
+            HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+        gr_ptr      = ri_ptr->gr_ptr;
+        nattrs      = ri_ptr->lattr_count;
+        search_tree = ri_ptr->lattree;
+    } /* end else */
+    if (nattrs == 0)
+        HGOTO_DONE(0);
+
+    /* the tree is keyed by index, so it is walked in index order */
+    if (NULL == (t = (void **)tbbtfirst((TBBT_NODE *)*search_tree)))
+        HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+    do {
+        at_ptr = (at_info_t *)*t;
+        space += HDattr_space(strlen(at_ptr->name),
+                              (size_t)(at_ptr->len * DFKNTsize((at_ptr->nt | DFNT_NATIVE) & (~DFNT_LITEND))));
+    } while ((t = (void **)tbbtnext((TBBT_NODE *)t)) != NULL);
+
+    if (NULL == (buf = HDattrs_alloc((intn)nattrs, space, &next)))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    t = (void **)tbbtfirst((TBBT_NODE *)*search_tree);
+    for (i = 0; i < nattrs && t != NULL; i++, t = (void **)tbbtnext((TBBT_NODE *)t)) {
+        size_t at_size;
+
+        at_ptr  = (at_info_t *)*t;
+        at_size = (size_t)(at_ptr->len * DFKNTsize((at_ptr->nt | DFNT_NATIVE) & (~DFNT_LITEND)));
+        values  = HDattr_place(&buf[i], &next, at_ptr->name, strlen(at_ptr->name), at_ptr->nt, at_ptr->len,
+                               at_size);
+        if (at_ptr->data != NULL)
+            memcpy(values, at_ptr->data, at_size);
+        else if (VSIreadattr(gr_ptr->hdf_file_id, at_ptr->ref, values) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+    } /* end for */
+    if (i != nattrs)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    *attrs    = buf;
+    ret_value = (intn)nattrs;
+
+done:
+    if (ret_value == FAIL)
+        free(buf);
+    return ret_value;
+} /* end GRgetattrs() */
+
 /*--------------------------------------------------------------------------
  NAME
     GRfindattr
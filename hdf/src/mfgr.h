@@ -127,6 +127,9 @@ typedef struct ri_info {
     uintn        store_fill; /* whether to add fill value attribute or not */
     intn name_generated; /* whether the image has name that was given by app. or was generated by the library
                             like the DFR8 images (added for hmap)*/
+    intn   info_pending; /* whether the information above is still to be read from the file (GRIread_image) */
+    uint16 found_tag;    /* tag of the group the image was found in: DFTAG_VG, DFTAG_RIG or DFTAG_NULL */
+    intn   found_index;  /* position of the image in the search of the file, for generated names */
 } ri_info_t;
 
 /* Useful raster routines for generally private use */
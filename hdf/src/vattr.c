@@ -135,6 +135,9 @@
 *   intn VSgetattr(int32 vsid, int32 findex, intn attrindex,
 *                  void * values)
 *        get values of an attribute
+*   intn VSgetattrs(int32 vsid, int32 findex, hdf_attr_t **attrs)
+*        get names, types and values of all attributes of a vdata
+*        or a field at once
 *   intn VSisattr(int32 vsid)
 *        test if a vdata is an attribute of other object
 *   < int32 VSgetversion(int32 vsid) already defined in vio.c >
@@ -158,12 +161,21 @@
 *	 that are counted by Vnattrs2.
 *   intn Vgetattr(int32 vgid, intn attrindex, void * values)
 *        get values of an attribute
+*   intn Vgetattrs(int32 vgid, hdf_attr_t **attrs)
+*        get names, types and values of all attributes at once
 *   intn Vgetattr2(int32 vgid, intn attrindex, void * values)
 *        get values of an attribute - this function processes attributes
 *	 that are counted by Vnattrs2.
 *   int32 Vgetversion(int32 vgid)
 *        get vset version of a vgroup
 * Private routines:
+*   intn VIattr_index_add(attr_index_t *idx, int32 findex,
+*                         const char *name, intn aindex)
+*        add an attribute name to the name index of a vgroup/vdata
+*   void VIattr_index_free(attr_index_t *idx)
+*        free the name index of a vgroup/vdata
+*   intn VSIreadattr(HFILEID f, uint16 ref, void *values)
+*        read the values of an attribute vdata without attaching it
 *
 * Affected existing functions:
 *    vgp.c:vunpackvg--VPgetinfo
@@ -185,6 +197,306 @@
 #define VSET_INTERFACE
 #include "hdf.h"
 
+/* number of buckets a new attribute name index starts with */
+#define ATTR_INDEX_MIN 8
+
+static uint32        VIattr_hash(int32 findex, const char *name);
+static attr_index_t *VIattr_index_new(intn nnames);
+static intn          VIattr_index_find(const attr_index_t *idx, int32 findex, const char *name);
+static VDATA        *VIattr_vdata(int32 fid, uint16 aref);
+static intn          VIgetattrs(int32 fid, intn nattrs, const uint16 refs[], hdf_attr_t **attrs);
+
+/* -------------------  VIattr_hash ------------------------
+NAME
+   VIattr_hash -- hash of a field index and an attribute name
+RETURNS
+   The hash value (FNV-1a).
+----------------------------------------------------------- */
+static uint32
+VIattr_hash(int32 findex, const char *name)
+{
+    uint32 h = 2166136261U ^ (uint32)findex;
+
+    while (*name != '\0')
+        h = (h ^ (uint8)*name++) * 16777619U;
+    return h;
+} /* VIattr_hash */
+
+/* -------------------  VIattr_index_new -------------------
+NAME
+   VIattr_index_new -- create an empty attribute name index
+USAGE
+   attr_index_t *VIattr_index_new(intn nnames)
+   intn nnames;     IN: number of names expected
+RETURNS
+   The new index, NULL if out of memory.
+----------------------------------------------------------- */
+static attr_index_t *
+VIattr_index_new(intn nnames)
+{
+    attr_index_t *idx = NULL;
+    intn          nbuckets;
+
+    for (nbuckets = ATTR_INDEX_MIN; nbuckets < nnames; nbuckets *= 2)
+        ;
+
+    if (NULL == (idx = (attr_index_t *)calloc(1, sizeof(attr_index_t))))
+        return NULL;
+    idx->bucket = (intn *)malloc((size_t)nbuckets * sizeof(intn));
+    idx->names  = (attr_name_t *)malloc((size_t)nbuckets * sizeof(attr_name_t));
+    if (idx->bucket == NULL || idx->names == NULL) {
+        VIattr_index_free(idx);
+        return NULL;
+    }
+    memset(idx->bucket, 0xff, (size_t)nbuckets * sizeof(intn)); /* all -1 */
+    idx->nbuckets = nbuckets;
+    idx->maxnames = nbuckets;
+    return idx;
+} /* VIattr_index_new */
+
+/* -------------------  VIattr_index_add -------------------
+NAME
+   VIattr_index_add -- add an attribute name to a name index
+USAGE
+   intn VIattr_index_add(attr_index_t *idx, int32 findex,
+                         const char *name, intn aindex)
+   attr_index_t *idx;   IN: the index
+   int32 findex;        IN: field of the attribute, or _HDF_VDATA
+   const char *name;    IN: name of the attribute
+   intn aindex;         IN: index of the attribute to return
+                            when looking up this name
+RETURNS
+   SUCCEED, or FAIL if out of memory.
+DESCRIPTION
+   A name that is already in the index for the same field is
+   not added again; the first attribute with a name is the one
+   found, as when the attributes are searched one by one.
+   The buckets double when there are more names than buckets.
+----------------------------------------------------------- */
+intn
+VIattr_index_add(attr_index_t *idx, int32 findex, const char *name, intn aindex)
+{
+    attr_name_t *entry;
+    uint32       mask;
+    intn         i;
+    intn         ret_value = SUCCEED;
+
+    if (VIattr_index_find(idx, findex, name) != FAIL)
+        HGOTO_DONE(SUCCEED);
+
+    if (idx->nnames == idx->maxnames) {
+        intn         nbuckets = idx->nbuckets * 2;
+        intn        *bucket;
+        attr_name_t *names;
+
+        if (NULL == (names = realloc(idx->names, (size_t)nbuckets * sizeof(attr_name_t))))
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        idx->names    = names;
+        idx->maxnames = nbuckets;
+        if (NULL == (bucket = realloc(idx->bucket, (size_t)nbuckets * sizeof(intn))))
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        idx->bucket   = bucket;
+        idx->nbuckets = nbuckets;
+
+        /* chain the names again in the larger table */
+        memset(idx->bucket, 0xff, (size_t)nbuckets * sizeof(intn));
+        mask = (uint32)nbuckets - 1;
+        for (i = 0; i < idx->nnames; i++) {
+            uint32 b = VIattr_hash(idx->names[i].findex, idx->names[i].name) & mask;
+
+            idx->names[i].next = idx->bucket[b];
+            idx->bucket[b]     = i;
+        } /* end for */
+    }     /* end if */
+
+    entry = &idx->names[idx->nnames];
+    if (NULL == (entry->name = strdup(name)))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    entry->findex = findex;
+    entry->aindex = aindex;
+
+    mask           = (uint32)idx->nbuckets - 1;
+    i              = (intn)(VIattr_hash(findex, name) & mask);
+    entry->next    = idx->bucket[i];
+    idx->bucket[i] = idx->nnames++;
+
+done:
+    return ret_value;
+} /* VIattr_index_add */
+
+/* -------------------  VIattr_index_find ------------------
+NAME
+   VIattr_index_find -- look up an attribute name
+USAGE
+   intn VIattr_index_find(const attr_index_t *idx, int32 findex,
+                          const char *name)
+RETURNS
+   The attribute index stored with the name, FAIL if the name
+   is not in the index for that field.
+----------------------------------------------------------- */
+static intn
+VIattr_index_find(const attr_index_t *idx, int32 findex, const char *name)
+{
+    intn i = idx->bucket[VIattr_hash(findex, name) & ((uint32)idx->nbuckets - 1)];
+
+    for (; i != -1; i = idx->names[i].next)
+        if (idx->names[i].findex == findex && !strcmp(idx->names[i].name, name))
+            return idx->names[i].aindex;
+    return FAIL;
+} /* VIattr_index_find */
+
+/* -------------------  VIattr_index_free ------------------
+NAME
+   VIattr_index_free -- free an attribute name index
+USAGE
+   void VIattr_index_free(attr_index_t *idx)
+   attr_index_t *idx;   IN: the index, may be NULL
+----------------------------------------------------------- */
+void
+VIattr_index_free(attr_index_t *idx)
+{
+    intn i;
+
+    if (idx == NULL)
+        return;
+    for (i = 0; i < idx->nnames; i++)
+        free(idx->names[i].name);
+    free(idx->names);
+    free(idx->bucket);
+    free(idx);
+} /* VIattr_index_free */
+
+/* -------------------  VIattr_vdata -----------------------
+NAME
+   VIattr_vdata -- get the header of an attribute vdata
+USAGE
+   VDATA *VIattr_vdata(int32 fid, uint16 aref)
+   int32 fid;     IN: file id
+   uint16 aref;   IN: ref of the attribute vdata
+RETURNS
+   The vdata header, NULL if it can't be found or isn't an
+   attribute.
+DESCRIPTION
+   Only the header of the vdata is read, the first time it is
+   used; the vdata is not attached.
+----------------------------------------------------------- */
+static VDATA *
+VIattr_vdata(int32 fid, uint16 aref)
+{
+    vsinstance_t *attr_inst;
+    VDATA        *ret_value = NULL;
+
+    if (NULL == (attr_inst = vsinst(fid, aref)))
+        HGOTO_ERROR(DFE_CANTATTACH, NULL);
+    if (attr_inst->vs == NULL ||
+        HDstrncmp(attr_inst->vs->vsclass, _HDF_ATTRIBUTE, HDstrlen(_HDF_ATTRIBUTE)))
+        HGOTO_ERROR(DFE_BADATTR, NULL);
+    ret_value = attr_inst->vs;
+
+done:
+    return ret_value;
+} /* VIattr_vdata */
+
+/* -------------------  VSIreadattr ------------------------
+NAME
+   VSIreadattr -- read the values of an attribute vdata
+USAGE
+   intn VSIreadattr(HFILEID f, uint16 ref, void *values)
+   HFILEID f;     IN: file id
+   uint16 ref;    IN: ref of the attribute vdata
+   void *values;  OUT: all the values of its one field, in the
+                       memory format of this machine
+RETURNS
+   SUCCEED, or FAIL if the vdata can't be read.
+DESCRIPTION
+   Reads the data element of the vdata and converts it, without
+   attaching the vdata.  Attribute vdatas have one field, so
+   the records are the values one after the other.
+----------------------------------------------------------- */
+intn
+VSIreadattr(HFILEID f, uint16 ref, void *values)
+{
+    vsinstance_t *attr_inst;
+    VDATA        *vs;
+    uint8        *raw = NULL;
+    int32         aid = FAIL;
+    int32         nvalues, rawsize;
+    intn          ret_value = SUCCEED;
+
+    if (NULL == (attr_inst = vsinst(f, ref)) || NULL == (vs = attr_inst->vs))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+    if (vs->wlist.n != 1)
+        HGOTO_ERROR(DFE_BADATTR, FAIL);
+    nvalues = vs->nvertices * (int32)vs->wlist.order[0];
+    rawsize = vs->nvertices * (int32)vs->wlist.isize[0];
+    if (nvalues == 0)
+        HGOTO_DONE(SUCCEED);
+
+    if (NULL == (raw = (uint8 *)malloc((size_t)rawsize)))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if (FAIL == (aid = Hstartread(f, DFTAG_VS, ref)))
+        HGOTO_ERROR(DFE_BADAID, FAIL);
+    if (Hread(aid, rawsize, raw) != rawsize)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+    if (FAIL == DFKconvert(raw, values, vs->wlist.type[0], nvalues, DFACC_READ, 0, 0))
+        HGOTO_ERROR(DFE_BADCONV, FAIL);
+
+done:
+    if (aid != FAIL)
+        Hendaccess(aid);
+    free(raw);
+    return ret_value;
+} /* VSIreadattr */
+
+/* -------------------  VIgetattrs -------------------------
+NAME
+   VIgetattrs -- read a list of attribute vdatas in one buffer
+USAGE
+   intn VIgetattrs(int32 fid, intn nattrs, const uint16 refs[],
+                   hdf_attr_t **attrs)
+   int32 fid;           IN: file id
+   intn nattrs;         IN: number of attributes
+   const uint16 refs[]; IN: refs of the attribute vdatas
+   hdf_attr_t **attrs;  OUT: the attributes, see Vgetattrs
+RETURNS
+   nattrs, or FAIL.
+----------------------------------------------------------- */
+static intn
+VIgetattrs(int32 fid, intn nattrs, const uint16 refs[], hdf_attr_t **attrs)
+{
+    VDATA      *vs;
+    hdf_attr_t *buf = NULL;
+    uint8      *next;
+    void       *values;
+    size_t      space = 0;
+    intn        i;
+    intn        ret_value = nattrs;
+
+    /* size everything from the headers first */
+    for (i = 0; i < nattrs; i++) {
+        if (NULL == (vs = VIattr_vdata(fid, refs[i])) || vs->wlist.n != 1)
+            HGOTO_ERROR(DFE_BADATTR, FAIL);
+        space += HDattr_space(HDstrlen(vs->vsname), (size_t)vs->nvertices * vs->wlist.esize[0]);
+    }
+    if (NULL == (buf = HDattrs_alloc(nattrs, space, &next)))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    for (i = 0; i < nattrs; i++) {
+        vs     = VIattr_vdata(fid, refs[i]);
+        values = HDattr_place(&buf[i], &next, vs->vsname, HDstrlen(vs->vsname), vs->wlist.type[0],
+                              vs->nvertices * (int32)vs->wlist.order[0],
+                              (size_t)vs->nvertices * vs->wlist.esize[0]);
+        if (FAIL == VSIreadattr(fid, refs[i], values))
+            HGOTO_ERROR(DFE_VSREAD, FAIL);
+    }
+    *attrs = buf;
+
+done:
+    if (ret_value == FAIL)
+        free(buf);
+    return ret_value;
+} /* VIgetattrs */
+
 /* -----------------  VSfindex ---------------------
 NAME
       VSfindex -- find index of a named field in a vdata
@@ -356,6 +668,9 @@ VSsetattr(int32 vsid, int32 findex, const char *attrname, int32 datatype, int32
     vs->alist[vs->nattrs].atag   = DFTAG_VH;
     vs->alist[vs->nattrs].aref   = (uint16)attr_vs_ref;
     vs->nattrs++;
+    if (vs->attr_index != NULL &&
+        VIattr_index_add(vs->attr_index, findex, attrname, VSfnattrs(vsid, findex) - 1) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
     /* set attr flag and  version number */
     vs->flags    = vs->flags | VS_ATTR_SET;
     vs->version  = VSET_NEW_VERSION;
@@ -469,11 +784,11 @@ intn
 VSfindattr(int32 vsid, int32 findex, const char *attrname)
 {
     VDATA        *vs, *attr_vs;
-    vsinstance_t *vs_inst, *attr_inst;
+    vsinstance_t *vs_inst;
     vs_attr_t    *vs_alist;
-    int32         fid, attr_vsid;
+    attr_index_t *idx;
     int32         ret_value = FAIL;
-    intn          i, nattrs, a_index, found;
+    intn          i, j, nattrs, a_index;
 
     HEclear();
     /* check if id is valid vdata */
@@ -496,38 +811,25 @@ VSfindattr(int32 vsid, int32 findex, const char *attrname)
     if (nattrs == 0 || vs_alist == NULL)
         /* no attrs or bad attr list */
         HGOTO_ERROR(DFE_ARGS, FAIL);
-    fid     = vs->f;
-    found   = 0;
-    a_index = -1;
-    for (i = 0; i < nattrs; i++) {
-        if (vs_alist->findex == findex) {
-            a_index++; /* index of fld attr */
-            if ((attr_vsid = VSattach(fid, (int32)vs_alist->aref, "r")) == FAIL)
-                HGOTO_ERROR(DFE_CANTATTACH, FAIL);
-            if (HAatom_group(attr_vsid) != VSIDGROUP) {
-                VSdetach(attr_vsid);
-                HGOTO_ERROR(DFE_ARGS, FAIL);
-            }
-            if (NULL == (attr_inst = (vsinstance_t *)HAatom_object(attr_vsid))) {
-                VSdetach(attr_vsid);
-                HGOTO_ERROR(DFE_NOVS, FAIL);
-            }
-            if (NULL == (attr_vs = attr_inst->vs) ||
-                HDstrncmp(attr_vs->vsclass, _HDF_ATTRIBUTE, HDstrlen(_HDF_ATTRIBUTE))) {
-                VSdetach(attr_vsid);
+
+    /* index the names of all the attributes the first time */
+    if (vs->attr_index == NULL) {
+        if (NULL == (idx = VIattr_index_new(nattrs)))
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        for (i = 0; i < nattrs; i++) {
+            /* index of the attribute among those of its field */
+            for (a_index = 0, j = 0; j < i; j++)
+                if (vs_alist[j].findex == vs_alist[i].findex)
+                    a_index++;
+            if (NULL == (attr_vs = VIattr_vdata(vs->f, vs_alist[i].aref)) ||
+                VIattr_index_add(idx, vs_alist[i].findex, attr_vs->vsname, a_index) == FAIL) {
+                VIattr_index_free(idx);
                 HGOTO_ERROR(DFE_BADATTR, FAIL);
             }
-            if (!HDstrcmp(attr_vs->vsname, attrname)) {
-                ret_value = a_index;
-                found     = 1;
-            }
-            if (VSdetach(attr_vsid) == FAIL)
-                HGOTO_ERROR(DFE_CANTDETACH, FAIL);
         }
-        if (found)
-            break;
-        vs_alist++;
+        vs->attr_index = idx;
     }
+    ret_value = VIattr_index_find(vs->attr_index, findex, attrname);
 
 done:
     return ret_value;
@@ -708,6 +1010,61 @@ done:
     return ret_value;
 } /* VSgetattr */
 
+/* ----------------------  VSgetattrs -------------------
+NAME
+   VSgetattrs -- get all the attributes of a vdata or field
+USAGE
+   intn VSgetattrs(int32 vsid, int32 findex, hdf_attr_t **attrs)
+   int32 vsid;          IN: vdata access id
+   int32 findex;        IN: field index; _HDF_VDATA (-1) for vdata
+   hdf_attr_t **attrs;  OUT: the attributes; NULL if there are none
+RETURNS
+   Returns the number of attributes, FAIL otherwise
+DESCRIPTION
+   Returns the name, number type, count and values of every
+   attribute of the field or vdata, in the order VSattrinfo
+   numbers them, in one buffer that the caller frees with free().
+   The attribute vdatas are not attached.
+--------------------------------------------------------- */
+intn
+VSgetattrs(int32 vsid, int32 findex, hdf_attr_t **attrs)
+{
+    VDATA        *vs;
+    vsinstance_t *vs_inst;
+    uint16       *refs = NULL;
+    intn          i, nattrs;
+    intn          ret_value = FAIL;
+
+    HEclear();
+    if (HAatom_group(vsid) != VSIDGROUP || attrs == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    *attrs = NULL;
+    /* locate vs' index in vstab */
+    if (NULL == (vs_inst = (vsinstance_t *)HAatom_object(vsid)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+    if (NULL == (vs = vs_inst->vs))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+    if ((findex >= vs->wlist.n || findex < 0) && (findex != _HDF_VDATA))
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+    if (vs->nattrs == 0)
+        HGOTO_DONE(0);
+    if (vs->alist == NULL)
+        HGOTO_ERROR(DFE_BADATTR, FAIL);
+
+    if (NULL == (refs = (uint16 *)malloc((size_t)vs->nattrs * sizeof(uint16))))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0, nattrs = 0; i < vs->nattrs; i++)
+        if (vs->alist[i].findex == findex)
+            refs[nattrs++] = vs->alist[i].aref;
+    if (nattrs == 0)
+        HGOTO_DONE(0);
+    ret_value = VIgetattrs(vs->f, nattrs, refs, attrs);
+
+done:
+    free(refs);
+    return ret_value;
+} /* VSgetattrs */
+
 /* -------------------- VSisattr ----------------------
 NAME
    VSisattr -- test if a vdata is an attribute of
@@ -851,6 +1208,9 @@ Vsetattr(int32 vgid, const char *attrname, int32 datatype, int32 count, const vo
     vg->alist[vg->nattrs - 1].atag = DFTAG_VH;
     vg->alist[vg->nattrs - 1].aref = (uint16)attr_vs_ref;
     vg->marked                     = 1;
+    if (vg->attr_index != NULL &&
+        VIattr_index_add(vg->attr_index, _HDF_VDATA, attrname, vg->nattrs - 1) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
     /* list of refs of all attributes, it is only used when Vattrinfo2 is
        invoked; see Vattrinfo2 function header for info. 2/4/2011 -BMR */
     vg->old_alist = NULL;
@@ -1121,12 +1481,11 @@ intn
 Vfindattr(int32 vgid, const char *attrname)
 {
     VGROUP       *vg;
-    VDATA        *vs;
+    VDATA        *attr_vs;
     vginstance_t *v;
-    vsinstance_t *vs_inst;
-    int32         fid, vsid;
+    attr_index_t *idx;
     int32         ret_value = FAIL;
-    intn          i, found;
+    intn          i;
 
     HEclear();
 
@@ -1141,8 +1500,7 @@ Vfindattr(int32 vgid, const char *attrname)
     /* locate vg's index in vgtab */
     if (NULL == (v = (vginstance_t *)HAatom_object(vgid)))
         HGOTO_ERROR(DFE_VTAB, FAIL);
-    vg  = v->vg;
-    fid = vg->f;
+    vg = v->vg;
     if (vg == NULL)
         HGOTO_ERROR(DFE_BADPTR, FAIL);
     if (vg->otag != DFTAG_VG)
@@ -1150,23 +1508,20 @@ Vfindattr(int32 vgid, const char *attrname)
     if (vg->nattrs == 0 || vg->alist == NULL)
         /* no attrs or bad attr list */
         HGOTO_ERROR(DFE_ARGS, FAIL);
-    found = 0;
-    for (i = 0; found == 0 && i < vg->nattrs; i++) {
-        if ((vsid = VSattach(fid, (int32)vg->alist[i].aref, "r")) == FAIL)
-            HGOTO_ERROR(DFE_CANTATTACH, FAIL);
-        if (HAatom_group(vsid) != VSIDGROUP)
-            HGOTO_ERROR(DFE_ARGS, FAIL);
-        if (NULL == (vs_inst = (vsinstance_t *)HAatom_object(vsid)))
-            HGOTO_ERROR(DFE_NOVS, FAIL);
-        if (NULL == (vs = vs_inst->vs) || HDstrcmp(vs->vsclass, _HDF_ATTRIBUTE) != 0)
-            HGOTO_ERROR(DFE_BADATTR, FAIL);
-        if (0 == HDstrcmp(vs->vsname, attrname)) {
-            ret_value = i;
-            found     = 1;
-        }
-        if (VSdetach(vsid) == FAIL)
-            HGOTO_ERROR(DFE_CANTDETACH, FAIL);
+
+    /* index the names of all the attributes the first time */
+    if (vg->attr_index == NULL) {
+        if (NULL == (idx = VIattr_index_new(vg->nattrs)))
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        for (i = 0; i < vg->nattrs; i++)
+            if (NULL == (attr_vs = VIattr_vdata(vg->f, vg->alist[i].aref)) ||
+                VIattr_index_add(idx, _HDF_VDATA, attr_vs->vsname, i) == FAIL) {
+                VIattr_index_free(idx);
+                HGOTO_ERROR(DFE_BADATTR, FAIL);
+            }
+        vg->attr_index = idx;
     }
+    ret_value = VIattr_index_find(vg->attr_index, _HDF_VDATA, attrname);
 
 done:
     return ret_value;
@@ -1441,6 +1796,57 @@ done:
     return ret_value;
 } /* Vgetattr */
 
+/* ----------  Vgetattrs  -----------------------
+NAME
+   Vgetattrs -- get all the attributes of a vgroup
+USAGE
+   intn Vgetattrs(int32 vgid, hdf_attr_t **attrs)
+   int32 vgid;          IN: vgroup id
+   hdf_attr_t **attrs;  OUT: the attributes; NULL if there are none
+RETURNS
+   Returns the number of attributes, FAIL otherwise
+DESCRIPTION
+   Returns the name, number type, count and values of every
+   attribute set by Vsetattr, in the order Vattrinfo numbers
+   them, in one buffer that the caller frees with free().
+   The attribute vdatas are not attached.
+------------------------------------------------- */
+intn
+Vgetattrs(int32 vgid, hdf_attr_t **attrs)
+{
+    VGROUP       *vg;
+    vginstance_t *v;
+    uint16       *refs = NULL;
+    intn          i;
+    intn          ret_value = FAIL;
+
+    HEclear();
+    if (HAatom_group(vgid) != VGIDGROUP || attrs == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    *attrs = NULL;
+    /* locate vg's index in vgtab */
+    if (NULL == (v = (vginstance_t *)HAatom_object(vgid)))
+        HGOTO_ERROR(DFE_VTAB, FAIL);
+    if (NULL == (vg = v->vg))
+        HGOTO_ERROR(DFE_BADPTR, FAIL);
+    if (vg->otag != DFTAG_VG)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (vg->nattrs == 0)
+        HGOTO_DONE(0);
+    if (vg->alist == NULL)
+        HGOTO_ERROR(DFE_BADATTR, FAIL);
+
+    if (NULL == (refs = (uint16 *)malloc((size_t)vg->nattrs * sizeof(uint16))))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < vg->nattrs; i++)
+        refs[i] = vg->alist[i].aref;
+    ret_value = VIgetattrs(vg->f, vg->nattrs, refs, attrs);
+
+done:
+    free(refs);
+    return ret_value;
+} /* Vgetattrs */
+
 /* ----------  Vgetattr2  -----------------------
 NAME
    Vgetattr2 -- read values of a vgroup attribute
@@ -421,6 +421,11 @@ VSsizeof(int32 vkey, /* IN vdata key */
         for (j = 0; j < vs->wlist.n; j++)
             totalsize += vs->wlist.esize[j];
     }
+    else if (vs->rlist.fields != NULL && !HDstrcmp(fields, vs->rlist.fields)) {
+        /* the same fields as the read list, no need to parse them again */
+        for (i = 0; i < vs->rlist.n; i++)
+            totalsize += vs->wlist.esize[vs->rlist.item[i]];
+    }
     else { /* parse field string */
         if ((scanattrs(fields, &ac, &av) < 0) || (ac < 1))
             HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -94,9 +94,49 @@ typedef struct dyn_vgattr_struct {
     uint16 atag, aref; /* tag/ref pair of the attr     */
 } vg_attr_t;
 
+/* Index of the attribute names of a vgroup or a vdata, so that Vfindattr
+   and VSfindattr do not attach every attribute vdata to compare names.
+   It is built on the first lookup; entries with the same hash of field
+   index and name are chained through 'next'. */
+typedef struct attr_name_struct {
+    char  *name;   /* name of the attribute */
+    int32  findex; /* field it belongs to, _HDF_VDATA for the object itself */
+    intn   aindex; /* index Vfindattr/VSfindattr returns for it */
+    intn   next;   /* next entry in the same bucket, -1 at the end */
+} attr_name_t;
+
+typedef struct attr_index_struct {
+    intn         nnames;   /* number of names in the index */
+    intn         maxnames; /* number of entries allocated */
+    intn         nbuckets; /* size of the bucket table, a power of 2 */
+    intn        *bucket;   /* first entry of each bucket, -1 if empty */
+    attr_name_t *names;    /* the entries */
+} attr_index_t;
+
+/* Index of the tag/ref pairs of a large vgroup, so that Vinsert, Vinqtagref
+   and Vdeletetagref do not compare every member.  It is built on the first
+   lookup in a vgroup of VG_MEMBER_INDEX_MIN members or more, then kept up
+   to date as members are added and deleted.  A pair may be in a vgroup
+   more than once, so each entry counts how many times; entries whose
+   count drops to 0 are kept for the pair to be added again. */
+typedef struct member_struct {
+    uint16 tag, ref; /* tag/ref pair of the member */
+    uintn  count;    /* number of times the pair is in the vgroup */
+    intn   next;     /* next entry in the same bucket, -1 at the end */
+} member_t;
+
+typedef struct member_index_struct {
+    intn      nentries;   /* number of entries in the index */
+    intn      maxentries; /* number of entries allocated */
+    intn      nbuckets;   /* size of the bucket table, a power of 2 */
+    intn     *bucket;     /* first entry of each bucket, -1 if empty */
+    member_t *entries;    /* the entries */
+} member_index_t;
+
 typedef struct dyn_read_struct {
-    intn  n;    /* # fields to read */
-    intn *item; /* index into vftable_struct */
+    intn  n;      /* # fields to read */
+    intn *item;   /* index into vftable_struct */
+    char *fields; /* field string the list was made from, NULL if none */
 } DYN_VREADLIST;
 
 /*
@@ -129,6 +169,8 @@ struct vgroup_desc {
     vg_attr_t *all_alist;              /* combined list; previous approach, only keep
                        just in case we come back to that approach; will
                        remove it once we decide not to go back 2/16/11 */
+    attr_index_t       *attr_index;    /* names of alist, built by Vfindattr */
+    member_index_t     *member_index;  /* tag/ref pairs of a large vgroup */
     int16               version, more; /* version and "more" field */
     struct vgroup_desc *next;          /* pointer to next node (for free list only) */
 };
@@ -163,6 +205,7 @@ struct vdata_desc {
                             bit 3-15  -- unused.   */
     intn                       nattrs;
     vs_attr_t                 *alist;         /* attribute list */
+    attr_index_t              *attr_index;    /* names of alist, built by VSfindattr */
     int16                      version, more; /* version and "more" field */
     int32                      aid;           /* access id - for LINKED blocks */
     struct vs_instance_struct *instance;      /* ptr to the instance struct for this VData */
@@ -233,12 +276,20 @@ void VSIrelease_vdata_node(VDATA *v);
 
 intn VSIgetvdatas(int32 id, const char *vsclass, const uintn start_vd, const uintn n_vds, uint16 *refarray);
 
+intn VSIreadattr(HFILEID f, uint16 ref, void *values);
+
 HDFLIBAPI vsinstance_t *VSIget_vsinstance_node(void);
 
 HDFLIBAPI void VSIrelease_vsinstance_node(vsinstance_t *vs);
 
 VGROUP *VIget_vgroup_node(void);
 
+intn VIattr_index_add(attr_index_t *idx, int32 findex, const char *name, intn aindex);
+
+void VIattr_index_free(attr_index_t *idx);
+
+void VImember_index_free(member_index_t *idx);
+
 void VIrelease_vgroup_node(VGROUP *v);
 
 HDFLIBAPI vginstance_t *VIget_vginstance_node(void);
@@ -71,6 +71,7 @@ EXPORTED ROUTINES
  VQuerytag    -- Return the tag of this Vgroup.
  VQueryref    -- Return the ref of this Vgroup.
  Vaddtagref   -- Inserts a tag/ref pair into the attached vgroup vg.
+ Vaddtagrefs  -- Inserts n tag/ref pairs into the attached vgroup vg.
  vinsertpair  -- Inserts a tag/ref pair into the attached vgroup vg.
  Ventries     -- Returns the num of entries (+ve integer) in the vgroup vgid.
  Vsetname     -- Gives a name to the VGROUP vg.
@@ -109,6 +110,9 @@ EXPORTED ROUTINES
 #define HDF_NUM_INTERNAL_VGS 6
 const char *HDF_INTERNAL_VGS[] = {_HDF_VARIABLE, _HDF_DIMENSION, _HDF_UDIMENSION, _HDF_CDF, GR_NAME, RI_NAME};
 
+/* number of members from which the tag/ref pairs of a vgroup are indexed */
+#define VG_MEMBER_INDEX_MIN 64
+
 /* Prototypes */
 extern void vprint(void *k1);
 
@@ -120,6 +124,8 @@ static intn vunpackvg(VGROUP *vg, uint8 buf[], intn len);
 
 static intn VIstart(void);
 
+static intn VIismember(VGROUP *vg, uint16 tag, uint16 ref);
+
 /*
  * --------------------------------------------------------------------
  * Private data structure and routines.
@@ -386,10 +392,8 @@ Load_vfile(HFILEID f /* IN: file handle */)
         v->key = (int32)ref; /* set the key for the node */
         v->ref = (uintn)ref;
 
-        /* get the header information */
-        v->vg = VPgetinfo(f, ref);
-        if (v->vg == NULL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        /* the header is read by vginst, when the vgroup is first used */
+        v->vg = NULL;
 
         /* insert the vg instance in B-tree */
         tbbtdins(vf->vgtree, (void *)v, NULL);
@@ -430,10 +434,8 @@ Load_vfile(HFILEID f /* IN: file handle */)
         w->key = (int32)ref; /* set the key for the node */
         w->ref = (uintn)ref;
 
-        /* get the header information */
-        w->vs = VSPgetinfo(f, ref);
-        if (w->vs == NULL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        /* the header is read by vsinst, when the vdata is first used */
+        w->vs = NULL;
 
         w->nattach   = 0;
         w->nvertices = 0;
@@ -582,6 +584,8 @@ vdestroynode(void *n /* IN: node to free */)
             free(vg->vgname);
             free(vg->vgclass);
             free(vg->alist);
+            VIattr_index_free(vg->attr_index);
+            VImember_index_free(vg->member_index);
 
             /* Free the old-style attr list and reset associated fields */
             if (vg->old_alist != NULL) {
@@ -719,7 +723,13 @@ vginst(HFILEID f, /* IN: file handle */
     key = (int32)vgid;
     t   = (void **)tbbtdfind(vf->vgtree, (void *)&key, NULL);
     if (t != NULL) {
-        ret_value = ((vginstance_t *)*t); /* return the actual vginstance_t ptr */
+        vginstance_t *v = (vginstance_t *)*t;
+
+        /* read the header of a vgroup in the file the first time */
+        if (v->vg == NULL && (v->vg = VPgetinfo(f, vgid)) == NULL)
+            HGOTO_ERROR(DFE_INTERNAL, NULL);
+
+        ret_value = v; /* return the actual vginstance_t ptr */
         goto done;
     }
 
@@ -1296,6 +1306,210 @@ done:
     return ret_value;
 } /* Vdetach */
 
+/*******************************************************************************
+NAME
+   VImember_hash
+
+DESCRIPTION
+   Hash of a tag/ref pair, for the member index of a vgroup.
+
+RETURNS
+   The hash value.
+
+*******************************************************************************/
+static uint32
+VImember_hash(uint16 tag, uint16 ref)
+{
+    uint32 h = (((uint32)tag << 16) | (uint32)ref) * 2654435761U;
+
+    return h ^ (h >> 16);
+} /* VImember_hash */
+
+/*******************************************************************************
+NAME
+   VImember_index_find
+
+DESCRIPTION
+   Looks up a tag/ref pair in the member index of a vgroup.
+
+RETURNS
+   The entry of the pair, NULL if the pair was never in the index.
+   The count of the entry is 0 if the pair has been deleted since.
+
+*******************************************************************************/
+static member_t *
+VImember_index_find(const member_index_t *idx, /* IN: member index */
+                    uint16 tag, uint16 ref /* IN: tag/ref pair to find */)
+{
+    intn i = idx->bucket[VImember_hash(tag, ref) & ((uint32)idx->nbuckets - 1)];
+
+    for (; i != -1; i = idx->entries[i].next)
+        if (idx->entries[i].tag == tag && idx->entries[i].ref == ref)
+            return &idx->entries[i];
+    return NULL;
+} /* VImember_index_find */
+
+/*******************************************************************************
+NAME
+   VImember_index_add
+
+DESCRIPTION
+   Counts one more occurrence of a tag/ref pair in the member index of a
+   vgroup, adding an entry for the pair if it has none.  The buckets
+   double when there are more entries than buckets.
+
+RETURNS
+   SUCCEED, or FAIL if out of memory.
+
+*******************************************************************************/
+static intn
+VImember_index_add(member_index_t *idx, /* IN: member index */
+                   uint16 tag, uint16 ref /* IN: tag/ref pair to add */)
+{
+    member_t *entry;
+    uint32    b;
+    intn      i;
+    intn      ret_value = SUCCEED;
+
+    if ((entry = VImember_index_find(idx, tag, ref)) != NULL) {
+        entry->count++;
+        HGOTO_DONE(SUCCEED);
+    }
+
+    if (idx->nentries == idx->maxentries) {
+        intn      nbuckets = idx->nbuckets * 2;
+        intn     *bucket;
+        member_t *entries;
+
+        if (NULL == (entries = realloc(idx->entries, (size_t)nbuckets * sizeof(member_t))))
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        idx->entries    = entries;
+        idx->maxentries = nbuckets;
+        if (NULL == (bucket = realloc(idx->bucket, (size_t)nbuckets * sizeof(intn))))
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        idx->bucket   = bucket;
+        idx->nbuckets = nbuckets;
+
+        /* chain the entries again in the larger table */
+        memset(idx->bucket, 0xff, (size_t)nbuckets * sizeof(intn));
+        for (i = 0; i < idx->nentries; i++) {
+            b = VImember_hash(idx->entries[i].tag, idx->entries[i].ref) & ((uint32)nbuckets - 1);
+
+            idx->entries[i].next = idx->bucket[b];
+            idx->bucket[b]       = i;
+        } /* end for */
+    }     /* end if */
+
+    entry        = &idx->entries[idx->nentries];
+    entry->tag   = tag;
+    entry->ref   = ref;
+    entry->count = 1;
+
+    b              = VImember_hash(tag, ref) & ((uint32)idx->nbuckets - 1);
+    entry->next    = idx->bucket[b];
+    idx->bucket[b] = idx->nentries++;
+
+done:
+    return ret_value;
+} /* VImember_index_add */
+
+/*******************************************************************************
+NAME
+   VImember_index_free
+
+DESCRIPTION
+   Frees the member index of a vgroup.  'idx' may be NULL.
+
+RETURNS
+   Nothing
+
+*******************************************************************************/
+void
+VImember_index_free(member_index_t *idx /* IN: member index */)
+{
+    if (idx == NULL)
+        return;
+    free(idx->entries);
+    free(idx->bucket);
+    free(idx);
+} /* VImember_index_free */
+
+/*******************************************************************************
+NAME
+   VImember_index_build
+
+DESCRIPTION
+   Builds the member index of a vgroup from its tag/ref arrays.
+
+RETURNS
+   The new index, NULL if out of memory.
+
+*******************************************************************************/
+static member_index_t *
+VImember_index_build(VGROUP *vg /* IN: vgroup struct */)
+{
+    member_index_t *idx = NULL;
+    intn            nbuckets;
+    uintn           u;
+
+    for (nbuckets = VG_MEMBER_INDEX_MIN; nbuckets < (intn)vg->nvelt; nbuckets *= 2)
+        ;
+
+    if (NULL == (idx = (member_index_t *)calloc(1, sizeof(member_index_t))))
+        return NULL;
+    idx->bucket  = (intn *)malloc((size_t)nbuckets * sizeof(intn));
+    idx->entries = (member_t *)malloc((size_t)nbuckets * sizeof(member_t));
+    if (idx->bucket == NULL || idx->entries == NULL) {
+        VImember_index_free(idx);
+        return NULL;
+    }
+    memset(idx->bucket, 0xff, (size_t)nbuckets * sizeof(intn)); /* all -1 */
+    idx->nbuckets   = nbuckets;
+    idx->maxentries = nbuckets;
+
+    for (u = 0; u < (uintn)vg->nvelt; u++)
+        if (VImember_index_add(idx, vg->tag[u], vg->ref[u]) == FAIL) {
+            VImember_index_free(idx);
+            return NULL;
+        }
+    return idx;
+} /* VImember_index_build */
+
+/*******************************************************************************
+NAME
+   VIismember
+
+DESCRIPTION
+   Checks whether a tag/ref pair is a member of a vgroup.  A small vgroup
+   is searched member by member; for a large one the member index is
+   built on the first call and used from then on.  If there is no memory
+   for the index, the members are searched one by one.
+
+RETURNS
+   TRUE if the pair is in the vgroup, FALSE if not.
+
+*******************************************************************************/
+static intn
+VIismember(VGROUP *vg, /* IN: vgroup struct */
+           uint16 tag, uint16 ref /* IN: tag/ref pair to look for */)
+{
+    member_t *entry;
+    uintn     u;
+
+    if (vg->member_index == NULL && vg->nvelt >= VG_MEMBER_INDEX_MIN)
+        vg->member_index = VImember_index_build(vg);
+
+    if (vg->member_index != NULL) {
+        entry = VImember_index_find(vg->member_index, tag, ref);
+        return (entry != NULL && entry->count > 0) ? TRUE : FALSE;
+    }
+
+    for (u = 0; u < (uintn)vg->nvelt; u++)
+        if (vg->tag[u] == tag && vg->ref[u] == ref)
+            return TRUE;
+    return FALSE;
+} /* VIismember */
+
 /*******************************************************************************
 NAME
    Vinsert
@@ -1321,7 +1535,6 @@ Vinsert(int32 vkey, /* IN: vgroup key */
     uint16        newtag = 0;
     uint16        newref = 0;
     int32         newfid;
-    uintn         u;
     int32         ret_value = SUCCEED;
 
     /* clear error stack */
@@ -1382,10 +1595,8 @@ Vinsert(int32 vkey, /* IN: vgroup key */
         HGOTO_ERROR(DFE_DIFFFILES, FAIL);
 
     /* check and prevent duplicate links */
-    for (u = 0; u < (uintn)vg->nvelt; u++) {
-        if ((vg->ref[u] == newref) && (vg->tag[u] == newtag))
-            HGOTO_ERROR(DFE_DUPDD, FAIL);
-    }
+    if (VIismember(vg, newtag, newref))
+        HGOTO_ERROR(DFE_DUPDD, FAIL);
 
     /* Finally, ok to insert */
     if (vinsertpair(vg, newtag, newref) == FAIL)
@@ -1480,7 +1691,6 @@ Vinqtagref(int32 vkey, /* IN: vgroup key */
            int32 tag,  /* IN: tag to check in vgroup */
            int32 ref /* IN: ref to check in vgroup */)
 {
-    uintn         u;
     uint16        ttag;
     uint16        rref;
     vginstance_t *v         = NULL;
@@ -1506,10 +1716,7 @@ Vinqtagref(int32 vkey, /* IN: vgroup key */
     ttag = (uint16)tag;
     rref = (uint16)ref;
 
-    for (u = 0; u < (uintn)vg->nvelt; u++) {
-        if ((ttag == vg->tag[u]) && (rref == vg->ref[u]))
-            HGOTO_DONE(TRUE);
-    }
+    ret_value = VIismember(vg, ttag, rref);
 
 done:
     return ret_value;
@@ -1535,7 +1742,7 @@ Vdeletetagref(int32 vkey, /* IN: vgroup key */
               int32 tag,  /* IN: tag to delete in vgroup */
               int32 ref /* IN: ref to delete in vgroup */)
 {
-    uintn         i, j;             /* loop indices */
+    uintn         i, j;             /* loop index, number of elements to shift */
     uint16        ttag;             /* tag for comparison */
     uint16        rref;             /* ref for comparison */
     vginstance_t *v         = NULL; /* vgroup instance struct */
@@ -1569,6 +1776,10 @@ Vdeletetagref(int32 vkey, /* IN: vgroup key */
     ttag = (uint16)tag;
     rref = (uint16)ref;
 
+    /* no need to look for a pair that is not in the vgroup */
+    if (!VIismember(vg, ttag, rref))
+        HGOTO_DONE(FAIL);
+
     /* look through elements in vgroup */
     for (i = 0; i < (uintn)vg->nvelt; i++) { /* see if element tag/ref matches search tag/ref */
         if ((ttag == vg->tag[i]) &&
@@ -1579,18 +1790,19 @@ Vdeletetagref(int32 vkey, /* IN: vgroup key */
                                        are more occurrences and then delete them.*/
 
             /* check if element found is last one in vgroup */
-            if (i != ((uintn)vg->nvelt - 1)) { /* Basically shifts the contents of the array down by one.
-                                                  This method will preserve the order without using
-                                                  extra memory for storage etc. If speed/performance
-                                                  is an issue you can use memmove()/memcpy(). */
-                for (j = i; j < (uintn)vg->nvelt - 1; j++) {
-                    vg->tag[j] = vg->tag[j + 1];
-                    vg->ref[j] = vg->ref[j + 1];
-                }
+            if (i != ((uintn)vg->nvelt - 1)) { /* Shift the contents of the arrays down by one,
+                                                  preserving the order. */
+                j = (uintn)vg->nvelt - 1 - i;
+                memmove(&vg->tag[i], &vg->tag[i + 1], j * sizeof(uint16));
+                memmove(&vg->ref[i], &vg->ref[i + 1], j * sizeof(uint16));
             }
             /* else if last one , do nothing and allow the
                number of elements to be decrementd. */
 
+            /* one occurrence less of the pair */
+            if (vg->member_index != NULL)
+                VImember_index_find(vg->member_index, ttag, rref)->count--;
+
             /* reset last ones, just to be sure  */
             vg->tag[(uintn)vg->nvelt - 1] = DFTAG_NULL;
             vg->ref[(uintn)vg->nvelt - 1] = 0; /* invalid ref */
@@ -1911,12 +2123,9 @@ Vaddtagref(int32 vkey, /* IN: vgroup key */
            int32 tag,  /* IN: tag to add */
            int32 ref /* IN: ref to add */)
 {
-    vginstance_t *v  = NULL;
-    VGROUP       *vg = NULL;
-#ifdef NO_DUPLICATES
-    uintn i;
-#endif /* NO_DUPLICATES */
-    int32 ret_value = SUCCEED;
+    vginstance_t *v         = NULL;
+    VGROUP       *vg        = NULL;
+    int32         ret_value = SUCCEED;
 
     /* clear error stack */
     HEclear();
@@ -1938,9 +2147,8 @@ Vaddtagref(int32 vkey, /* IN: vgroup key */
     /* SD interface needs duplication if two dims have the same name.
        So, don't remove the ifdef/endif pair.   */
     /* make sure doesn't already exist in the Vgroup */
-    for (i = 0; i < vg->nvelt; i++)
-        if ((tag == vg->tag[i]) && (ref == vg->ref[i]))
-            HGOTO_DONE(FAIL);
+    if (VIismember(vg, (uint16)tag, (uint16)ref))
+        HGOTO_DONE(FAIL);
 #endif /* NO_DUPLICATES  */
 
     ret_value = vinsertpair(vg, (uint16)tag, (uint16)ref);
@@ -1949,6 +2157,86 @@ done:
     return ret_value;
 } /* Vaddtagref */
 
+/*******************************************************************************
+NAME
+  Vaddtagrefs
+
+DESCRIPTION
+  Inserts n tag/ref pairs into the attached vgroup vg, in the order given.
+  Works as n calls to Vaddtagref, but the tag/ref space of the vgroup is
+  expanded once for all the pairs.
+  If error, returns FAIL and no tag/ref is inserted.
+  If OK, returns the total number of tag/refs in the vgroup (a +ve integer).
+
+RETURNS
+
+*******************************************************************************/
+int32
+Vaddtagrefs(int32       vkey,   /* IN: vgroup key */
+            int32       n,      /* IN: number of pairs to add */
+            const int32 tags[], /* IN: tags to add */
+            const int32 refs[] /* IN: refs to add */)
+{
+    vginstance_t *v  = NULL;
+    VGROUP       *vg = NULL;
+    intn          msize;
+    uint16       *ptr;
+    int32         i;
+    int32         ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check if vgroup is valid */
+    if (HAatom_group(vkey) != VGIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (n < 0 || (n > 0 && (tags == NULL || refs == NULL)))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get instance of vgroup */
+    if (NULL == (v = (vginstance_t *)HAatom_object(vkey)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+
+    /* get vgroup itself and check */
+    vg = v->vg;
+    if (vg == NULL)
+        HGOTO_ERROR(DFE_BADPTR, FAIL);
+
+    /* the number of elements of a vgroup is stored in 16 bits */
+    if ((int32)vg->nvelt + n > (int32)MAX_REF)
+        HGOTO_ERROR(DFE_EXCEEDMAX, FAIL);
+
+#ifdef NO_DUPLICATES
+    /* make sure none already exists in the Vgroup */
+    for (i = 0; i < n; i++)
+        if (VIismember(vg, (uint16)tags[i], (uint16)refs[i]))
+            HGOTO_DONE(FAIL);
+#endif /* NO_DUPLICATES  */
+
+    /* expand the tag/ref space once for all the pairs */
+    for (msize = vg->msize; msize < (intn)vg->nvelt + n; msize *= 2)
+        ;
+    if (msize > vg->msize) {
+        if (NULL == (ptr = (uint16 *)realloc((void *)vg->tag, (size_t)msize * sizeof(uint16))))
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        vg->tag = ptr;
+        if (NULL == (ptr = (uint16 *)realloc((void *)vg->ref, (size_t)msize * sizeof(uint16))))
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        vg->ref   = ptr;
+        vg->msize = msize;
+    }
+
+    for (i = 0; i < n; i++)
+        if (vinsertpair(vg, (uint16)tags[i], (uint16)refs[i]) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    ret_value = ((int32)vg->nvelt);
+
+done:
+    return ret_value;
+} /* Vaddtagrefs */
+
 /*******************************************************************************
 NAME
   vinsertpair
@@ -1985,6 +2273,13 @@ vinsertpair(VGROUP *vg,  /* IN: vgroup struct */
     vg->ref[(uintn)vg->nvelt] = ref;
     vg->nvelt++;
 
+    /* keep the member index up to date; without memory for it, drop it
+       and let the members be searched one by one */
+    if (vg->member_index != NULL && VImember_index_add(vg->member_index, tag, ref) == FAIL) {
+        VImember_index_free(vg->member_index);
+        vg->member_index = NULL;
+    }
+
     vg->marked = TRUE;
     ret_value  = ((int32)vg->nvelt);
 
@@ -259,6 +259,7 @@ vsinst(HFILEID f, /* IN: File handle */
 {
     void        **t  = NULL;
     vfile_t      *vf = NULL;
+    vsinstance_t *w  = NULL;
     int32         key;
     vsinstance_t *ret_value = NULL; /* FAIL */
 
@@ -274,8 +275,14 @@ vsinst(HFILEID f, /* IN: File handle */
     if ((t = (void **)tbbtdfind(vf->vstree, &key, NULL)) == NULL)
         HGOTO_ERROR(DFE_NOMATCH, NULL);
 
+    w = (vsinstance_t *)*t;
+
+    /* read the header of a vdata in the file the first time */
+    if (w->vs == NULL && (w->vs = VSPgetinfo(f, vsid)) == NULL)
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
+
     /* return the actual vsinstance_t ptr */
-    ret_value = ((vsinstance_t *)*t);
+    ret_value = w;
 
 done:
     return ret_value;
@@ -653,8 +660,10 @@ vsdestroynode(void *n /* IN: Node in TBBT-tree */)
             free(vs->wlist.bptr);
 
             free(vs->rlist.item);
+            free(vs->rlist.fields);
 
             free(vs->alist);
+            VIattr_index_free(vs->attr_index);
 
             VSIrelease_vdata_node(vs);
         }
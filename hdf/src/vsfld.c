@@ -97,6 +97,12 @@ VSsetfields(int32 vkey, const char *fields)
     if (vs == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    /* a vdata with records is usually read again and again with the same
+       fields, e.g. when it is attached many times; its read list is then
+       still right and does not need to be parsed again */
+    if (vs->nvertices > 0 && vs->rlist.fields != NULL && !HDstrcmp(fields, vs->rlist.fields))
+        HGOTO_DONE(SUCCEED);
+
     if ((scanattrs(fields, &ac, &av) == FAIL) || (ac == 0))
         HGOTO_ERROR(DFE_BADFIELDS, FAIL);
 
@@ -220,6 +226,8 @@ VSsetfields(int32 vkey, const char *fields)
         rlist->n = 0;
         free(rlist->item);
         rlist->item = NULL;
+        free(rlist->fields);
+        rlist->fields = NULL;
 
         /* Allocate enough space for the read list */
         if ((rlist->item = (intn *)malloc(sizeof(intn) * (size_t)(ac))) == NULL)
@@ -237,7 +245,10 @@ VSsetfields(int32 vkey, const char *fields)
             if (!found) /* field does not exist - error */
                 HGOTO_ERROR(DFE_BADFIELDS, FAIL);
         }
-        ret_value = SUCCEED;
+
+        /* remember the fields for the next call; not an error if no memory */
+        rlist->fields = HDstrdup(fields);
+        ret_value     = SUCCEED;
     } /* setting read list */
 
 done:
@@ -82,20 +82,32 @@ set (HDF4_TESTHDF_FILES
     tdf24.hdf
     tdfan.hdf
     temp.hdf
+    tfree.hdf
     thf.hdf
+    timage.hdf
+    twbuf.hdf
+    tprealloc.hdf
+    tnoprealloc.hdf
+    tlimit.hdf
     tjpeg.hdf
     tlongnames.hdf
     tman.hdf
+    tman_many.hdf
     tmgr.hdf
     tmgratt.hdf
     tmgrchk.hdf
+    tmgridx.hdf
     tnbit.hdf
+    tnewref.hdf
+    tpool.hdf
     tref.hdf
     tuservds.hdf
     tuservgs.hdf
     tvattr.hdf
     tvpack.hdf
     tvsempty.hdf
+    tvsfields.hdf
+    tvgmembers.hdf
     tvset.hdf
     tvsetext.hdf
     tx.hdf
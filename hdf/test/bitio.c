@@ -63,6 +63,8 @@
 #define BITIO_REF_2 2500
 #define BITIO_TAG_3 3500
 #define BITIO_REF_3 3500
+#define BITIO_TAG_4 4500
+#define BITIO_REF_4 4500
 
 static uint8 outbuf[BUFSIZE], inbuf[DATASIZE];
 
@@ -78,6 +80,7 @@ static uint32 maskbuf[] = {0x00000000,   0x00000001,   0x00000003,  0x00000007,
 static void test_bitio_write(void);
 static void test_bitio_read(void);
 static void test_bitio_seek(void);
+static void test_bitio_read_n(void);
 
 static void
 test_bitio_write(void)
@@ -399,10 +402,85 @@ test_bitio_seek(void)
     RESULT("Hclose");
 } /* test_bitio_seek() */
 
+static void
+test_bitio_read_n(void)
+{
+    static const intn widths[] = {1, 7, 13, 24, 32};
+    int32             fid;
+    int32             bitid1;
+    int32             ret;
+    intn              w;
+    intn              i;
+
+    SEED((uintn)time(NULL));
+
+    MESSAGE(6, printf("Testing bitio batched read routine\n"););
+
+    fid = Hopen(TESTFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    for (w = 0; w < (intn)(sizeof(widths) / sizeof(widths[0])); w++) {
+        MESSAGE(8, printf("Reading %d-bit fields\n", (int)widths[w]););
+        for (i = 0; i < BUFSIZE; i++)
+            outbuf2[i] = (uintn)RAND() & maskbuf[widths[w]];
+
+        bitid1 = Hstartbitwrite(fid, BITIO_TAG_4, (uint16)(BITIO_REF_4 + w), 0);
+        CHECK_VOID(bitid1, FAIL, "Hstartbitwrite");
+
+        ret = Hbitappendable(bitid1);
+        RESULT("Hbitappendable");
+
+        for (i = 0; i < BUFSIZE; i++) {
+            ret = Hbitwrite(bitid1, widths[w], outbuf2[i]);
+            VERIFY_VOID(ret, widths[w], "Hbitwrite");
+        } /* end for */
+
+        ret = Hendbitaccess(bitid1, 0);
+        RESULT("Hbitendaccess");
+
+        memset(inbuf2, 0, sizeof(inbuf2));
+        bitid1 = Hstartbitread(fid, BITIO_TAG_4, (uint16)(BITIO_REF_4 + w));
+        CHECK_VOID(bitid1, FAIL, "Hstartbitread");
+
+        /* mix single and batched reads so the bit buffer is handed back and forth */
+        ret = Hbitread(bitid1, widths[w], &inbuf2[0]);
+        VERIFY_VOID(ret, widths[w], "Hbitread");
+        ret = Hbitread_n(bitid1, widths[w], BUFSIZE / 2 - 1, &inbuf2[1]);
+        VERIFY_VOID(ret, BUFSIZE / 2 - 1, "Hbitread_n");
+        ret = Hbitread(bitid1, widths[w], &inbuf2[BUFSIZE / 2]);
+        VERIFY_VOID(ret, widths[w], "Hbitread");
+        ret = Hbitread_n(bitid1, widths[w], BUFSIZE / 2 - 1, &inbuf2[BUFSIZE / 2 + 1]);
+        VERIFY_VOID(ret, BUFSIZE / 2 - 1, "Hbitread_n");
+
+        if (memcmp(outbuf2, inbuf2, sizeof(uint32) * BUFSIZE) != 0) {
+            printf("Error in batched reading of %d-bit fields\n", (int)widths[w]);
+            num_errs++;
+        } /* end if */
+
+        /* seek back into the middle and read the rest again */
+        ret = Hbitseek(bitid1, (int32)((widths[w] * 100) / 8), (intn)((widths[w] * 100) % 8));
+        CHECK_VOID(ret, FAIL, "Hbitseek");
+        ret = Hbitread_n(bitid1, widths[w], BUFSIZE - 100, &inbuf2[100]);
+        VERIFY_VOID(ret, BUFSIZE - 100, "Hbitread_n");
+
+        if (memcmp(outbuf2, inbuf2, sizeof(uint32) * BUFSIZE) != 0) {
+            printf("Error in batched reading of %d-bit fields after seek\n", (int)widths[w]);
+            num_errs++;
+        } /* end if */
+
+        ret = Hendbitaccess(bitid1, 0);
+        RESULT("Hbitendaccess");
+    } /* end for */
+
+    ret = Hclose(fid);
+    RESULT("Hclose");
+} /* test_bitio_read_n() */
+
 void
 test_bitio(void)
 {
     test_bitio_read();
     test_bitio_write();
     test_bitio_seek();
+    test_bitio_read_n();
 }
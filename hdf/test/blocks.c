@@ -18,6 +18,10 @@
 
 #define HLCONVERT_TAG 1500
 
+/* size and number of the pieces appended to the element that is grown */
+#define GROW_PIECE   4000
+#define GROW_NPIECES 80
+
 static uint8 outbuf[BUFSIZE], inbuf[BUFSIZE];
 
 void
@@ -267,5 +271,77 @@ test_hblocks(void)
         errors++;
     }
 
+    MESSAGE(5, printf("Growing an appendable element into Linked Blocks\n"););
+    fid = Hopen(TESTFILE_NAME, DFACC_WRITE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    ref = Hnewref(fid);
+    aid = Hstartaccess(fid, HLCONVERT_TAG, ref, DFACC_WRITE | DFACC_APPENDABLE);
+    CHECK_VOID(aid, FAIL, "Hstartaccess");
+
+    /* grow the element in place to 3 pieces */
+    for (i = 0; i < 3; i++) {
+        ret = Hwrite(aid, GROW_PIECE, outbuf);
+        VERIFY_VOID(ret, GROW_PIECE, "Hwrite");
+    }
+
+    /* write something after it, so the next piece converts it */
+    ret = Hputelement(fid, HLCONVERT_TAG, Hnewref(fid), outbuf, 16);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+
+    for (i = 3; i < GROW_NPIECES; i++) {
+        ret = Hwrite(aid, GROW_PIECE, outbuf);
+        VERIFY_VOID(ret, GROW_PIECE, "Hwrite");
+    }
+
+    /* the blocks are sized from the 3 pieces, not the default length */
+    {
+        int32 first_length, block_length, number_blocks;
+
+        ret = HDinqblockinfo(aid, &length, &first_length, &block_length, &number_blocks);
+        CHECK_VOID(ret, FAIL, "HDinqblockinfo");
+        VERIFY_VOID(length, GROW_PIECE * GROW_NPIECES, "HDinqblockinfo");
+        VERIFY_VOID(first_length, GROW_PIECE * 3, "HDinqblockinfo");
+        VERIFY_VOID(block_length, 4 * HDF_APPENDABLE_BLOCK_LEN, "HDinqblockinfo");
+    }
+
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* read it back across the block tables, in order and after a seek */
+    fid = Hopen(TESTFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    aid = Hstartread(fid, HLCONVERT_TAG, ref);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+
+    for (i = 0; i < GROW_NPIECES; i++) {
+        ret = Hread(aid, GROW_PIECE, inbuf);
+        VERIFY_VOID(ret, GROW_PIECE, "Hread");
+        if (memcmp(inbuf, outbuf, GROW_PIECE)) {
+            fprintf(stderr, "Error when reading piece %d of grown element\n", i);
+            errors++;
+            break;
+        }
+    }
+
+    ret = Hseek(aid, GROW_PIECE * (GROW_NPIECES - 2) + 100, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+    ret = Hread(aid, GROW_PIECE, inbuf);
+    VERIFY_VOID(ret, GROW_PIECE, "Hread");
+    if (memcmp(inbuf, outbuf + 100, GROW_PIECE - 100) || memcmp(inbuf + GROW_PIECE - 100, outbuf, 100)) {
+        fprintf(stderr, "Error when reading grown element after seeking\n");
+        errors++;
+    }
+
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
     num_errs += errors; /* increment global error count */
 }
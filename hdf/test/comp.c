@@ -33,6 +33,7 @@
 #include <time.h>
 #include "tproto.h"
 #include "hfile.h"
+#include "hcompi.h"
 
 #define TESTFILE_NAME "tcomp.hdf"
 
@@ -95,6 +96,8 @@ static void   free_buffers(void);
 static uint16 write_data(int32 fid, comp_model_t m_type, model_info *m_info, comp_coder_t c_type,
                          comp_info *c_info, intn test_num, int32 ntype);
 static void   read_data(int32 fid, uint16 ref_num, intn test_num, int32 ntype);
+static void   test_rle_pieces(int32 fid);
+static void   test_skphuff_tail(int32 fid);
 
 static void
 init_model_info(comp_model_t m_type, model_info *m_info, int32 test_ntype)
@@ -381,6 +384,184 @@ read_data(int32 fid, uint16 ref_num, intn test_num, int32 ntype)
     CHECK_VOID(err_ret, FAIL, "Hendaccess");
 } /* end read_data() */
 
+/* # of bytes in the element written by test_rle_pieces(), a few times the
+   size of the RLE coder's I/O buffer */
+#define RLE_PIECES_SIZE (3 * RLE_IO_BUF_SIZE + 123)
+
+/* Write and read an RLE element in pieces which do not line up with the
+   RLE coder's I/O buffer */
+static void
+test_rle_pieces(int32 fid)
+{
+    model_info m_info;
+    comp_info  c_info;
+    uint8     *outbuf;
+    uint8     *inbuf;
+    uint16     ref;
+    int32      aid;
+    int32      ret;
+    int32      pos;
+    int32      len;
+    int32      i;
+
+    MESSAGE(6, printf("Testing RLE elements written and read in pieces\n");)
+
+    outbuf = (uint8 *)malloc(RLE_PIECES_SIZE);
+    inbuf  = (uint8 *)malloc(RLE_PIECES_SIZE);
+    CHECK_ALLOC(outbuf, "outbuf", "test_rle_pieces");
+    CHECK_ALLOC(inbuf, "inbuf", "test_rle_pieces");
+
+    /* alternate runs with bytes which do not repeat, so the compressed
+       element is also larger than the I/O buffer */
+    for (i = 0; i < RLE_PIECES_SIZE; i++)
+        outbuf[i] = (uint8)(((i / 300) % 2) ? i / 300 : (i * 7) % 251);
+
+    init_model_info(COMP_MODEL_STDIO, &m_info, DFNT_UINT8);
+    init_coder_info(COMP_CODE_RLE, &c_info, DFNT_UINT8);
+    ref = Hnewref(fid);
+    aid = HCcreate(fid, COMP_TAG, ref, COMP_MODEL_STDIO, &m_info, COMP_CODE_RLE, &c_info);
+    CHECK_VOID(aid, FAIL, "HCcreate");
+    for (pos = 0; pos < RLE_PIECES_SIZE; pos += len) {
+        len = MIN(1000, RLE_PIECES_SIZE - pos);
+        ret = Hwrite(aid, len, &outbuf[pos]);
+        VERIFY_VOID(ret, len, "Hwrite");
+    } /* end for */
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    aid = Hstartread(fid, COMP_TAG, ref);
+    CHECK_VOID(aid, FAIL, "Hstartread");
+    for (pos = 0; pos < RLE_PIECES_SIZE; pos += len) {
+        len = MIN(777, RLE_PIECES_SIZE - pos);
+        ret = Hread(aid, len, &inbuf[pos]);
+        VERIFY_VOID(ret, len, "Hread");
+    } /* end for */
+    if (memcmp(inbuf, outbuf, RLE_PIECES_SIZE) != 0) {
+        fprintf(stderr, "ERROR: Data read in pieces from the RLE element differs\n");
+        num_errs++;
+    } /* end if */
+
+    /* seek back across a buffer boundary and read again */
+    ret = Hseek(aid, RLE_IO_BUF_SIZE - 10, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+    ret = Hread(aid, 20, inbuf);
+    VERIFY_VOID(ret, 20, "Hread");
+    if (memcmp(inbuf, &outbuf[RLE_IO_BUF_SIZE - 10], 20) != 0) {
+        fprintf(stderr, "ERROR: Data read after seeking in the RLE element differs\n");
+        num_errs++;
+    } /* end if */
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    free(outbuf);
+    free(inbuf);
+} /* end test_rle_pieces() */
+
+/* # of bytes in the elements written by test_skphuff_tail(), odd sizes so
+   the last code ends anywhere in the last word read by the decoder */
+static const int32 skphuff_tail_sizes[] = {1, 2, 3, 5, 17, 1001, 4099};
+
+/* Write skipping Huffman elements in two parts, the second one appended after
+   seeking to the end, and read them back up to and near their end */
+static void
+test_skphuff_tail(int32 fid)
+{
+    model_info m_info;
+    comp_info  c_info;
+    uint8      outbuf[4099];
+    uint8      inbuf[4099];
+    uint16     ref, whole_ref;
+    int32      aid;
+    int32      ret;
+    int32      comp_size, whole_comp_size;
+    int32      orig_size;
+    int32      size;
+    int32      first;
+    int32      pos;
+    int32      len;
+    int32      i;
+    intn       skip, k;
+
+    MESSAGE(6, printf("Testing the end of skipping Huffman elements\n");)
+
+    for (i = 0; i < (int32)sizeof(outbuf); i++)
+        outbuf[i] = (uint8)((i * i + i / 7) % 251);
+
+    init_model_info(COMP_MODEL_STDIO, &m_info, DFNT_UINT8);
+    for (skip = 1; skip <= 4; skip += 3)
+        for (k = 0; k < (intn)(sizeof(skphuff_tail_sizes) / sizeof(skphuff_tail_sizes[0])); k++) {
+            size                    = skphuff_tail_sizes[k];
+            first                   = size - size / 3;
+            c_info.skphuff.skp_size = skip;
+
+            ref = Hnewref(fid);
+            aid = HCcreate(fid, COMP_TAG, ref, COMP_MODEL_STDIO, &m_info, COMP_CODE_SKPHUFF, &c_info);
+            CHECK_VOID(aid, FAIL, "HCcreate");
+            ret = Hwrite(aid, first, outbuf);
+            VERIFY_VOID(ret, first, "Hwrite");
+            ret = Hendaccess(aid);
+            CHECK_VOID(ret, FAIL, "Hendaccess");
+
+            /* reaching the end decodes the whole element, appending must
+               start right after its last code */
+            if (size > first) {
+                aid = Hstartaccess(fid, COMP_TAG, ref, DFACC_RDWR);
+                CHECK_VOID(aid, FAIL, "Hstartaccess");
+                ret = Hseek(aid, first, DF_START);
+                CHECK_VOID(ret, FAIL, "Hseek");
+                ret = Hwrite(aid, size - first, &outbuf[first]);
+                VERIFY_VOID(ret, size - first, "Hwrite");
+                ret = Hendaccess(aid);
+                CHECK_VOID(ret, FAIL, "Hendaccess");
+            } /* end if */
+
+            /* the codes are the same as when writing all the data at once,
+               nothing read past the end may have been written back */
+            whole_ref = Hnewref(fid);
+            aid =
+                HCcreate(fid, COMP_TAG, whole_ref, COMP_MODEL_STDIO, &m_info, COMP_CODE_SKPHUFF, &c_info);
+            CHECK_VOID(aid, FAIL, "HCcreate");
+            ret = Hwrite(aid, size, outbuf);
+            VERIFY_VOID(ret, size, "Hwrite");
+            ret = Hendaccess(aid);
+            CHECK_VOID(ret, FAIL, "Hendaccess");
+            ret = HCPgetdatasize(fid, COMP_TAG, whole_ref, &whole_comp_size, &orig_size);
+            CHECK_VOID(ret, FAIL, "HCPgetdatasize");
+            ret = HCPgetdatasize(fid, COMP_TAG, ref, &comp_size, &orig_size);
+            CHECK_VOID(ret, FAIL, "HCPgetdatasize");
+            VERIFY_VOID(orig_size, size, "HCPgetdatasize");
+            VERIFY_VOID(comp_size, whole_comp_size, "HCPgetdatasize");
+
+            aid = Hstartread(fid, COMP_TAG, ref);
+            CHECK_VOID(aid, FAIL, "Hstartread");
+            for (pos = 0; pos < size; pos += len) {
+                len = MIN(7, size - pos);
+                ret = Hread(aid, len, &inbuf[pos]);
+                VERIFY_VOID(ret, len, "Hread");
+            } /* end for */
+            if (memcmp(inbuf, outbuf, (size_t)size) != 0) {
+                fprintf(stderr, "ERROR: Data read from a %d byte skipping Huffman element differs\n",
+                        (int)size);
+                num_errs++;
+            } /* end if */
+
+            /* seek near the end and read the last bytes again */
+            for (pos = MAX(size - 5, 0); pos < size; pos += 2) {
+                ret = Hseek(aid, pos, DF_START);
+                CHECK_VOID(ret, FAIL, "Hseek");
+                ret = Hread(aid, size - pos, inbuf);
+                VERIFY_VOID(ret, size - pos, "Hread");
+                if (memcmp(inbuf, &outbuf[pos], (size_t)(size - pos)) != 0) {
+                    fprintf(stderr, "ERROR: Data read at %d in a %d byte skipping Huffman element differs\n",
+                            (int)pos, (int)size);
+                    num_errs++;
+                } /* end if */
+            }     /* end for */
+            ret = Hendaccess(aid);
+            CHECK_VOID(ret, FAIL, "Hendaccess");
+        } /* end for */
+} /* end test_skphuff_tail() */
+
 void
 test_comp(void)
 {
@@ -432,6 +613,9 @@ test_comp(void)
         }         /* end for */
     }             /* end for */
 
+    test_rle_pieces(fid);
+    test_skphuff_tail(fid);
+
     /* close the HDF file */
     ret = Hclose(fid);
     CHECK_VOID(ret, FAIL, "Hclose");
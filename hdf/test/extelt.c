@@ -18,12 +18,17 @@
 #include "tproto.h"
 #define TESTFILE_NAME  "t.hdf"                  /* file for first 4 series of tests */
 #define TESTFILE_NAME1 "tx.hdf"                 /* file for last test */
+#define TESTFILE_NAME2 "tpool.hdf"              /* file for the open file pool test */
 #define STRING         "element 1000 2"         /* 14 bytes */
 #define STRING2        "element 1000 1   wrong" /* 22 bytes */
 #define STRING3        "element 1000 1 correct" /* 22 bytes */
 
 #define BUF_SIZE 4096
 
+/* more external files than can be kept open at once */
+#define NPOOL_FILES (MAX_EXT_FILE + 8)
+#define POOL_LENGTH 100
+
 static uint8 outbuf[BUF_SIZE], inbuf[BUF_SIZE];
 
 void
@@ -391,5 +396,130 @@ test_hextelt(void)
     ret = HXsetdir(NULL);
     CHECK_VOID(ret, FAIL, "HXsetdir");
 
+    /*
+     * Access more external files at once than are kept open, so that the
+     * files are closed and opened again while their elements are in use.
+     */
+    MESSAGE(5, printf("Creating %d external elements from %s\n", NPOOL_FILES, TESTFILE_NAME2););
+
+    fid = Hopen(TESTFILE_NAME2, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    ret = HXsetcreatedir("testdir");
+    CHECK_VOID(ret, FAIL, "HXsetcreatedir");
+
+    for (i = 0; i < NPOOL_FILES; i++) {
+        char  fname[32];
+        int32 aid;
+
+        snprintf(fname, sizeof(fname), "tpool%d.hdf", i);
+        aid = HXcreate(fid, 1001, (uint16)(i + 1), fname, (int32)0, (int32)0);
+        CHECK_VOID(aid, FAIL, "HXcreate");
+        ret = Hwrite(aid, POOL_LENGTH, outbuf + i);
+        VERIFY_VOID(ret, POOL_LENGTH, "Hwrite");
+        ret = Hendaccess(aid);
+        CHECK_VOID(ret, FAIL, "Hendaccess");
+    }
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    MESSAGE(5, printf("Reading the external elements in turn, all of them attached\n"););
+
+    ret = HXsetdir("testdir");
+    CHECK_VOID(ret, FAIL, "HXsetdir");
+
+    fid = Hopen(TESTFILE_NAME2, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    {
+        int32 aids[NPOOL_FILES];
+        int   j;
+
+        for (i = 0; i < NPOOL_FILES; i++) {
+            aids[i] = Hstartwrite(fid, 1001, (uint16)(i + 1), POOL_LENGTH);
+            CHECK_VOID(aids[i], FAIL, "Hstartwrite");
+        }
+
+        /* read the elements in two halves, so every file is reopened */
+        errflag = 0;
+        for (j = 0; j < 2; j++)
+            for (i = 0; i < NPOOL_FILES; i++) {
+                ret = Hread(aids[i], POOL_LENGTH / 2, inbuf);
+                VERIFY_VOID(ret, POOL_LENGTH / 2, "Hread");
+                if (memcmp(inbuf, outbuf + i + j * (POOL_LENGTH / 2), POOL_LENGTH / 2) != 0)
+                    errflag = 1;
+            }
+        if (errflag) {
+            fprintf(stderr, "Error: Wrong data read from the pooled external files\n");
+            errors++;
+        }
+
+        /* overwrite the start of each element through the same AIDs */
+        for (i = 0; i < NPOOL_FILES; i++) {
+            ret = Hseek(aids[i], 0, DF_START);
+            CHECK_VOID(ret, FAIL, "Hseek");
+            ret = Hwrite(aids[i], POOL_LENGTH / 2, outbuf + 2 * i);
+            VERIFY_VOID(ret, POOL_LENGTH / 2, "Hwrite");
+        }
+
+        for (i = 0; i < NPOOL_FILES; i++) {
+            ret = Hendaccess(aids[i]);
+            CHECK_VOID(ret, FAIL, "Hendaccess");
+        }
+    }
+
+    errflag = 0;
+    for (i = 0; i < NPOOL_FILES; i++) {
+        ret = Hgetelement(fid, (uint16)1001, (uint16)(i + 1), inbuf);
+        VERIFY_VOID(ret, POOL_LENGTH, "Hgetelement");
+        if (memcmp(inbuf, outbuf + 2 * i, POOL_LENGTH / 2) != 0 ||
+            memcmp(inbuf + POOL_LENGTH / 2, outbuf + i + POOL_LENGTH / 2, POOL_LENGTH / 2) != 0)
+            errflag = 1;
+    }
+    if (errflag) {
+        fprintf(stderr, "Error: Wrong data after rewriting the pooled external files\n");
+        errors++;
+    }
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /*
+     * Replace an external file between closing and reopening the HDF file,
+     * the new file has to be read rather than the one still open before.
+     */
+    MESSAGE(5, printf("Reading an external file replaced after the HDF file was closed\n"););
+    {
+        char  fname[32];
+        FILE *f;
+
+        /* the last file used, which is still in the pool */
+        snprintf(fname, sizeof(fname), "testdir/tpool%d.hdf", NPOOL_FILES - 1);
+        remove(fname);
+        f = fopen(fname, "wb");
+        CHECK_VOID(f, NULL, "fopen");
+        if (f != NULL) {
+            fwrite(outbuf + 3, 1, POOL_LENGTH, f);
+            fclose(f);
+        }
+    }
+
+    fid = Hopen(TESTFILE_NAME2, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hgetelement(fid, (uint16)1001, (uint16)NPOOL_FILES, inbuf);
+    VERIFY_VOID(ret, POOL_LENGTH, "Hgetelement");
+    if (memcmp(inbuf, outbuf + 3, POOL_LENGTH) != 0) {
+        fprintf(stderr, "Error: Data read from an external file which was replaced\n");
+        errors++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = HXsetcreatedir(NULL);
+    CHECK_VOID(ret, FAIL, "HXsetcreatedir");
+    ret = HXsetdir(NULL);
+    CHECK_VOID(ret, FAIL, "HXsetdir");
+
     num_errs += errors; /* increment global error count */
 }
@@ -41,14 +41,32 @@
    ** With wildcard.
    ** Open more access elements than there is space.
 
+   * Hdeldd/Hputelement
+   ** Space of a deleted element is reused by later elements.
+   *** In the same session.
+   *** After the file is re-opened.
+
  */
 
 #include "tproto.h"
-#define TESTFILE_NAME "t.hdf"
-#define BUF_SIZE      4096
+#include "hfile.h"
+#define TESTFILE_NAME  "t.hdf"
+#define FREESPACE_NAME "tfree.hdf"
+#define IMAGE_NAME     "timage.hdf"
+#define WRITEBUF_NAME  "twbuf.hdf"
+#define PREALLOC_NAME  "tprealloc.hdf"
+#define NOALLOC_NAME   "tnoprealloc.hdf"
+#define LIMIT_NAME     "tlimit.hdf"
+#define BUF_SIZE       4096
 
 static uint8 outbuf[BUF_SIZE], inbuf[BUF_SIZE];
 
+static void test_hfile_freespace(void);
+static void test_hfile_image(void);
+static void test_hfile_writebuf(void);
+static void test_hfile_prealloc(void);
+static void test_hfile_limit(void);
+
 void
 test_hfile(void)
 {
@@ -211,4 +229,424 @@ test_hfile(void)
 
     ret_bool = (intn)Hishdf("qqqqqqqq.qqq"); /* I sure hope it isn't there */
     CHECK_VOID(ret, TRUE, "Hishdf");
+
+    test_hfile_freespace();
+    test_hfile_image();
+    test_hfile_writebuf();
+    test_hfile_prealloc();
+    test_hfile_limit();
+}
+
+/* returns the size of the file 'name' on disk */
+static long
+file_size(const char *name)
+{
+    FILE *fp;
+    long  size = -1;
+
+    if ((fp = fopen(name, "rb")) != NULL) {
+        if (fseek(fp, 0, SEEK_END) == 0)
+            size = ftell(fp);
+        fclose(fp);
+    }
+    return size;
+}
+
+/* checks that space released by deleted elements is handed out again */
+static void
+test_hfile_freespace(void)
+{
+    int32 fid;
+    int32 off_a, off_c, off_d;
+    int32 ret;
+    long  size;
+
+    MESSAGE(5, printf("Reusing the space of deleted elements in %s\n", FREESPACE_NAME););
+    fid = Hopen(FREESPACE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    ret = Hputelement(fid, 1000, 1, outbuf, 2000);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    ret = Hputelement(fid, 1000, 2, outbuf + 2000, 1000);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    off_a = Hoffset(fid, 1000, 1);
+    CHECK_VOID(off_a, FAIL, "Hoffset");
+
+    /* the first element is deleted, the next one goes in its place */
+    ret = Hdeldd(fid, 1000, 1);
+    CHECK_VOID(ret, FAIL, "Hdeldd");
+    ret = Hputelement(fid, 1000, 3, outbuf + 1000, 1500);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    off_c = Hoffset(fid, 1000, 3);
+    VERIFY_VOID(off_c, off_a, "Hoffset");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    size = file_size(FREESPACE_NAME);
+
+    /* the rest of the hole is found again after re-opening the file */
+    fid = Hopen(FREESPACE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hputelement(fid, 1000, 4, outbuf + 3000, 500);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    off_d = Hoffset(fid, 1000, 4);
+    VERIFY_VOID(off_d, off_a + 1500, "Hoffset");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+    VERIFY_VOID(file_size(FREESPACE_NAME), size, "file_size");
+
+    /* all of the data is intact */
+    fid = Hopen(FREESPACE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hgetelement(fid, 1000, 2, inbuf);
+    VERIFY_VOID(ret, 1000, "Hgetelement");
+    if (memcmp(inbuf, outbuf + 2000, 1000) != 0) {
+        fprintf(stderr, "ERROR: wrong data in element 1000/2\n");
+        num_errs++;
+    }
+    ret = Hgetelement(fid, 1000, 3, inbuf);
+    VERIFY_VOID(ret, 1500, "Hgetelement");
+    if (memcmp(inbuf, outbuf + 1000, 1500) != 0) {
+        fprintf(stderr, "ERROR: wrong data in element 1000/3\n");
+        num_errs++;
+    }
+    ret = Hgetelement(fid, 1000, 4, inbuf);
+    VERIFY_VOID(ret, 500, "Hgetelement");
+    if (memcmp(inbuf, outbuf + 3000, 500) != 0) {
+        fprintf(stderr, "ERROR: wrong data in element 1000/4\n");
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+}
+
+/* checks that files can be created and opened in memory */
+static void
+test_hfile_image(void)
+{
+    int32  fid;
+    int32  len, len2;
+    int32  ret;
+    uint8 *image, *image2;
+    FILE  *fp;
+
+    MESSAGE(5, printf("Creating a file image in memory\n"););
+    fid = Hopen_image(NULL, 0, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen_image");
+    ret = Hputelement(fid, 1000, 1, outbuf, 3000);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    ret = Hputelement(fid, 1000, 2, outbuf + 3000, 1000);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+
+    len = Hget_image(fid, NULL, 0);
+    CHECK_VOID(len, FAIL, "Hget_image");
+    image = (uint8 *)malloc((size_t)len);
+    ret   = Hget_image(fid, image, len);
+    VERIFY_VOID(ret, len, "Hget_image");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* the image is a HDF file as it would be on disk */
+    if ((fp = fopen(IMAGE_NAME, "wb")) != NULL) {
+        fwrite(image, 1, (size_t)len, fp);
+        fclose(fp);
+    }
+    fid = Hopen(IMAGE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hgetelement(fid, 1000, 1, inbuf);
+    VERIFY_VOID(ret, 3000, "Hgetelement");
+    if (memcmp(inbuf, outbuf, 3000) != 0) {
+        fprintf(stderr, "ERROR: wrong data in element 1000/1 of %s\n", IMAGE_NAME);
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* a read-only image is read in place and can't be written */
+    MESSAGE(5, printf("Reading the file image in place\n"););
+    fid = Hopen_image(image, len, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen_image");
+    ret = Hgetelement(fid, 1000, 2, inbuf);
+    VERIFY_VOID(ret, 1000, "Hgetelement");
+    if (memcmp(inbuf, outbuf + 3000, 1000) != 0) {
+        fprintf(stderr, "ERROR: wrong data in element 1000/2 of the image\n");
+        num_errs++;
+    }
+    ret = Hputelement(fid, 1000, 3, outbuf, 100);
+    VERIFY_VOID(ret, FAIL, "Hputelement");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* a writable image is a copy which grows as it is written */
+    MESSAGE(5, printf("Adding to a copy of the file image\n"););
+    fid = Hopen_image(image, len, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen_image");
+    ret = Hputelement(fid, 1000, 3, outbuf, BUF_SIZE);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    len2 = Hget_image(fid, NULL, 0);
+    if (len2 < len + BUF_SIZE) {
+        fprintf(stderr, "ERROR: image did not grow, %ld bytes\n", (long)len2);
+        num_errs++;
+    }
+    image2 = (uint8 *)malloc((size_t)len2);
+    ret    = Hget_image(fid, image2, len2);
+    VERIFY_VOID(ret, len2, "Hget_image");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen_image(image2, len2, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen_image");
+    ret = Hgetelement(fid, 1000, 3, inbuf);
+    VERIFY_VOID(ret, BUF_SIZE, "Hgetelement");
+    if (memcmp(inbuf, outbuf, BUF_SIZE) != 0) {
+        fprintf(stderr, "ERROR: wrong data in element 1000/3 of the image\n");
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* the original image was left alone */
+    fid = Hopen_image(image, len, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen_image");
+    ret = Hexist(fid, 1000, 3);
+    VERIFY_VOID(ret, FAIL, "Hexist");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    free(image);
+    free(image2);
+}
+
+/* checks that small writes held in the write buffer are read back and
+   written out correctly, in whatever order they were made */
+static void
+test_hfile_writebuf(void)
+{
+    static uint8 expect[BUF_SIZE];
+    int32        fid, aid;
+    int32        ret;
+    int          i;
+
+    MESSAGE(5, printf("Mixing small writes and reads in %s\n", WRITEBUF_NAME););
+    fid = Hopen(WRITEBUF_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    /* many small elements, each read back while still buffered */
+    for (i = 0; i < 200; i++) {
+        ret = Hputelement(fid, 1000, (uint16)(i + 1), outbuf + i, 10 + i);
+        CHECK_VOID(ret, FAIL, "Hputelement");
+        ret = Hgetelement(fid, 1000, (uint16)(i + 1), inbuf);
+        VERIFY_VOID(ret, 10 + i, "Hgetelement");
+        if (memcmp(inbuf, outbuf + i, (size_t)(10 + i)) != 0) {
+            fprintf(stderr, "ERROR: wrong data in element 1000/%d before Hclose\n", i + 1);
+            num_errs++;
+        }
+    }
+
+    /* rewrite the start of a larger element with overlapping small writes;
+       expect[] follows what the file should end up holding */
+    ret = Hputelement(fid, 1001, 1, outbuf, BUF_SIZE);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    memcpy(expect, outbuf, BUF_SIZE);
+    aid = Hstartwrite(fid, 1001, 1, BUF_SIZE);
+    CHECK_VOID(aid, FAIL, "Hstartwrite");
+    ret = Hseek(aid, 100, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+    ret = Hwrite(aid, 50, outbuf + 1000);
+    VERIFY_VOID(ret, 50, "Hwrite");
+    memcpy(expect + 100, outbuf + 1000, 50);
+    ret = Hseek(aid, 120, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+    ret = Hwrite(aid, 10, outbuf + 2001);
+    VERIFY_VOID(ret, 10, "Hwrite");
+    memcpy(expect + 120, outbuf + 2001, 10);
+    ret = Hseek(aid, 0, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+    ret = Hwrite(aid, 110, outbuf + 3003);
+    VERIFY_VOID(ret, 110, "Hwrite");
+    memcpy(expect, outbuf + 3003, 110);
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    ret = Hgetelement(fid, 1001, 1, inbuf);
+    VERIFY_VOID(ret, BUF_SIZE, "Hgetelement");
+    if (memcmp(inbuf, expect, BUF_SIZE) != 0) {
+        fprintf(stderr, "ERROR: wrong data in element 1001/1 before Hclose\n");
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen(WRITEBUF_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    for (i = 0; i < 200; i++) {
+        ret = Hgetelement(fid, 1000, (uint16)(i + 1), inbuf);
+        VERIFY_VOID(ret, 10 + i, "Hgetelement");
+        if (memcmp(inbuf, outbuf + i, (size_t)(10 + i)) != 0) {
+            fprintf(stderr, "ERROR: wrong data in element 1000/%d\n", i + 1);
+            num_errs++;
+        }
+    }
+    ret = Hgetelement(fid, 1001, 1, inbuf);
+    VERIFY_VOID(ret, BUF_SIZE, "Hgetelement");
+    if (memcmp(inbuf, expect, BUF_SIZE) != 0) {
+        fprintf(stderr, "ERROR: wrong data in element 1001/1\n");
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+}
+
+/* writes the same elements to 'name', with extent bytes preallocated ahead */
+static void
+write_prealloc(const char *name, int32 extent)
+{
+    int32 fid, aid;
+    int32 ret;
+    int   i;
+
+    fid = Hopen(name, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hpreallocate(fid, extent);
+    CHECK_VOID(ret, FAIL, "Hpreallocate");
+
+    for (i = 0; i < 4; i++) {
+        ret = Hputelement(fid, 1000, (uint16)(i + 1), outbuf, BUF_SIZE);
+        CHECK_VOID(ret, FAIL, "Hputelement");
+    }
+    if (extent > 0)
+        VERIFY_VOID(file_size(name) >= extent, TRUE, "file_size");
+
+    /* an appendable element growing at the end of the file */
+    aid = Hstartwrite(fid, 1001, 1, 100);
+    CHECK_VOID(aid, FAIL, "Hstartwrite");
+    ret = Happendable(aid);
+    CHECK_VOID(ret, FAIL, "Happendable");
+    for (i = 0; i < 10; i++) {
+        ret = Hwrite(aid, 300, outbuf + i * 100);
+        VERIFY_VOID(ret, 300, "Hwrite");
+    }
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+}
+
+/* checks that preallocated space not used is given back at close */
+static void
+test_hfile_prealloc(void)
+{
+    int32 fid;
+    int32 ret;
+    int   i;
+
+    MESSAGE(5, printf("Preallocating file space for %s\n", PREALLOC_NAME););
+    ret = Hpreallocate(PREALLOC_ALL_FILES, -1);
+    VERIFY_VOID(ret, FAIL, "Hpreallocate");
+
+    /* nothing to test where the file system space can't be reserved */
+    fid = Hopen(PREALLOC_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hpreallocate(fid, 1);
+    Hclose(fid);
+    if (ret == FAIL) {
+        MESSAGE(5, printf("Preallocation is not supported, skipping\n"););
+        return;
+    }
+
+    write_prealloc(NOALLOC_NAME, 0);
+    write_prealloc(PREALLOC_NAME, 1024 * 1024);
+    VERIFY_VOID(file_size(PREALLOC_NAME) <= file_size(NOALLOC_NAME), TRUE, "file_size");
+
+    fid = Hopen(PREALLOC_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    for (i = 0; i < 4; i++) {
+        ret = Hgetelement(fid, 1000, (uint16)(i + 1), inbuf);
+        VERIFY_VOID(ret, BUF_SIZE, "Hgetelement");
+        if (memcmp(inbuf, outbuf, BUF_SIZE) != 0) {
+            fprintf(stderr, "ERROR: wrong data in element 1000/%d\n", i + 1);
+            num_errs++;
+        }
+    }
+    ret = Hgetelement(fid, 1001, 1, inbuf);
+    VERIFY_VOID(ret, 3000, "Hgetelement");
+    for (i = 0; i < 10; i++)
+        if (memcmp(inbuf + i * 300, outbuf + i * 100, 300) != 0) {
+            fprintf(stderr, "ERROR: wrong data in element 1001/1 at %d\n", i * 300);
+            num_errs++;
+        }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+}
+
+/* whether the error stack holds 'error' */
+static intn
+error_pushed(int16 error)
+{
+    int32 level;
+
+    for (level = 1; HEvalue(level) != DFE_NONE; level++)
+        if (HEvalue(level) == error)
+            return TRUE;
+    return FALSE;
+}
+
+/* checks that a file can't grow past the offsets a DD can hold */
+static void
+test_hfile_limit(void)
+{
+    filerec_t *file_rec;
+    int32      fid, aid;
+    int32      end_off, offset;
+    int32      ret;
+
+    MESSAGE(5, printf("Growing %s up to the largest offset\n", LIMIT_NAME););
+    fid = Hopen(LIMIT_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    aid = Hstartwrite(fid, 1002, 1, 1000);
+    CHECK_VOID(aid, FAIL, "Hstartwrite");
+    ret = Happendable(aid);
+    CHECK_VOID(ret, FAIL, "Happendable");
+    ret = Hwrite(aid, 2000, outbuf);
+    VERIFY_VOID(ret, 2000, "Hwrite");
+
+    /* the guard fails before any data is touched, so the length can be huge */
+    ret = Hinquire(aid, NULL, NULL, NULL, NULL, &offset, NULL, NULL, NULL);
+    CHECK_VOID(ret, FAIL, "Hinquire");
+    ret = Hwrite(aid, MAX_FILE_OFFSET - offset - 2000 + 1, outbuf);
+    VERIFY_VOID(ret, FAIL, "Hwrite");
+    VERIFY_VOID(error_pushed(DFE_EXCEEDMAX), TRUE, "HEvalue");
+    ret = Hendaccess(aid);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    /* pretend the file already ends near the limit instead of writing 2 GB */
+    if ((file_rec = HAatom_object(fid)) == NULL) {
+        fprintf(stderr, "ERROR: no file record for %s\n", LIMIT_NAME);
+        num_errs++;
+        return;
+    }
+    end_off             = file_rec->f_end_off;
+    file_rec->f_end_off = MAX_FILE_OFFSET - 4096;
+
+    aid = Hstartwrite(fid, 1002, 2, 8192);
+    VERIFY_VOID(aid, FAIL, "Hstartwrite");
+
+    file_rec->f_end_off = end_off;
+    ret                 = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    fid = Hopen(LIMIT_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Hgetelement(fid, 1002, 1, inbuf);
+    VERIFY_VOID(ret, 2000, "Hgetelement");
+    if (memcmp(inbuf, outbuf, 2000) != 0) {
+        fprintf(stderr, "ERROR: wrong data in element 1002/1\n");
+        num_errs++;
+    }
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    remove(LIMIT_NAME);
 }
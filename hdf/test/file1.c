@@ -17,15 +17,17 @@
 
 #include "tproto.h"
 #include "hfile.h"
-#define BIG            600
-#define TESTFILE_NAME  "thf"
-#define TESTREF_NAME   "tref.hdf"
-#define MAX_REF_TESTED MAX_REF
+#define BIG             600
+#define TESTFILE_NAME   "thf"
+#define TESTREF_NAME    "tref.hdf"
+#define TESTNEWREF_NAME "tnewref.hdf"
+#define MAX_REF_TESTED  MAX_REF
 static int32 files[BIG];
 static int32 accs[BIG];
 
 static void test_file_limits(void);
 static void test_ref_limits(void);
+static void test_newref_limits(void);
 
 static void
 test_file_limits(void)
@@ -202,9 +204,68 @@ test_ref_limits(void)
     }     /* end if */
 } /* end test_ref_limits() */
 
+static void
+test_newref_limits(void)
+{
+    int32  fid;  /* file ID */
+    int32  data; /* data to write */
+    int32  ret;
+    uint16 ref;
+    int32  i; /* local counting variable */
+
+    MESSAGE(6, printf("Testing new reference #s once all have been given out\n"););
+    fid = Hopen(TESTNEWREF_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    if (fid == FAIL)
+        return;
+
+    /* Use up all the ref #s, one data item each */
+    data = 0;
+    for (i = 0; (ref = Hnewref(fid)) != DFREF_NONE && i < MAX_REF; i++) {
+        ret = Hputelement(fid, TAG1, ref, (uint8 *)&data, sizeof(int32));
+        CHECK_VOID(ret, FAIL, "Hputelement");
+        if (ret == FAIL)
+            break;
+    } /* end for */
+    VERIFY_VOID(ref, DFREF_NONE, "Hnewref");
+
+    /* A ref # freed by one tag is still in use while another tag has it */
+    ret = Hputelement(fid, TAG2, 100, (uint8 *)&data, sizeof(int32));
+    CHECK_VOID(ret, FAIL, "Hputelement");
+    ret = Hdeldd(fid, TAG1, 100);
+    CHECK_VOID(ret, FAIL, "Hdeldd");
+    ret = Hdeldd(fid, TAG1, 60000);
+    CHECK_VOID(ret, FAIL, "Hdeldd");
+    ret = Hdeldd(fid, TAG1, 5000);
+    CHECK_VOID(ret, FAIL, "Hdeldd");
+
+    ref = Hnewref(fid);
+    VERIFY_VOID(ref, 5000, "Hnewref");
+    ret = Hputelement(fid, TAG2, ref, (uint8 *)&data, sizeof(int32));
+    CHECK_VOID(ret, FAIL, "Hputelement");
+
+    ref = Hnewref(fid);
+    VERIFY_VOID(ref, 60000, "Hnewref");
+    ret = Hputelement(fid, TAG1, ref, (uint8 *)&data, sizeof(int32));
+    CHECK_VOID(ret, FAIL, "Hputelement");
+
+    ref = Hnewref(fid);
+    VERIFY_VOID(ref, DFREF_NONE, "Hnewref");
+
+    /* Once the last tag lets go of it, the ref # can be given out again */
+    ret = Hdeldd(fid, TAG2, 100);
+    CHECK_VOID(ret, FAIL, "Hdeldd");
+    ref = Hnewref(fid);
+    VERIFY_VOID(ref, 100, "Hnewref");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+} /* end test_newref_limits() */
+
 void
 test_hfile1(void)
 {
     test_file_limits();
     test_ref_limits();
+    test_newref_limits();
 }
@@ -44,6 +44,13 @@
 #define COLS     10         /* column size of dataset/image */
 #define REPS     3          /* number of images/data sets to write to file */
 
+/* many data labels on a few elements, with big elements between them */
+#define TESTFILE_MANY "tman_many.hdf"
+#define NMANY_ANNS    120  /* number of data labels */
+#define NMANY_ELEMS   40   /* number of elements labeled */
+#define FILLER_TAG    1000 /* tag of the elements written between the labels */
+#define FILLER_LEN    8192 /* their length */
+
 /* File labels/descriptions to write */
 static const char *file_lab[3] = {"File label #1: aaa", "File label #2: bbbbbb", "File label #3: cccc"};
 
@@ -74,6 +81,8 @@ static void gen2Dfloat(int height, int width, float32 *data);
 
 static int32 check_fann(const char *fname);
 
+static int32 check_many_dann(const char *fname);
+
 static int32 check_lab_desc(const char *fname, uint16 tag, uint16 ref, const char *label[],
                             const char *desc[]);
 
@@ -286,6 +295,121 @@ check_fann_rewrite(const char *fname)
     return SUCCEED;
 } /* check_fann_rewrite() */
 
+/****************************************************************
+**
+**  check_many_dann:  Check many data labels written apart from
+**                    each other in the file: the element tag/ref
+**                    of each one is read back correctly, also
+**                    when re-writing a label
+**
+****************************************************************/
+static int32
+check_many_dann(const char *fname)
+{
+    int32  ret = SUCCEED;           /* return value */
+    int32  file_handle;             /* file handle */
+    int32  an_handle;               /* annotation interface handle */
+    int32  ann_handle;              /* annotation handle */
+    int32  ann_list[NMANY_ANNS];    /* annotations of an element */
+    uint8 *filler = NULL;           /* data of the filler elements */
+    char   label[32];               /* label written */
+    char   ann_label[32];           /* label read */
+    uint16 atag, aref;              /* tag/ref of an annotation */
+    int32  nanns, total;
+    int    i, j;
+
+    if ((filler = (uint8 *)calloc(FILLER_LEN, 1)) == NULL) {
+        fprintf(stderr, "Error: unable to allocate space\n");
+        return FAIL;
+    }
+
+    /* write the labels, 3 on each element, with a filler every 30 labels */
+    ret = file_handle = Hopen(fname, DFACC_CREATE, 0);
+    RESULT("Hopen");
+    ret = an_handle = ANstart(file_handle);
+    RESULT("ANstart");
+    for (i = 0; i < NMANY_ANNS; i++) {
+        if (i % 30 == 0) {
+            ret = Hputelement(file_handle, FILLER_TAG, (uint16)(i + 1), filler, FILLER_LEN);
+            RESULT("Hputelement");
+        }
+        snprintf(label, sizeof(label), "label %d", i);
+        ret = ann_handle = ANcreate(an_handle, DFTAG_NDG, (uint16)(i % NMANY_ELEMS + 1), AN_DATA_LABEL);
+        RESULT("ANcreate");
+        ret = ANwriteann(ann_handle, label, (int32)HDstrlen(label));
+        RESULT("ANwriteann");
+        ret = ANendaccess(ann_handle);
+        RESULT("ANendaccess");
+    }
+    ret = ANend(an_handle);
+    RESULT("ANend");
+    ret = Hclose(file_handle);
+    RESULT("Hclose");
+    free(filler);
+
+    /* re-write the first label; its element tag/ref must be kept */
+    ret = file_handle = Hopen(fname, DFACC_RDWR, 0);
+    RESULT("Hopen");
+    ret = an_handle = ANstart(file_handle);
+    RESULT("ANstart");
+    ret = ANget_tagref(an_handle, 0, AN_DATA_LABEL, &atag, &aref);
+    RESULT("ANget_tagref");
+    VERIFY(atag, DFTAG_DIL, "ANget_tagref");
+    ret = ann_handle = ANselect(an_handle, 0, AN_DATA_LABEL);
+    RESULT("ANselect");
+    ret = ANwriteann(ann_handle, "label again", (int32)HDstrlen("label again"));
+    RESULT("ANwriteann");
+    ret = ANendaccess(ann_handle);
+    RESULT("ANendaccess");
+    ret = ANend(an_handle);
+    RESULT("ANend");
+    ret = Hclose(file_handle);
+    RESULT("Hclose");
+
+    /* read the labels back, element by element */
+    ret = file_handle = Hopen(fname, DFACC_READ, 0);
+    RESULT("Hopen");
+    ret = an_handle = ANstart(file_handle);
+    RESULT("ANstart");
+    total = 0;
+    for (i = 0; i < NMANY_ELEMS; i++) {
+        nanns = ret = ANnumann(an_handle, AN_DATA_LABEL, DFTAG_NDG, (uint16)(i + 1));
+        RESULT("ANnumann");
+        VERIFY(nanns, NMANY_ANNS / NMANY_ELEMS, "ANnumann");
+        ret = ANannlist(an_handle, AN_DATA_LABEL, DFTAG_NDG, (uint16)(i + 1), ann_list);
+        RESULT("ANannlist");
+        for (j = 0; j < nanns && j < ret; j++) {
+            int32 ann_len = ANannlen(ann_list[j]);
+            int   n       = -1;
+
+            if (ann_len <= 0 || ann_len >= (int32)sizeof(ann_label)) {
+                printf(">>> bad length %d of a label of element %d\n", (int)ann_len, i + 1);
+                num_errs++;
+                continue;
+            }
+            ret = ANreadann(ann_list[j], ann_label, (int32)sizeof(ann_label));
+            RESULT("ANreadann");
+            if (HDstrcmp(ann_label, "label again") != 0 &&
+                (sscanf(ann_label, "label %d", &n) != 1 || n % NMANY_ELEMS != i)) {
+                printf(">>> label \"%s\" found on element %d\n", ann_label, i + 1);
+                num_errs++;
+            }
+            ANendaccess(ann_list[j]);
+        }
+        total += nanns;
+    }
+    VERIFY(total, NMANY_ANNS, "ANnumann");
+    nanns = ret = ANnumann(an_handle, AN_DATA_LABEL, DFTAG_RIG, 1);
+    RESULT("ANnumann");
+    VERIFY(nanns, 0, "ANnumann");
+    ret = ANend(an_handle);
+    RESULT("ANend");
+    ret = Hclose(file_handle);
+    RESULT("Hclose");
+
+    return SUCCEED;
+} /* check_many_dann() */
+
 /****************************************************************
 **
 **  check_fann:  Check file labels and descriptions in file
@@ -856,6 +980,10 @@ test_man(void)
     if (check_fann_rewrite(TESTFILE) == FAIL)
         return; /* end of test */
 
+    /* check many data labels spread over the file */
+    if (check_many_dann(TESTFILE_MANY) == FAIL)
+        return; /* end of test */
+
     /* free up space */
     free(data);
     free(image);
@@ -3006,17 +3006,114 @@ test_mgr_image(int flag)
 **  III. ID/Ref/Index Functions
 **      A. GRidtoref
 **      B. GRreftoindex
+**      C. GRnametoindex
 **
 ****************************************************************/
+#define GR_INDEXFILE "tmgridx.hdf"
+#define INDEX_NIMGS  3 /* number of GR images written */
+#define INDEX_XDIM   6
+#define INDEX_YDIM   4
+
 static void
 test_mgr_index(int flag)
 {
+    int32  fid;                        /* HDF file ID */
+    int32  grid;                       /* GRID for the interface */
+    int32  riid;                       /* RI ID for an image */
+    int32  n_datasets, n_attrs;        /* number of datasets/attributes */
+    int32  ncomp, nt, il;              /* image info */
+    int32  dims[2] = {INDEX_XDIM, INDEX_YDIM};
+    uint16 refs[INDEX_NIMGS];          /* refs of the GR images */
+    char   name[32];                   /* name of an image */
+    uint8  image[INDEX_YDIM][INDEX_XDIM];
+    int32  ret;                        /* generic return value */
+    intn   i;
+
     (void)flag;
 
     /* output message about test being performed */
     MESSAGE(6, printf("Testing Multi-File Raster id/ref/index routines\n"););
 
-    /* I believe that these are adequately tested in the test_mgr_image routine -QAK */
+    /* The images of a file are only read in when first selected; check the
+       calls that find an image before it is selected */
+    memset(image, 7, sizeof(image));
+    fid = Hopen(GR_INDEXFILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    grid = GRstart(fid);
+    CHECK_VOID(grid, FAIL, "GRstart");
+    for (i = 0; i < INDEX_NIMGS; i++) {
+        int32 start[2] = {0, 0};
+        int32 value    = i;
+
+        snprintf(name, sizeof(name), "Image %d", (int)i);
+        riid = GRcreate(grid, name, 1, DFNT_UINT8, MFGR_INTERLACE_PIXEL, dims);
+        CHECK_VOID(riid, FAIL, "GRcreate");
+        ret = GRwriteimage(riid, start, NULL, dims, image);
+        CHECK_VOID(ret, FAIL, "GRwriteimage");
+        ret = GRsetattr(riid, "index", DFNT_INT32, 1, &value);
+        CHECK_VOID(ret, FAIL, "GRsetattr");
+        refs[i] = GRidtoref(riid);
+        CHECK_VOID(refs[i], 0, "GRidtoref");
+        ret = GRendaccess(riid);
+        CHECK_VOID(ret, FAIL, "GRendaccess");
+    } /* end for */
+    ret = GRend(grid);
+    CHECK_VOID(ret, FAIL, "GRend");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* add an old-style 8-bit image */
+    ret = DFR8addimage(GR_INDEXFILE, image, INDEX_XDIM, INDEX_YDIM, 0);
+    CHECK_VOID(ret, FAIL, "DFR8addimage");
+
+    fid = Hopen(GR_INDEXFILE, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    grid = GRstart(fid);
+    CHECK_VOID(grid, FAIL, "GRstart");
+    ret = GRfileinfo(grid, &n_datasets, &n_attrs);
+    CHECK_VOID(ret, FAIL, "GRfileinfo");
+    VERIFY_VOID(n_datasets, INDEX_NIMGS + 1, "GRfileinfo");
+
+    /* look images up before selecting them */
+    ret = GRreftoindex(grid, refs[2]);
+    VERIFY_VOID(ret, 2, "GRreftoindex");
+    ret = GRnametoindex(grid, "Image 1");
+    VERIFY_VOID(ret, 1, "GRnametoindex");
+    ret = GRnametoindex(grid, "No such image");
+    VERIFY_VOID(ret, FAIL, "GRnametoindex");
+
+    /* select them out of order */
+    for (i = INDEX_NIMGS; i >= 0; i--) {
+        int32 value = -1;
+
+        riid = GRselect(grid, i);
+        CHECK_VOID(riid, FAIL, "GRselect");
+        ret = GRgetiminfo(riid, name, &ncomp, &nt, &il, dims, &n_attrs);
+        CHECK_VOID(ret, FAIL, "GRgetiminfo");
+        VERIFY_VOID(ncomp, 1, "GRgetiminfo");
+        VERIFY_VOID(dims[0], INDEX_XDIM, "GRgetiminfo");
+        VERIFY_VOID(dims[1], INDEX_YDIM, "GRgetiminfo");
+        if (i < INDEX_NIMGS) {
+            char expected[32];
+
+            snprintf(expected, sizeof(expected), "Image %d", (int)i);
+            if (strcmp(name, expected) != 0) {
+                MESSAGE(3, printf("Error! Image %d is named '%s'\n", (int)i, name););
+                num_errs++;
+            } /* end if */
+            VERIFY_VOID(n_attrs, 1, "GRgetiminfo");
+            ret = GRgetattr(riid, 0, &value);
+            CHECK_VOID(ret, FAIL, "GRgetattr");
+            VERIFY_VOID(value, i, "GRgetattr");
+        } /* end if */
+        ret = GRendaccess(riid);
+        CHECK_VOID(ret, FAIL, "GRendaccess");
+    } /* end for */
+
+    ret = GRend(grid);
+    CHECK_VOID(ret, FAIL, "GRend");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
 } /* end test_mgr_index() */
 
 /****************************************************************
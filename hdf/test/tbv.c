@@ -24,6 +24,7 @@ static void test_1(void);
 static void test_2(void);
 static void test_3(void);
 static void test_4(void);
+static void test_5(void);
 
 /* Basic creation & deletion tests */
 static void
@@ -283,6 +284,65 @@ test_4(void)
     CHECK_VOID(ret, FAIL, "bv_delete");
 } /* end test_4 */
 
+/* Find zeros in a large, mostly full bit-vector */
+static void
+test_5(void)
+{
+    bv_ptr b;
+    int32  bit_num;
+    int32  i;
+    intn   ret;
+
+    MESSAGE(6, printf("Testing finding zeros in a large bit-vector\n"););
+
+    /* Create a bit-vector spanning many chunks and fill it */
+    MESSAGE(7, printf("Create and fill a bit-vector\n"););
+    b = bv_new(65536);
+    CHECK_VOID(b, NULL, "bv_new");
+    for (i = 0; i < 65536; i++) {
+        ret = bv_set(b, i, BV_TRUE);
+        CHECK_VOID(ret, FAIL, "bv_set");
+    }
+
+    /* Clear bits far apart, and in every position of a byte and word */
+    ret = bv_set(b, 60001, BV_FALSE);
+    CHECK_VOID(ret, FAIL, "bv_set");
+    ret = bv_set(b, 40007, BV_FALSE);
+    CHECK_VOID(ret, FAIL, "bv_set");
+    ret = bv_set(b, 517, BV_FALSE);
+    CHECK_VOID(ret, FAIL, "bv_set");
+
+    bit_num = bv_find_next_zero(b);
+    VERIFY_VOID(bit_num, 517, "bv_find_next_zero");
+    ret = bv_set(b, bit_num, BV_TRUE);
+    CHECK_VOID(ret, FAIL, "bv_set");
+
+    bit_num = bv_find_next_zero(b);
+    VERIFY_VOID(bit_num, 40007, "bv_find_next_zero");
+    ret = bv_set(b, bit_num, BV_TRUE);
+    CHECK_VOID(ret, FAIL, "bv_set");
+
+    /* A zero behind the one found last must still be seen */
+    ret = bv_set(b, 9, BV_FALSE);
+    CHECK_VOID(ret, FAIL, "bv_set");
+    bit_num = bv_find_next_zero(b);
+    VERIFY_VOID(bit_num, 9, "bv_find_next_zero");
+    ret = bv_set(b, bit_num, BV_TRUE);
+    CHECK_VOID(ret, FAIL, "bv_set");
+
+    bit_num = bv_find_next_zero(b);
+    VERIFY_VOID(bit_num, 60001, "bv_find_next_zero");
+    ret = bv_set(b, bit_num, BV_TRUE);
+    CHECK_VOID(ret, FAIL, "bv_set");
+
+    /* Once full, the next bit extends the array */
+    bit_num = bv_find_next_zero(b);
+    VERIFY_VOID(bit_num, 65536, "bv_find_next_zero");
+
+    ret = bv_delete(b);
+    CHECK_VOID(ret, FAIL, "bv_delete");
+} /* end test_5 */
+
 void
 test_bitvect(void)
 {
@@ -290,4 +350,5 @@ test_bitvect(void)
     test_2(); /* basic set & get testing */
     test_3(); /* advanced set & get testing */
     test_4(); /* pathological set & find testing */
+    test_5(); /* large set & find testing */
 }
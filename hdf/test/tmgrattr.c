@@ -178,6 +178,59 @@ test_mgr_fillvalues()
     return num_errs;
 } /* end test_mgr_fillvalues() */
 
+/********************************************************************
+   Name: check_getattrs()
+
+   Description:
+        Reads all the attributes of a file or an image at once with
+        GRgetattrs and compares them with what GRattrinfo and GRgetattr
+        return for each one.
+
+*********************************************************************/
+static void
+check_getattrs(int32 id, int32 n_attrs)
+{
+    hdf_attr_t *attrs = NULL;
+    char        attr_name[H4_MAX_GR_NAME];
+    int32       ntype, n_values;
+    int32       att_index;
+    uint8       data_buf[256];
+    intn        status;
+
+    status = GRgetattrs(id, &attrs);
+    VERIFY_CONT(status, n_attrs, "GRgetattrs");
+    if (status != n_attrs) {
+        free(attrs);
+        return;
+    } /* end if */
+
+    /* Report every mismatch but keep going, attrs must be freed below */
+    for (att_index = 0; att_index < n_attrs; att_index++) {
+        status = GRattrinfo(id, att_index, attr_name, &ntype, &n_values);
+        CHECK_CONT(status, FAIL, "GRattrinfo");
+        if (status == FAIL)
+            continue;
+        status = GRgetattr(id, att_index, (void *)data_buf);
+        CHECK_CONT(status, FAIL, "GRgetattr");
+        if (status == FAIL)
+            continue;
+        if (HDstrcmp(attrs[att_index].name, attr_name) != 0) {
+            MESSAGE(3, printf("GRgetattrs read wrong name %s for attribute %s\n", attrs[att_index].name,
+                              attr_name););
+            num_errs++;
+        } /* end if */
+        VERIFY_CONT(attrs[att_index].nt, ntype, "GRgetattrs");
+        VERIFY_CONT(attrs[att_index].count, n_values, "GRgetattrs");
+        if (attrs[att_index].nt == ntype && attrs[att_index].count == n_values &&
+            memcmp(attrs[att_index].values, data_buf, (size_t)(n_values * DFKNTsize(ntype | DFNT_NATIVE))) !=
+                0) {
+            MESSAGE(3, printf("GRgetattrs read wrong values for attribute %s\n", attr_name););
+            num_errs++;
+        } /* end if */
+    } /* for */
+    free(attrs);
+} /* check_getattrs */
+
 /********************************************************************
    Name: test_mgr_userattr()
 
@@ -261,6 +314,9 @@ test_mgr_userattr()
     status = GRfileinfo(grid, &n_rimages, &n_file_attrs);
     CHECK(status, FAIL, "GRfileinfo");
 
+    /* Read all the file attributes at once, before any is cached */
+    check_getattrs(grid, n_file_attrs);
+
     /* Read each file attribute and verify its values */
     if (status != FAIL && n_file_attrs > 0) {
         for (f_att_index = 0; f_att_index < n_file_attrs; f_att_index++) {
@@ -346,6 +402,9 @@ test_mgr_userattr()
     status = GRgetiminfo(riid, ri_name, &ncomp, &ntype, &il, dims, &n_attrs);
     CHECK(status, FAIL, "GRgetiminfo");
 
+    /* Read all the image attributes at once */
+    check_getattrs(riid, n_attrs);
+
     /* Verify each attribute's values */
     if (status != FAIL && n_attrs > 0) {
         for (ri_att_index = 0; ri_att_index < n_attrs; ri_att_index++) {
@@ -427,6 +486,7 @@ test_mgr_userattr()
 
         } /* for */
     }     /* if */
+
     /* Terminate accesses, and close the HDF file. */
     status = GRendaccess(riid);
     CHECK(status, FAIL, "GRendaccess");
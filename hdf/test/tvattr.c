@@ -75,6 +75,7 @@ static intn create_vset_stuff(void);
 static intn write_vattrs(void);
 static intn read_vattrs(void);
 static void test_readattrtwice(void);
+static void test_findattr_many(void);
 
 /* create vdatas and vgroups */
 
@@ -814,6 +815,159 @@ test_readattrtwice(void)
     CHECK_VOID(ret, FAIL, "Hclose");
 } /* test_readattrtwice */
 
+/* check that Vfindattr and VSfindattr find every one of many attributes,
+   including those added after the names were first looked up */
+#define NMANY_ATTRS 40
+
+static void
+check_findattr_many(int32 vgid, int32 vsid, intn nattrs, intn check_field)
+{
+    char name[20];
+    intn i;
+    intn ret;
+
+    for (i = 0; i < nattrs; i++) {
+        snprintf(name, sizeof(name), "attr%d", i);
+        ret = Vfindattr(vgid, name);
+        VERIFY_VOID(ret, i, "Vfindattr");
+        ret = VSfindattr(vsid, _HDF_VDATA, name);
+        VERIFY_VOID(ret, i, "VSfindattr");
+        /* field 1 has the same names, in reverse order */
+        ret = VSfindattr(vsid, 1, name);
+        VERIFY_VOID(ret, (check_field ? nattrs - 1 - i : FAIL), "VSfindattr");
+    }
+    ret = Vfindattr(vgid, "no such attr");
+    VERIFY_VOID(ret, FAIL, "Vfindattr");
+    ret = VSfindattr(vsid, 0, "attr0");
+    VERIFY_VOID(ret, FAIL, "VSfindattr");
+} /* check_findattr_many */
+
+/* check the attributes Vgetattrs or VSgetattrs return; the values are the
+   numbers in the names, except for attr3, and come in reverse order if
+   'reverse' is set */
+static void
+check_getattrs_many(intn nattrs, const hdf_attr_t *attrs, intn reverse, int32 attr3)
+{
+    char name[20];
+    intn i, k;
+
+    VERIFY_VOID(nattrs, NMANY_ATTRS, "getattrs");
+    if (nattrs != NMANY_ATTRS)
+        return;
+    for (i = 0; i < NMANY_ATTRS; i++) {
+        k = reverse ? NMANY_ATTRS - 1 - i : i;
+        snprintf(name, sizeof(name), "attr%d", k);
+        VERIFY_CHAR_VOID(attrs[i].name, name, "getattrs");
+        VERIFY_VOID(attrs[i].nt, DFNT_INT32, "getattrs");
+        VERIFY_VOID(attrs[i].count, 1, "getattrs");
+        VERIFY_VOID(*(int32 *)attrs[i].values, (k == 3 ? attr3 : k), "getattrs");
+    }
+} /* check_getattrs_many */
+
+static void
+test_findattr_many(void)
+{
+    int32       fid, vgid, vsid, vgref, vsref;
+    int32       value;
+    char        name[20];
+    hdf_attr_t *attrs = NULL;
+    intn        i, half = NMANY_ATTRS / 2;
+    intn        ret;
+
+    fid = Hopen(FILENAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Vstart(fid);
+    CHECK_VOID(ret, FAIL, "Vstart");
+
+    vgid = Vattach(fid, -1, "w");
+    CHECK_VOID(vgid, FAIL, "Vattach");
+    vsid = VSattach(fid, -1, "w");
+    CHECK_VOID(vsid, FAIL, "VSattach");
+    ret = VSfdefine(vsid, FLDNAME0, DFNT_INT32, 1);
+    CHECK_VOID(ret, FAIL, "VSfdefine");
+    ret = VSfdefine(vsid, FLDNAME1, DFNT_INT32, 1);
+    CHECK_VOID(ret, FAIL, "VSfdefine");
+    ret = VSsetfields(vsid, FLDNAME0 "," FLDNAME1);
+    CHECK_VOID(ret, FAIL, "VSsetfields");
+
+    /* a first half, then look the names up, then the second half */
+    for (i = 0; i < NMANY_ATTRS; i++) {
+        if (i == half)
+            check_findattr_many(vgid, vsid, half, FALSE);
+        value = i;
+        snprintf(name, sizeof(name), "attr%d", i);
+        ret = Vsetattr(vgid, name, DFNT_INT32, 1, &value);
+        CHECK_VOID(ret, FAIL, "Vsetattr");
+        ret = VSsetattr(vsid, _HDF_VDATA, name, DFNT_INT32, 1, &value);
+        CHECK_VOID(ret, FAIL, "VSsetattr");
+    }
+    /* field 1 gets its attributes in reverse order */
+    for (i = NMANY_ATTRS - 1; i >= 0; i--) {
+        value = i;
+        snprintf(name, sizeof(name), "attr%d", i);
+        ret = VSsetattr(vsid, 1, name, DFNT_INT32, 1, &value);
+        CHECK_VOID(ret, FAIL, "VSsetattr");
+    }
+    check_findattr_many(vgid, vsid, NMANY_ATTRS, TRUE);
+
+    /* setting an attribute again does not add a name */
+    value = -1;
+    ret   = Vsetattr(vgid, "attr3", DFNT_INT32, 1, &value);
+    CHECK_VOID(ret, FAIL, "Vsetattr");
+    ret = Vnattrs(vgid);
+    VERIFY_VOID(ret, NMANY_ATTRS, "Vnattrs");
+    ret = Vfindattr(vgid, "attr3");
+    VERIFY_VOID(ret, 3, "Vfindattr");
+
+    vgref = VQueryref(vgid);
+    CHECK_VOID(vgref, FAIL, "VQueryref");
+    vsref = VSQueryref(vsid);
+    CHECK_VOID(vsref, FAIL, "VSQueryref");
+    ret = VSdetach(vsid);
+    CHECK_VOID(ret, FAIL, "VSdetach");
+    ret = Vdetach(vgid);
+    CHECK_VOID(ret, FAIL, "Vdetach");
+    ret = Vend(fid);
+    CHECK_VOID(ret, FAIL, "Vend");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* the names are indexed again from the file */
+    fid = Hopen(FILENAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    ret = Vstart(fid);
+    CHECK_VOID(ret, FAIL, "Vstart");
+    vgid = Vattach(fid, vgref, "r");
+    CHECK_VOID(vgid, FAIL, "Vattach");
+    vsid = VSattach(fid, vsref, "r");
+    CHECK_VOID(vsid, FAIL, "VSattach");
+
+    check_findattr_many(vgid, vsid, NMANY_ATTRS, TRUE);
+
+    /* all the attributes at once; attr3 of the vgroup was set to -1 */
+    ret = Vgetattrs(vgid, &attrs);
+    check_getattrs_many(ret, attrs, FALSE, -1);
+    free(attrs);
+    ret = VSgetattrs(vsid, _HDF_VDATA, &attrs);
+    check_getattrs_many(ret, attrs, FALSE, 3);
+    free(attrs);
+    ret = VSgetattrs(vsid, 1, &attrs);
+    check_getattrs_many(ret, attrs, TRUE, 3);
+    free(attrs);
+    ret = VSgetattrs(vsid, 0, &attrs);
+    VERIFY_VOID(ret, 0, "VSgetattrs");
+    VERIFY_VOID((attrs == NULL), TRUE, "VSgetattrs");
+
+    ret = VSdetach(vsid);
+    CHECK_VOID(ret, FAIL, "VSdetach");
+    ret = Vdetach(vgid);
+    CHECK_VOID(ret, FAIL, "Vdetach");
+    ret = Vend(fid);
+    CHECK_VOID(ret, FAIL, "Vend");
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+} /* test_findattr_many */
+
 /* main test driver */
 void
 test_vset_attr(void)
@@ -822,4 +976,5 @@ test_vset_attr(void)
     write_vattrs();
     read_vattrs();
     test_readattrtwice();
+    test_findattr_many();
 } /* test_vset_attr */
@@ -30,6 +30,8 @@
 #define FNAME0     "tvset.hdf"
 #define EXTFNM     "tvsetext.hdf"
 #define EMPTYNM    "tvsempty.hdf"
+#define FIELDSNM   "tvsfields.hdf"
+#define MEMBERSNM  "tvgmembers.hdf"
 #define LONGNAMES  "tlongnames.hdf"
 #define LKBLK_FILE "tvsblkinfo.hdf"
 
@@ -59,7 +61,9 @@ static int32 read_vset_stuff(void);
 static void  test_vsdelete(void);
 static void  test_vdelete(void);
 static void  test_vdeletetagref(void);
+static void  test_vaddtagrefs(void);
 static void  test_emptyvdata(void);
+static void  test_vsfields_reattach(void);
 static void  test_vglongnames(void);
 static void  test_getvgroups(void);
 static void  test_getvdatas(void);
@@ -1601,6 +1605,114 @@ test_vdeletetagref(void)
 
 } /* test_vdeletetagref */
 
+/* Tests adding, finding and deleting the members of a large vgroup */
+#define NUM_MEMBERS 1000
+static void
+test_vaddtagrefs(void)
+{
+    int32 status; /* Status values from routines */
+    int32 fid;    /* File ID */
+    int32 vg1;    /* Vgroup ID */
+    int32 ref;    /* Vgroup ref */
+    int32 tags[NUM_MEMBERS], refs[NUM_MEMBERS];
+    int32 rtags[NUM_MEMBERS], rrefs[NUM_MEMBERS];
+    int32 i, n;
+
+    /* Members 0, 2, 4... are vdatas, the others vgroups */
+    for (i = 0; i < NUM_MEMBERS; i++) {
+        tags[i] = (i % 2 == 0) ? DFTAG_VH : DFTAG_VG;
+        refs[i] = 1000 + i / 2;
+    }
+
+    fid = Hopen(MEMBERSNM, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+
+    vg1 = Vattach(fid, -1, "w");
+    CHECK_VOID(vg1, FAIL, "Vattach");
+    status = Vsetname(vg1, "Members");
+    CHECK_VOID(status, FAIL, "Vsetname");
+
+    /* Add a few members one at a time, then the rest all at once */
+    for (i = 0; i < 10; i++) {
+        status = Vaddtagref(vg1, tags[i], refs[i]);
+        VERIFY_VOID(status, i + 1, "Vaddtagref");
+    }
+    status = Vaddtagrefs(vg1, NUM_MEMBERS - 10, &tags[10], &refs[10]);
+    VERIFY_VOID(status, NUM_MEMBERS, "Vaddtagrefs");
+    status = Vaddtagrefs(vg1, -1, tags, refs);
+    VERIFY_VOID(status, FAIL, "Vaddtagrefs");
+
+    for (i = 0; i < NUM_MEMBERS; i += 37) {
+        status = Vinqtagref(vg1, tags[i], refs[i]);
+        VERIFY_VOID(status, TRUE, "Vinqtagref");
+    }
+    status = Vinqtagref(vg1, DFTAG_VH, 1000 + NUM_MEMBERS);
+    VERIFY_VOID(status, FALSE, "Vinqtagref");
+
+    /* A pair added twice must be deleted twice */
+    status = Vaddtagref(vg1, tags[5], refs[5]);
+    VERIFY_VOID(status, NUM_MEMBERS + 1, "Vaddtagref");
+    status = Vdeletetagref(vg1, tags[5], refs[5]);
+    CHECK_VOID(status, FAIL, "Vdeletetagref");
+    status = Vinqtagref(vg1, tags[5], refs[5]);
+    VERIFY_VOID(status, TRUE, "Vinqtagref");
+    status = Vdeletetagref(vg1, tags[5], refs[5]);
+    CHECK_VOID(status, FAIL, "Vdeletetagref");
+    status = Vinqtagref(vg1, tags[5], refs[5]);
+    VERIFY_VOID(status, FALSE, "Vinqtagref");
+    status = Vdeletetagref(vg1, tags[5], refs[5]);
+    VERIFY_VOID(status, FAIL, "Vdeletetagref");
+
+    /* Delete the last member, and add back member 5 at the end */
+    status = Vdeletetagref(vg1, tags[NUM_MEMBERS - 1], refs[NUM_MEMBERS - 1]);
+    CHECK_VOID(status, FAIL, "Vdeletetagref");
+    status = Vaddtagref(vg1, tags[5], refs[5]);
+    VERIFY_VOID(status, NUM_MEMBERS - 1, "Vaddtagref");
+
+    status = Vdetach(vg1);
+    CHECK_VOID(status, FAIL, "Vdetach");
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+
+    /* Reopen the file and check the members and their order */
+    fid = Hopen(MEMBERSNM, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+
+    ref = Vfind(fid, "Members");
+    CHECK_VOID(ref, FAIL, "Vfind");
+    vg1 = Vattach(fid, ref, "r");
+    CHECK_VOID(vg1, FAIL, "Vattach");
+
+    n = Vgettagrefs(vg1, rtags, rrefs, NUM_MEMBERS);
+    VERIFY_VOID(n, NUM_MEMBERS - 1, "Vgettagrefs");
+    for (i = 0; i < n; i++) {
+        int32 j = (i < 5) ? i : (i < NUM_MEMBERS - 2) ? i + 1 : 5;
+
+        if (rtags[i] != tags[j] || rrefs[i] != refs[j]) {
+            num_errs++;
+            printf(">>> Got bogus member %d: tag %d ref %d\n", (int)i, (int)rtags[i], (int)rrefs[i]);
+        }
+    }
+
+    status = Vinqtagref(vg1, tags[NUM_MEMBERS - 1], refs[NUM_MEMBERS - 1]);
+    VERIFY_VOID(status, FALSE, "Vinqtagref");
+    status = Vinqtagref(vg1, tags[5], refs[5]);
+    VERIFY_VOID(status, TRUE, "Vinqtagref");
+
+    status = Vdetach(vg1);
+    CHECK_VOID(status, FAIL, "Vdetach");
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+} /* test_vaddtagrefs() */
+
 static void
 test_emptyvdata(void)
 {
@@ -1763,6 +1875,123 @@ test_emptyvdata(void)
 
 } /* test_emptyvdata() */
 
+/* Tests reading a vdata that is attached again and again, with the same
+   or different fields selected each time */
+#define NUM_FIELD_RECS 5
+#define NUM_REATTACH   20
+static void
+test_vsfields_reattach(void)
+{
+    int32 status; /* Status values from routines */
+    int32 fid;    /* File ID */
+    int32 vs1;    /* Vdata ID */
+    int32 ref;    /* Vdata ref */
+    int32 data[NUM_FIELD_RECS][ORDER_1 + ORDER_2 + ORDER_3];
+    int32 rdata[NUM_FIELD_RECS * (ORDER_1 + ORDER_2 + ORDER_3)];
+    int32 *rec;
+    intn  i, j, k;
+
+    for (i = 0; i < NUM_FIELD_RECS; i++)
+        for (j = 0; j < ORDER_1 + ORDER_2 + ORDER_3; j++)
+            data[i][j] = i * 100 + j;
+
+    /* Create a vdata with three fields and a few records */
+    fid = Hopen(FIELDSNM, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+
+    vs1 = VSattach(fid, -1, "w");
+    CHECK_VOID(vs1, FAIL, "VSattach");
+    status = VSsetname(vs1, "Fields");
+    CHECK_VOID(status, FAIL, "VSsetname");
+    status = VSfdefine(vs1, FIELD1_NAME, DFNT_INT32, ORDER_1);
+    CHECK_VOID(status, FAIL, "VSfdefine");
+    status = VSfdefine(vs1, FIELD2_NAME, DFNT_INT32, ORDER_2);
+    CHECK_VOID(status, FAIL, "VSfdefine");
+    status = VSfdefine(vs1, FIELD3_NAME, DFNT_INT32, ORDER_3);
+    CHECK_VOID(status, FAIL, "VSfdefine");
+    status = VSsetfields(vs1, FIELD_NAME_LIST);
+    CHECK_VOID(status, FAIL, "VSsetfields");
+    status = VSwrite(vs1, (uint8 *)data, NUM_FIELD_RECS, FULL_INTERLACE);
+    VERIFY_VOID(status, NUM_FIELD_RECS, "VSwrite");
+    status = VSdetach(vs1);
+    CHECK_VOID(status, FAIL, "VSdetach");
+
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+
+    /* Attach it many times, selecting the fields read in turn.  Each selection
+       is made on two attaches in a row, so the second one finds the read list
+       of the first one still there and must read the same data through it */
+    fid = Hopen(FIELDSNM, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+
+    ref = VSfind(fid, "Fields");
+    CHECK_VOID(ref, FAIL, "VSfind");
+
+    for (k = 0; k < NUM_REATTACH; k++) {
+        vs1 = VSattach(fid, ref, "r");
+        CHECK_VOID(vs1, FAIL, "VSattach");
+
+        /* A bad field fails, and does not spoil the next selection */
+        if (k % 3 == 2) {
+            status = VSsetfields(vs1, FIELD2_NAME ",Bogus");
+            VERIFY_VOID(status, FAIL, "VSsetfields");
+        }
+
+        if ((k / 2) % 2 == 0) {
+            status = VSsetfields(vs1, FIELD2_NAME);
+            CHECK_VOID(status, FAIL, "VSsetfields");
+            status = VSsizeof(vs1, FIELD2_NAME);
+            VERIFY_VOID(status, ORDER_2 * (int32)sizeof(int32), "VSsizeof");
+
+            status = VSread(vs1, (uint8 *)rdata, NUM_FIELD_RECS, FULL_INTERLACE);
+            VERIFY_VOID(status, NUM_FIELD_RECS, "VSread");
+            for (i = 0; i < NUM_FIELD_RECS; i++)
+                if (rdata[i] != data[i][ORDER_1]) {
+                    num_errs++;
+                    printf(">>> Got bogus %s in record %d: %d\n", FIELD2_NAME, (int)i, (int)rdata[i]);
+                }
+        }
+        else {
+            status = VSsetfields(vs1, FIELD3_NAME "," FIELD1_NAME);
+            CHECK_VOID(status, FAIL, "VSsetfields");
+            status = VSsizeof(vs1, FIELD3_NAME "," FIELD1_NAME);
+            VERIFY_VOID(status, (ORDER_3 + ORDER_1) * (int32)sizeof(int32), "VSsizeof");
+
+            status = VSread(vs1, (uint8 *)rdata, NUM_FIELD_RECS, FULL_INTERLACE);
+            VERIFY_VOID(status, NUM_FIELD_RECS, "VSread");
+            for (i = 0; i < NUM_FIELD_RECS; i++) {
+                rec = &rdata[i * (ORDER_3 + ORDER_1)];
+                for (j = 0; j < ORDER_3; j++)
+                    if (rec[j] != data[i][ORDER_1 + ORDER_2 + j]) {
+                        num_errs++;
+                        printf(">>> Got bogus %s in record %d: %d\n", FIELD3_NAME, (int)i, (int)rec[j]);
+                    }
+                for (j = 0; j < ORDER_1; j++)
+                    if (rec[ORDER_3 + j] != data[i][j]) {
+                        num_errs++;
+                        printf(">>> Got bogus %s in record %d: %d\n", FIELD1_NAME, (int)i,
+                               (int)rec[ORDER_3 + j]);
+                    }
+            }
+        }
+
+        status = VSdetach(vs1);
+        CHECK_VOID(status, FAIL, "VSdetach");
+    }
+
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+} /* test_vsfields_reattach() */
+
 static void
 test_vglongnames(void)
 {
@@ -3352,9 +3581,15 @@ test_vsets(void)
     /* test Vdeletetagref() */
     test_vdeletetagref();
 
+    /* test Vaddtagrefs() and the lookups in a large vgroup */
+    test_vaddtagrefs();
+
     /* test Vdatas with no fields defined */
     test_emptyvdata();
 
+    /* test selecting fields of a vdata that is attached many times */
+    test_vsfields_reattach();
+
     /* test Vgroups with name and class that have more than 64 characters */
     test_vglongnames();
 
@@ -299,3 +299,12 @@ ADD_H4_TEST(VGROUP "TEST" ${HREPACK_FILE3})
 
 #    if (vg_verifygrpdep(HREPACK_FILE3,HREPACK_FILE3_OUT) != 0 )
 #        goto out;
+
+#-------------------------------------------------------------------------
+# test12:
+# auto-tune the compression, chunking SELECTED and no chunking
+#-------------------------------------------------------------------------
+#
+ADD_H4_TEST(AUTO_SIZE "TEST" ${HREPACK_FILE1} -a SIZE)
+ADD_H4_TEST(AUTO_BALANCE_CHUNK "TEST" ${HREPACK_FILE1} -t "dset5:RLE" -c dset4:10x8 -c dset5:10x8 -a BALANCE)
+ADD_H4_TEST(AUTO_SPEED_NONE "TEST" ${HREPACK_FILE1} -t "dset4:NONE" -a SPEED)
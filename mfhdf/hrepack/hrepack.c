@@ -41,6 +41,8 @@ int list_main(const char *infname, const char *outfname, options_t *options);
 int
 hrepack_main(const char *infile, const char *outfile, options_t *options)
 {
+    int ret;
+
     options->trip = 0;
 
     /* also checks input */
@@ -54,11 +56,26 @@ hrepack_main(const char *infile, const char *outfile, options_t *options)
     /* the real deal now */
     options->trip = 1;
 
+    /* scratch file where -a tries the compressions, next to the output;
+       it is shared by all the SDSs and removed at the end */
+    if (options->tune != TUNE_NONE) {
+        snprintf(options->tune_fname, sizeof(options->tune_fname), "%s.tune", outfile);
+        options->tune_sd = SDstart(options->tune_fname, DFACC_CREATE);
+    }
+
     if (options->verbose)
         printf("Making new file %s...\n", outfile);
 
     /* this can fail for different reasons */
-    if (list_main(infile, outfile, options) < 0)
+    ret = list_main(infile, outfile, options);
+
+    if (options->tune_sd != FAIL) {
+        SDend(options->tune_sd);
+        options->tune_sd = FAIL;
+        remove(options->tune_fname);
+    }
+
+    if (ret < 0)
         return FAIL;
 
     return SUCCEED;
@@ -206,6 +223,7 @@ hrepack_init(options_t *options, int verbose)
     memset(options, 0, sizeof(options_t));
     options->threshold = 1024;
     options->verbose   = verbose;
+    options->tune_sd   = FAIL;
     options_table_init(&(options->op_tbl));
 }
 
@@ -302,6 +320,9 @@ print_options(options_t *options)
                     break;
             };
         }
+        if (options->tune != TUNE_NONE)
+            printf("\tAuto-tune objects without compression information for %s\n",
+                   get_stune(options->tune));
     } /* verbose */
 
     for (i = 0; i < options->op_tbl->nelems; i++) {
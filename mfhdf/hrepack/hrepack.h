@@ -24,6 +24,12 @@
 #define TAG_GRP_IMAGE DFTAG_RIG
 #define TAG_GRP_DSET  DFTAG_NDG
 
+/* goals for the -a option, compression chosen by sampling each SDS */
+#define TUNE_NONE    0 /* no auto-tuning */
+#define TUNE_SIZE    1 /* smallest output */
+#define TUNE_SPEED   2 /* fastest to read back */
+#define TUNE_BALANCE 3 /* smallest output among the fast readers */
+
 /* a list of names */
 typedef struct {
     char obj[H4_MAX_NC_NAME];
@@ -46,6 +52,7 @@ typedef struct {
 typedef struct {
     char         objpath[H4_MAX_NC_NAME]; /* name of object */
     comp_info_t  comp;                    /* compression information */
+    int          comp_set;                /* 1 if a -t option gave comp, even NONE */
     chunk_info_t chunk;                   /* chunk information */
 } pack_info_t;
 
@@ -58,14 +65,17 @@ typedef struct {
 
 /* all the above, ready to go to the hrepack call */
 typedef struct {
-    options_table_t *op_tbl;    /*table with all -c and -t options */
-    int              all_chunk; /*chunk all objects, input of "*" */
-    int              all_comp;  /*comp all objects, input of "*" */
-    comp_info_t      comp_g;    /*global compress INFO for the ALL case */
-    chunk_info_t     chunk_g;   /*global chunk INFO for the ALL case */
-    int              verbose;   /*verbose mode */
-    int              trip;      /*which cycle are we in */
-    int              threshold; /*minimum size to compress, in bytes */
+    options_table_t *op_tbl;           /*table with all -c and -t options */
+    int              all_chunk;        /*chunk all objects, input of "*" */
+    int              all_comp;         /*comp all objects, input of "*" */
+    comp_info_t      comp_g;           /*global compress INFO for the ALL case */
+    chunk_info_t     chunk_g;          /*global chunk INFO for the ALL case */
+    int              verbose;          /*verbose mode */
+    int              trip;             /*which cycle are we in */
+    int              threshold;        /*minimum size to compress, in bytes */
+    int              tune;             /*auto-tune goal of the -a option, TUNE_NONE if not tuning */
+    char             tune_fname[1024]; /*scratch file where the -a option tries compressions */
+    int32            tune_sd;          /*SD id of the scratch file, FAIL when it is not open */
 } options_t;
 
 #ifdef __cplusplus
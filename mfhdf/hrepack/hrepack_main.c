@@ -90,6 +90,14 @@ main(int argc, char **argv)
             ++i;
         }
 
+        else if (strcmp(argv[i], "-a") == 0) {
+
+            options.tune = parse_tune(argv[i + 1]);
+            if (options.tune == -1)
+                goto out;
+            ++i;
+        }
+
         else if (strcmp(argv[i], "-f") == 0) {
             if (read_info(argv[++i], &options) < 0)
                 goto out;
@@ -139,7 +147,7 @@ usage(void)
 {
 
     printf("usage: hrepack -i input -o output [-V] [-h] [-v] [-t 'comp_info'] [-c 'chunk_info'] [-f cfile] "
-           "[-m size]\n");
+           "[-m size] [-a goal]\n");
     printf("  -i input          input HDF File\n");
     printf("  -o output         output HDF File\n");
     printf("  [-V]              prints version of the HDF4 library and exits\n");
@@ -173,6 +181,12 @@ usage(void)
     printf("\t\t        NONE, to unchunk a previous chunked object\n");
     printf("  [-f cfile]      file with compression information -t and -c\n");
     printf("  [-m size]       do not compress objects smaller than size (bytes)\n");
+    printf("  [-a goal]       choose the compression of each SDS without -t information by\n");
+    printf("\t\t     compressing samples of it with each type; 'goal' can be:\n");
+    printf("\t\t       SIZE, for the smallest output\n");
+    printf("\t\t       SPEED, for the fastest read among types saving 10%% or more\n");
+    printf("\t\t       BALANCE, for the smallest output among types reading at most\n");
+    printf("\t\t        twice as slow as the fastest one\n");
     printf("\n");
     printf("Examples:\n");
     printf("\n");
@@ -193,5 +207,8 @@ usage(void)
     printf("4) hrepack -v -i file1.hdf -o file2.hdf -t 'A:SZIP 8,NN'\n");
     printf("   applies SZIP compression to object A, with parameters 8 and NN\n");
     printf("\n");
+    printf("5) hrepack -v -i file1.hdf -o file2.hdf -c '*:10x10' -a BALANCE\n");
+    printf("   chunks all objects and picks a compression for each one by sampling its chunks\n");
+    printf("\n");
     printf("Note: the use of the verbose option -v is recommended\n");
 }
@@ -40,6 +40,7 @@ options_table_init(options_table_t **tbl)
         HDstrcpy(op_tbl->objs[i].objpath, "\0");
         op_tbl->objs[i].comp.info  = -1;
         op_tbl->objs[i].comp.type  = COMP_CODE_NONE;
+        op_tbl->objs[i].comp_set   = 0;
         op_tbl->objs[i].chunk.rank = -1;
     }
 
@@ -86,6 +87,7 @@ options_add_chunk(obj_list_t *obj_list, int n_objs, int32 *chunk_lengths, int ch
             HDstrcpy(op_tbl->objs[i].objpath, "\0");
             op_tbl->objs[i].comp.info  = -1;
             op_tbl->objs[i].comp.type  = COMP_CODE_NONE;
+            op_tbl->objs[i].comp_set   = 0;
             op_tbl->objs[i].chunk.rank = -1;
         }
     }
@@ -166,6 +168,7 @@ options_add_comp(obj_list_t *obj_list, int n_objs, comp_info_t comp, options_tab
             HDstrcpy(op_tbl->objs[i].objpath, "\0");
             op_tbl->objs[i].comp.info  = -1;
             op_tbl->objs[i].comp.type  = COMP_CODE_NONE;
+            op_tbl->objs[i].comp_set   = 0;
             op_tbl->objs[i].chunk.rank = -1;
         }
     }
@@ -186,8 +189,9 @@ options_add_comp(obj_list_t *obj_list, int n_objs, comp_info_t comp, options_tab
                     }
                     /* insert the comp info */
                     else {
-                        op_tbl->objs[i].comp = comp;
-                        found                = 1;
+                        op_tbl->objs[i].comp     = comp;
+                        op_tbl->objs[i].comp_set = 1;
+                        found                    = 1;
                         break;
                     }
                 } /* if */
@@ -198,7 +202,8 @@ options_add_comp(obj_list_t *obj_list, int n_objs, comp_info_t comp, options_tab
                 I = op_tbl->nelems + added;
                 added++;
                 HDstrcpy(op_tbl->objs[I].objpath, obj_list[j].obj);
-                op_tbl->objs[I].comp = comp;
+                op_tbl->objs[I].comp     = comp;
+                op_tbl->objs[I].comp_set = 1;
             }
         } /* j */
     }
@@ -210,7 +215,8 @@ options_add_comp(obj_list_t *obj_list, int n_objs, comp_info_t comp, options_tab
             I = op_tbl->nelems + added;
             added++;
             HDstrcpy(op_tbl->objs[I].objpath, obj_list[j].obj);
-            op_tbl->objs[I].comp = comp;
+            op_tbl->objs[I].comp     = comp;
+            op_tbl->objs[I].comp_set = 1;
         }
     }
 
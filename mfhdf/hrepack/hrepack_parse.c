@@ -476,3 +476,50 @@ get_scomp(comp_coder_t code)
     }
     return NULL;
 }
+
+/*-------------------------------------------------------------------------
+ * Function: parse_tune
+ *
+ * Purpose: read the goal of the -a option
+ *   Example: -a BALANCE
+ *
+ * Return: TUNE_SIZE, TUNE_SPEED, TUNE_BALANCE or -1 for an invalid goal
+ *
+ *-------------------------------------------------------------------------
+ */
+
+int
+parse_tune(const char *str)
+{
+    if (str == NULL)
+        return -1;
+    if (HDstrcmp(str, "SIZE") == 0)
+        return TUNE_SIZE;
+    if (HDstrcmp(str, "SPEED") == 0)
+        return TUNE_SPEED;
+    if (HDstrcmp(str, "BALANCE") == 0)
+        return TUNE_BALANCE;
+
+    printf("Input Error: Invalid auto-tune goal <%s>\n", str);
+    return -1;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: get_stune
+ *
+ * Purpose: return the auto-tune goal as a string
+ *
+ *-------------------------------------------------------------------------
+ */
+
+const char *
+get_stune(int goal)
+{
+    if (goal == TUNE_SIZE)
+        return "SIZE";
+    else if (goal == TUNE_SPEED)
+        return "SPEED";
+    else if (goal == TUNE_BALANCE)
+        return "BALANCE";
+    return "NONE";
+}
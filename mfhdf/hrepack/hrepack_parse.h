@@ -29,6 +29,11 @@ int parse_number(char *str);
 obj_list_t *parse_comp(const char *str, int *n_objs, comp_info_t *comp);
 const char *get_scomp(comp_coder_t code);
 
+/* auto-tuning */
+
+int         parse_tune(const char *str);
+const char *get_stune(int goal);
+
 /* chunking */
 
 obj_list_t *parse_chunk(const char *str, int *n_objs, int32 *chunk_lengths, int *chunk_rank);
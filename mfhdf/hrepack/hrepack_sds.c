@@ -21,6 +21,7 @@
 #include "hrepack_parse.h"
 #include "hrepack_opttable.h"
 #include "hrepack_dim.h"
+#include "hrepack_tune.h"
 
 #define H4TOOLS_BUFSIZE    (1024 * 1024)
 #define H4TOOLS_MALLOCSIZE (1024 * 1024)
@@ -301,6 +302,19 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
             );
             if (have_info == FAIL)
                 goto out;
+
+            /* with -a, sample the object to pick a compression, unless -t gave it one, */
+            /* even NONE; the size is counted in size_t, it may not fit in an int32 */
+            if (options->tune != TUNE_NONE && options->all_comp == 0 &&
+                (size_t)nelms * (size_t)eltsz >= (size_t)options->threshold) {
+                pack_info_t *obj = options_get_object(path, options->op_tbl);
+
+                if (obj == NULL || !obj->comp_set) {
+                    if (tune_sds(sds_id, path, options, rank, dimsizes, dtype, &chunk_flags, &chunk_def,
+                                 &comp_type, &info, &szip_mode) == FAIL)
+                        printf("Warning: could not auto-tune <%s>, keeping its compression\n", path);
+                }
+            }
         } /* check inspection mode */
 
         /*-------------------------------------------------------------------------
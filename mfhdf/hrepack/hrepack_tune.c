@@ -0,0 +1,392 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <time.h>
+#include "hdf.h"
+#include "mfhdf.h"
+#include "hrepack.h"
+#include "hrepack_tune.h"
+#include "hrepack_utils.h"
+#include "hrepack_parse.h"
+
+#define TUNE_SAMPLE_BYTES   (256 * 1024) /* size of each sample block, when not chunked */
+#define TUNE_NSAMPLES       4            /* number of sample blocks taken along the slowest dimension */
+#define TUNE_NREADS         3            /* number of timed reads of each block; the fastest counts */
+#define TUNE_MAX_CANDS      10           /* room in the table of candidate compressions */
+#define TUNE_BALANCE_FACTOR 2.0          /* BALANCE accepts readers this many times slower than the fastest */
+
+/* one compression tried on the samples and what it gave */
+typedef struct {
+    comp_info_t comp;   /* compression tried */
+    int32       nbytes; /* bytes stored for all samples */
+    double      rtime;  /* seconds to read all samples back */
+    int         ok;     /* 1 if the compression could be applied to the samples */
+} tune_cand_t;
+
+/*-------------------------------------------------------------------------
+ * Function: tune_set_cinfo
+ *
+ * Purpose: translate a candidate into the library compression information
+ *
+ * Return: SUCCEED, FAIL if the candidate cannot be used
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+tune_set_cinfo(comp_info_t *comp, comp_info *c_info)
+{
+    memset(c_info, 0, sizeof(comp_info));
+    switch (comp->type) {
+        case COMP_CODE_NONE:
+        case COMP_CODE_RLE:
+            break;
+        case COMP_CODE_SKPHUFF:
+            c_info->skphuff.skp_size = comp->info;
+            break;
+        case COMP_CODE_DEFLATE:
+            c_info->deflate.level = comp->info;
+            break;
+        case COMP_CODE_SZIP:
+            if (set_szip(comp->info, comp->szip_mode, c_info) == FAIL)
+                return FAIL;
+            break;
+        default:
+            return FAIL;
+    }
+    return SUCCEED;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: tune_label
+ *
+ * Purpose: write a candidate the way it would be given to -t
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static void
+tune_label(comp_info_t *comp, char *label, size_t size)
+{
+    if (comp->type == COMP_CODE_SZIP)
+        snprintf(label, size, "SZIP %d,%s", comp->info, comp->szip_mode == NN_MODE ? "NN" : "EC");
+    else if (comp->type == COMP_CODE_SKPHUFF || comp->type == COMP_CODE_DEFLATE)
+        snprintf(label, size, "%s %d", get_scomp(comp->type), comp->info);
+    else
+        snprintf(label, size, "%s", get_scomp(comp->type));
+}
+
+/*-------------------------------------------------------------------------
+ * Function: tune_try
+ *
+ * Purpose: store one sample block in the scratch file with a candidate
+ *  compression, then read it back; add the stored size and the read time
+ *  to the candidate
+ *
+ * Return: SUCCEED, FAIL if the candidate cannot be used for this block
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+tune_try(int32 sd_tmp, tune_cand_t *cand, int32 rank, int32 *edges, int32 dtype, int chunked, void *buf,
+         void *rbuf, int ntry)
+{
+    char          name[H4_MAX_NC_NAME];
+    int32         sds_id;
+    int32         index;
+    int32         start[H4_MAX_VAR_DIMS];
+    int32         comp_size, uncomp_size;
+    int32         flags;
+    HDF_CHUNK_DEF chunk_def;
+    comp_info     c_info;
+    clock_t       t0;
+    double        t, tmin = -1.0;
+    int           i;
+
+    if (tune_set_cinfo(&cand->comp, &c_info) == FAIL)
+        return FAIL;
+
+    for (i = 0; i < rank; i++)
+        start[i] = 0;
+
+    snprintf(name, sizeof(name), "tune%d", ntry);
+    if ((sds_id = SDcreate(sd_tmp, name, dtype, rank, edges)) == FAIL)
+        return FAIL;
+    /* the names repeat from one SDS to the next, so the block is found again by its index */
+    if ((index = SDreftoindex(sd_tmp, SDidtoref(sds_id))) == FAIL)
+        goto out;
+
+    /* the block is one chunk of the output when it is chunked */
+    if (chunked) {
+        memset(&chunk_def, 0, sizeof(HDF_CHUNK_DEF));
+        for (i = 0; i < rank; i++)
+            chunk_def.comp.chunk_lengths[i] = edges[i];
+        chunk_def.comp.comp_type = cand->comp.type;
+        chunk_def.comp.cinfo     = c_info;
+        flags = (cand->comp.type > COMP_CODE_NONE) ? (HDF_CHUNK | HDF_COMP) : HDF_CHUNK;
+        if (SDsetchunk(sds_id, chunk_def, flags) == FAIL)
+            goto out;
+    }
+    else if (cand->comp.type > COMP_CODE_NONE) {
+        if (SDsetcompress(sds_id, cand->comp.type, &c_info) == FAIL)
+            goto out;
+    }
+
+    if (SDwritedata(sds_id, start, NULL, edges, buf) == FAIL)
+        goto out;
+    if (SDendaccess(sds_id) == FAIL)
+        return FAIL;
+
+    /* read back from a fresh access each time, so nothing decoded is cached */
+    for (i = 0; i < TUNE_NREADS; i++) {
+        t0 = clock();
+        if ((sds_id = SDselect(sd_tmp, index)) == FAIL)
+            return FAIL;
+        if (SDreaddata(sds_id, start, NULL, edges, rbuf) == FAIL)
+            goto out;
+        t = (double)(clock() - t0) / CLOCKS_PER_SEC;
+        if (tmin < 0 || t < tmin)
+            tmin = t;
+        if (i < TUNE_NREADS - 1 && SDendaccess(sds_id) == FAIL)
+            return FAIL;
+    }
+
+    if (SDgetdatasize(sds_id, &comp_size, &uncomp_size) == FAIL)
+        goto out;
+    SDendaccess(sds_id);
+
+    cand->nbytes += comp_size;
+    cand->rtime += tmin;
+    return SUCCEED;
+
+out:
+    SDendaccess(sds_id);
+    return FAIL;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: tune_sds
+ *
+ * Purpose: choose the compression of an SDS for the -a option
+ *
+ * A few blocks of the SDS are read (one chunk each when the output is
+ * chunked, otherwise about TUNE_SAMPLE_BYTES of contiguous rows), spread
+ * along the slowest dimension. Each candidate compression (RLE, HUFF,
+ * GZIP at fast, default and best levels, SZIP NN and EC) stores the
+ * blocks in a scratch file, which is read back to time decoding. The
+ * goal then picks the candidate:
+ *
+ *  SIZE     the fewest stored bytes
+ *  SPEED    the fastest read among candidates saving at least 10%
+ *  BALANCE  the fewest stored bytes among candidates reading no more
+ *           than TUNE_BALANCE_FACTOR times slower than the fastest
+ *           candidate saving at least 10%
+ *
+ * NONE is chosen when no candidate saves 10%. The decision is printed,
+ * with all the candidates in verbose mode.
+ *
+ * Return: SUCCEED, FAIL if the samples could not be taken; the
+ *  compression and chunk information are unchanged on FAIL
+ *
+ *-------------------------------------------------------------------------
+ */
+
+int
+tune_sds(int32 sds_id, char *path, options_t *options, int32 rank, int32 *dimsizes, int32 dtype,
+         int32 *chunk_flags, HDF_CHUNK_DEF *chunk_def, comp_coder_t *comp_type, int *info, int *szip_mode)
+{
+    tune_cand_t cands[TUNE_MAX_CANDS];
+    int         ncands = 0;
+    char        label[32];
+    int32       blk[H4_MAX_VAR_DIMS];   /* size of a sample block */
+    int32       start[H4_MAX_VAR_DIMS]; /* start of the current sample block */
+    int32       edges[H4_MAX_VAR_DIMS]; /* edges of the current sample block */
+    int32       eltsz;
+    int32       nblk, nsamples, budget;
+    size_t      raw = 0; /* bytes sampled, before compression */
+    int32       sd_tmp   = options->tune_sd;
+    void       *buf      = NULL;
+    void       *rbuf     = NULL;
+    int         chunked  = (*chunk_flags & HDF_CHUNK) ? 1 : 0;
+    int         best     = -1;
+    int         fastest  = -1;
+    int         ntry     = 0;
+    size_t      blkbytes = 1;
+    int         i, j, k;
+
+    eltsz = DFKNTsize((dtype & DFNT_MASK) | DFNT_NATIVE);
+    if (rank < 1 || eltsz <= 0)
+        return FAIL;
+
+    /*-------------------------------------------------------------------------
+     * candidates
+     *-------------------------------------------------------------------------
+     */
+    memset(cands, 0, sizeof(cands));
+    cands[ncands++].comp.type = COMP_CODE_NONE;
+    cands[ncands++].comp.type = COMP_CODE_RLE;
+    cands[ncands].comp.type   = COMP_CODE_SKPHUFF;
+    cands[ncands++].comp.info = eltsz;
+    cands[ncands].comp.type   = COMP_CODE_DEFLATE;
+    cands[ncands++].comp.info = 1;
+    cands[ncands].comp.type   = COMP_CODE_DEFLATE;
+    cands[ncands++].comp.info = 6;
+    cands[ncands].comp.type   = COMP_CODE_DEFLATE;
+    cands[ncands++].comp.info = 9;
+#ifdef H4_HAVE_LIBSZ
+    if (SZ_encoder_enabled()) {
+        /* pixels per block must be even and no more than a scanline */
+        int ppb = (dimsizes[rank - 1] < 16 ? dimsizes[rank - 1] : 16) & ~1;
+
+        if (chunked && chunk_def->chunk_lengths[rank - 1] < ppb)
+            ppb = chunk_def->chunk_lengths[rank - 1] & ~1;
+        if (ppb >= 2) {
+            cands[ncands].comp.type        = COMP_CODE_SZIP;
+            cands[ncands].comp.info        = ppb;
+            cands[ncands++].comp.szip_mode = NN_MODE;
+            cands[ncands].comp.type        = COMP_CODE_SZIP;
+            cands[ncands].comp.info        = ppb;
+            cands[ncands++].comp.szip_mode = EC_MODE;
+        }
+    }
+#endif
+    for (i = 0; i < ncands; i++)
+        cands[i].ok = 1;
+
+    /*-------------------------------------------------------------------------
+     * size of the sample blocks: a chunk, or whole rows filling the budget
+     *-------------------------------------------------------------------------
+     */
+    budget = TUNE_SAMPLE_BYTES / eltsz;
+    for (i = rank - 1; i >= 0; i--) {
+        if (chunked)
+            blk[i] = chunk_def->chunk_lengths[i] < dimsizes[i] ? chunk_def->chunk_lengths[i] : dimsizes[i];
+        else {
+            blk[i] = dimsizes[i] < budget ? dimsizes[i] : budget;
+            if (blk[i] < 1)
+                blk[i] = 1;
+            budget /= blk[i];
+        }
+        if (blk[i] < 1)
+            return FAIL;
+        blkbytes *= (size_t)blk[i];
+    }
+    blkbytes *= (size_t)eltsz;
+
+    nblk     = (dimsizes[0] + blk[0] - 1) / blk[0];
+    nsamples = nblk < TUNE_NSAMPLES ? nblk : TUNE_NSAMPLES;
+
+    if (sd_tmp == FAIL)
+        return FAIL;
+    if ((buf = malloc(blkbytes)) == NULL || (rbuf = malloc(blkbytes)) == NULL)
+        goto out;
+
+    /*-------------------------------------------------------------------------
+     * try every candidate on every sample block
+     *-------------------------------------------------------------------------
+     */
+    for (k = 0; k < nsamples; k++) {
+        for (i = 0; i < rank; i++) {
+            start[i] = 0;
+            edges[i] = blk[i];
+        }
+        start[0] = (int32)(((long)k * nblk / nsamples) * blk[0]);
+        if (start[0] + edges[0] > dimsizes[0])
+            edges[0] = dimsizes[0] - start[0];
+
+        if (SDreaddata(sds_id, start, NULL, edges, buf) == FAIL)
+            goto out;
+
+        raw += blkbytes / (size_t)blk[0] * (size_t)edges[0];
+        for (j = 0; j < ncands; j++) {
+            if (!cands[j].ok)
+                continue;
+            if (tune_try(sd_tmp, &cands[j], rank, edges, dtype, chunked, buf, rbuf, ntry++) == FAIL)
+                cands[j].ok = 0;
+        }
+    }
+
+    /*-------------------------------------------------------------------------
+     * decide
+     *-------------------------------------------------------------------------
+     */
+    for (j = 1; j < ncands; j++) {
+        if (!cands[j].ok || (double)cands[j].nbytes > 0.9 * raw)
+            continue;
+        if (fastest == -1 || cands[j].rtime < cands[fastest].rtime)
+            fastest = j;
+    }
+
+    if (fastest == -1)
+        best = 0;
+    else if (options->tune == TUNE_SPEED)
+        best = fastest;
+    else {
+        for (j = 1; j < ncands; j++) {
+            if (!cands[j].ok)
+                continue;
+            if (options->tune == TUNE_BALANCE &&
+                cands[j].rtime > TUNE_BALANCE_FACTOR * cands[fastest].rtime)
+                continue;
+            if (best == -1 || cands[j].nbytes < cands[best].nbytes ||
+                (cands[j].nbytes == cands[best].nbytes && cands[j].rtime < cands[best].rtime))
+                best = j;
+        }
+    }
+
+    /*-------------------------------------------------------------------------
+     * report
+     *-------------------------------------------------------------------------
+     */
+    if (options->verbose) {
+        printf("Auto-tune candidates for <%s>, %lu bytes sampled\n", path, (unsigned long)raw);
+        for (j = 0; j < ncands; j++) {
+            tune_label(&cands[j].comp, label, sizeof(label));
+            if (!cands[j].ok)
+                printf("\t%-10s not applicable\n", label);
+            else
+                printf("\t%-10s ratio %6.2f read %9.3f ms\n", label,
+                       cands[j].nbytes > 0 ? (double)raw / cands[j].nbytes : 0.0, cands[j].rtime * 1000.0);
+        }
+    }
+    tune_label(&cands[best].comp, label, sizeof(label));
+    printf("Auto-tune %s <%s>: %s, ratio %.2f\n", get_stune(options->tune), path, label,
+           cands[best].nbytes > 0 ? (double)raw / cands[best].nbytes : 0.0);
+
+    /*-------------------------------------------------------------------------
+     * hand the choice back, the same way options_get_info does
+     *-------------------------------------------------------------------------
+     */
+    *comp_type = cands[best].comp.type;
+    *info      = cands[best].comp.info;
+    *szip_mode = cands[best].comp.szip_mode;
+    if (chunked) {
+        if (*comp_type > COMP_CODE_NONE) {
+            *chunk_flags              = HDF_CHUNK | HDF_COMP;
+            chunk_def->comp.comp_type = *comp_type;
+            tune_set_cinfo(&cands[best].comp, &chunk_def->comp.cinfo);
+        }
+        else
+            *chunk_flags = HDF_CHUNK;
+    }
+
+    free(buf);
+    free(rbuf);
+    return SUCCEED;
+
+out:
+    free(buf);
+    free(rbuf);
+    return FAIL;
+}
@@ -0,0 +1,42 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * Copyright by the Board of Trustees of the University of Illinois.         *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef HREPACK_TUNE_H
+#define HREPACK_TUNE_H
+
+#include "hdf.h"
+#include "mfhdf.h"
+#include "hrepack.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int tune_sds(int32          sds_id,      /* input SDS IN */
+             char          *path,        /* path of object IN */
+             options_t     *options,     /* global options IN */
+             int32          rank,        /* rank of object IN */
+             int32         *dimsizes,    /* dimensions of object IN */
+             int32          dtype,       /* numeric type IN */
+             int32         *chunk_flags, /* chunk flags IN/OUT */
+             HDF_CHUNK_DEF *chunk_def,   /* chunk definition IN/OUT */
+             comp_coder_t  *comp_type,   /* compression type OUT */
+             int           *info,        /* compression information OUT */
+             int           *szip_mode    /* szip mode OUT */
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HREPACK_TUNE_H */
@@ -577,3 +577,171 @@ func:
         NCadvise(NC_EXDR, "xdr_NC_array: func");
     return (stat);
 }
+
+/*
+ * Name index of an array of dimensions or variables
+ *
+ * NC_dim and NC_var both start with their name, so one index serves both.
+ * Each element is chained, in increasing element order, in the bucket of
+ * the hash of its name.  The index follows the array lazily: elements
+ * appended since the last lookup are added by the next one, and an index
+ * made for another array is rebuilt.  Renaming an element in place must be
+ * followed by NC_nameindex_move().
+ */
+
+/* number of buckets a new name index starts with */
+#define NC_NAMEINDEX_MIN 64
+
+/* name of element 'i' of an array of dimensions or variables */
+#define NC_ELEM_NAME(array, i) (*(NC_string **)((Void **)(array)->values)[i])
+
+/* FNV-1a hash of a name */
+static unsigned
+NC_name_hash(const char *name, unsigned len)
+{
+    unsigned h = 2166136261U;
+
+    while (len-- > 0)
+        h = (h ^ (unsigned char)*name++) * 16777619U;
+    return h;
+}
+
+/* whether 'str' is the 'len' characters of 'name' */
+static int
+NC_name_is(const NC_string *str, const char *name, unsigned len)
+{
+    return (len == str->len && (len == 0 || memcmp(name, str->values, len) == 0));
+}
+
+/* chain element 'i' in the bucket of 'hash', keeping the chain in order */
+static void
+NC_nameindex_link(NC_nameindex *idx, int i, unsigned hash)
+{
+    int *pp = &idx->bucket[hash & (idx->nbuckets - 1)];
+
+    while (*pp != -1 && *pp < i)
+        pp = &idx->next[*pp];
+    idx->next[i] = *pp;
+    *pp          = i;
+    idx->hash[i] = hash;
+}
+
+/* add elements nindexed..count-1 of 'array', growing the index as needed */
+static int
+NC_nameindex_sync(NC_nameindex **idxp, NC_array *array)
+{
+    NC_nameindex *idx = *idxp;
+    unsigned      ii;
+
+    if (idx != NULL && (idx->array != array || idx->nindexed > array->count)) {
+        NC_nameindex_free(idx);
+        idx = *idxp = NULL;
+    }
+
+    if (idx == NULL) {
+        if ((idx = calloc(1, sizeof(NC_nameindex))) == NULL)
+            return FAIL;
+        idx->array = array;
+        *idxp      = idx;
+    }
+
+    if (array->count > idx->nbuckets) {
+        unsigned nbuckets = (idx->nbuckets ? idx->nbuckets : NC_NAMEINDEX_MIN);
+        int     *bucket, *next;
+        unsigned *hash;
+
+        while (nbuckets < array->count)
+            nbuckets *= 2;
+        if ((bucket = realloc(idx->bucket, nbuckets * sizeof(int))) == NULL)
+            return FAIL;
+        idx->bucket = bucket;
+        if ((next = realloc(idx->next, nbuckets * sizeof(int))) == NULL)
+            return FAIL;
+        idx->next = next;
+        if ((hash = realloc(idx->hash, nbuckets * sizeof(unsigned))) == NULL)
+            return FAIL;
+        idx->hash     = hash;
+        idx->nbuckets = nbuckets;
+
+        /* chain what is already indexed again in the larger table */
+        memset(idx->bucket, 0xff, nbuckets * sizeof(int)); /* all -1 */
+        for (ii = 0; ii < idx->nindexed; ii++)
+            NC_nameindex_link(idx, (int)ii, idx->hash[ii]);
+    }
+
+    for (ii = idx->nindexed; ii < array->count; ii++) {
+        NC_string *name = NC_ELEM_NAME(array, ii);
+
+        NC_nameindex_link(idx, (int)ii, NC_name_hash(name->values, name->len));
+    }
+    idx->nindexed = array->count;
+
+    return SUCCEED;
+}
+
+/*
+ * Find the first element after element 'after' (-1 to start from the
+ * first one) of an array of dimensions or variables that is named 'name'.
+ * '*idxp' is the name index of the array, created or brought up to date
+ * here.  Returns the index of the element, -1 if there is none.
+ */
+int
+NC_nameindex_find(NC_nameindex **idxp, NC_array *array, const char *name, int after)
+{
+    unsigned len = (unsigned)strlen(name);
+    int      i;
+
+    if (array == NULL || array->count == 0)
+        return (-1);
+
+    if (NC_nameindex_sync(idxp, array) == FAIL) {
+        /* no memory for the index, look at every name */
+        for (i = after + 1; i < (int)array->count; i++)
+            if (NC_name_is(NC_ELEM_NAME(array, i), name, len))
+                return (i);
+        return (-1);
+    }
+
+    for (i = (*idxp)->bucket[NC_name_hash(name, len) & ((*idxp)->nbuckets - 1)]; i != -1;
+         i = (*idxp)->next[i])
+        if (i > after && NC_name_is(NC_ELEM_NAME(array, i), name, len))
+            return (i);
+    return (-1);
+}
+
+/*
+ * Move element 'elem' to the bucket of its new name, after it was renamed
+ * or replaced by another element.  'idx' may be NULL.
+ */
+void
+NC_nameindex_move(NC_nameindex *idx, int elem)
+{
+    NC_string *name;
+    int       *pp;
+
+    if (idx == NULL || elem < 0 || (unsigned)elem >= idx->nindexed)
+        return;
+
+    /* unchain it from the bucket of its old name */
+    pp = &idx->bucket[idx->hash[elem] & (idx->nbuckets - 1)];
+    while (*pp != elem)
+        pp = &idx->next[*pp];
+    *pp = idx->next[elem];
+
+    name = NC_ELEM_NAME(idx->array, elem);
+    NC_nameindex_link(idx, elem, NC_name_hash(name->values, name->len));
+}
+
+/*
+ * Free a name index, which may be NULL
+ */
+void
+NC_nameindex_free(NC_nameindex *idx)
+{
+    if (idx != NULL) {
+        free(idx->bucket);
+        free(idx->next);
+        free(idx->hash);
+        free(idx);
+    }
+}
@@ -35,6 +35,8 @@ NC_new_attr(const char *name, nc_type type, unsigned count, const void *values)
         goto alloc_err;
 #ifdef HDF
     ret->HDFtype = hdf_map_type(type);
+    ret->ref     = 0;
+    ret->dirty   = FALSE;
 #endif
     return (ret);
 alloc_err:
@@ -207,6 +209,11 @@ NC_aput(int cdfid, NC_array **ap, const char *name, nc_type datatype, unsigned c
                 *atp = old;
                 return (-1);
             }
+#ifdef HDF
+            /* the new values may go over the old ones in the file */
+            (*atp)->ref   = old->ref;
+            (*atp)->dirty = TRUE;
+#endif
             NC_free_attr(old);
             return ((*ap)->count - 1);
         }
@@ -218,6 +225,7 @@ NC_aput(int cdfid, NC_array **ap, const char *name, nc_type datatype, unsigned c
         /* else */
 #ifdef HDF
         (*atp)->HDFtype = hdf_map_type(datatype);
+        (*atp)->dirty   = TRUE;
 #endif
         if (handle->flags & NC_HSYNC) {
             handle->xdrs->x_op = XDR_ENCODE;
@@ -339,6 +347,9 @@ ncattrename(int cdfid, int varid, const char *name, const char *newname)
     if (NC_lookupattr(cdfid, varid, newname, FALSE) != NULL) /* name in use */
         return (-1);
 
+#ifdef HDF
+    (*attr)->dirty = TRUE;
+#endif
     old = (*attr)->name;
     if (NC_indefine(cdfid, FALSE)) {
         new = NC_new_string((unsigned)strlen(newname), newname);
@@ -420,6 +431,11 @@ ncattdel(int cdfid, int varid, const char *name)
     }
     /* decrement count */
     (*ap)->count--;
+#ifdef HDF
+    /* the variable's Vgroup still lists the attribute */
+    if (varid != NC_GLOBAL)
+        ((NC_var **)NC_check_id(cdfid)->vars->values)[varid]->dirty = TRUE;
+#endif
 
     NC_free_attr(old);
 
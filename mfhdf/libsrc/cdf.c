@@ -25,6 +25,13 @@ int32 hdf_get_magicnum(const char *filename);
 static intn hdf_num_attrs(NC   *handle, /* IN: handle to SDS */
                           int32 vg /* IN: ref of top Vgroup */);
 
+static intn hdf_rewrite_attr(NC *handle, NC_attr *attr, const void *values, int size, int type, int order);
+
+static intn hdf_update_attrs(XDR *xdrs, NC *handle, NC_array *attrs);
+
+static intn hdf_vg_update(NC *handle, int32 vgid, int32 *tags, int32 *refs, int32 count, const char *name,
+                          const char *vgclass, intn top);
+
 #endif /* HDF */
 
 static bool_t NC_xdr_cdf(XDR *xdrs, NC **handlep);
@@ -61,6 +68,10 @@ NC_free_xcdf(NC *handle)
             HGOTO_FAIL(FAIL);
         if (NC_free_array(handle->vars) == FAIL)
             HGOTO_FAIL(FAIL);
+        NC_nameindex_free(handle->dimindex);
+        handle->dimindex = NULL;
+        NC_nameindex_free(handle->varindex);
+        handle->varindex = NULL;
     }
 
 done:
@@ -303,6 +314,8 @@ NC_new_cdf(const char *name, int mode)
     cdf->dims      = NULL;
     cdf->attrs     = NULL;
     cdf->vars      = NULL;
+    cdf->dimindex  = NULL;
+    cdf->varindex  = NULL;
     cdf->begin_rec = 0;
     cdf->recsize   = 0;
     cdf->numrecs   = 0;
@@ -440,6 +453,8 @@ NC_dup_cdf(const char *name, int mode, NC *old)
     cdf->dims      = NULL;
     cdf->attrs     = NULL;
     cdf->vars      = NULL;
+    cdf->dimindex  = NULL;
+    cdf->varindex  = NULL;
     cdf->begin_rec = 0;
     cdf->recsize   = 0;
     cdf->numrecs   = 0;
@@ -896,6 +911,10 @@ hdf_write_attr(XDR *xdrs, NC *handle, NC_attr **attr)
     }
 #endif
 
+    /* the Vdata in the file still holds these values */
+    if ((*attr)->ref != 0 && !(*attr)->dirty)
+        HGOTO_DONE((*attr)->ref);
+
     if (type == DFNT_CHAR) {
         order = size;
         size  = 1;
@@ -904,16 +923,91 @@ hdf_write_attr(XDR *xdrs, NC *handle, NC_attr **attr)
         order = 1;
     }
 
+    if ((*attr)->ref != 0) {
+        /* write over the old values if they take the same space */
+        if (hdf_rewrite_attr(handle, *attr, values, size, type, order) == SUCCEED) {
+            (*attr)->dirty = FALSE;
+            HGOTO_DONE((*attr)->ref);
+        }
+        if (vexistvs(handle->hdf_file, (uint16)(*attr)->ref) != FAIL &&
+            VSdelete(handle->hdf_file, (*attr)->ref) == FAIL)
+            HGOTO_FAIL(FAIL);
+    }
+
     ret_value = VHstoredatam(handle->hdf_file, ATTR_FIELD_NAME, (unsigned char *)values, size, type, name,
                              _HDF_ATTRIBUTE, order);
+    if (ret_value != FAIL) {
+        (*attr)->ref   = ret_value;
+        (*attr)->dirty = FALSE;
+    }
 
 #ifdef DEBUG
     fprintf(stderr, "hdf_write_attr returning %d\n", ret_value);
 #endif
 
+done:
     return ret_value;
 } /* hdf_write_attr */
 
+/* ----------------------------------------------------------------
+** Write new values over those in the Vdata of an attribute, if the
+**   Vdata has the same type and number of values.  Return FAIL
+**   (without an error) when it doesn't.
+*/
+static intn
+hdf_rewrite_attr(NC *handle, NC_attr *attr, const void *values, int size, int type, int order)
+{
+    char  vsname[VSNAMELENMAX + 1] = "";
+    int32 vs;
+    intn  ret_value = FAIL;
+
+    if ((vs = VSattach(handle->hdf_file, attr->ref, "w")) == FAIL)
+        return FAIL;
+
+    if (VFnfields(vs) == 1 && VFfieldtype(vs, 0) == type && VFfieldorder(vs, 0) == order &&
+        VSelts(vs) == size && VSgetname(vs, vsname) != FAIL) {
+        /* an attribute renamed keeps its Vdata too */
+        if ((HDstrcmp(vsname, attr->name->values) == 0 || VSsetname(vs, attr->name->values) != FAIL) &&
+            VSsetfields(vs, ATTR_FIELD_NAME) != FAIL && VSseek(vs, 0) != FAIL &&
+            VSwrite(vs, (const uint8 *)values, size, FULL_INTERLACE) == size)
+            ret_value = SUCCEED;
+    }
+
+    if (VSdetach(vs) == FAIL)
+        ret_value = FAIL;
+
+    return ret_value;
+} /* hdf_rewrite_attr */
+
+/* ----------------------------------------------------------------
+** Write the attributes in the list that changed.  Return TRUE if all
+**   of them are still in the Vdatas they were read from, FALSE if the
+**   Vgroup listing them must be written again, FAIL on error
+*/
+static intn
+hdf_update_attrs(XDR *xdrs, NC *handle, NC_array *attrs)
+{
+    NC_attr **attr;
+    int32     ref;
+    unsigned  i;
+    intn      ret_value = TRUE;
+
+    if (attrs == NULL)
+        return TRUE;
+    attr = (NC_attr **)attrs->values;
+    for (i = 0; i < attrs->count; i++, attr++) {
+        if ((ref = (*attr)->ref) == 0)
+            ret_value = FALSE;
+        else if ((*attr)->dirty) {
+            if (hdf_write_attr(xdrs, handle, attr) == FAIL)
+                return FAIL;
+            if ((*attr)->ref != ref)
+                ret_value = FALSE;
+        }
+    }
+    return ret_value;
+} /* hdf_update_attrs */
+
 /* ----------------------------------------------------------------
 ** Write out a group representing a dimension
 */
@@ -932,6 +1026,11 @@ hdf_write_dim(XDR *xdrs, NC *handle, NC_dim **dim, int32 cnt)
     fprintf(stderr, "The name is -- %s -- \n", (*dim)->name->values);
 #endif
 
+    /* a dimension already in the file keeps its Vgroup; the value of an
+       unlimited one is the number of records, which may have changed */
+    if ((*dim)->vgid != 0 && !(*dim)->dirty && (*dim)->size != NC_UNLIMITED)
+        HGOTO_DONE((*dim)->vgid);
+
     /*
      * Look up to see if there is a variable of the same name
      *  giving values
@@ -964,7 +1063,14 @@ hdf_write_dim(XDR *xdrs, NC *handle, NC_dim **dim, int32 cnt)
         HDstrcpy(name, (*dim)->name->values);
 
     /* write out the dimension group? */
-    (*dim)->vgid = VHmakegroup(handle->hdf_file, tags, refs, count, name, class);
+    if ((*dim)->vgid != 0) {
+        if (hdf_vg_update(handle, (*dim)->vgid, tags, refs, count, name, class, FALSE) == FAIL)
+            HGOTO_FAIL(FAIL);
+    }
+    else
+        (*dim)->vgid = VHmakegroup(handle->hdf_file, tags, refs, count, name, class);
+    if ((*dim)->vgid != FAIL)
+        (*dim)->dirty = FALSE;
 
     ret_value = (*dim)->vgid; /* ref of vgroup of dimension */
 
@@ -1000,6 +1106,20 @@ hdf_write_var(XDR *xdrs, NC *handle, NC_var **var)
     assoc = (*var)->assoc;
     attrs = (*var)->attrs;
 
+    /* a variable already in the file keeps its Vgroup if its attributes
+       can be written in place and nothing else changed; the SDD of a
+       record variable holds the number of records */
+    if ((*var)->vgid != 0 && !(*var)->dirty && !IS_RECVAR(*var)) {
+        switch (hdf_update_attrs(xdrs, handle, attrs)) {
+            case TRUE:
+                HGOTO_DONE((*var)->vgid);
+            case FAIL:
+                HGOTO_FAIL(FAIL);
+            default:
+                break;
+        }
+    }
+
 #ifdef DEBUG
     fprintf(stderr, "hdf_write_var I've been called\n");
     fprintf(stderr, "handle->hdf_file = %d\n", handle->hdf_file);
@@ -1117,6 +1237,11 @@ hdf_write_var(XDR *xdrs, NC *handle, NC_var **var)
     count++;
 
 #ifdef WRITE_NDG
+    /* the NDG is written again under the same ref */
+    if ((*var)->vgid != 0 && Hexist(handle->hdf_file, DFTAG_NDG, (*var)->ndg_ref) == SUCCEED &&
+        Hdeldd(handle->hdf_file, DFTAG_NDG, (*var)->ndg_ref) == FAIL)
+        HGOTO_FAIL(FAIL);
+
     /* prepare to start writing ndg   */
     if ((GroupID = DFdisetup(10)) < 0)
         HGOTO_FAIL(FAIL);
@@ -1182,7 +1307,15 @@ hdf_write_var(XDR *xdrs, NC *handle, NC_var **var)
 #endif /* WRITE_NDG */
 
     /* write the vgroup for the coordinate variable */
-    (*var)->vgid = VHmakegroup(handle->hdf_file, tags, refs, count, (*var)->name->values, _HDF_VARIABLE);
+    if ((*var)->vgid != 0) {
+        if (hdf_vg_update(handle, (*var)->vgid, tags, refs, (int32)count, (*var)->name->values, _HDF_VARIABLE,
+                          FALSE) == FAIL)
+            HGOTO_FAIL(FAIL);
+    }
+    else
+        (*var)->vgid = VHmakegroup(handle->hdf_file, tags, refs, count, (*var)->name->values, _HDF_VARIABLE);
+    if ((*var)->vgid != FAIL)
+        (*var)->dirty = FALSE;
 
 #ifdef DEBUG
     if ((*var)->vgid == FAIL) {
@@ -1201,6 +1334,41 @@ done:
     return ret_value;
 } /* hdf_write_var */
 
+/* ----------------------------------------------------------------
+** Forget the Vgroups and Vdatas the objects were read from, so that
+**   all of them are written as new
+*/
+static void
+hdf_forget_refs(NC *handle)
+{
+    NC_dim  **dims;
+    NC_var  **vars;
+    NC_attr **attrs;
+    unsigned  i, j;
+
+    if (handle->dims) {
+        dims = (NC_dim **)handle->dims->values;
+        for (i = 0; i < handle->dims->count; i++)
+            dims[i]->vgid = 0;
+    }
+    if (handle->attrs) {
+        attrs = (NC_attr **)handle->attrs->values;
+        for (i = 0; i < handle->attrs->count; i++)
+            attrs[i]->ref = 0;
+    }
+    if (handle->vars) {
+        vars = (NC_var **)handle->vars->values;
+        for (i = 0; i < handle->vars->count; i++) {
+            vars[i]->vgid = 0;
+            if (vars[i]->attrs) {
+                attrs = (NC_attr **)vars[i]->attrs->values;
+                for (j = 0; j < vars[i]->attrs->count; j++)
+                    attrs[j]->ref = 0;
+            }
+        }
+    }
+} /* hdf_forget_refs */
+
 /* ----------------------------------------------------------------
 ** Write out a cdf structure
 */
@@ -1223,12 +1391,19 @@ hdf_write_xdr_cdf(XDR *xdrs, NC **handlep)
     uint32    thash;
     Void     *vars      = NULL;
     Void     *attrs     = NULL;
+    intn      update;
     intn      ret_value = SUCCEED;
 
 #ifdef DEBUG
     fprintf(stderr, "hdf_write_xdr_cdf i've been called op = %d \n", xdrs->x_op);
 #endif
 
+    /* if the file already has the structure, only the objects that changed
+       are written again, over the old ones */
+    update = ((*handlep)->vgid != 0);
+    if (!update)
+        hdf_forget_refs(*handlep);
+
     /* Convert old scales into coordinate var values before writing
        out any header info */
     status = hdf_conv_scales(handlep);
@@ -1359,7 +1534,13 @@ hdf_write_xdr_cdf(XDR *xdrs, NC **handlep)
 
     /* write out final VGroup thang */
     /* set the top level CDF VGroup pointer */
-    (*handlep)->vgid = VHmakegroup((*handlep)->hdf_file, tags, refs, count, (*handlep)->path, _HDF_CDF);
+    if (update) {
+        if (hdf_vg_update(*handlep, (*handlep)->vgid, tags, refs, count, (*handlep)->path, _HDF_CDF, TRUE) ==
+            FAIL)
+            HGOTO_FAIL(FAIL);
+    }
+    else
+        (*handlep)->vgid = VHmakegroup((*handlep)->hdf_file, tags, refs, count, (*handlep)->path, _HDF_CDF);
 
     ret_value = (*handlep)->vgid; /* ref of final vgroup  */
 
@@ -1449,16 +1630,18 @@ done:
 intn
 hdf_read_dims(XDR *xdrs, NC *handle, int32 vg)
 {
-    char     vgname[H4_MAX_NC_NAME]   = "";
-    char     vsclass[H4_MAX_NC_CLASS] = "";
-    char     vgclass[H4_MAX_NC_CLASS] = "";
-    int      id, count, i, found;
-    int      sub_id;
-    int32    dim_size;
-    NC_dim **dimension = NULL;
-    int32    dim, entries;
-    int32    vs;
-    intn     ret_value = SUCCEED;
+    char          vgname[H4_MAX_NC_NAME]   = "";
+    char          vsclass[H4_MAX_NC_CLASS] = "";
+    char          vgclass[H4_MAX_NC_CLASS] = "";
+    int           id, count, i, found;
+    int           sub_id;
+    int32         dim_size;
+    NC_dim      **dimension = NULL;
+    NC_array      dim_array;        /* 'dimension' as an array, to index it */
+    NC_nameindex *dim_index = NULL; /* name index of 'dimension' */
+    int32         dim, entries;
+    int32         vs;
+    intn          ret_value = SUCCEED;
 
     (void)xdrs;
 
@@ -1482,6 +1665,11 @@ hdf_read_dims(XDR *xdrs, NC *handle, int32 vg)
 #endif
         HGOTO_FAIL(FAIL);
     }
+    dim_array.type   = NC_DIMENSION;
+    dim_array.len    = 0;
+    dim_array.szof   = sizeof(NC_dim *);
+    dim_array.count  = 0;
+    dim_array.values = (Void *)dimension;
 
     /*
      * Look through for a Vgroup of class _HDF_DIMENSION
@@ -1568,10 +1756,11 @@ hdf_read_dims(XDR *xdrs, NC *handle, int32 vg)
                             HGOTO_FAIL(FAIL);
 
                         /* Is it the second dim vs of a compatible dim? */
-                        found = FALSE;
-                        for (i = count - 1; ((i >= 0) && (!found)); i--) {
-                            if (!HDstrcmp(vgname, dimension[i]->name->values) &&
-                                (dim_size == dimension[i]->size)) {
+                        found           = FALSE;
+                        dim_array.count = (unsigned)count;
+                        for (i = NC_nameindex_find(&dim_index, &dim_array, vgname, -1); i != -1 && !found;
+                             i = NC_nameindex_find(&dim_index, &dim_array, vgname, i)) {
+                            if (dim_size == dimension[i]->size) {
                                 /* vgname is the dim name and may be diff from vsname */
                                 if (is_dimval01 == TRUE && is_dimval == TRUE)
                                     dimension[i]->dim00_compat = 1;
@@ -1596,7 +1785,8 @@ hdf_read_dims(XDR *xdrs, NC *handle, int32 vg)
 
                             /* record vgroup id here so we can use later */
                             /* Note: this is only for later file -BMR */
-                            dimension[count]->vgid = id;
+                            dimension[count]->vgid  = id;
+                            dimension[count]->dirty = FALSE;
 
                             count++;
                         } /* found */
@@ -1629,6 +1819,7 @@ done:
         }
     }
 
+    NC_nameindex_free(dim_index);
     free(dimension);
 
     return ret_value;
@@ -1809,6 +2000,7 @@ hdf_read_attrs(XDR *xdrs, NC *handle, int32 vg)
                     HGOTO_FAIL(NULL);
                 }
                 attributes[count]->HDFtype = nt;
+                attributes[count]->ref     = id;
 
 #ifdef HDF_READ_ATTRS
                 fprintf(stderr, "hdf_read_attrs: Attribute <%s> has type %d and size %d\n", vsname, type,
@@ -2144,6 +2336,7 @@ hdf_read_vars(XDR *xdrs, NC *handle, int32 vg)
 #endif
                 /* set up for easy access later */
                 vp->vgid     = id;
+                vp->dirty    = FALSE;
                 vp->data_ref = data_ref;
                 vp->data_tag = DATA_TAG;
                 vp->HDFtype  = HDFtype;
@@ -2328,8 +2521,10 @@ hdf_xdr_cdf(XDR *xdrs, NC **handlep)
 
     switch (xdrs->x_op) {
         case XDR_ENCODE:
+            /* the structure already in the file is updated in place by
+               hdf_write_xdr_cdf rather than clobbered and written again */
             if ((*handlep)->vgid) {
-                if (FAIL == hdf_cdf_clobber((*handlep)))
+                if (FAIL == hdf_close((*handlep)))
                     HGOTO_FAIL(FAIL);
             }
             status = hdf_write_xdr_cdf(xdrs, handlep);
@@ -2491,6 +2686,124 @@ done:
     return ret_value;
 } /* hdf_vg_clobber */
 
+/* ---------------------- hdf_vg_update --------------- */
+/*
+  Make a VGroup that is on the disk hold the given tag/refs, name and
+  class, the way VHmakegroup would have made a new one.  The members
+  that are no longer listed are deleted from the file, except data.
+  Vgroups dropped from the top level CDF VGroup are deleted with
+  their members; those dropped from a variable are dimensions
+  still owned by the top level VGroup.
+*/
+static intn
+hdf_vg_update(NC *handle, int32 vgid, int32 *tags, int32 *refs, int32 count, const char *name,
+              const char *vgclass, intn top)
+{
+    int32  vg       = FAIL;
+    int32 *old_tags = NULL;
+    int32 *old_refs = NULL;
+    int32  n, keep, i, j;
+    uint16 len;
+    char  *str       = NULL;
+    intn   found;
+    intn   ret_value = SUCCEED;
+
+    if ((vg = Vattach(handle->hdf_file, vgid, "w")) == FAIL)
+        HGOTO_FAIL(FAIL);
+    if ((n = Vntagrefs(vg)) == FAIL)
+        HGOTO_FAIL(FAIL);
+
+    if (n > 0) {
+        old_tags = malloc(sizeof(int32) * (size_t)n);
+        old_refs = malloc(sizeof(int32) * (size_t)n);
+        if (NULL == old_tags || NULL == old_refs)
+            HGOTO_FAIL(FAIL);
+        if (Vgettagrefs(vg, old_tags, old_refs, n) != n)
+            HGOTO_FAIL(FAIL);
+    }
+
+    /* the members both lists start with stay where they are */
+    for (keep = 0; keep < n && keep < count; keep++)
+        if (old_tags[keep] != tags[keep] || old_refs[keep] != refs[keep])
+            break;
+
+    /* Vdeletetagref removes the first match, so start over if a member
+       to remove is also one to keep */
+    for (i = keep; i < n && keep > 0; i++)
+        for (j = 0; j < keep; j++)
+            if (old_tags[i] == old_tags[j] && old_refs[i] == old_refs[j]) {
+                keep = 0;
+                break;
+            }
+
+    /* delete the members that are gone from the file */
+    for (i = keep; i < n; i++) {
+        found = FALSE;
+        for (j = keep; j < count && !found; j++)
+            if (old_tags[i] == tags[j] && old_refs[i] == refs[j])
+                found = TRUE;
+        if (found)
+            continue;
+
+        switch (old_tags[i]) {
+            case DFTAG_VG:
+                if (top && vexistvg(handle->hdf_file, (uint16)old_refs[i]) != FAIL) {
+                    if (hdf_vg_clobber(handle, old_refs[i]) == FAIL)
+                        HGOTO_FAIL(FAIL);
+                    if (Vdelete(handle->hdf_file, old_refs[i]) == FAIL)
+                        HGOTO_FAIL(FAIL);
+                }
+                break;
+            case DFTAG_VH:
+                if (vexistvs(handle->hdf_file, (uint16)old_refs[i]) != FAIL &&
+                    VSdelete(handle->hdf_file, old_refs[i]) == FAIL)
+                    HGOTO_FAIL(FAIL);
+                break;
+            case DFTAG_SD:
+                /* Don't delete actual numeric data */
+                break;
+            default:
+                if (Hexist(handle->hdf_file, (uint16)old_tags[i], (uint16)old_refs[i]) == SUCCEED &&
+                    Hdeldd(handle->hdf_file, (uint16)old_tags[i], (uint16)old_refs[i]) == FAIL)
+                    HGOTO_FAIL(FAIL);
+                break;
+        }
+    }
+
+    /* replace the rest of the member list */
+    for (i = n - 1; i >= keep; i--)
+        if (Vdeletetagref(vg, old_tags[i], old_refs[i]) == FAIL)
+            HGOTO_FAIL(FAIL);
+    for (j = keep; j < count; j++)
+        if (Vaddtagref(vg, tags[j], refs[j]) == FAIL)
+            HGOTO_FAIL(FAIL);
+
+    if (Vgetnamelen(vg, &len) == FAIL || NULL == (str = malloc((size_t)len + 1)))
+        HGOTO_FAIL(FAIL);
+    if (Vgetname(vg, str) == FAIL)
+        HGOTO_FAIL(FAIL);
+    if (HDstrcmp(str, name) != 0 && Vsetname(vg, name) == FAIL)
+        HGOTO_FAIL(FAIL);
+    free(str);
+    str = NULL;
+
+    if (Vgetclassnamelen(vg, &len) == FAIL || NULL == (str = malloc((size_t)len + 1)))
+        HGOTO_FAIL(FAIL);
+    if (Vgetclass(vg, str) == FAIL)
+        HGOTO_FAIL(FAIL);
+    if (HDstrcmp(str, vgclass) != 0 && Vsetclass(vg, vgclass) == FAIL)
+        HGOTO_FAIL(FAIL);
+
+done:
+    if (vg != FAIL && Vdetach(vg) == FAIL)
+        ret_value = FAIL;
+    free(str);
+    free(old_tags);
+    free(old_refs);
+
+    return ret_value;
+} /* hdf_vg_update */
+
 /* --------------------------- hdf_cdf_clobber ---------------------------- */
 /*
   Delete a netCDF structure that has been already written to disk
@@ -2670,6 +2983,10 @@ hdf_close(NC *handle)
         for (i = 0; i < tmp->count; i++) {
             vp = (NC_var **)vars;
 
+            /* write the fill values still owed by a dataset in lazy fill mode */
+            if (FAIL == hdf_lazy_fill(handle, *vp))
+                HGOTO_FAIL(FAIL);
+
             if ((*vp)->aid != FAIL) {
                 if (FAIL == Hendaccess((*vp)->aid)) {
 #ifdef HDF_CLOSE
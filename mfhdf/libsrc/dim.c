@@ -34,6 +34,7 @@ NC_new_dim(const char *name, long size)
 #ifdef HDF
     ret->vgid  = 0; /* no vgroup representing this dimension yet -BMR 2010/12/29 */
     ret->count = 1;
+    ret->dirty = TRUE;
     /*        ret->dim00_compat = (size == NC_UNLIMITED)? 0 : 1;  */
     ret->dim00_compat = 0;
 #endif /* HDF */
@@ -74,6 +75,29 @@ done:
     return ret_value;
 }
 
+/*
+ * Update the name index of the dimensions after dimension 'dimid' was
+ * renamed or made to point to another dimension.
+ */
+void
+NC_dimindex_move(NC *handle, int dimid)
+{
+    NC_nameindex_move(handle->dimindex, dimid);
+#ifdef HDF
+    {
+        NC_dim **dp  = (NC_dim **)handle->dims->values;
+        NC_dim  *dim = dp[dimid];
+        unsigned ii;
+
+        /* the other dimensions sharing this one were renamed with it */
+        if (dim->count > 1)
+            for (ii = 0; ii < handle->dims->count; ii++)
+                if (dp[ii] == dim && (int)ii != dimid)
+                    NC_nameindex_move(handle->dimindex, (int)ii);
+    }
+#endif /* HDF */
+}
+
 int
 ncdimdef(int cdfid, const char *name, long size)
 {
@@ -81,7 +105,7 @@ ncdimdef(int cdfid, const char *name, long size)
     NC_dim  *dim[1];
     NC_dim **dp;
     unsigned ii;
-    size_t   len;
+    int      dimid;
 
     cdf_routine_name = "ncdimdef";
 
@@ -113,17 +137,20 @@ ncdimdef(int cdfid, const char *name, long size)
     }
     else {
         /* check for name in use */
-        len = strlen(name);
-        dp  = (NC_dim **)handle->dims->values;
-        for (ii = 0; ii < handle->dims->count; ii++, dp++) {
-            if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, len) == 0) {
-                NCadvise(NC_ENAMEINUSE, "dimension \"%s\" in use with index %d", (*dp)->name->values, ii);
-                return (-1);
-            }
-            if ((*dp)->size == NC_UNLIMITED && size == NC_UNLIMITED) {
-                NCadvise(NC_EUNLIMIT, "NC_UNLIMITED size already in use: dimension \"%s\" (index %d)",
-                         (*dp)->name->values, ii);
-                return (-1);
+        dimid = NC_nameindex_find(&handle->dimindex, handle->dims, name, -1);
+        if (dimid != -1) {
+            dp = (NC_dim **)handle->dims->values + dimid;
+            NCadvise(NC_ENAMEINUSE, "dimension \"%s\" in use with index %d", (*dp)->name->values, dimid);
+            return (-1);
+        }
+        if (size == NC_UNLIMITED) {
+            dp = (NC_dim **)handle->dims->values;
+            for (ii = 0; ii < handle->dims->count; ii++, dp++) {
+                if ((*dp)->size == NC_UNLIMITED) {
+                    NCadvise(NC_EUNLIMIT, "NC_UNLIMITED size already in use: dimension \"%s\" (index %d)",
+                             (*dp)->name->values, ii);
+                    return (-1);
+                }
             }
         }
 
@@ -139,16 +166,11 @@ ncdimdef(int cdfid, const char *name, long size)
 int
 NC_dimid(NC *handle, char *name)
 {
-    unsigned ii;
-    size_t   len;
-    NC_dim **dp;
+    int dimid;
 
-    len = strlen(name);
-    dp  = (NC_dim **)handle->dims->values;
-    for (ii = 0; ii < handle->dims->count; ii++, dp++) {
-        if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, len) == 0)
-            return (ii);
-    }
+    dimid = NC_nameindex_find(&handle->dimindex, handle->dims, name, -1);
+    if (dimid != -1)
+        return (dimid);
     NCadvise(NC_EBADDIM, "dim \"%s\" not found", name);
     return (-1);
 }
@@ -156,10 +178,8 @@ NC_dimid(NC *handle, char *name)
 int
 ncdimid(int cdfid, const char *name)
 {
-    NC      *handle;
-    NC_dim **dp;
-    unsigned ii;
-    size_t   len;
+    NC *handle;
+    int dimid;
 
     cdf_routine_name = "ncdimid";
 
@@ -168,12 +188,9 @@ ncdimid(int cdfid, const char *name)
         return (-1);
     if (handle->dims == NULL)
         return (-1);
-    len = strlen(name);
-    dp  = (NC_dim **)handle->dims->values;
-    for (ii = 0; ii < handle->dims->count; ii++, dp++) {
-        if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, len) == 0)
-            return (ii);
-    }
+    dimid = NC_nameindex_find(&handle->dimindex, handle->dims, name, -1);
+    if (dimid != -1)
+        return (dimid);
     NCadvise(NC_EBADDIM, "dim \"%s\" not found", name);
     return (-1);
 }
@@ -220,8 +237,7 @@ ncdimrename(int cdfid, int dimid, const char *newname)
     NC        *handle;
     NC_dim   **dp;
     NC_string *old, *new;
-    unsigned   ii;
-    size_t     len;
+    int        ii;
 
     cdf_routine_name = "ncdimrename";
 
@@ -235,17 +251,18 @@ ncdimrename(int cdfid, int dimid, const char *newname)
         return (-1);
 
     /* check for name in use */
-    len = strlen(newname);
-    dp  = (NC_dim **)handle->dims->values;
-    for (ii = 0; ii < handle->dims->count; ii++, dp++) {
-        if (len == (*dp)->name->len && strncmp(newname, (*dp)->name->values, len) == 0) {
-            NCadvise(NC_ENAMEINUSE, "dimension \"%s\" in use with index %d", (*dp)->name->values, ii);
-            return (-1);
-        }
+    ii = NC_nameindex_find(&handle->dimindex, handle->dims, newname, -1);
+    if (ii != -1) {
+        dp = (NC_dim **)handle->dims->values + ii;
+        NCadvise(NC_ENAMEINUSE, "dimension \"%s\" in use with index %d", (*dp)->name->values, ii);
+        return (-1);
     }
 
     dp = (NC_dim **)handle->dims->values;
     dp += dimid;
+#ifdef HDF
+    (*dp)->dirty = TRUE;
+#endif
 
     old = (*dp)->name;
     if (NC_indefine(cdfid, FALSE)) {
@@ -254,12 +271,14 @@ ncdimrename(int cdfid, int dimid, const char *newname)
             return (-1);
         (*dp)->name = new;
         NC_free_string(old);
+        NC_dimindex_move(handle, dimid);
         return (dimid);
     } /* else */
     new = NC_re_string(old, (unsigned)strlen(newname), newname);
     if (new == NULL)
         return (-1);
     (*dp)->name = new;
+    NC_dimindex_move(handle, dimid);
     if (handle->flags & NC_HSYNC) {
         handle->xdrs->x_op = XDR_ENCODE;
         if (!xdr_cdf(handle->xdrs, &handle))
@@ -989,11 +989,18 @@ ncsetfill(int id, int fillmode)
         return -1;
     }
 
-    ret = (handle->flags & NC_NOFILL) ? NC_NOFILL : NC_FILL;
+    ret = (handle->flags & NC_NOFILL) ? NC_NOFILL : (handle->flags & NC_LAZYFILL) ? NC_LAZYFILL : NC_FILL;
 
-    if (fillmode == NC_NOFILL)
+    if (fillmode == NC_NOFILL) {
         handle->flags |= NC_NOFILL;
-    else if (fillmode == NC_FILL) {
+        handle->flags &= ~(unsigned)NC_LAZYFILL;
+    }
+    else if (fillmode == NC_FILL || fillmode == NC_LAZYFILL) {
+        /* datasets already being filled lazily keep that until they are closed */
+        if (fillmode == NC_LAZYFILL)
+            handle->flags |= NC_LAZYFILL;
+        else
+            handle->flags &= ~(unsigned)NC_LAZYFILL;
         if (handle->flags & NC_NOFILL) {
             /*
              * We are changing back to fill mode
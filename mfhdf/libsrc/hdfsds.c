@@ -77,6 +77,13 @@
 
 #define SDG_MAX_INITIAL 100
 
+/* the last number type element read while converting SDGs */
+typedef struct hdf_nt_memo_t {
+    uint16 tag;
+    uint16 ref;
+    uint8  ntstring[4];
+} hdf_nt_memo_t;
+
 /* local variables */
 static intn    sdgCurrent;
 static intn    sdgMax;
@@ -202,10 +209,12 @@ hdf_check_nt(uint8 *ntstring, int32 *type)
 
 /******************************************************************************
  NAME
-   hdf_read_rank - Reads the rank from file
+   hdf_read_rank - Decodes the rank from an SDD record
 
  DESCRIPTION
    (Refactored from hdf_read_ndgs - Jun, 2017)
+   The whole SDD record is read by the caller; this only decodes the rank
+   from the first two bytes of it.
 
  RETURNS
    rank / FAIL
@@ -213,71 +222,47 @@ hdf_check_nt(uint8 *ntstring, int32 *type)
 
 ******************************************************************************/
 static hdf_err_code_t
-hdf_read_rank(int32 acc_id, int16 *rank)
+hdf_read_rank(const uint8 *sdd_buf, int32 sdd_len, int16 *rank)
 {
-    uint8         *p, *local_buf = NULL;
+    const uint8   *p;
+    int16          temp_rank = 0;
     hdf_err_code_t ret_value = DFE_NONE;
 
-    local_buf = malloc(2 * sizeof(uint8));
-    if (local_buf == NULL) {
-        HGOTO_ERROR(DFE_NOSPACE, DFE_NOSPACE);
-    }
-
-    /* read and extract the rank */
-    if (Hread(acc_id, (int32)2, local_buf) == FAIL) {
+    if (sdd_len < 2) {
         HGOTO_ERROR(DFE_READERROR, DFE_READERROR);
     }
-    else {
-        int16 temp_rank = 0;
-        p               = local_buf;
-        INT16DECODE(p, temp_rank);
-        if (temp_rank > 0) /* what about the case of rank=0? -BMR */
-        {
-            *rank = temp_rank;
-            free(local_buf);
-        }
-        else
-            HGOTO_ERROR(DFE_RANGE, DFE_RANGE);
-    }
 
-done:
-    if (ret_value != DFE_NONE) { /* Failure cleanup */
-        free(local_buf);
-    }
+    /* extract the rank */
+    p = sdd_buf;
+    INT16DECODE(p, temp_rank);
+    if (temp_rank > 0) /* what about the case of rank=0? -BMR */
+        *rank = temp_rank;
+    else
+        HGOTO_ERROR(DFE_RANGE, DFE_RANGE);
 
+done:
     /* return DFE_NONE or error code */
     return (ret_value);
 } /* hdf_read_rank */
 
 /******************************************************************************
  NAME
-   hdf_read_dimsizes - Reads the dimensions' size from file
+   hdf_read_dimsizes - Decodes the dimensions' size from an SDD record
 
  DESCRIPTION
    (Refactored from hdf_read_ndgs - Jun, 2017)
+   'p' points at the dimension sizes in an SDD record already in memory.
 
  RETURNS
    DFE_NONE / <error code>
 
 ******************************************************************************/
 static hdf_err_code_t
-hdf_read_dimsizes(int32 acc_id, int16 rank, int32 *dimsizes)
+hdf_read_dimsizes(const uint8 *p, int16 rank, int32 *dimsizes)
 {
-    uint8         *p, *local_buf = NULL;
     intn           i;
     hdf_err_code_t ret_value = DFE_NONE;
 
-    local_buf = malloc(4 * (size_t)rank * sizeof(uint8));
-    if (local_buf == NULL) {
-        HGOTO_ERROR(DFE_NOSPACE, DFE_NOSPACE);
-    }
-
-    /* read dimension record */
-    if (Hread(acc_id, (int32)4 * rank, local_buf) == FAIL) {
-        HGOTO_ERROR(DFE_READERROR, DFE_READERROR);
-    }
-
-    p = local_buf;
     for (i = 0; i < rank; i++) {
         int32 dim_size = 0;
         INT32DECODE(p, dim_size);
@@ -287,13 +272,8 @@ hdf_read_dimsizes(int32 acc_id, int16 rank, int32 *dimsizes)
         else
             dimsizes[i] = dim_size;
     }
-    free(local_buf);
 
 done:
-    if (ret_value != DFE_NONE) { /* Failure cleanup */
-        free(local_buf);
-    }
-
     /* return DFE_NONE or error code */
     return (ret_value);
 } /* hdf_read_dimsizes */
@@ -304,43 +284,37 @@ done:
 
  DESCRIPTION
    (Refactored from hdf_read_ndgs - Jun, 2017)
+   'p' points at an NT tag/ref pair in an SDD record already in memory.
+   The data and scale NTs of a dataset are normally the same element, and
+   so are those of datasets written together, so the last NT read is kept
+   in 'nt_memo' and only a different tag/ref goes back to the file.
 
  RETURNS
    DFE_NONE / <error code>
 
 ******************************************************************************/
 static hdf_err_code_t
-hdf_read_NT(int32 acc_id, NC *handle, uint8 *ntstring_buf)
+hdf_read_NT(const uint8 *p, NC *handle, hdf_nt_memo_t *nt_memo, uint8 *ntstring_buf)
 {
     uint16         ntTag;
     uint16         ntRef;
-    uint8         *p, *local_buf = NULL;
     hdf_err_code_t ret_value = DFE_NONE;
 
-    local_buf = malloc(4 * sizeof(uint8));
-    if (local_buf == NULL) {
-        HGOTO_ERROR(DFE_NOSPACE, DFE_NOSPACE);
-    }
-
-    if (Hread(acc_id, (int32)4, local_buf) == FAIL) {
-        HGOTO_ERROR(DFE_READERROR, DFE_READERROR);
-    }
-
-    p = local_buf;
     UINT16DECODE(p, ntTag);
     UINT16DECODE(p, ntRef);
 
-    /* read NT of this scale (dimension) */
-    if (Hgetelement(handle->hdf_file, ntTag, ntRef, ntstring_buf) == FAIL) {
-        HGOTO_ERROR(DFE_GETELEM, DFE_GETELEM);
+    /* read NT of this scale (dimension) unless it was the last one read */
+    if (nt_memo->tag == DFTAG_NULL || nt_memo->tag != ntTag || nt_memo->ref != ntRef) {
+        nt_memo->tag = DFTAG_NULL;
+        if (Hgetelement(handle->hdf_file, ntTag, ntRef, nt_memo->ntstring) == FAIL) {
+            HGOTO_ERROR(DFE_GETELEM, DFE_GETELEM);
+        }
+        nt_memo->tag = ntTag;
+        nt_memo->ref = ntRef;
     }
-    free(local_buf);
+    memcpy(ntstring_buf, nt_memo->ntstring, sizeof(nt_memo->ntstring));
 
 done:
-    if (ret_value != DFE_NONE) { /* Failure cleanup */
-        free(local_buf);
-    }
-
     /* return DFE_NONE or error code */
     return (ret_value);
 } /* hdf_read_NT */
@@ -461,31 +435,27 @@ done:
 
  DESCRIPTION
    (Refactored from hdf_read_ndgs - Jun, 2017)
+   'an_handle' is the annotation interface that hdf_read_ndgs keeps open
+   for all of the groups, so the annotation lists are built only once.
 
  RETURNS
    DFE_NONE / <error code>
 
 ******************************************************************************/
 static hdf_err_code_t
-hdf_get_desc_annot(NC *handle, uint16 ndgTag, uint16 ndgRef, NC_attr **tmp_attr, intn *curr_attr)
+hdf_get_desc_annot(int32 an_handle, uint16 ndgTag, uint16 ndgRef, NC_attr **tmp_attr, intn *curr_attr)
 {
     intn           i;
     hdf_err_code_t ret_value = DFE_NONE;
 
     /* Re-vamped desc annotation handling to use new ANxxx interface
      *  -georgev 6/11/97 */
-    int32  an_handle = FAIL;
-    int32 *ddescs    = NULL;
-    char  *ann_desc  = NULL;
+    int32 *ddescs   = NULL;
+    char  *ann_desc = NULL;
     int32  ann_len;
     intn   num_ddescs;
     char   hremark[30] = ""; /* should be big enough for new attribute */
 
-    /* start Annotation interface */
-    if ((an_handle = ANstart(handle->hdf_file)) == FAIL) {
-        HGOTO_ERROR(DFE_ANAPIERROR, DFE_ANAPIERROR);
-    }
-
     /* Get number of data descs with this tag/ref */
     num_ddescs = ANnumann(an_handle, AN_DATA_DESC, ndgTag, ndgRef);
     if (num_ddescs != 0) {
@@ -544,11 +514,7 @@ hdf_get_desc_annot(NC *handle, uint16 ndgTag, uint16 ndgRef, NC_attr **tmp_attr,
     } /* end if descs */
 
 done:
-    if (ret_value == DFE_NONE) { /* Failure cleanup */
-        free(ddescs);
-        if (an_handle != FAIL)
-            ANend(an_handle);
-    }
+    free(ddescs);
     /* cleanup */
 
     /* return the status */
@@ -562,31 +528,27 @@ done:
 
  DESCRIPTION
    (Refactored from hdf_read_ndgs - Jun, 2017)
+   'an_handle' is the annotation interface that hdf_read_ndgs keeps open
+   for all of the groups, so the annotation lists are built only once.
 
  RETURNS
    DFE_NONE / <error code>
 
 ******************************************************************************/
 static hdf_err_code_t
-hdf_get_label_annot(NC *handle, uint16 ndgTag, uint16 ndgRef, NC_attr **tmp_attr, intn *curr_attr)
+hdf_get_label_annot(int32 an_handle, uint16 ndgTag, uint16 ndgRef, NC_attr **tmp_attr, intn *curr_attr)
 {
     intn           i;
     hdf_err_code_t ret_value = DFE_NONE;
 
     /* Re-vamped label annotation handling to use new ANxxx interface
      *  -georgev 6/11/97 */
-    int32  an_handle = FAIL;
     int32 *dlabels   = NULL;
     char  *ann_label = NULL;
     int32  ann_len;
     intn   num_dlabels;
     char   hlabel[30] = ""; /* should be big enough for new attribute */
 
-    /* start Annotation interface */
-    if ((an_handle = ANstart(handle->hdf_file)) == FAIL) {
-        HGOTO_ERROR(DFE_ANAPIERROR, DFE_ANAPIERROR);
-    }
-
     /* Get number of data labels with this tag/ref */
     num_dlabels = ANnumann(an_handle, AN_DATA_LABEL, ndgTag, ndgRef);
 
@@ -645,11 +607,7 @@ hdf_get_label_annot(NC *handle, uint16 ndgTag, uint16 ndgRef, NC_attr **tmp_attr
     } /* end if labels */
 
 done:
-    if (ret_value == DFE_NONE) { /* Failure cleanup */
-        free(dlabels);
-        if (an_handle != FAIL)
-            ANend(an_handle);
-    }
+    free(dlabels);
     /* cleanup */
     /* return the status */
     return (ret_value);
@@ -914,7 +872,10 @@ hdf_read_ndgs(NC *handle)
     /* info about NDG structure */
     int32          GroupID;
     int32          aid;
-    int32          aid1;
+    int32          an_handle = FAIL;
+    int32          sdd_len;
+    uint8         *sdd_buf = NULL;
+    hdf_nt_memo_t  nt_memo;
     uint16         ndgTag;
     uint16         ndgRef;
     uint16         lRef;
@@ -981,6 +942,19 @@ hdf_read_ndgs(NC *handle)
     current_var = 0;
     dimcount    = 0;
 
+    /* no number type read yet */
+    nt_memo.tag = DFTAG_NULL;
+    nt_memo.ref = 0;
+
+    /*
+     * Keep one annotation interface open for all of the groups; starting
+     * and ending it for each group rebuilt the annotation lists, and so
+     * re-read every annotation in the file, twice per group.
+     */
+    if ((an_handle = ANstart(handle->hdf_file)) == FAIL) {
+        HGOTO_ERROR(DFE_ANAPIERROR, FAIL);
+    }
+
     for (tag_index = 0; tag_index < 2; tag_index++) {
 
         if (tag_index == 0)
@@ -1054,18 +1028,30 @@ hdf_read_ndgs(NC *handle)
             while (!DFdiget(GroupID, &tmpTag, &tmpRef)) {
                 switch (tmpTag) {
                     case DFTAG_SDD:
-                        /* hdf_get_sdd(handle, tmpTag, tmpRef);
-                         */
-                        aid1 = Hstartread(handle->hdf_file, tmpTag, tmpRef);
-                        if (aid1 == FAIL) {
+                        /* read the whole SDD record at once and decode it from memory */
+                        if ((sdd_len = Hlength(handle->hdf_file, tmpTag, tmpRef)) == FAIL) {
                             HGOTO_ERROR(DFE_CANTACCESS, FAIL);
                         }
 
+                        sdd_buf = malloc((uint32)sdd_len);
+                        if (sdd_buf == NULL) {
+                            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                        }
+
+                        if (Hgetelement(handle->hdf_file, tmpTag, tmpRef, sdd_buf) == FAIL) {
+                            HGOTO_ERROR(DFE_READERROR, FAIL);
+                        }
+
                         /* read rank */
-                        err_code = hdf_read_rank(aid1, &rank);
+                        err_code = hdf_read_rank(sdd_buf, sdd_len, &rank);
                         if (err_code != DFE_NONE)
                             HGOTO_ERROR(err_code, FAIL);
 
+                        /* rank, dimension sizes, then the data NT and one NT per scale */
+                        if (sdd_len < 2 + 4 * (int32)rank + 4 * ((int32)rank + 1)) {
+                            HGOTO_ERROR(DFE_READERROR, FAIL);
+                        }
+
                         /* get space for dimensions */
                         dimsizes = malloc((uint32)rank * sizeof(int32));
                         if (dimsizes == NULL) {
@@ -1083,14 +1069,17 @@ hdf_read_ndgs(NC *handle)
                         }
 
                         /* read dimension record */
-                        err_code = hdf_read_dimsizes(aid1, rank, dimsizes);
+                        p        = sdd_buf + 2;
+                        err_code = hdf_read_dimsizes(p, rank, dimsizes);
                         if (err_code != DFE_NONE)
                             HGOTO_ERROR(err_code, FAIL);
+                        p += 4 * rank;
 
                         /* read in number type string */
-                        err_code = hdf_read_NT(aid1, handle, ntstring);
-                        if (err_code == FAIL)
+                        err_code = hdf_read_NT(p, handle, &nt_memo, ntstring);
+                        if (err_code != DFE_NONE)
                             HGOTO_ERROR(err_code, FAIL);
+                        p += 4;
 
                         HDFtype = ntstring[1];
                         if ((type = hdf_unmap_type(HDFtype)) == FAIL) {
@@ -1103,9 +1092,10 @@ hdf_read_ndgs(NC *handle)
 
                         /* read in scale NTs */
                         for (i = 0; i < rank; i++) {
-                            err_code = hdf_read_NT(aid1, handle, ntstring);
+                            err_code = hdf_read_NT(p, handle, &nt_memo, ntstring);
                             if (err_code != DFE_NONE)
                                 HGOTO_ERROR(err_code, FAIL);
+                            p += 4;
 
                             scaletypes[i] = ntstring[1];
 
@@ -1120,9 +1110,8 @@ hdf_read_ndgs(NC *handle)
                             scaletypes[i] = temptype;
                         }
 
-                        if (Hendaccess(aid1) == FAIL) {
-                            HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
-                        }
+                        free(sdd_buf);
+                        sdd_buf = NULL;
 
                         break;
 
@@ -1472,7 +1461,7 @@ hdf_read_ndgs(NC *handle)
             {
                 err_code = DFE_NONE;
 
-                err_code = hdf_get_desc_annot(handle, ndgTag, ndgRef, &attrs[current_attr], &current_attr);
+                err_code = hdf_get_desc_annot(an_handle, ndgTag, ndgRef, &attrs[current_attr], &current_attr);
                 if (err_code != DFE_NONE) {
                     HGOTO_ERROR(err_code, FAIL);
                 }
@@ -1486,7 +1475,7 @@ hdf_read_ndgs(NC *handle)
             {
                 err_code = DFE_NONE;
 
-                err_code = hdf_get_label_annot(handle, ndgTag, ndgRef, &attrs[current_attr], &current_attr);
+                err_code = hdf_get_label_annot(an_handle, ndgTag, ndgRef, &attrs[current_attr], &current_attr);
                 if (err_code != DFE_NONE) {
                     HGOTO_ERROR(err_code, FAIL);
                 }
@@ -1587,6 +1576,9 @@ done:
         free(ptbuf);
     }
 
+    free(sdd_buf);
+    if (an_handle != FAIL)
+        ANend(an_handle);
     free(dims);
     free(vars);
     free(attrs);
@@ -163,6 +163,7 @@ typedef struct {
     int32 dim00_compat; /* compatible with Dim0.0 */
     int32 vgid;         /* id of the Vgroup representing this dimension */
     int32 count;        /* Number of pointers to this dimension */
+    int32 dirty;        /* BOOLEAN == the Vgroup must be written again */
 #endif
 } NC_dim;
 
@@ -173,9 +174,21 @@ typedef struct {
 #ifdef HDF
     int32 HDFtype; /* it should be in NC_array *data. However, */
                    /* NC.dims and NC.vars are NC_array too. */
+    int32 ref;     /* ref of the attribute's Vdata in the file, 0 if none */
+    int32 dirty;   /* BOOLEAN == the Vdata does not hold the current values */
 #endif
 } NC_attr;
 
+/* Name index of an array of dimensions or variables, see array.c */
+typedef struct {
+    NC_array *array;    /* the array indexed */
+    unsigned  nindexed; /* elements 0..nindexed-1 are in the index */
+    unsigned  nbuckets; /* number of buckets, a power of 2 */
+    int      *bucket;   /* first element in each bucket, -1 if none */
+    int      *next;     /* next element in the same bucket, in increasing order */
+    unsigned *hash;     /* hash of the name each element was indexed by */
+} NC_nameindex;
+
 typedef struct {
     char          path[FILENAME_MAX + 1];
     unsigned      flags;
@@ -195,6 +208,8 @@ typedef struct {
     int        hdf_mode; /* mode we are attached for */
     hdf_file_t cdf_fp;   /* file pointer used for CDF files */
 #endif
+    NC_nameindex *dimindex; /* name index of dims, built on first lookup */
+    NC_nameindex *varindex; /* name index of vars, built on first lookup */
 } NC;
 
 /* NC variable: description and data */
@@ -216,6 +231,7 @@ typedef struct {
     uint16        data_ref; /* ref of the variable's data storage (if exists), default 0 */
     uint16        data_tag; /* tag of the variable's data storage (if exists), default DATA_TAG */
     uint16        ndg_ref;  /* ref of ndg for this dataset */
+    int32         dirty;    /* BOOLEAN == the variable's Vgroup must be written again */
     hdf_vartype_t var_type; /* type of this variable, default UNKNOWN
             IS_SDSVAR == this var is an SDS variable
             IS_CRDVAR == this var is a coordinate variable
@@ -236,6 +252,14 @@ typedef struct {
         block special element when they don't need to be one */
     int32  created;    /* BOOLEAN == is newly created */
     int32  set_length; /* BOOLEAN == needs length set */
+    /* In lazy fill mode the space of a new fixed-size dataset is allocated the
+        same way, and the byte ranges written are kept here so that reads of the
+        rest can return the fill value and hdf_lazy_fill() can write fill
+        values into only what is still unwritten when the dataset is closed */
+    int32  lazy_fill;   /* BOOLEAN == fill values not written yet */
+    int32 *written;     /* sorted, disjoint [start, end) byte ranges written */
+    int32  nwritten;    /* number of ranges in 'written' */
+    int32  max_written; /* number of ranges 'written' has room for */
     int32  is_ragged;  /* BOOLEAN == is a ragged array */
     int32 *rag_list;   /* size of ragged array lines */
     int32  rag_fill;   /* last line in rag_list to be set */
@@ -300,6 +324,10 @@ extern "C" {
 #define NC_free_var       HNAME(NC_free_var)
 #define NC_incr_array     HNAME(NC_incr_array)
 #define NC_dimid          HNAME(NC_dimid)
+#define NC_nameindex_find HNAME(NC_nameindex_find)
+#define NC_nameindex_move HNAME(NC_nameindex_move)
+#define NC_nameindex_free HNAME(NC_nameindex_free)
+#define NC_dimindex_move  HNAME(NC_dimindex_move)
 #define NCcktype          HNAME(NCcktype)
 #define NC_indefine       HNAME(NC_indefine)
 #define xdr_cdf           HNAME(xdr_cdf)
@@ -466,6 +494,10 @@ HDFLIBAPI int  NC_free_var(NC_var *var);
 HDFLIBAPI Void *NC_incr_array(NC_array *array, Void *tail);
 
 HDFLIBAPI int    NC_dimid(NC *handle, char *name);
+HDFLIBAPI int    NC_nameindex_find(NC_nameindex **idxp, NC_array *array, const char *name, int after);
+HDFLIBAPI void   NC_nameindex_move(NC_nameindex *idx, int elem);
+HDFLIBAPI void   NC_nameindex_free(NC_nameindex *idx);
+HDFLIBAPI void   NC_dimindex_move(NC *handle, int dimid);
 HDFLIBAPI bool_t NCcktype(nc_type datatype);
 HDFLIBAPI bool_t NC_indefine(int cdfid, bool_t iserr);
 HDFLIBAPI bool_t xdr_cdf(XDR *xdrs, NC **handlep);
@@ -512,6 +544,8 @@ HDFLIBAPI intn hdf_get_data(NC *handle, NC_var *vp);
 
 HDFLIBAPI int32 hdf_get_vp_aid(NC *handle, NC_var *vp);
 
+HDFLIBAPI intn hdf_lazy_fill(NC *handle, NC_var *vp);
+
 HDFLIBAPI int hdf_map_type(nc_type);
 
 HDFLIBAPI nc_type hdf_unmap_type(int);
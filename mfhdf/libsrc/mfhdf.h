@@ -33,6 +33,7 @@
 #define SD_UNLIMITED        NC_UNLIMITED /* use this as marker for unlimited dimension */
 #define SD_NOFILL           NC_NOFILL
 #define SD_FILL             NC_FILL
+#define SD_LAZYFILL         NC_LAZYFILL
 #define SD_DIMVAL_BW_COMP   1
 #define SD_DIMVAL_BW_INCOMP 0
 #define SD_RAGGED           -1 /* marker for ragged dimension */
@@ -57,6 +58,8 @@ extern "C" {
 
 HDFLIBAPI int32 SDstart(const char *name, int32 accs);
 
+HDFLIBAPI int32 SDstart_image(int32 file_id);
+
 HDFLIBAPI intn SDend(int32 fid);
 
 HDFLIBAPI intn SDfileinfo(int32 fid, int32 *datasets, int32 *attrs);
@@ -95,10 +98,14 @@ HDFLIBAPI intn SDattrinfo(int32 id, int32 idx, char *name, int32 *nt, int32 *cou
 
 HDFLIBAPI intn SDreadattr(int32 id, int32 idx, void *buf);
 
+HDFLIBAPI intn SDgetattrs(int32 id, hdf_attr_t **attrs);
+
 #ifndef __CSTAR__
 HDFLIBAPI intn SDwritedata(int32 sdsid, int32 *start, int32 *stride, int32 *end, void *data);
 #endif
 
+HDFLIBAPI intn SDappenddata(int32 sdsid, int32 nrecs, const void *data);
+
 HDFLIBAPI intn SDsetdatastrs(int32 sdsid, const char *l, const char *u, const char *f, const char *c);
 
 HDFLIBAPI intn SDsetcal(int32 sdsid, float64 cal, float64 cale, float64 ioff, float64 ioffe, int32 nt);
@@ -28,6 +28,9 @@ SD interface:
     --- open a file ---
 fid    = SDstart(file name, access);
 
+    --- open a file image, from Hopen_image ---
+fid    = SDstart_image(file id);
+
         --- get number of data sets and number of attributes in the file ---
 status = SDfileinfo(fid, *n_datasets, *n_attrs);
 
@@ -370,6 +373,63 @@ done:
     return ret_value;
 } /* SDstart */
 
+/******************************************************************************
+ NAME
+    SDstart_image -- open a file image in memory
+
+ DESCRIPTION
+    Start the SD interface on a file opened by Hopen_image(), with the
+    access the image was opened with.  The SD interface keeps its own
+    reference to the image, so the file ID from Hopen_image() stays
+    valid after SDend(), to retrieve the image with Hget_image() and
+    then close it with Hclose().
+
+ RETURNS
+    A file ID or FAIL
+
+******************************************************************************/
+int32
+SDstart_image(int32 file_id /* IN: file ID from Hopen_image() */)
+{
+    char *name;
+    intn  access, attach;
+    intn  cdfid     = -1;
+    NC   *handle    = NULL;
+    int32 ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* turn off annoying crash on error stuff */
+    ncopts = 0;
+
+    /* Perform global, one-time initialization */
+    if (library_terminate == FALSE)
+        if (SDIstart() == FAIL)
+            HGOTO_ERROR(DFE_CANTINIT, FAIL);
+
+    /* the image is opened again under the name it was given, which shares
+       its file record instead of looking for a file on disk */
+    if (Hfidinquire(file_id, &name, &access, &attach) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    cdfid = ncopen(name, (access & DFACC_WRITE) ? NC_RDWR : NC_NOWRITE);
+    if (cdfid == -1)
+        HGOTO_ERROR(DFE_BADOPEN, FAIL);
+
+    handle = NC_check_id(cdfid);
+    if (handle == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* set in 'define' mode? */
+    handle->flags &= ~(NC_INDEF);
+
+    /* create file id to return */
+    ret_value = (((int32)cdfid) << 20) + (((int32)CDFTYPE) << 16) + cdfid;
+
+done:
+    return ret_value;
+} /* SDstart_image */
+
 /******************************************************************************
  NAME
     SDend -- close a file
@@ -830,11 +890,9 @@ int32
 SDnametoindex(int32       fid, /* IN: file ID */
               const char *name /* IN: name of dataset to search for */)
 {
-    unsigned ii;
-    intn     len;
-    NC      *handle    = NULL;
-    NC_var **dp        = NULL;
-    int32    ret_value = FAIL;
+    int   ii;
+    NC   *handle    = NULL;
+    int32 ret_value = FAIL;
 
 #ifdef SDDEBUG
     fprintf(stderr, "SDnametoindex: I've been called\n");
@@ -850,12 +908,9 @@ SDnametoindex(int32       fid, /* IN: file ID */
         HGOTO_ERROR(DFE_ARGS, FAIL);
     }
 
-    len = HDstrlen(name);
-    dp  = (NC_var **)handle->vars->values;
-    for (ii = 0; ii < handle->vars->count; ii++, dp++) {
-        if (len == (*dp)->name->len && HDstrncmp(name, (*dp)->name->values, HDstrlen(name)) == 0) {
-            HGOTO_DONE((int32)ii);
-        }
+    ii = NC_nameindex_find(&handle->varindex, handle->vars, name, -1);
+    if (ii != -1) {
+        HGOTO_DONE((int32)ii);
     }
 
     ret_value = FAIL;
@@ -1242,6 +1297,19 @@ SDcreate(int32       fid,  /* IN: file ID */
         var->rag_fill = 0;
     }
 
+    /* compute all of the shape information */
+    if (NC_var_shape(var, handle->dims) == -1) {
+        NC_free_var(var);
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+
+    /* offsets and lengths in an HDF file are 32-bit, so is the size of
+       the data a fixed-size dataset is stored in */
+    if (handle->file_type == HDF_FILE && !IS_RECVAR(var) && var->len > (unsigned long)MAX_FILE_OFFSET) {
+        NC_free_var(var);
+        HGOTO_ERROR(DFE_EXCEEDMAX, FAIL);
+    }
+
     /* add it to the handle */
     if (handle->vars == NULL) { /* first time */
         handle->vars = NC_new_array(NC_VARIABLE, (unsigned)1, (Void *)&var);
@@ -1260,11 +1328,6 @@ SDcreate(int32       fid,  /* IN: file ID */
         }
     }
 
-    /* compute all of the shape information */
-    if (NC_var_shape(var, handle->dims) == -1) {
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
-    }
-
     /* create a handle we can give back to the user */
     sdsid = (((int32)fid) << 20) + (((int32)SDSTYPE) << 16);
     sdsid += handle->vars->count - 1;
@@ -1381,8 +1444,7 @@ SDsetdimname(int32       id, /* IN: dataset ID */
     NC_string *old    = NULL;
     NC_string *new    = NULL;
     NC_array **ap     = NULL;
-    size_t     len;
-    unsigned   ii;
+    int        ii;
     intn       ret_value = SUCCEED;
 
 #ifdef SDDEBUG
@@ -1405,24 +1467,33 @@ SDsetdimname(int32       id, /* IN: dataset ID */
     }
 
     /* check for name in use */
-    len = HDstrlen(name);
-    dp  = (NC_dim **)handle->dims->values;
-    for (ii = 0; ii < handle->dims->count; ii++, dp++) {
-        if (len == (*dp)->name->len && HDstrncmp(name, (*dp)->name->values, HDstrlen(name)) == 0) {
-            if (dim != (*dp)) {
-                /* a dimension with this name already exists */
-                /* so change to point to it */
-                if (dim->size != (*dp)->size) {
-                    HGOTO_ERROR(DFE_BADDIMNAME, FAIL);
-                }
-
-                ap = (NC_array **)handle->dims->values;
-                ap += id & 0xffff;
-                NC_free_dim(dim);
-                (*dp)->count += 1;
-                (*ap) = (NC_array *)(*dp);
-                HGOTO_DONE(SUCCEED);
+    for (ii = NC_nameindex_find(&handle->dimindex, handle->dims, name, -1); ii != -1;
+         ii = NC_nameindex_find(&handle->dimindex, handle->dims, name, ii)) {
+        dp = (NC_dim **)handle->dims->values + ii;
+        if (dim != (*dp)) {
+            /* a dimension with this name already exists */
+            /* so change to point to it */
+            if (dim->size != (*dp)->size) {
+                HGOTO_ERROR(DFE_BADDIMNAME, FAIL);
             }
+
+            ap = (NC_array **)handle->dims->values;
+            ap += id & 0xffff;
+            /* the variables using the dimension now list another one */
+            if (handle->vars != NULL) {
+                NC_var **vp = (NC_var **)handle->vars->values;
+                unsigned jj, kk;
+
+                for (jj = 0; jj < handle->vars->count; jj++, vp++)
+                    for (kk = 0; kk < (*vp)->assoc->count; kk++)
+                        if ((*vp)->assoc->values[kk] == (int)(id & 0xffff))
+                            (*vp)->dirty = TRUE;
+            } /* end if */
+            NC_free_dim(dim);
+            (*dp)->count += 1;
+            (*ap) = (NC_array *)(*dp);
+            NC_nameindex_move(handle->dimindex, (int)(id & 0xffff));
+            HGOTO_DONE(SUCCEED);
         }
     }
 
@@ -1433,8 +1504,10 @@ SDsetdimname(int32       id, /* IN: dataset ID */
         HGOTO_ERROR(DFE_ARGS, FAIL);
     }
 
-    dim->name = new;
+    dim->name  = new;
+    dim->dirty = TRUE;
     NC_free_string(old);
+    NC_dimindex_move(handle, (int)(id & 0xffff));
 
     /* make sure it gets reflected in the file */
     handle->flags |= NC_HDIRTY;
@@ -1570,6 +1643,9 @@ SDIputattr(NC_array  **ap,    /* IN/OUT: attribute list */
                 HGOTO_ERROR(DFE_INTERNAL, FAIL);
             }
             (*atp)->HDFtype = nt; /* Add HDFtype  */
+            /* the new values may go over the old ones in the file */
+            (*atp)->ref   = old->ref;
+            (*atp)->dirty = TRUE;
             NC_free_attr(old);
         }
         else {
@@ -1957,6 +2033,79 @@ done:
     return ret_value;
 } /* SDreadattr */
 
+/******************************************************************************
+ NAME
+    SDgetattrs -- get all the attributes of an object
+
+ DESCRIPTION
+    Return the name, number type, count and values of every attribute of
+    a file, dataset or dimension, in index order, in one buffer that the
+    caller frees with free().  *attrs is set to NULL if there are none.
+
+ RETURNS
+    The number of attributes, or FAIL.
+
+******************************************************************************/
+intn
+SDgetattrs(int32        id,   /* IN:  object ID */
+           hdf_attr_t **attrs /* OUT: the attributes */)
+{
+    NC_array   *ap        = NULL;
+    NC_array  **app       = NULL;
+    NC_attr   **atp       = NULL;
+    NC         *handle    = NULL;
+    hdf_attr_t *buf       = NULL;
+    uint8      *next      = NULL;
+    void       *values    = NULL;
+    size_t      space     = 0;
+    unsigned    i;
+    intn        ret_value = FAIL;
+
+#ifdef SDDEBUG
+    fprintf(stderr, "SDgetattrs: I've been called\n");
+#endif
+
+    /* clear error stack */
+    HEclear();
+
+    /* sanity check args */
+    if (attrs == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    *attrs = NULL;
+
+    /* determine what type of ID we've been given */
+    if (SDIapfromid(id, &handle, &app) == FAIL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    ap = (*app);
+    if (ap == NULL || ap->count == 0)
+        HGOTO_DONE(0);
+
+    /* size all the names and values first */
+    atp = (NC_attr **)ap->values;
+    for (i = 0; i < ap->count; i++) {
+        if (atp[i] == NULL)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        space += HDattr_space(atp[i]->name->len, (size_t)atp[i]->data->count * atp[i]->data->szof);
+    }
+    if ((buf = HDattrs_alloc((intn)ap->count, space, &next)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* move the information over */
+    for (i = 0; i < ap->count; i++) {
+        values = HDattr_place(&buf[i], &next, atp[i]->name->values, atp[i]->name->len, atp[i]->HDFtype,
+                              (int32)atp[i]->data->count, (size_t)atp[i]->data->count * atp[i]->data->szof);
+        memcpy(values, atp[i]->data->values, (size_t)atp[i]->data->count * atp[i]->data->szof);
+    }
+
+    *attrs    = buf;
+    ret_value = (intn)ap->count;
+
+done:
+    return ret_value;
+} /* SDgetattrs */
+
 /******************************************************************************
  NAME
     SDwritedata -- write a hyperslab of data
@@ -2108,6 +2257,10 @@ SDwritedata(int32  sdsid,  /* IN: dataset ID */
         if (!IS_RECVAR(var) && (handle->flags & NC_NOFILL)) {
             var->set_length = TRUE;
         } /* end if */
+        else if (!IS_RECVAR(var) && (handle->flags & NC_LAZYFILL) && handle->file_type == HDF_FILE) {
+            var->set_length = TRUE;
+            var->lazy_fill  = TRUE;
+        } /* end if */
         var->created = FALSE;
     } /* end if */
 
@@ -2133,6 +2286,72 @@ done:
     return ret_value;
 } /* SDwritedata */
 
+/******************************************************************************
+ NAME
+    SDappenddata -- append records to a dataset with an unlimited dimension
+
+ DESCRIPTION
+    Write nrecs whole records after the last record of the dataset, as
+    one SDwritedata() would with start[0] set to the current number of
+    records.  The element grows once for all the records, and the
+    number of records is updated once for the call.  In an HDF file it
+    is only marked dirty here; it is written with the size of the
+    unlimited dimension when the file is closed.  Appending many
+    records in one call is much cheaper than appending them one at a
+    time.
+
+ RETURNS
+    SUCCEED / FAIL
+
+******************************************************************************/
+intn
+SDappenddata(int32       sdsid, /* IN: dataset ID */
+             int32       nrecs, /* IN: number of records to append */
+             const void *data /* IN: data buffer */)
+{
+    NC     *handle = NULL;
+    NC_var *var    = NULL;
+    int32   start[H4_MAX_VAR_DIMS];
+    int32   edge[H4_MAX_VAR_DIMS];
+    int     i;
+    intn    ret_value = SUCCEED;
+
+#ifdef SDDEBUG
+    fprintf(stderr, "SDappenddata: I've been called\n");
+#endif
+
+    /* clear error stack */
+    HEclear();
+
+    if (nrecs <= 0 || data == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->vars == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* only a dataset with an unlimited dimension has records */
+    if (!IS_RECVAR(var))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* start at the end of the dataset and write whole records */
+    start[0] = handle->file_type == HDF_FILE ? (int32)var->numrecs : (int32)handle->numrecs;
+    edge[0]  = nrecs;
+    for (i = 1; i < var->assoc->count; i++) {
+        start[i] = 0;
+        edge[i]  = (int32)var->shape[i];
+    }
+
+    ret_value = SDwritedata(sdsid, start, NULL, edge, (void *)data);
+
+done:
+    return ret_value;
+} /* SDappenddata */
+
 /******************************************************************************
  NAME
     SDsetdatastrs -- set "data strings"
@@ -2604,8 +2823,7 @@ SDIgetcoordvar(NC     *handle, /* IN: file handle */
                int32   id,     /* IN: dimension ID */
                int32   nt /* IN: number type to use if new variable*/)
 {
-    unsigned   ii;
-    unsigned   len;
+    int        ii;
     nc_type    nctype;
     intn       dimindex;
     NC_string *name      = NULL;
@@ -2615,49 +2833,49 @@ SDIgetcoordvar(NC     *handle, /* IN: file handle */
 
     /* look for a variable with the same name */
     name = dim->name;
-    len  = dim->name->len;
-    dp   = (NC_var **)handle->vars->values;
-    for (ii = 0; ii < handle->vars->count; ii++, dp++) {
+    for (ii = NC_nameindex_find(&handle->varindex, handle->vars, name->values, -1); ii != -1;
+         ii = NC_nameindex_find(&handle->varindex, handle->vars, name->values, ii)) {
+        dp = (NC_var **)handle->vars->values + ii;
         /* eliminate vars with rank > 1, coord vars only have rank 1 */
         if ((*dp)->assoc->count == 1)
-            if (len == (*dp)->name->len && HDstrncmp(name->values, (*dp)->name->values, (size_t)len) == 0)
-                /* only proceed if the file is a netCDF file (bugz 1644)
-                or if this variable is a coordinate var or when
-                the status is unknown due to its being created prior to
-                the fix of bugzilla 624 - BMR 05/14/2007 */
-                if ((handle->file_type != HDF_FILE) || (*dp)->var_type == IS_CRDVAR ||
-                    (*dp)->var_type == UNKNOWN) {
-                    /* see if we need to change the number type */
-                    if ((nt != 0) && (nt != (*dp)->type)) {
+            /* only proceed if the file is a netCDF file (bugz 1644)
+            or if this variable is a coordinate var or when
+            the status is unknown due to its being created prior to
+            the fix of bugzilla 624 - BMR 05/14/2007 */
+            if ((handle->file_type != HDF_FILE) || (*dp)->var_type == IS_CRDVAR ||
+                (*dp)->var_type == UNKNOWN) {
+                /* see if we need to change the number type */
+                if ((nt != 0) && (nt != (*dp)->type)) {
 #ifdef SDDEBUG
-                        fprintf(stderr, "SDIgetcoordvar redefining type\n");
+                    fprintf(stderr, "SDIgetcoordvar redefining type\n");
 #endif
-                        if (((*dp)->type = hdf_unmap_type((int)nt)) == FAIL) {
+                    if (((*dp)->type = hdf_unmap_type((int)nt)) == FAIL) {
 #ifdef SDDEBUG
-                            /* replace it with NCAdvice or HERROR? */
-                            fprintf(stderr, "SDIgetcoordvar: hdf_unmap_type failed for %d\n", nt);
+                        /* replace it with NCAdvice or HERROR? */
+                        fprintf(stderr, "SDIgetcoordvar: hdf_unmap_type failed for %d\n", nt);
 #endif
-                            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                        }
-
-                        (*dp)->HDFtype = nt;
-                        (*dp)->cdf     = handle;
-                        /* don't forget to reset the sizes  */
-                        (*dp)->szof = NC_typelen((*dp)->type);
-                        if (FAIL == ((*dp)->HDFsize = DFKNTsize(nt))) {
-                            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                        }
+                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+                    }
 
-                        /* recompute all of the shape information */
-                        /* BUG: this may be a memory leak ??? */
-                        if (NC_var_shape((*dp), handle->dims) == -1) {
-                            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                        }
+                    (*dp)->HDFtype = nt;
+                    (*dp)->cdf     = handle;
+                    (*dp)->dirty   = TRUE;
+                    /* don't forget to reset the sizes  */
+                    (*dp)->szof = NC_typelen((*dp)->type);
+                    if (FAIL == ((*dp)->HDFsize = DFKNTsize(nt))) {
+                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
                     }
 
-                    /* found it? */
-                    HGOTO_DONE((int32)ii);
+                    /* recompute all of the shape information */
+                    /* BUG: this may be a memory leak ??? */
+                    if (NC_var_shape((*dp), handle->dims) == -1) {
+                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+                    }
                 }
+
+                /* found it? */
+                HGOTO_DONE((int32)ii);
+            }
     }
 
     /* create a new var with this dim as only coord */
@@ -2827,6 +3045,11 @@ SDIfreevarAID(NC   *handle, /* IN: file handle */
 
     var = (NC_var *)*ap;
 
+    /* write the fill values still owed by a dataset in lazy fill mode */
+    if (var && hdf_lazy_fill(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    }
+
     if (var && var->aid != 0 && var->aid != FAIL) {
         if (Hendaccess(var->aid) == FAIL) {
             HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -3039,7 +3262,6 @@ SDdiminfo(int32  id,   /* IN:  dimension ID */
     NC_dim  *dim    = NULL;
     NC_var **dp     = NULL;
     intn     ii;
-    intn     len;
     int      ret_value = SUCCEED;
 
 #ifdef SDDEBUG
@@ -3089,32 +3311,30 @@ SDdiminfo(int32  id,   /* IN:  dimension ID */
        coordinate var of the dimension; so, if there is no coord var associated
        with the dimension being inquired, these info will not be available. */
     if (handle->vars) {
-        len = dim->name->len;
-        dp  = (NC_var **)handle->vars->values;
-        for (ii = 0; ii < handle->vars->count; ii++, dp++) {
+        /* look at the variables that have the dimension's name */
+        for (ii = NC_nameindex_find(&handle->varindex, handle->vars, dim->name->values, -1); ii != -1;
+             ii = NC_nameindex_find(&handle->varindex, handle->vars, dim->name->values, ii)) {
+            dp = (NC_var **)handle->vars->values + ii;
             /* eliminate vars with rank > 1, coord vars only have rank 1 */
             if ((*dp)->assoc->count == 1) {
-                /* check if this variable matches the searched name */
-                if (len == (*dp)->name->len && HDstrncmp(name, (*dp)->name->values, (*dp)->name->len) == 0) {
-                    if (handle->file_type == HDF_FILE) /* HDF file */
-                    {
-                        /* only proceed if this variable is a coordinate var or
-                        when its status is unknown due to its being created
-                        prior to the fix of bugzilla 624 - BMR - 05/14/2007 */
-                        if ((*dp)->var_type == IS_CRDVAR || (*dp)->var_type == UNKNOWN) {
-                            *nt    = ((*dp)->numrecs ? (*dp)->HDFtype : 0);
-                            *nattr = ((*dp)->attrs ? (*dp)->attrs->count : 0);
-                            HGOTO_DONE(ret_value);
-                        }
-                    }
-                    else /* netCDF file */
-                    {
-                        *nt    = (*dp)->HDFtype;
+                if (handle->file_type == HDF_FILE) /* HDF file */
+                {
+                    /* only proceed if this variable is a coordinate var or
+                    when its status is unknown due to its being created
+                    prior to the fix of bugzilla 624 - BMR - 05/14/2007 */
+                    if ((*dp)->var_type == IS_CRDVAR || (*dp)->var_type == UNKNOWN) {
+                        *nt    = ((*dp)->numrecs ? (*dp)->HDFtype : 0);
                         *nattr = ((*dp)->attrs ? (*dp)->attrs->count : 0);
                         HGOTO_DONE(ret_value);
                     }
-                } /* name matched */
-            }     /* rank = 1 */
+                }
+                else /* netCDF file */
+                {
+                    *nt    = (*dp)->HDFtype;
+                    *nattr = ((*dp)->attrs ? (*dp)->attrs->count : 0);
+                    HGOTO_DONE(ret_value);
+                }
+            } /* rank = 1 */
         }
     }
 done:
@@ -3147,8 +3367,7 @@ SDgetdimstrs(int32 id, /* IN:  dataset ID */
     NC_dim   *dim    = NULL;
     NC_attr **attr   = NULL;
     char     *name   = NULL;
-    int32     ii;
-    int32     namelen;
+    int       ii;
     intn      ret_value = SUCCEED;
 
 #ifdef SDDEBUG
@@ -3179,27 +3398,26 @@ SDgetdimstrs(int32 id, /* IN:  dataset ID */
     /* need to get a pointer to the var now */
     var = NULL;
     if (handle->vars) {
-        name    = dim->name->values;
-        namelen = HDstrlen(name);
-        dp      = (NC_var **)handle->vars->values;
-        for (ii = 0; ii < handle->vars->count; ii++, dp++) {
+        name = dim->name->values;
+        for (ii = NC_nameindex_find(&handle->varindex, handle->vars, name, -1); ii != -1;
+             ii = NC_nameindex_find(&handle->varindex, handle->vars, name, ii)) {
+            dp = (NC_var **)handle->vars->values + ii;
             /* eliminate vars with rank > 1, coord vars only have rank 1 */
             if ((*dp)->assoc->count == 1)
-                if (namelen == (*dp)->name->len && HDstrncmp(name, (*dp)->name->values, HDstrlen(name)) == 0)
-                    /* because a dim was given, make sure that this is a coord var */
-                    /* if it is an SDS, the function will fail */
-                    if ((*dp)->var_type == IS_SDSVAR) {
-                        HGOTO_ERROR(DFE_ARGS, FAIL)
-                    }
-                    /* only proceed if this variable is a coordinate var or when
-                    its status is unknown due to its being created prior to
-                    the fix of bugzilla 624 - BMR - 05/14/2007 */
-                    else
-                    /* i.e., (*dp)->var_type == IS_CRDVAR ||
-                        (*dp)->var_type == UNKNOWN) */
-                    {
-                        var = (*dp);
-                    }
+                /* because a dim was given, make sure that this is a coord var */
+                /* if it is an SDS, the function will fail */
+                if ((*dp)->var_type == IS_SDSVAR) {
+                    HGOTO_ERROR(DFE_ARGS, FAIL)
+                }
+                /* only proceed if this variable is a coordinate var or when
+                its status is unknown due to its being created prior to
+                the fix of bugzilla 624 - BMR - 05/14/2007 */
+                else
+                /* i.e., (*dp)->var_type == IS_CRDVAR ||
+                    (*dp)->var_type == UNKNOWN) */
+                {
+                    var = (*dp);
+                }
         }
     }
 
@@ -3336,6 +3554,11 @@ SDsetexternalfile(int32       id,       /* IN: dataset ID */
 
     /* already exists */
     if (var->data_ref) {
+        /* the data moved to the external file must include its fill values */
+        if (hdf_lazy_fill(handle, var) == FAIL) {
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        }
+
         /* no need to give a length since the element already exists */
         status = (intn)HXcreate(handle->hdf_file, (uint16)DATA_TAG, (uint16)var->data_ref, filename, offset,
                                 (int32)0);
@@ -3355,6 +3578,7 @@ SDsetexternalfile(int32       id,       /* IN: dataset ID */
         if (var->data_ref == 0) {
             HGOTO_ERROR(DFE_NOREF, FAIL);
         }
+        var->dirty = TRUE; /* the Vgroup doesn't list the data yet */
 
         /* need to give a length since the element does not exist yet */
         status = (intn)HXcreate(handle->hdf_file, (uint16)DATA_TAG, (uint16)var->data_ref, filename, offset,
@@ -3736,8 +3960,14 @@ SDsetnbitdataset(int32 id,        /* IN: dataset ID */
         if (var->data_ref == 0) {
             HGOTO_ERROR(DFE_ARGS, FAIL);
         }
+        var->dirty = TRUE; /* the Vgroup doesn't list the data yet */
     } /* end if */
 
+    /* the data compressed from here on must include its fill values */
+    if (hdf_lazy_fill(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    }
+
     status = (intn)HCcreate(handle->hdf_file, (uint16)DATA_TAG, (uint16)var->data_ref, COMP_MODEL_STDIO,
                             &m_info, COMP_CODE_NBIT, &c_info);
 
@@ -3937,6 +4167,11 @@ SDsetcompress(int32        id,        /* IN: dataset ID */
         }
     } /* end if */
 
+    /* the data compressed from here on must include its fill values */
+    if (hdf_lazy_fill(handle, var) == FAIL) {
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    }
+
     status = (intn)HCcreate(handle->hdf_file, (uint16)DATA_TAG, (uint16)var->data_ref, COMP_MODEL_STDIO,
                             &m_info, comp_type, &c_info_x);
 
@@ -3970,6 +4205,7 @@ SDsetcompress(int32        id,        /* IN: dataset ID */
         if (Vaddtagref(vg, (int32)DATA_TAG, (int32)var->data_ref) == FAIL) {
             HGOTO_ERROR(DFE_ARGS, FAIL);
         }
+        var->dirty = TRUE; /* the NDG doesn't list the data yet */
 
         /* detach from the variable's VGroup --- will no longer need it */
         if (Vdetach(vg) == FAIL) {
@@ -4746,11 +4982,18 @@ done:
 
 /******************************************************************************
  NAME
-   SDsetfillmode -- set fill mode as fill or nofill
+   SDsetfillmode -- set fill mode as fill, nofill or lazy fill
 
  DESCRIPTION
    Calls ncsetfill().
 
+   In SD_LAZYFILL mode a new fixed-size dataset gets its full storage
+   when it is first written, but fill values are only written into the
+   parts that are still unwritten when the dataset is closed with
+   SDendaccess() or SDend(); until then reads of those parts return the
+   fill value.  Datasets that are compressed, chunked or have an
+   unlimited dimension are filled the usual way.
+
  RETURNS
    The current fill mode of the file, or FAIL for error.
 
@@ -4758,7 +5001,7 @@ done:
 intn
 SDsetfillmode(int32 sd_id,  /* IN: HDF file ID, returned from SDstart */
               intn fillmode /* IN: Desired fill mode for the file,
-                                   either SD_FILL or SD_NOFILL.
+                                   SD_FILL, SD_NOFILL or SD_LAZYFILL.
                                    SD_FILL is the default mode. */)
 {
     NC  *handle = NULL;
@@ -4830,6 +5073,7 @@ SDsetdimval_comp(int32 dimid,    /* IN: dimension ID, returned from SDgetdimid *
     */
     if (dim->dim00_compat != comp_mode) {
         dim->dim00_compat = comp_mode;
+        dim->dirty        = TRUE;
 
         /* make sure it gets reflected in the file */
         handle->flags |= NC_HDIRTY;
@@ -5145,6 +5389,7 @@ SDsetchunk(int32         sdsid,     /* IN: sds access id */
 #endif
             HGOTO_ERROR(DFE_ARGS, FAIL);
         }
+        var->dirty = TRUE; /* the Vgroup doesn't list the data yet */
     }
     else /* data ref exists, Error since can't convert existing SDS to chunked */
     {
@@ -849,6 +849,7 @@ hdf_get_data(NC *handle, NC_var *vp)
             ret_value = DFREF_NONE;
             goto done;
         }
+        vp->dirty = TRUE; /* the NDG doesn't list the data yet */
 
         /* detach from the variable's VGroup --- will no longer need it */
         if (FAIL == Vdetach(vg)) {
@@ -922,6 +923,234 @@ done:
     return ret_value;
 } /* hdf_get_vp_aid */
 
+/* ----------------------------- hdf_lazy_add ----------------------------- */
+/*
+ * Record that bytes [start, end) of a variable in lazy fill mode have been
+ * written, merging the range with the ones it overlaps or touches.
+ */
+static intn
+hdf_lazy_add(NC_var *vp, int32 start, int32 end)
+{
+    int32 *ranges;
+    int32  new_max;
+    int32  i, j;
+    intn   ret_value = SUCCEED;
+
+    /* find the first range ending at or after 'start'; writes mostly come
+       in order, so look from the last range back */
+    for (i = vp->nwritten; i > 0 && vp->written[2 * (i - 1) + 1] >= start; i--)
+        ;
+
+    /* ranges i up to j overlap or touch the new one */
+    for (j = i; j < vp->nwritten && vp->written[2 * j] <= end; j++) {
+        start = MIN(start, vp->written[2 * j]);
+        end   = MAX(end, vp->written[2 * j + 1]);
+    }
+
+    if (i == j) { /* make room for a new range at i */
+        if (vp->nwritten == vp->max_written) {
+            new_max = (vp->max_written > 0) ? 2 * vp->max_written : 8;
+            ranges  = realloc(vp->written, (size_t)new_max * 2 * sizeof(int32));
+            if (ranges == NULL) {
+                ret_value = FAIL;
+                goto done;
+            }
+            vp->written     = ranges;
+            vp->max_written = new_max;
+        }
+        memmove(&vp->written[2 * (i + 1)], &vp->written[2 * i],
+                (size_t)(vp->nwritten - i) * 2 * sizeof(int32));
+        vp->nwritten++;
+    }
+    else if (j > i + 1) { /* ranges i+1 to j-1 are merged into range i */
+        memmove(&vp->written[2 * (i + 1)], &vp->written[2 * j],
+                (size_t)(vp->nwritten - j) * 2 * sizeof(int32));
+        vp->nwritten -= j - i - 1;
+    }
+    vp->written[2 * i]     = start;
+    vp->written[2 * i + 1] = end;
+
+done:
+    return ret_value;
+} /* hdf_lazy_add */
+
+/* --------------------------- hdf_lazy_covered --------------------------- */
+/*
+ * Return TRUE if bytes [start, end) of a variable in lazy fill mode lie in
+ * one range that has been written.
+ */
+static intn
+hdf_lazy_covered(const NC_var *vp, int32 start, int32 end)
+{
+    int32 lo = 0, hi = vp->nwritten, mid;
+
+    /* find the last range starting at or before 'start' */
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (vp->written[2 * mid] <= start)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return (lo > 0 && vp->written[2 * (lo - 1) + 1] >= end) ? TRUE : FALSE;
+} /* hdf_lazy_covered */
+
+/* ----------------------------- hdf_lazy_read ----------------------------- */
+/*
+ * Read 'count' items at 'where' from a variable in lazy fill mode: the
+ *  parts that have been written are read from the file and the rest is
+ *  set to the fill value.
+ */
+static intn
+hdf_lazy_read(NC *handle, NC_var *vp, int32 where, nc_type type, uint32 count, void *values)
+{
+    NC_attr **attr    = NC_findattr(&vp->attrs, _FillValue);
+    int32     end     = where + (int32)count * vp->HDFsize;
+    uint8    *pvalues = values;
+    int32     seg_end;
+    uint32    seg_count;
+    int32     i         = 0;
+    intn      ret_value = SUCCEED;
+
+    while (where < end) {
+        /* skip the ranges that end before this point */
+        while (i < vp->nwritten && vp->written[2 * i + 1] <= where)
+            i++;
+
+        if (i < vp->nwritten && vp->written[2 * i] <= where) { /* written, read it */
+            seg_end   = MIN(end, vp->written[2 * i + 1]);
+            seg_count = (uint32)((seg_end - where) / vp->HDFsize);
+            if (hdf_xdr_NCvdata(handle, vp, (u_long)where, type, seg_count, pvalues) == FAIL) {
+                ret_value = FAIL;
+                goto done;
+            }
+        }
+        else { /* never written, return fill values */
+            seg_end   = (i < vp->nwritten) ? MIN(end, vp->written[2 * i]) : end;
+            seg_count = (uint32)((seg_end - where) / vp->HDFsize);
+            if (attr != NULL)
+                HDmemfill(pvalues, (*attr)->data->values, (uint32)vp->szof, seg_count);
+            else
+                NC_arrayfill(pvalues, seg_count * vp->szof, vp->type);
+        }
+
+        pvalues += seg_count * vp->szof;
+        where = seg_end;
+    }
+
+done:
+    return ret_value;
+} /* hdf_lazy_read */
+
+/* ----------------------------- hdf_lazy_fill ----------------------------- */
+/*
+ * Write fill values into the parts of a variable in lazy fill mode that
+ *  have not been written, and take the variable out of lazy fill mode.
+ *  Does nothing for other variables.
+ */
+intn
+hdf_lazy_fill(NC *handle, NC_var *vp)
+{
+    NC_attr **attr = NULL;
+    int8      platntsubclass; /* the machine type of the current platform */
+    int8      outntsubclass;  /* the data's machine type */
+    uint32    fill_count;     /* number of fill values in the buffer */
+    int32     chunk_size;     /* bytes of fill values in the buffer */
+    int32     len;
+    int32     pos;
+    int32     gap_end;
+    int32     i;
+    uint8    *write_buf = NULL;
+    intn      ret_value = SUCCEED;
+
+    if (!vp->lazy_fill)
+        goto done;
+
+    /* the positions in the element are int32 */
+    if (vp->len > (unsigned long)INT32_MAX) {
+        ret_value = FAIL;
+        goto done;
+    }
+
+    if (vp->aid == FAIL && hdf_get_vp_aid(handle, vp) == FAIL) {
+        ret_value = FAIL;
+        goto done;
+    }
+
+    /* one buffer of fill values, in the file's number format */
+    fill_count = (uint32)(MIN((int32)vp->len, MAX_SIZE) / vp->HDFsize);
+    chunk_size = (int32)fill_count * vp->HDFsize;
+    if (fill_count == 0)
+        goto finish;
+    if (SDIresizebuf((void **)&tBuf, &tBuf_size, (int32)(fill_count * vp->szof)) == FAIL) {
+        ret_value = FAIL;
+        goto done;
+    }
+    if ((attr = NC_findattr(&vp->attrs, _FillValue)) != NULL)
+        HDmemfill(tBuf, (*attr)->data->values, (uint32)vp->szof, fill_count);
+    else
+        NC_arrayfill(tBuf, fill_count * vp->szof, vp->type);
+
+    if (FAIL == (platntsubclass = DFKgetPNSC(vp->HDFtype, DF_MT))) {
+        ret_value = FAIL;
+        goto done;
+    }
+    if (DFKisnativeNT(vp->HDFtype)) {
+        if (FAIL == (outntsubclass = DFKgetPNSC(vp->HDFtype, DF_MT))) {
+            ret_value = FAIL;
+            goto done;
+        }
+    }
+    else
+        outntsubclass = DFKislitendNT(vp->HDFtype) ? DFNTF_PC : DFNTF_HDFDEFAULT;
+
+    if (platntsubclass != outntsubclass) {
+        if (SDIresizebuf((void **)&tValues, &tValues_size, chunk_size) == FAIL) {
+            ret_value = FAIL;
+            goto done;
+        }
+        if (FAIL == DFKconvert(tBuf, tValues, vp->HDFtype, (int32)fill_count, DFACC_WRITE, 0, 0)) {
+            ret_value = FAIL;
+            goto done;
+        }
+        write_buf = (uint8 *)tValues;
+    }
+    else
+        write_buf = (uint8 *)tBuf;
+
+    /* write the gaps before, between and after the written ranges */
+    pos = 0;
+    for (i = 0; i <= vp->nwritten; i++) {
+        gap_end = (i < vp->nwritten) ? vp->written[2 * i] : (int32)vp->len;
+        if (pos < gap_end && Hseek(vp->aid, pos, DF_START) == FAIL) {
+            ret_value = FAIL;
+            goto done;
+        }
+        while (pos < gap_end) {
+            len = MIN(chunk_size, gap_end - pos);
+            if (Hwrite(vp->aid, len, write_buf) != len) {
+                ret_value = FAIL;
+                goto done;
+            }
+            pos += len;
+        }
+        if (i < vp->nwritten)
+            pos = vp->written[2 * i + 1];
+    }
+
+finish:
+    free(vp->written);
+    vp->written     = NULL;
+    vp->nwritten    = 0;
+    vp->max_written = 0;
+    vp->lazy_fill   = FALSE;
+
+done:
+    SDPfreebuf();
+    return ret_value;
+} /* hdf_lazy_fill */
+
 /* --------------------------- hdf_xdr_NCvdata ---------------------------- */
 /*
  *  Read / write 'count' items of contiguous data of type 'type' at 'where'
@@ -1021,6 +1250,24 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
     /* Collect all the number-type size information, etc. */
     byte_count = count * vp->HDFsize;
 
+    /* Lazy fill needs the full length allocated up front in plain storage;
+       otherwise fill this dataset the usual way */
+    if (vp->lazy_fill) {
+        if (isspecial != 0 || vp->data_offset > 0 || vp->len > (unsigned long)INT32_MAX ||
+            elem_length < (int32)vp->len) {
+            free(vp->written);
+            vp->written     = NULL;
+            vp->nwritten    = 0;
+            vp->max_written = 0;
+            vp->lazy_fill   = FALSE;
+        }
+        else if (handle->xdrs->x_op == XDR_DECODE &&
+                 !hdf_lazy_covered(vp, (int32)where, (int32)where + byte_count)) {
+            ret_value = hdf_lazy_read(handle, vp, (int32)where, type, count, values);
+            goto done;
+        }
+    }
+
     if (FAIL == (platntsubclass = DFKgetPNSC(vp->HDFtype, DF_MT))) {
         ret_value = FAIL;
         goto done;
@@ -1385,7 +1632,12 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, u_long where, nc_type type, uint32 count
                 goto done;
             }
         } /* no convert */
-    }     /* XDR_ENCODE */
+
+        if (vp->lazy_fill && hdf_lazy_add(vp, (int32)where, (int32)where + byte_count) == FAIL) {
+            ret_value = FAIL;
+            goto done;
+        }
+    } /* XDR_ENCODE */
 
     /* if we get here and the length is 0, we need to finish writing out the fill-values */
     bytes_left = vp->len - (where + byte_count);
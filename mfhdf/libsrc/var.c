@@ -55,12 +55,17 @@ NC_new_var(const char *name, nc_type type, int ndims, const int *dims)
     ret->numrecs     = 0;        /* Only used in unlimited dimension case */
     ret->aid         = FAIL;
     ret->ndg_ref     = 0;
+    ret->dirty       = TRUE; /* no Vgroup written for it yet */
     ret->var_type    = UNKNOWN; /* Unknown whether this var is an SDS or a coord var */
     ret->HDFtype     = hdf_map_type(type);
     ret->HDFsize     = DFKNTsize(ret->HDFtype);
     ret->is_ragged   = FALSE;
     ret->created     = FALSE; /* This is set in SDcreate() if it's a new SDS */
     ret->set_length  = FALSE; /* This is set in SDwritedata() if the data needs its length set */
+    ret->lazy_fill   = FALSE; /* This is set in SDwritedata() in lazy fill mode */
+    ret->written     = NULL;
+    ret->nwritten    = 0;
+    ret->max_written = 0;
 #endif
 
     return (ret);
@@ -91,6 +96,9 @@ NC_free_var(NC_var *var)
         }
         free(var->shape);
         free(var->dsizes);
+#ifdef HDF
+        free(var->written);
+#endif
 
         if (NC_free_array(var->attrs) == FAIL) {
             ret_value = FAIL;
@@ -229,7 +237,6 @@ ncvardef(int cdfid, const char *name, nc_type type, int ndims, const int dims[])
     NC_var  *var[1];
     NC_var **dp;
     int      ii;
-    int      len;
 
     cdf_routine_name = "ncvardef";
 
@@ -272,13 +279,11 @@ ncvardef(int cdfid, const char *name, nc_type type, int ndims, const int dims[])
     }
     else {
         /* check for name in use */
-        len = strlen(name);
-        dp  = (NC_var **)handle->vars->values;
-        for (ii = 0; ii < handle->vars->count; ii++, dp++) {
-            if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, len) == 0) {
-                NCadvise(NC_ENAMEINUSE, "variable \"%s\" in use with index %d", (*dp)->name->values, ii);
-                return (-1);
-            }
+        ii = NC_nameindex_find(&handle->varindex, handle->vars, name, -1);
+        if (ii != -1) {
+            dp = (NC_var **)handle->vars->values + ii;
+            NCadvise(NC_ENAMEINUSE, "variable \"%s\" in use with index %d", (*dp)->name->values, ii);
+            return (-1);
         }
         var[0] = NC_new_var(name, type, ndims, dims);
         if (var[0] == NULL)
@@ -349,10 +354,8 @@ NC_computeshapes(NC *handle)
 int
 ncvarid(int cdfid, const char *name)
 {
-    NC      *handle;
-    NC_var **dp;
-    int      ii;
-    int      len;
+    NC *handle;
+    int ii;
 
     cdf_routine_name = "ncvarid";
 
@@ -361,13 +364,9 @@ ncvarid(int cdfid, const char *name)
         return (-1);
     if (handle->vars == NULL)
         return (-1);
-    len = strlen(name);
-    dp  = (NC_var **)handle->vars->values;
-    for (ii = 0; ii < handle->vars->count; ii++, dp++) {
-        if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, len) == 0) {
-            return (ii);
-        }
-    }
+    ii = NC_nameindex_find(&handle->varindex, handle->vars, name, -1);
+    if (ii != -1)
+        return (ii);
     NCadvise(NC_ENOTVAR, "variable \"%s\" not found", name);
     return (-1);
 }
@@ -461,7 +460,6 @@ ncvarrename(int cdfid, int varid, const char *newname)
     NC        *handle;
     NC_var   **vpp;
     int        ii;
-    int        len;
     NC_string *old, *new;
 
     cdf_routine_name = "ncvarrename";
@@ -473,13 +471,11 @@ ncvarrename(int cdfid, int varid, const char *newname)
         return (-1);
 
     /* check for name in use */
-    len = strlen(newname);
-    vpp = (NC_var **)handle->vars->values;
-    for (ii = 0; ii < handle->vars->count; ii++, vpp++) {
-        if (len == (*vpp)->name->len && strncmp(newname, (*vpp)->name->values, len) == 0) {
-            NCadvise(NC_ENAMEINUSE, "variable name \"%s\" in use with index %d", (*vpp)->name->values, ii);
-            return (-1);
-        }
+    ii = NC_nameindex_find(&handle->varindex, handle->vars, newname, -1);
+    if (ii != -1) {
+        vpp = (NC_var **)handle->vars->values + ii;
+        NCadvise(NC_ENAMEINUSE, "variable name \"%s\" in use with index %d", (*vpp)->name->values, ii);
+        return (-1);
     }
 
     if (varid == NC_GLOBAL) /* Global is error in this context */
@@ -496,6 +492,9 @@ ncvarrename(int cdfid, int varid, const char *newname)
         return (-1);
     }
 
+#ifdef HDF
+    (*vpp)->dirty = TRUE;
+#endif
     old = (*vpp)->name;
     if (NC_indefine(cdfid, TRUE)) {
         new = NC_new_string((unsigned)strlen(newname), newname);
@@ -503,11 +502,13 @@ ncvarrename(int cdfid, int varid, const char *newname)
             return (-1);
         (*vpp)->name = new;
         NC_free_string(old);
+        NC_nameindex_move(handle->varindex, varid);
         return (varid);
     } /* else */
     new = NC_re_string(old, (unsigned)strlen(newname), newname);
     if (new == NULL)
         return (-1);
+    NC_nameindex_move(handle->varindex, varid);
     if (handle->flags & NC_HSYNC) {
         handle->xdrs->x_op = XDR_ENCODE;
         if (!xdr_cdf(handle->xdrs, &handle))
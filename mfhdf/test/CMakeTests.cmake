@@ -53,6 +53,7 @@ set (HDF4_TESTMFHDF_FILES
     datainfo_simple.hdf
     datasizes.hdf
     dim.hdf
+    dimnames.hdf
     emptySDSs.hdf
     extfile.hdf
     exttst.hdf
@@ -83,9 +84,14 @@ set (HDF4_TESTMFHDF_FILES
     'This file name has quite a few characters because it is used to test the fix of bugzilla 1331. It has to be at least this long to see.'
     Unlim_dim.hdf
     Unlim_inloop.hdf
+    Lazy_fill.hdf
+    Attr_update.hdf
+    Data_later.hdf
+    Append_recs.hdf
     vars_samename.hdf
     tdfanndg.hdf
     tdfansdg.hdf
+    tdfsdndgs.hdf
 )
 add_test (
     NAME MFHDF_TEST-clearall-objects
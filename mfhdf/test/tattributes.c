@@ -18,6 +18,11 @@
  *	  test_count - tests that SDsetattr fails when the parameter
  *		"count" is set to 0.  (HDFFD-989 and 227: SDsetattr didn't
  *		fail but, eventually, SDend did)
+ *	  test_update - tests that attributes changed in an existing file
+ *		are written over the old ones at SDend
+ *	  test_data_later - tests that data written to the datasets of an
+ *		existing file is listed in their NDGs at SDend
+ *	  test_getattrs - tests reading all attributes of an object at once
  *
  ****************************************************************************/
 
@@ -27,6 +32,8 @@
 
 #include "hdftest.h"
 
+#include <sys/stat.h>
+
 /********************************************************************
    Name: test_count() - tests that SDsetattr fails when the parameter
                         "count" is passed into SDsetattr as 0 and the
@@ -78,6 +85,16 @@
 #define ATTR_ZERO     "ZERO"
 #define ATTR_LEN_ZERO 0
 
+#define FILE_UATTR  "Attr_update.hdf"
+#define N_UPD_SDS   3
+#define UPD_LEN     10
+#define UNITS_NAME  "units"
+#define RANGE_NAME  "valid_range"
+#define NOTE_NAME   "note"
+#define GLOBAL_NAME "history"
+
+#define FILE_UDATA "Data_later.hdf"
+
 static intn
 test_count(void)
 {
@@ -262,6 +279,376 @@ test_count(void)
     return num_errs;
 } /* test_count */
 
+/********************************************************************
+   Name: test_update() - tests that attributes changed in an existing
+                         file are written over the old ones.
+
+   Description:
+        When a file that already holds SDSs is closed, SDend writes
+        again only the attributes and datasets that changed.  An
+        attribute that keeps its type and number of values is written
+        over its old values, so the file doesn't grow.
+
+        The main contents of the test are listed below.
+        - create N_UPD_SDS datasets, each with two attributes and data,
+          and a global attribute, then close the file
+        - reopen the file, change the values of an attribute of the
+          second dataset to others of the same size, and close the file
+        - verify that the file didn't grow
+        - reopen the file, give the same attribute more values, add an
+          attribute to the first dataset, and close the file
+        - reopen the file and verify all datasets, attributes and data
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+
+static intn
+file_size(const char *name)
+{
+    struct stat sb;
+
+    if (stat(name, &sb) < 0)
+        return FAIL;
+    return (intn)sb.st_size;
+}
+
+static intn
+check_upd_sds(int32 sds_id, intn idx, const char *units, int32 units_len, intn with_note)
+{
+    char    sds_name[H4_MAX_NC_NAME], attr_name[H4_MAX_NC_NAME];
+    char    expected[H4_MAX_NC_NAME], attr_values[80];
+    int32   dimsize[1], rank, ntype, nattrs, count;
+    int32   range[2], data[UPD_LEN];
+    int32   start = 0, edge = UPD_LEN;
+    intn    status, i;
+    intn    num_errs = 0;
+
+    status = SDgetinfo(sds_id, sds_name, &rank, dimsize, &ntype, &nattrs);
+    CHECK(status, FAIL, "SDgetinfo");
+    sprintf(expected, "Data %d", idx);
+    VERIFY(HDstrcmp(sds_name, expected), 0, "SDgetinfo");
+    VERIFY(nattrs, (with_note ? 3 : 2), "SDgetinfo");
+
+    /* attributes are in the order they were set */
+    status = SDattrinfo(sds_id, 0, attr_name, &ntype, &count);
+    CHECK(status, FAIL, "SDattrinfo");
+    VERIFY(HDstrcmp(attr_name, UNITS_NAME), 0, "SDattrinfo");
+    VERIFY(count, units_len, "SDattrinfo");
+    status = SDreadattr(sds_id, 0, attr_values);
+    CHECK(status, FAIL, "SDreadattr");
+    VERIFY(HDstrncmp(attr_values, units, (size_t)units_len), 0, "SDreadattr");
+
+    status = SDattrinfo(sds_id, 1, attr_name, &ntype, &count);
+    CHECK(status, FAIL, "SDattrinfo");
+    VERIFY(HDstrcmp(attr_name, RANGE_NAME), 0, "SDattrinfo");
+    VERIFY(count, 2, "SDattrinfo");
+    status = SDreadattr(sds_id, 1, range);
+    CHECK(status, FAIL, "SDreadattr");
+    VERIFY(range[0], idx, "SDreadattr");
+    VERIFY(range[1], idx + 100, "SDreadattr");
+
+    if (with_note) {
+        status = SDattrinfo(sds_id, 2, attr_name, &ntype, &count);
+        CHECK(status, FAIL, "SDattrinfo");
+        VERIFY(HDstrcmp(attr_name, NOTE_NAME), 0, "SDattrinfo");
+    }
+
+    status = SDreaddata(sds_id, &start, NULL, &edge, data);
+    CHECK(status, FAIL, "SDreaddata");
+    for (i = 0; i < UPD_LEN; i++)
+        VERIFY(data[i], idx * 100 + i, "SDreaddata");
+
+    return num_errs;
+}
+
+static intn
+test_update(void)
+{
+    char   sds_name[H4_MAX_NC_NAME], attr_values[80];
+    int32  file_id, sds_id;
+    int32  dimsize[1] = {UPD_LEN}, range[2], data[UPD_LEN];
+    int32  start = 0, edge = UPD_LEN;
+    int32  ntype, count, index;
+    intn   size_before, size_after;
+    intn   status, i, j;
+    intn   num_errs = 0;
+
+    file_id = SDstart(FILE_UATTR, DFACC_CREATE);
+    CHECK(file_id, FAIL, "SDstart");
+
+    for (i = 0; i < N_UPD_SDS; i++) {
+        sprintf(sds_name, "Data %d", i);
+        sds_id = SDcreate(file_id, sds_name, DFNT_INT32, 1, dimsize);
+        CHECK(sds_id, FAIL, "SDcreate");
+
+        status = SDsetattr(sds_id, UNITS_NAME, DFNT_CHAR8, 6, "meters");
+        CHECK(status, FAIL, "SDsetattr");
+        range[0] = i;
+        range[1] = i + 100;
+        status   = SDsetattr(sds_id, RANGE_NAME, DFNT_INT32, 2, range);
+        CHECK(status, FAIL, "SDsetattr");
+
+        for (j = 0; j < UPD_LEN; j++)
+            data[j] = i * 100 + j;
+        status = SDwritedata(sds_id, &start, NULL, &edge, data);
+        CHECK(status, FAIL, "SDwritedata");
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    status = SDsetattr(file_id, GLOBAL_NAME, DFNT_CHAR8, 7, "created");
+    CHECK(status, FAIL, "SDsetattr");
+
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    size_before = file_size(FILE_UATTR);
+    CHECK(size_before, FAIL, "file_size");
+
+    /* Change an attribute to values of the same size */
+    file_id = SDstart(FILE_UATTR, DFACC_RDWR);
+    CHECK(file_id, FAIL, "SDstart");
+    sds_id = SDselect(file_id, 1);
+    CHECK(sds_id, FAIL, "SDselect");
+    status = SDsetattr(sds_id, UNITS_NAME, DFNT_CHAR8, 6, "inches");
+    CHECK(status, FAIL, "SDsetattr");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* The new values took the place of the old ones */
+    size_after = file_size(FILE_UATTR);
+    VERIFY(size_after, size_before, "file_size");
+
+    /* Make the attribute larger and add another */
+    file_id = SDstart(FILE_UATTR, DFACC_RDWR);
+    CHECK(file_id, FAIL, "SDstart");
+    sds_id = SDselect(file_id, 1);
+    CHECK(sds_id, FAIL, "SDselect");
+    status = SDsetattr(sds_id, UNITS_NAME, DFNT_CHAR8, 11, "centimeters");
+    CHECK(status, FAIL, "SDsetattr");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    sds_id = SDselect(file_id, 0);
+    CHECK(sds_id, FAIL, "SDselect");
+    status = SDsetattr(sds_id, NOTE_NAME, DFNT_CHAR8, 5, "added");
+    CHECK(status, FAIL, "SDsetattr");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* Verify everything in the file */
+    file_id = SDstart(FILE_UATTR, DFACC_READ);
+    CHECK(file_id, FAIL, "SDstart");
+
+    for (i = 0; i < N_UPD_SDS; i++) {
+        sprintf(sds_name, "Data %d", i);
+        index = SDnametoindex(file_id, sds_name);
+        VERIFY(index, i, "SDnametoindex");
+        sds_id = SDselect(file_id, index);
+        CHECK(sds_id, FAIL, "SDselect");
+        if (i == 1)
+            num_errs += check_upd_sds(sds_id, i, "centimeters", 11, FALSE);
+        else
+            num_errs += check_upd_sds(sds_id, i, "meters", 6, i == 0);
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+
+    index = SDfindattr(file_id, GLOBAL_NAME);
+    VERIFY(index, 0, "SDfindattr");
+    status = SDattrinfo(file_id, index, sds_name, &ntype, &count);
+    CHECK(status, FAIL, "SDattrinfo");
+    VERIFY(count, 7, "SDattrinfo");
+    status = SDreadattr(file_id, index, attr_values);
+    CHECK(status, FAIL, "SDreadattr");
+    VERIFY(HDstrncmp(attr_values, "created", 7), 0, "SDreadattr");
+
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    return num_errs;
+} /* test_update */
+
+/********************************************************************
+   Name: test_data_later() - tests that data written to the datasets
+                             of an existing file is listed in their
+                             NDGs.
+
+   Description:
+        SDend doesn't write the NDG of a dataset again when the dataset
+        didn't change.  Writing the first data of a dataset changes it,
+        as its NDG has to list the data.
+
+        The main contents of the test are listed below.
+        - create two datasets without data and close the file
+        - reopen the file, write the data of the first dataset, set the
+          compression of the second and write its data, and close the
+          file
+        - read the data back with SDreaddata and with DFSDgetdata,
+          which only finds it through the NDG
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+
+static intn
+test_data_later(void)
+{
+    char      sds_name[H4_MAX_NC_NAME];
+    int32     file_id, sds_id;
+    int32     dimsize[1] = {UPD_LEN}, data[UPD_LEN];
+    int32     start = 0, edge = UPD_LEN;
+    intn      rank;
+    comp_info c_info;
+    intn      status, i, j;
+    intn      num_errs = 0;
+
+    file_id = SDstart(FILE_UDATA, DFACC_CREATE);
+    CHECK(file_id, FAIL, "SDstart");
+    for (i = 0; i < 2; i++) {
+        sprintf(sds_name, "Data %d", i);
+        sds_id = SDcreate(file_id, sds_name, DFNT_INT32, 1, dimsize);
+        CHECK(sds_id, FAIL, "SDcreate");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* Write the data once the datasets are in the file */
+    file_id = SDstart(FILE_UDATA, DFACC_RDWR);
+    CHECK(file_id, FAIL, "SDstart");
+    for (i = 0; i < 2; i++) {
+        sds_id = SDselect(file_id, i);
+        CHECK(sds_id, FAIL, "SDselect");
+        if (i == 1) {
+            c_info.deflate.level = 6;
+            status               = SDsetcompress(sds_id, COMP_CODE_DEFLATE, &c_info);
+            CHECK(status, FAIL, "SDsetcompress");
+        }
+        for (j = 0; j < UPD_LEN; j++)
+            data[j] = i * 100 + j + 1;
+        status = SDwritedata(sds_id, &start, NULL, &edge, data);
+        CHECK(status, FAIL, "SDwritedata");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* Read the data back through the SD interface */
+    file_id = SDstart(FILE_UDATA, DFACC_READ);
+    CHECK(file_id, FAIL, "SDstart");
+    for (i = 0; i < 2; i++) {
+        sds_id = SDselect(file_id, i);
+        CHECK(sds_id, FAIL, "SDselect");
+        memset(data, 0, sizeof(data));
+        status = SDreaddata(sds_id, &start, NULL, &edge, data);
+        CHECK(status, FAIL, "SDreaddata");
+        for (j = 0; j < UPD_LEN; j++)
+            VERIFY(data[j], i * 100 + j + 1, "SDreaddata");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* and through the DFSD interface, which follows the NDGs */
+    for (i = 0; i < 2; i++) {
+        memset(data, 0, sizeof(data));
+        status = DFSDgetdims(FILE_UDATA, &rank, dimsize, 1);
+        CHECK(status, FAIL, "DFSDgetdims");
+        status = DFSDgetdata(FILE_UDATA, 1, dimsize, data);
+        CHECK(status, FAIL, "DFSDgetdata");
+        for (j = 0; j < UPD_LEN; j++)
+            VERIFY(data[j], i * 100 + j + 1, "DFSDgetdata");
+    }
+    status = DFSDrestart();
+    CHECK(status, FAIL, "DFSDrestart");
+
+    return num_errs;
+} /* test_data_later */
+
+/********************************************************************
+   Name: test_getattrs() - tests reading all the attributes of an
+                           object at once with SDgetattrs.
+
+   Description:
+        Uses the file test_update leaves behind.  Reads the attributes
+        of the first dataset, which has three, and of the file, which
+        has one, and verifies their names, types, counts and values.
+        A dimension without attributes gives none.
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+static intn
+test_getattrs(void)
+{
+    hdf_attr_t *attrs = NULL;
+    int32       file_id, sds_id, dim_id;
+    int32      *range;
+    intn        status;
+    intn        num_errs = 0;
+
+    file_id = SDstart(FILE_UATTR, DFACC_READ);
+    CHECK(file_id, FAIL, "SDstart");
+    sds_id = SDselect(file_id, 0);
+    CHECK(sds_id, FAIL, "SDselect");
+
+    status = SDgetattrs(sds_id, &attrs);
+    VERIFY(status, 3, "SDgetattrs");
+    if (status == 3) {
+        VERIFY(HDstrcmp(attrs[0].name, UNITS_NAME), 0, "SDgetattrs");
+        VERIFY(attrs[0].nt, DFNT_CHAR8, "SDgetattrs");
+        VERIFY(attrs[0].count, 6, "SDgetattrs");
+        VERIFY(HDstrncmp(attrs[0].values, "meters", 6), 0, "SDgetattrs");
+
+        VERIFY(HDstrcmp(attrs[1].name, RANGE_NAME), 0, "SDgetattrs");
+        VERIFY(attrs[1].nt, DFNT_INT32, "SDgetattrs");
+        VERIFY(attrs[1].count, 2, "SDgetattrs");
+        range = (int32 *)attrs[1].values;
+        VERIFY(range[0], 0, "SDgetattrs");
+        VERIFY(range[1], 100, "SDgetattrs");
+
+        VERIFY(HDstrcmp(attrs[2].name, NOTE_NAME), 0, "SDgetattrs");
+        VERIFY(attrs[2].count, 5, "SDgetattrs");
+        VERIFY(HDstrncmp(attrs[2].values, "added", 5), 0, "SDgetattrs");
+    }
+    free(attrs);
+
+    /* the dimension has no attributes */
+    dim_id = SDgetdimid(sds_id, 0);
+    CHECK(dim_id, FAIL, "SDgetdimid");
+    status = SDgetattrs(dim_id, &attrs);
+    VERIFY(status, 0, "SDgetattrs");
+    VERIFY((attrs == NULL), TRUE, "SDgetattrs");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDgetattrs(file_id, &attrs);
+    VERIFY(status, 1, "SDgetattrs");
+    if (status == 1) {
+        VERIFY(HDstrcmp(attrs[0].name, GLOBAL_NAME), 0, "SDgetattrs");
+        VERIFY(attrs[0].count, 7, "SDgetattrs");
+        VERIFY(HDstrncmp(attrs[0].values, "created", 7), 0, "SDgetattrs");
+    }
+    free(attrs);
+
+    status = SDend(file_id);
+    CHECK(status, FAIL, "SDend");
+
+    return num_errs;
+} /* test_getattrs */
+
 /* Test driver for testing SD attributes. */
 extern int
 test_attributes()
@@ -274,6 +661,15 @@ test_attributes()
     /* test when count is passed into SDsetattr as 0 */
     num_errs = num_errs + test_count();
 
+    /* test that changed attributes are written over the old ones */
+    num_errs = num_errs + test_update();
+
+    /* test that data written to an existing file is in the NDGs */
+    num_errs = num_errs + test_data_later();
+
+    /* test reading all attributes of an object at once */
+    num_errs = num_errs + test_getattrs();
+
     if (num_errs == 0)
         PASSED();
 
@@ -17,6 +17,7 @@
  *    test_dim_basics - tests basic dimension operations
  *    test_dim_scales - tests basic dimension scale operations
  *    test_dim_strs   - tests SDsetdimstrs and SDgetdimstrs
+ *    test_dim_names  - tests name lookups in a file with many datasets
  *
  *********************************************************************/
 
@@ -752,6 +753,153 @@ test_dim_strs()
 
 } /* test_dim_strs */
 
+/********************************************************************
+   Name: test_dim_names()
+
+   Description:
+        This test routine exercises the dimension and dataset name
+        lookups on a file holding many datasets.
+        The main contents include:
+        - creates NUM_NAMED_SDS datasets, each sharing its first dimension
+          with all the others and giving its second dimension a unique name
+        - renames one of the unique dimensions, then checks that the old
+          name is free and the new name is taken
+        - verifies that a shared name with a different size is refused
+        - reopens the file and verifies the names and the shared dimension
+
+        The following are included in this test routine:
+        - SDsetdimname
+        - SDnametoindex
+        - SDdiminfo
+
+   Return value:
+        The number of errors occurred in this routine.
+
+*********************************************************************/
+#define NAMES_FILE    "dimnames.hdf"
+#define NUM_NAMED_SDS 100
+#define SHARED_DIM    "Shared Dimension"
+#define RENAMED_DIM   "Renamed Dimension"
+static intn
+test_dim_names()
+{
+    int32 fid, sds_id, dim_id, first_dim_id, sds_idx, status;
+    int32 dims[2], size, dim_data_type, dim_num_attrs;
+    int32 array_rank, num_type, attributes, dim_sizes[H4_MAX_VAR_DIMS];
+    char  name[H4_MAX_NC_NAME], sds_name[H4_MAX_NC_NAME];
+    intn  i;
+    int   num_errs = 0; /* number of errors so far */
+
+    fid = SDstart(NAMES_FILE, DFACC_CREATE);
+    CHECK(fid, FAIL, "SDstart");
+
+    dims[0] = LENGTH4;
+    dims[1] = LENGTH5;
+    for (i = 0; i < NUM_NAMED_SDS; i++) {
+        snprintf(sds_name, sizeof(sds_name), "Named Data %d", i);
+        sds_id = SDcreate(fid, sds_name, DFNT_INT32, RANK2, dims);
+        CHECK(sds_id, FAIL, "SDcreate");
+
+        dim_id = SDgetdimid(sds_id, 0);
+        CHECK(dim_id, FAIL, "SDgetdimid");
+        status = SDsetdimname(dim_id, SHARED_DIM);
+        CHECK(status, FAIL, "SDsetdimname");
+
+        snprintf(name, sizeof(name), "Dimension %d", i);
+        dim_id = SDgetdimid(sds_id, 1);
+        CHECK(dim_id, FAIL, "SDgetdimid");
+        status = SDsetdimname(dim_id, name);
+        CHECK(status, FAIL, "SDsetdimname");
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+
+    /* Rename the second dimension of one dataset, then give its old name to
+       the second dimension of another; both names must resolve correctly */
+    sds_idx = SDnametoindex(fid, "Named Data 50");
+    CHECK(sds_idx, FAIL, "SDnametoindex");
+    sds_id = SDselect(fid, sds_idx);
+    CHECK(sds_id, FAIL, "SDselect");
+    dim_id = SDgetdimid(sds_id, 1);
+    CHECK(dim_id, FAIL, "SDgetdimid");
+    status = SDsetdimname(dim_id, RENAMED_DIM);
+    CHECK(status, FAIL, "SDsetdimname");
+
+    /* A name that is taken by a dimension of another size must be refused */
+    status = SDsetdimname(dim_id, SHARED_DIM);
+    VERIFY(status, FAIL, "SDsetdimname");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    sds_idx = SDnametoindex(fid, "Named Data 51");
+    CHECK(sds_idx, FAIL, "SDnametoindex");
+    sds_id = SDselect(fid, sds_idx);
+    CHECK(sds_id, FAIL, "SDselect");
+    dim_id = SDgetdimid(sds_id, 1);
+    CHECK(dim_id, FAIL, "SDgetdimid");
+    status = SDsetdimname(dim_id, "Dimension 50");
+    CHECK(status, FAIL, "SDsetdimname");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Reopen the file and check what was written */
+    fid = SDstart(NAMES_FILE, DFACC_READ);
+    CHECK(fid, FAIL, "SDstart");
+
+    first_dim_id = FAIL;
+    for (i = 0; i < NUM_NAMED_SDS; i++) {
+        snprintf(sds_name, sizeof(sds_name), "Named Data %d", i);
+        sds_idx = SDnametoindex(fid, sds_name);
+        CHECK(sds_idx, FAIL, "SDnametoindex");
+        sds_id = SDselect(fid, sds_idx);
+        CHECK(sds_id, FAIL, "SDselect");
+
+        status = SDgetinfo(sds_id, name, &array_rank, dim_sizes, &num_type, &attributes);
+        CHECK(status, FAIL, "SDgetinfo");
+        VERIFY_CHAR(name, sds_name, "SDgetinfo");
+
+        /* All the first dimensions are the same dimension */
+        dim_id = SDgetdimid(sds_id, 0);
+        CHECK(dim_id, FAIL, "SDgetdimid");
+        if (first_dim_id == FAIL)
+            first_dim_id = dim_id;
+        VERIFY(dim_id, first_dim_id, "SDgetdimid");
+        status = SDdiminfo(dim_id, name, &size, &dim_data_type, &dim_num_attrs);
+        CHECK(status, FAIL, "SDdiminfo");
+        VERIFY_CHAR(name, SHARED_DIM, "SDdiminfo");
+        VERIFY(size, LENGTH4, "SDdiminfo");
+
+        dim_id = SDgetdimid(sds_id, 1);
+        CHECK(dim_id, FAIL, "SDgetdimid");
+        status = SDdiminfo(dim_id, name, &size, &dim_data_type, &dim_num_attrs);
+        CHECK(status, FAIL, "SDdiminfo");
+        if (i == 50)
+            HDstrcpy(sds_name, RENAMED_DIM);
+        else
+            snprintf(sds_name, sizeof(sds_name), "Dimension %d", i == 51 ? 50 : i);
+        VERIFY_CHAR(name, sds_name, "SDdiminfo");
+        VERIFY(size, LENGTH5, "SDdiminfo");
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+
+    /* A name that no dataset has must not be found */
+    sds_idx = SDnametoindex(fid, "Named Data");
+    VERIFY(sds_idx, FAIL, "SDnametoindex");
+
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Return the number of errors that's been kept track of so far */
+    return num_errs;
+
+} /* test_dim_names */
+
 /* Test driver for testing dimension functionality */
 extern int
 test_dimensions()
@@ -770,6 +918,9 @@ test_dimensions()
     /* Test SD[set/get]dimstrs */
     num_errs = num_errs + test_dim_strs();
 
+    /* Test name lookups with many datasets and dimensions */
+    num_errs = num_errs + test_dim_names();
+
     if (num_errs == 0)
         PASSED();
     return num_errs;
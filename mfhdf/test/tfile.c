@@ -427,6 +427,97 @@ test_fileformat()
     return num_errs;
 }
 
+/********************************************************************
+   Name: test_image() - tests SDstart_image on a file image in memory
+
+   Description:
+    The main contents include:
+    - create an image with Hopen_image, and a dataset in it through
+      SDstart_image
+    - get the image back with Hget_image after SDend
+    - open a copy of the image read-only and read the dataset back
+    - check that the read-only image can't be written
+
+   Return value:
+    The number of errors occurred in this routine.
+
+*********************************************************************/
+
+static int
+test_image()
+{
+    int32  hfid, fid, sds_id, sds_index;
+    int32  dims[2] = {NX, NY}, start[2] = {0, 0};
+    int32  data[NX][NY], outdata[NX][NY];
+    int32  image_len;
+    uint8 *image    = NULL;
+    intn   i, j;
+    intn   status   = 0; /* status returned by called functions */
+    intn   num_errs = 0; /* number of errors so far */
+
+    for (i = 0; i < NX; i++)
+        for (j = 0; j < NY; j++)
+            data[i][j] = i * 100 + j;
+
+    /* Create a new image and a dataset in it */
+    hfid = Hopen_image(NULL, 0, DFACC_CREATE, 0);
+    CHECK(hfid, FAIL, "test_image: Hopen_image");
+    fid = SDstart_image(hfid);
+    CHECK(fid, FAIL, "test_image: SDstart_image");
+
+    sds_id = SDcreate(fid, "image data", DFNT_INT32, 2, dims);
+    CHECK(sds_id, FAIL, "test_image: SDcreate");
+    status = SDwritedata(sds_id, start, NULL, dims, data);
+    CHECK(status, FAIL, "test_image: SDwritedata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_image: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_image: SDend");
+
+    /* Get the image back, then close it */
+    image_len = Hget_image(hfid, NULL, 0);
+    CHECK(image_len, FAIL, "test_image: Hget_image");
+    image = (uint8 *)malloc((size_t)image_len);
+    CHECK_ALLOC(image, "image", "test_image");
+    status = Hget_image(hfid, image, image_len);
+    VERIFY(status, image_len, "test_image: Hget_image");
+    status = Hclose(hfid);
+    CHECK(status, FAIL, "test_image: Hclose");
+
+    /* Read the dataset from the image, in place */
+    hfid = Hopen_image(image, image_len, DFACC_READ, 0);
+    CHECK(hfid, FAIL, "test_image: Hopen_image");
+    fid = SDstart_image(hfid);
+    CHECK(fid, FAIL, "test_image: SDstart_image");
+
+    sds_index = SDnametoindex(fid, "image data");
+    CHECK(sds_index, FAIL, "test_image: SDnametoindex");
+    sds_id = SDselect(fid, sds_index);
+    CHECK(sds_id, FAIL, "test_image: SDselect");
+    status = SDreaddata(sds_id, start, NULL, dims, outdata);
+    CHECK(status, FAIL, "test_image: SDreaddata");
+    for (i = 0; i < NX; i++)
+        for (j = 0; j < NY; j++)
+            if (outdata[i][j] != data[i][j]) {
+                fprintf(stderr, "test_image: wrong data at [%d][%d]\n", i, j);
+                num_errs++;
+            }
+
+    /* The image was opened read-only, so it can't be written */
+    status = SDwritedata(sds_id, start, NULL, dims, data);
+    VERIFY(status, FAIL, "test_image: SDwritedata");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_image: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_image: SDend");
+    status = Hclose(hfid);
+    CHECK(status, FAIL, "test_image: Hclose");
+
+    free(image);
+    return num_errs;
+}
+
 /* Test driver for testing miscellaneous file related APIs. */
 extern int
 test_files()
@@ -448,6 +539,9 @@ test_files()
     /* Test determining of file format */
     num_errs = num_errs + test_fileformat();
 
+    /* Test SD on a file image in memory */
+    num_errs = num_errs + test_image();
+
     if (num_errs == 0)
         PASSED();
     return num_errs;
@@ -17,12 +17,14 @@
  *	Vgetvgroups
  *	VSgetvdatas
  *	Vgisinternal
+ *	SDstart on files written with DFSD and DFAN
  * Structure of the file:
  *    test_mixed_apis - test driver
  *	  test_SDAPI_ids    - tests SDidtype on SD API ids: sd, sds, dim ids
  *	  test_nonSDAPI_ids - tests SDidtype on non SD API ids and invalid id
  *	  test_vdatavgroups - tests Vgetvgroups and VSgetvdatas
  *	  test_vgisinternal - tests Vgisinternal
+ *	  test_dfsd_ndgs    - tests reading many DFSD datasets through SD
  ****************************************************************************/
 
 #include "mfhdf.h"
@@ -533,6 +535,123 @@ test_vgisinternal()
     return num_errs;
 } /* test_vgisinternal */
 
+/*
+ Tests reading datasets written by DFSD, along with their DFAN annotations,
+ through the SD interface.  The datasets alternate between two number types
+ and each has its own shape, label, and annotations, so that the metadata
+ of one dataset cannot be mistaken for that of another.
+*/
+#define DFSD_FILE    "tdfsdndgs.hdf"
+#define NUM_DFSD_DS  12
+#define DFSD_MAXSTR  40
+static intn
+test_dfsd_ndgs()
+{
+    int32  fid, sds_id;
+    int32  dimsizes[RANK], indims[RANK];
+    int32  n_datasets, n_fattrs, rank, nt, nattrs;
+    int32  sds_index, attr_index;
+    int32  idata[X_LENGTH * Y_LENGTH];
+    float  fdata[X_LENGTH * Y_LENGTH];
+    uint16 refs[NUM_DFSD_DS];
+    char   label[DFSD_MAXSTR], anno[DFSD_MAXSTR];
+    char   inbuf[DFSD_MAXSTR], name[DFSD_MAXSTR];
+    intn   ii, jj;
+    intn   status;
+    intn   num_errs = 0; /* number of errors so far */
+
+    for (jj = 0; jj < X_LENGTH * Y_LENGTH; jj++) {
+        idata[jj] = jj;
+        fdata[jj] = (float)jj / 2;
+    }
+
+    /* Write the datasets with DFSD, and label and describe each with DFAN */
+    for (ii = 0; ii < NUM_DFSD_DS; ii++) {
+        dimsizes[0] = ii % X_LENGTH + 1;
+        dimsizes[1] = Y_LENGTH;
+        status      = DFSDsetdims(RANK, dimsizes);
+        CHECK(status, FAIL, "DFSDsetdims");
+        status = DFSDsetNT(ii % 2 ? DFNT_INT32 : DFNT_FLOAT32);
+        CHECK(status, FAIL, "DFSDsetNT");
+        snprintf(label, sizeof(label), "dfsd label %d", ii);
+        status = DFSDsetdatastrs(label, "unit", "format", "coordsys");
+        CHECK(status, FAIL, "DFSDsetdatastrs");
+
+        if (ii == 0)
+            status = DFSDputdata(DFSD_FILE, RANK, dimsizes, ii % 2 ? (void *)idata : (void *)fdata);
+        else
+            status = DFSDadddata(DFSD_FILE, RANK, dimsizes, ii % 2 ? (void *)idata : (void *)fdata);
+        CHECK(status, FAIL, "DFSDadddata");
+        refs[ii] = (uint16)DFSDlastref();
+
+        snprintf(anno, sizeof(anno), "annotation label %d", ii);
+        status = DFANputlabel(DFSD_FILE, DFTAG_NDG, refs[ii], anno);
+        CHECK(status, FAIL, "DFANputlabel");
+        snprintf(anno, sizeof(anno), "annotation description %d", ii);
+        status = DFANputdesc(DFSD_FILE, DFTAG_NDG, refs[ii], anno, (int32)HDstrlen(anno));
+        CHECK(status, FAIL, "DFANputdesc");
+    }
+
+    /* Open the file with SD and verify each dataset and its attributes */
+    fid = SDstart(DFSD_FILE, DFACC_READ);
+    CHECK(fid, FAIL, "SDstart");
+
+    status = SDfileinfo(fid, &n_datasets, &n_fattrs);
+    CHECK(status, FAIL, "SDfileinfo");
+    /* each dataset comes with a coordinate variable for each of its dimensions */
+    VERIFY(n_datasets, NUM_DFSD_DS * (RANK + 1), "SDfileinfo");
+
+    for (ii = 0; ii < NUM_DFSD_DS; ii++) {
+        sds_index = SDreftoindex(fid, refs[ii]);
+        CHECK(sds_index, FAIL, "SDreftoindex");
+        sds_id = SDselect(fid, sds_index);
+        CHECK(sds_id, FAIL, "SDselect");
+
+        status = SDgetinfo(sds_id, name, &rank, indims, &nt, &nattrs);
+        CHECK(status, FAIL, "SDgetinfo");
+        VERIFY(rank, RANK, "SDgetinfo");
+        VERIFY(indims[0], (ii % X_LENGTH + 1), "SDgetinfo");
+        VERIFY(indims[1], Y_LENGTH, "SDgetinfo");
+        VERIFY(nt, (ii % 2 ? DFNT_INT32 : DFNT_FLOAT32), "SDgetinfo");
+
+        /* DFSD label => long_name */
+        snprintf(label, sizeof(label), "dfsd label %d", ii);
+        attr_index = SDfindattr(sds_id, _HDF_LongName);
+        CHECK(attr_index, FAIL, "SDfindattr");
+        memset(inbuf, 0, sizeof(inbuf));
+        status = SDreadattr(sds_id, attr_index, inbuf);
+        CHECK(status, FAIL, "SDreadattr");
+        VERIFY_CHAR(inbuf, label, "SDreadattr long_name");
+
+        /* DFAN label => anno_label-1 */
+        snprintf(anno, sizeof(anno), "annotation label %d", ii);
+        attr_index = SDfindattr(sds_id, _HDF_AnnoLabel "-1");
+        CHECK(attr_index, FAIL, "SDfindattr");
+        memset(inbuf, 0, sizeof(inbuf));
+        status = SDreadattr(sds_id, attr_index, inbuf);
+        CHECK(status, FAIL, "SDreadattr");
+        VERIFY_CHAR(inbuf, anno, "SDreadattr anno_label");
+
+        /* DFAN description => remarks-1 */
+        snprintf(anno, sizeof(anno), "annotation description %d", ii);
+        attr_index = SDfindattr(sds_id, _HDF_Remarks "-1");
+        CHECK(attr_index, FAIL, "SDfindattr");
+        memset(inbuf, 0, sizeof(inbuf));
+        status = SDreadattr(sds_id, attr_index, inbuf);
+        CHECK(status, FAIL, "SDreadattr");
+        VERIFY_CHAR(inbuf, anno, "SDreadattr remarks");
+
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+    }
+
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Return the number of errors that's been kept track of so far */
+    return num_errs;
+} /* test_dfsd_ndgs */
+
 /* Test driver for testing the API functions SDidtype, Vgetvgroups,
    VSgetvdatas, and Vgisinternal. */
 extern int
@@ -552,6 +671,9 @@ test_mixed_apis()
     /* Test Vgisinternal */
     num_errs = num_errs + test_vgisinternal();
 
+    /* Test SDstart on datasets written with DFSD */
+    num_errs = num_errs + test_dfsd_ndgs();
+
     if (num_errs == 0)
         PASSED();
     return num_errs;
@@ -26,6 +26,7 @@
  *	  test_valid_args - tests that when some invalid arguments were passed
  *		into an API, they can be caught and handled properly.
  *		(bugzilla 150)
+ *	  test_append - tests appending records with SDappenddata
  ****************************************************************************/
 
 #include "mfhdf.h"
@@ -744,6 +745,242 @@ test_valid_args2()
     return num_errs;
 } /* test_valid_args2 */
 
+/********************************************************************
+   Name: test_lazy_fill() - tests writing a dataset in SD_LAZYFILL mode
+
+   Description:
+        Writes a few rows of a dataset in lazy fill mode and checks that
+        the rows never written read back as the fill value, both before
+        the dataset is closed and after the file is reopened.
+ *********************************************************************/
+#define LF_FILE_NAME "Lazy_fill.hdf"
+#define LF_X         10
+#define LF_Y         8
+#define LF_FILL      -7
+
+static intn
+check_lazy_rows(int32 sds_id, const char *when)
+{
+    int32 start[2] = {0, 0}, edges[2] = {LF_X, LF_Y};
+    int32 outdata[LF_X][LF_Y];
+    int32 expected;
+    intn  i, j, status;
+    intn  num_errs = 0; /* number of errors so far */
+
+    status = SDreaddata(sds_id, start, NULL, edges, (void *)outdata);
+    CHECK(status, FAIL, "SDreaddata");
+
+    /* rows 2, 3 and 7 were written, the rest are fill values */
+    for (i = 0; i < LF_X; i++)
+        for (j = 0; j < LF_Y; j++) {
+            expected = (i == 2 || i == 3 || i == 7) ? i * 100 + j : LF_FILL;
+            if (outdata[i][j] != expected) {
+                fprintf(stderr, "test_lazy_fill: %s, [%d][%d] is %d instead of %d\n", when, i, j,
+                        (int)outdata[i][j], (int)expected);
+                num_errs++;
+            }
+        }
+
+    /* a read inside what was written */
+    start[0] = 3;
+    edges[0] = 1;
+    status   = SDreaddata(sds_id, start, NULL, edges, (void *)outdata);
+    CHECK(status, FAIL, "SDreaddata");
+    VERIFY(outdata[0][LF_Y - 1], 300 + LF_Y - 1, "SDreaddata");
+
+    return num_errs;
+}
+
+static intn
+test_lazy_fill()
+{
+    int32 sd_id, sds_id, sds_index;
+    int32 dimsizes[2] = {LF_X, LF_Y};
+    int32 start[2], edges[2];
+    int32 data[2][LF_Y], row7[LF_Y];
+    int32 fillval = LF_FILL;
+    intn  i, j, status;
+    intn  num_errs = 0; /* number of errors so far */
+
+    sd_id = SDstart(LF_FILE_NAME, DFACC_CREATE);
+    CHECK(sd_id, FAIL, "SDstart");
+
+    status = SDsetfillmode(sd_id, SD_LAZYFILL);
+    VERIFY(status, SD_FILL, "SDsetfillmode");
+    status = SDsetfillmode(sd_id, SD_LAZYFILL);
+    VERIFY(status, SD_LAZYFILL, "SDsetfillmode");
+
+    sds_id = SDcreate(sd_id, "lazy", DFNT_INT32, 2, dimsizes);
+    CHECK(sds_id, FAIL, "SDcreate");
+    status = SDsetfillvalue(sds_id, (void *)&fillval);
+    CHECK(status, FAIL, "SDsetfillvalue");
+
+    /* write row 7, then rows 2 and 3 */
+    for (j = 0; j < LF_Y; j++)
+        row7[j] = 700 + j;
+    for (i = 0; i < 2; i++)
+        for (j = 0; j < LF_Y; j++)
+            data[i][j] = (i + 2) * 100 + j;
+    start[0] = 7;
+    start[1] = 0;
+    edges[0] = 1;
+    edges[1] = LF_Y;
+    status   = SDwritedata(sds_id, start, NULL, edges, (void *)row7);
+    CHECK(status, FAIL, "SDwritedata");
+    start[0] = 2;
+    edges[0] = 2;
+    status   = SDwritedata(sds_id, start, NULL, edges, (void *)data);
+    CHECK(status, FAIL, "SDwritedata");
+
+    num_errs += check_lazy_rows(sds_id, "before SDendaccess");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+
+    /* the fill values must be in the file now */
+    sd_id = SDstart(LF_FILE_NAME, DFACC_READ);
+    CHECK(sd_id, FAIL, "SDstart");
+    sds_index = SDnametoindex(sd_id, "lazy");
+    CHECK(sds_index, FAIL, "SDnametoindex");
+    sds_id = SDselect(sd_id, sds_index);
+    CHECK(sds_id, FAIL, "SDselect");
+
+    num_errs += check_lazy_rows(sds_id, "after SDend");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(sd_id);
+    CHECK(status, FAIL, "SDend");
+
+    return num_errs;
+} /* test_lazy_fill */
+
+/***************************************************************************
+   Name: test_append() - tests appending records with SDappenddata
+   Description:
+        The main contents include:
+        - create a 2-dim dataset with an unlimited dimension and small
+          linked blocks, so that the records span many blocks and more
+          than one block table
+        - write one record with SDwritedata, then append the others with
+          SDappenddata in a few calls
+        - verify that SDappenddata fails on a fixed-size dataset
+        - close the file, reopen it and append some more records
+        - close the file, reopen it, and verify the size and the data
+
+   Return value:
+        The number of errors occurred in this routine.
+
+****************************************************************************/
+
+#define APPEND_FILE "Append_recs.hdf"
+#define APP_COLS    4
+#define APP_RECS    600
+#define APP_MORE    5
+
+static intn
+test_append()
+{
+    int32  fid, sds_id, fixed_id;
+    int32  dimsizes[2], start[2], edges[2];
+    int32  rank, dtype, nattrs;
+    int32 *data = NULL;
+    char   sds_name[20];
+    int    i;
+    intn   status;
+    intn   num_errs = 0; /* number of errors so far */
+
+    data = (int32 *)malloc(sizeof(int32) * (APP_RECS + APP_MORE) * APP_COLS);
+    CHECK_ALLOC(data, "data", "test_append");
+    for (i = 0; i < (APP_RECS + APP_MORE) * APP_COLS; i++)
+        data[i] = i;
+
+    fid = SDstart(APPEND_FILE, DFACC_CREATE);
+    CHECK(fid, FAIL, "SDstart");
+
+    dimsizes[0] = SD_UNLIMITED;
+    dimsizes[1] = APP_COLS;
+    sds_id      = SDcreate(fid, "Appended", DFNT_INT32, 2, dimsizes);
+    CHECK(sds_id, FAIL, "SDcreate");
+
+    /* four records in a block, 128 blocks in a block table */
+    status = SDsetblocksize(sds_id, 4 * APP_COLS * (int32)sizeof(int32));
+    CHECK(status, FAIL, "SDsetblocksize");
+
+    start[0] = start[1] = 0;
+    edges[0]            = 1;
+    edges[1]            = APP_COLS;
+    status              = SDwritedata(sds_id, start, NULL, edges, (void *)data);
+    CHECK(status, FAIL, "SDwritedata");
+
+    status = SDappenddata(sds_id, 10, data + APP_COLS);
+    CHECK(status, FAIL, "SDappenddata");
+    status = SDappenddata(sds_id, APP_RECS - 11, data + 11 * APP_COLS);
+    CHECK(status, FAIL, "SDappenddata");
+
+    /* Only datasets with an unlimited dimension have records to append */
+    dimsizes[0] = 3;
+    fixed_id    = SDcreate(fid, "Fixed", DFNT_INT32, 2, dimsizes);
+    CHECK(fixed_id, FAIL, "SDcreate");
+    status = SDappenddata(fixed_id, 1, data);
+    VERIFY(status, FAIL, "SDappenddata");
+    status = SDappenddata(sds_id, 0, data);
+    VERIFY(status, FAIL, "SDappenddata");
+
+    status = SDendaccess(fixed_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Append to the dataset in the existing file */
+    fid = SDstart(APPEND_FILE, DFACC_RDWR);
+    CHECK(fid, FAIL, "SDstart");
+    sds_id = SDselect(fid, 0);
+    CHECK(sds_id, FAIL, "SDselect");
+    status = SDappenddata(sds_id, APP_MORE, data + APP_RECS * APP_COLS);
+    CHECK(status, FAIL, "SDappenddata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    /* Verify the size and the data */
+    fid = SDstart(APPEND_FILE, DFACC_READ);
+    CHECK(fid, FAIL, "SDstart");
+    sds_id = SDselect(fid, 0);
+    CHECK(sds_id, FAIL, "SDselect");
+
+    status = SDgetinfo(sds_id, sds_name, &rank, dimsizes, &dtype, &nattrs);
+    CHECK(status, FAIL, "SDgetinfo");
+    VERIFY(dimsizes[0], APP_RECS + APP_MORE, "SDgetinfo");
+
+    for (i = 0; i < (APP_RECS + APP_MORE) * APP_COLS; i++)
+        data[i] = -1;
+    edges[0] = APP_RECS + APP_MORE;
+    status   = SDreaddata(sds_id, start, NULL, edges, (void *)data);
+    CHECK(status, FAIL, "SDreaddata");
+    for (i = 0; i < (APP_RECS + APP_MORE) * APP_COLS; i++)
+        if (data[i] != i) {
+            fprintf(stderr, "test_append: value %d is %d\n", i, (int)data[i]);
+            num_errs++;
+            break;
+        }
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "SDend");
+
+    free(data);
+
+    /* Return the number of errors that's been kept track of, so far */
+    return num_errs;
+} /* test_append */
+
 /* Test driver for testing various SDS' properties. */
 extern int
 test_SDSprops()
@@ -758,6 +995,8 @@ test_SDSprops()
     num_errs = num_errs + test_unlim_inloop();
     num_errs = num_errs + test_valid_args();
     num_errs = num_errs + test_valid_args2();
+    num_errs = num_errs + test_lazy_fill();
+    num_errs = num_errs + test_append();
 
     if (num_errs == 0)
         PASSED();